@@ -0,0 +1,34 @@
+#include "stdafx.h"
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	//Per thread, so counting costs nothing more than an increment and other threads don't show up
+	thread_local long long g_AllocationCount{};
+}
+
+long long AllocationCounter::GetCount()
+{
+	return g_AllocationCount;
+}
+
+//The array and nothrow versions end up here as well
+void* operator new(size_t size)
+{
+	++g_AllocationCount;
+	void* pMemory{ malloc(size == 0 ? 1 : size) };
+	if (pMemory == nullptr) throw std::bad_alloc{};
+	return pMemory;
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+//Counts the allocations made on the calling thread, the executable that links AllocationCounter.cpp
+//replaces the global operator new with one that counts. The plugin's allocations go through it too,
+//linked in or loaded as a library.
+namespace AllocationCounter
+{
+	long long GetCount();
+}
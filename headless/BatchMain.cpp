@@ -0,0 +1,239 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <thread>
+#include "BatchRunner.h"
+
+//Entry point of the plugin linked into this executable, defined in Plugin.h
+extern "C" IPluginBase* Register();
+
+namespace
+{
+	struct Options
+	{
+		int frames{ 36000 }; //10 minutes of game time at the first dt, stops earlier when the agent dies
+		std::vector<float> dts{ 1.f / 60.f }; //Every dt plays as much game time
+		int threadCount{ std::max<int>(1, int(std::thread::hardware_concurrency())) }; //0 when unknown
+		std::string pluginFile{};
+		std::string resultsFile{ "BatchResults.csv" };
+		//Every combination is played, -1 (or no level) keeps what the plugin asks for
+		std::vector<int> seeds{ 0 };
+		std::vector<int> enemyCounts{ -1 };
+		std::vector<int> itemCounts{ -1 };
+		std::vector<std::string> levelFiles{ "" };
+		std::vector<int> difficulties{ -1 };
+	};
+
+	void PrintUsage()
+	{
+		std::cout << "Usage: HeadlessBatch [--plugin file] [--threads n] [--frames n] [--dt a,b,..] [--out file]" << '\n'
+			<< "                     [--seeds first-last|a,b,..] [--enemies a,b,..] [--items a,b,..] [--levels a,b,..] [--difficulties a,b,..]" << '\n';
+	}
+
+	std::vector<std::string> Split(const std::string& list)
+	{
+		std::vector<std::string> values{};
+		size_t start{};
+		for (size_t comma{ list.find(',') }; comma != std::string::npos; comma = list.find(',', start))
+		{
+			values.push_back(list.substr(start, comma - start));
+			start = comma + 1;
+		}
+		values.push_back(list.substr(start));
+		return values;
+	}
+
+	bool ParseInts(const std::string& list, std::vector<int>& values)
+	{
+		values.clear();
+		for (const std::string& value : Split(list))
+		{
+			//A range, the first character can't be a separator so negative numbers still work
+			const size_t dash{ value.find('-', 1) };
+			if (dash == std::string::npos)
+			{
+				values.push_back(atoi(value.c_str()));
+				continue;
+			}
+
+			const int first{ atoi(value.substr(0, dash).c_str()) };
+			const int last{ atoi(value.substr(dash + 1).c_str()) };
+			if (last < first) return false;
+			for (int i{ first }; i <= last; ++i) values.push_back(i);
+		}
+		return !values.empty();
+	}
+
+	bool ParseFloats(const std::string& list, std::vector<float>& values)
+	{
+		values.clear();
+		for (const std::string& value : Split(list))
+		{
+			values.push_back(float(atof(value.c_str())));
+			if (values.back() <= 0.f) return false;
+		}
+		return !values.empty();
+	}
+
+	bool ParseOptions(int argc, char* argv[], Options& options)
+	{
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			const std::string option{ argv[i] };
+			if (i + 1 >= argc) return false;
+
+			const char* pValue{ argv[++i] };
+			bool isValid{ true };
+			if (option == "--plugin") options.pluginFile = pValue;
+			else if (option == "--threads") options.threadCount = atoi(pValue);
+			else if (option == "--frames") options.frames = atoi(pValue);
+			else if (option == "--dt") isValid = ParseFloats(pValue, options.dts);
+			else if (option == "--out") options.resultsFile = pValue;
+			else if (option == "--seeds") isValid = ParseInts(pValue, options.seeds);
+			else if (option == "--enemies") isValid = ParseInts(pValue, options.enemyCounts);
+			else if (option == "--items") isValid = ParseInts(pValue, options.itemCounts);
+			else if (option == "--levels") options.levelFiles = Split(pValue);
+			else if (option == "--difficulties") isValid = ParseInts(pValue, options.difficulties);
+			else return false;
+			if (!isValid) return false;
+		}
+		return options.frames > 0 && options.threadCount > 0;
+	}
+
+	std::vector<BatchRunner::Game> GetGames(const Options& options)
+	{
+		std::vector<BatchRunner::Game> games{};
+		for (float dt : options.dts)
+		{
+			const int frames{ std::max<int>(1, int(options.frames * options.dts.front() / dt)) };
+			for (const std::string& levelFile : options.levelFiles)
+				for (int difficulty : options.difficulties)
+					for (int enemyCount : options.enemyCounts)
+						for (int itemCount : options.itemCounts)
+							for (int seed : options.seeds)
+								games.push_back(BatchRunner::Game{ seed, enemyCount, itemCount, levelFile, difficulty, dt, frames, {} });
+		}
+		return games;
+	}
+
+	bool WriteResults(const std::string& filePath, const std::vector<BatchRunner::Result>& results)
+	{
+		std::ofstream file{ filePath };
+		if (!file) return false;
+
+		file << "seed,enemies,items,level,difficulty,dt,frames,time_survived,score,kills,hits,missed_shots,items_picked_up,died,"
+			<< "direction_reversals,run_toggles,wall_seconds" << '\n';
+		for (const BatchRunner::Result& result : results)
+		{
+			const GameDebugParams& params{ result.params };
+			const StatisticsInfo& stats{ result.stats };
+			file << params.Seed << ',' << params.EnemyCount << ',' << params.ItemCount << ','
+				<< (result.isLevelLoaded ? params.LevelFile : "generated") << ',' << params.StartingDifficultyStage << ','
+				<< result.game.dt << ',' << result.frames << ',' << stats.TimeSurvived << ',' << stats.Score << ','
+				<< stats.NumEnemiesKilled << ',' << stats.NumEnemiesHit << ',' << stats.NumMissedShots << ',' << stats.NumItemsPickUp << ','
+				<< (result.isDead ? 1 : 0) << ',' << result.directionReversals << ',' << result.runToggles << ',' << result.wallTime << '\n';
+		}
+		return bool(file);
+	}
+
+	//Everything a configuration played over its seeds
+	struct Summary
+	{
+		std::vector<float> survived;
+		float score;
+		float kills;
+		float missedShots;
+		int deaths;
+		float simulatedTime;
+		int directionReversals;
+		int runToggles;
+	};
+
+	void PrintSummary(const std::string& name, Summary& summary)
+	{
+		std::vector<float>& survived{ summary.survived };
+		std::sort(survived.begin(), survived.end());
+
+		const size_t count{ survived.size() };
+		float total{};
+		for (float time : survived) total += time;
+		const float median{ count % 2 == 1 ? survived[count / 2] : (survived[count / 2 - 1] + survived[count / 2]) * 0.5f };
+
+		std::cout << name << ": " << count << " games, survived mean " << total / count << "s, median " << median
+			<< "s, min " << survived.front() << "s, max " << survived.back() << "s, score " << summary.score / count
+			<< ", kills " << summary.kills / count << ", missed shots " << summary.missedShots / count
+			<< ", died " << summary.deaths * 100.f / count << "%, direction reversals " << summary.directionReversals / summary.simulatedTime
+			<< "/s, run toggles " << summary.runToggles / summary.simulatedTime << "/s" << '\n';
+	}
+
+	void PrintSummaries(const std::vector<BatchRunner::Result>& results)
+	{
+		std::map<std::string, Summary> summaries{};
+		Summary all{};
+		for (const BatchRunner::Result& result : results)
+		{
+			const GameDebugParams& params{ result.params };
+			const std::string name{ "enemies " + std::to_string(params.EnemyCount) + ", items " + std::to_string(params.ItemCount)
+				+ ", level " + (result.isLevelLoaded ? params.LevelFile : "generated") + ", difficulty " + std::to_string(params.StartingDifficultyStage)
+				+ ", dt " + std::to_string(result.game.dt) };
+
+			for (Summary* pSummary : { &summaries[name], &all })
+			{
+				pSummary->survived.push_back(result.stats.TimeSurvived);
+				pSummary->score += float(result.stats.Score);
+				pSummary->kills += float(result.stats.NumEnemiesKilled);
+				pSummary->missedShots += float(result.stats.NumMissedShots);
+				pSummary->deaths += result.isDead ? 1 : 0;
+				pSummary->simulatedTime += std::max<float>(result.frames * result.game.dt, 1e-6f);
+				pSummary->directionReversals += result.directionReversals;
+				pSummary->runToggles += result.runToggles;
+			}
+		}
+
+		if (summaries.size() > 1)
+		{
+			for (auto& summary : summaries) PrintSummary(summary.first, summary.second);
+		}
+		PrintSummary("All", all);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options{};
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const std::vector<BatchRunner::Game> games{ GetGames(options) };
+	BatchRunner runner{ &Register, options.pluginFile };
+	std::cout << "Playing " << games.size() << " games on " << options.threadCount << " threads" << '\n';
+	if (!runner.Run(games, options.threadCount))
+	{
+		std::cout << "Batch failed: " << runner.GetError() << '\n';
+		return 1;
+	}
+
+	const std::vector<BatchRunner::Result>& results{ runner.GetResults() };
+	if (!WriteResults(options.resultsFile, results))
+		std::cout << "Results could not be written to " << options.resultsFile << '\n';
+
+	long long frames{};
+	double simulatedTime{};
+	float gameTime{};
+	for (const BatchRunner::Result& result : results)
+	{
+		frames += result.frames;
+		simulatedTime += result.frames * double(result.game.dt);
+		gameTime += result.wallTime;
+	}
+	const float wallTime{ std::max<float>(runner.GetWallTime(), 1e-6f) };
+	std::cout << "Done in " << wallTime << "s, " << results.size() / wallTime << " games per second, " << frames / wallTime
+		<< " frames per second, " << simulatedTime / wallTime << " simulated seconds per second, "
+		<< gameTime / wallTime << " games in flight on average, " << runner.GetSteals() << " games stolen" << '\n';
+	PrintSummaries(results);
+	return 0;
+}
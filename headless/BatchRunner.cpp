@@ -0,0 +1,170 @@
+#include "stdafx.h"
+#include "BatchRunner.h"
+#include <chrono>
+#include <thread>
+#include "HeadlessInterface.h"
+
+namespace
+{
+	//Swallows the plugin's output, unlike a null rdbuf it doesn't touch the state cout shares between the workers
+	class NullBuffer final : public std::streambuf
+	{
+	protected:
+		int_type overflow(int_type c) override { return traits_type::not_eof(c); }
+		std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+	};
+
+	float GetSeconds(std::chrono::steady_clock::duration duration)
+	{
+		return std::chrono::duration<float>(duration).count();
+	}
+}
+
+BatchRunner::BatchRunner(PluginHost::RegisterFunction pRegister, const std::string& pluginFile, PluginHost::ParametersRegisterFunction pParametersRegister)
+	: m_pRegister{ pRegister }
+	, m_pParametersRegister{ pParametersRegister }
+	, m_PluginFile{ pluginFile }
+{
+}
+
+bool BatchRunner::Run(const std::vector<Game>& games, int threadCount)
+{
+	m_pGames = &games;
+	m_Results.assign(games.size(), Result{});
+	m_Error.clear();
+	m_Steals = 0;
+	m_WallTime = 0.f;
+	if (games.empty()) return true;
+
+	threadCount = std::max<int>(1, std::min<int>(threadCount, int(games.size())));
+	NullBuffer nullBuffer{};
+	std::streambuf* pCoutBuffer{ std::cout.rdbuf(&nullBuffer) };
+
+	//One frame of the first game on each level bakes its index and fields, so the workers only read them
+	std::vector<std::string> bakedLevels{};
+	for (const Game& game : games)
+	{
+		if (std::find(bakedLevels.begin(), bakedLevels.end(), game.levelFile) != bakedLevels.end()) continue;
+		bakedLevels.push_back(game.levelFile);
+
+		Result warmUp{};
+		if (!Play(game, 1, warmUp, m_Error))
+		{
+			std::cout.rdbuf(pCoutBuffer);
+			return false;
+		}
+	}
+
+	//Neighbouring games end up on the same worker, they tend to take about as long
+	m_Queues = std::vector<Queue>(threadCount);
+	for (int i{}; i < int(games.size()); ++i)
+		m_Queues[size_t(i) * threadCount / games.size()].games.push_back(i);
+
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers{};
+	for (int worker{ 1 }; worker < threadCount; ++worker)
+		workers.emplace_back(&BatchRunner::Work, this, worker);
+	Work(0);
+	for (std::thread& worker : workers) worker.join();
+	m_WallTime = GetSeconds(std::chrono::steady_clock::now() - start);
+
+	std::cout.rdbuf(pCoutBuffer);
+	m_Queues.clear();
+	return m_Error.empty();
+}
+
+bool BatchRunner::Play(const Game& game, int maxFrames, Result& result, std::string& error) const
+{
+	const auto start = std::chrono::steady_clock::now();
+	result.game = game;
+
+	PluginHost host{};
+	if (m_PluginFile.empty() && !game.parameters.empty() && m_pParametersRegister == nullptr)
+	{
+		error = "The game has parameters but nothing to pass them to";
+		return false;
+	}
+	bool isCreated{};
+	if (!m_PluginFile.empty()) isCreated = host.Load(m_PluginFile, game.parameters);
+	else if (game.parameters.empty()) isCreated = host.Create(m_pRegister);
+	else isCreated = host.Create(m_pParametersRegister, game.parameters);
+	if (!isCreated)
+	{
+		error = host.GetError();
+		return false;
+	}
+
+	//Same order as HeadlessGame: the seed and level go in first, what the batch varies wins over the plugin
+	GameDebugParams params{};
+	params.Seed = game.seed;
+	if (!game.levelFile.empty()) params.LevelFile = game.levelFile;
+	host.InitGameDebugParams(params);
+	if (game.enemyCount >= 0) params.EnemyCount = game.enemyCount;
+	if (game.itemCount >= 0) params.ItemCount = game.itemCount;
+	if (!game.levelFile.empty()) params.LevelFile = game.levelFile;
+	if (game.difficulty >= 0) params.StartingDifficultyStage = game.difficulty;
+
+	HeadlessInterface headless{};
+	headless.Reset(params);
+	host.Initialize(&headless);
+
+	int frame{};
+	for (; frame < maxFrames && !headless.IsGameOver(); ++frame)
+	{
+		headless.Step(game.dt, host.UpdateSteering(game.dt));
+	}
+	host.Unload();
+
+	result.params = params;
+	result.stats = headless.World_GetStats();
+	result.isDead = headless.Agent_GetInfo().Death;
+	result.isLevelLoaded = headless.IsLevelLoaded();
+	result.frames = frame;
+	result.wallTime = GetSeconds(std::chrono::steady_clock::now() - start);
+	result.directionReversals = headless.GetDirectionReversals();
+	result.runToggles = headless.GetRunToggles();
+	return true;
+}
+
+void BatchRunner::Work(int worker)
+{
+	int game{};
+	std::string error{};
+	while (Pop(worker, game))
+	{
+		const Game& toPlay{ (*m_pGames)[game] };
+		if (Play(toPlay, toPlay.frames, m_Results[game], error)) continue;
+
+		std::lock_guard<std::mutex> lock{ m_ErrorMutex };
+		if (m_Error.empty()) m_Error = error;
+	}
+}
+
+bool BatchRunner::Pop(int worker, int& game)
+{
+	{
+		Queue& own{ m_Queues[worker] };
+		std::lock_guard<std::mutex> lock{ own.mutex };
+		if (!own.games.empty())
+		{
+			game = own.games.front();
+			own.games.pop_front();
+			return true;
+		}
+	}
+
+	//Games are never added once running, when every queue is empty the batch is done
+	const int queueCount{ int(m_Queues.size()) };
+	for (int offset{ 1 }; offset < queueCount; ++offset)
+	{
+		Queue& victim{ m_Queues[(worker + offset) % queueCount] };
+		std::lock_guard<std::mutex> lock{ victim.mutex };
+		if (victim.games.empty()) continue;
+
+		game = victim.games.back();
+		victim.games.pop_back();
+		++m_Steals;
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include "PluginHost.h"
+
+//Plays many headless games side by side, one game per task on a pool of worker threads.
+//Every worker starts with its own share of the games and steals from the back of the others once it runs dry,
+//so a few long games (the agent survives) don't leave the other cores idle at the end.
+class BatchRunner final
+{
+public:
+	//What one game varies, -1 (or an empty level) keeps what the plugin asks for in InitGameDebugParams
+	struct Game
+	{
+		int seed;
+		int enemyCount;
+		int itemCount;
+		std::string levelFile;
+		int difficulty;
+		float dt; //Fixed, the game runs as fast as it goes
+		int frames; //At most, the game ends earlier when the agent dies
+		std::string parameters; //AIParameters.txt format, empty keeps what the plugin loads itself
+	};
+
+	struct Result
+	{
+		Game game;
+		GameDebugParams params; //What was played
+		StatisticsInfo stats;
+		bool isDead;
+		bool isLevelLoaded;
+		int frames;
+		float wallTime; //Seconds
+		int directionReversals;
+		int runToggles;
+	};
+
+	//The plugin comes from pluginFile when set, otherwise from pRegister, or pParametersRegister for games with parameters
+	BatchRunner(PluginHost::RegisterFunction pRegister, const std::string& pluginFile, PluginHost::ParametersRegisterFunction pParametersRegister = nullptr);
+	~BatchRunner() = default;
+	BatchRunner(const BatchRunner&) = delete;
+	BatchRunner& operator=(const BatchRunner&) = delete;
+	BatchRunner(BatchRunner&&) = delete;
+	BatchRunner& operator=(BatchRunner&&) = delete;
+
+	//Blocks until every game is played, results are in the order of the games
+	bool Run(const std::vector<Game>& games, int threadCount);
+
+	const std::vector<Result>& GetResults() const { return m_Results; }
+	const std::string& GetError() const { return m_Error; }
+	int GetSteals() const { return m_Steals; }
+	float GetWallTime() const { return m_WallTime; }
+
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<int> games;
+	};
+
+	bool Play(const Game& game, int maxFrames, Result& result, std::string& error) const;
+	void Work(int worker);
+	bool Pop(int worker, int& game);
+
+	const PluginHost::RegisterFunction m_pRegister;
+	const PluginHost::ParametersRegisterFunction m_pParametersRegister;
+	const std::string m_PluginFile;
+
+	const std::vector<Game>* m_pGames{};
+	std::vector<Result> m_Results{};
+	std::vector<Queue> m_Queues{};
+	std::mutex m_ErrorMutex{};
+	std::string m_Error{};
+	std::atomic<int> m_Steals{};
+	float m_WallTime{};
+};
@@ -0,0 +1,315 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include "AllocationCounter.h"
+#include "InstructionCounter.h"
+#include "PluginHost.h"
+#include "TraceReplayer.h"
+
+//Entry point of the plugin linked into this executable, defined in Plugin.h
+extern "C" IPluginBase* Register();
+
+namespace
+{
+	struct Options
+	{
+		std::vector<std::string> traceFiles{};
+		std::string pluginFile{};
+		std::string jsonFile{}; //Written as well when set, for tracking regressions
+		int warmups{ 1 }; //Replays per trace that aren't measured
+		int repeats{ 5 }; //Replays per trace that are, every frame of every replay is a sample
+	};
+
+	//One per frame UpdateSteering was called
+	struct Samples
+	{
+		std::vector<double> latencies; //Microseconds
+		std::vector<double> allocations;
+		std::vector<double> instructions;
+	};
+
+	struct Result
+	{
+		std::string name;
+		Samples samples;
+		std::string error; //Not loaded or damaged, nothing was measured
+		std::string divergence; //Only the frames up to it were measured
+	};
+
+	const int g_LatencyCount{ 6 };
+	const char* g_LatencyNames[g_LatencyCount]{ "mean", "p50", "p90", "p99", "p99.9", "max" };
+	const double g_Percentiles[g_LatencyCount - 1]{ 0.5, 0.9, 0.99, 0.999, 1.0 };
+
+	struct Summary
+	{
+		size_t frames;
+		double latencies[g_LatencyCount]; //Mean, p50, p90, p99, p99.9 and max
+		double allocations[2]; //Mean and max
+		double instructions[2]; //Mean and p99
+	};
+
+	void PrintUsage()
+	{
+		std::cout << "Usage: HeadlessBench trace [trace..] [--plugin file] [--warmups n] [--repeats n] [--json file]" << '\n';
+	}
+
+	bool ParseOptions(int argc, char* argv[], Options& options)
+	{
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			const std::string option{ argv[i] };
+			if (option.compare(0, 2, "--") != 0)
+			{
+				options.traceFiles.push_back(option);
+				continue;
+			}
+			if (i + 1 >= argc) return false;
+
+			const char* pValue{ argv[++i] };
+			if (option == "--plugin") options.pluginFile = pValue;
+			else if (option == "--json") options.jsonFile = pValue;
+			else if (option == "--warmups") options.warmups = atoi(pValue);
+			else if (option == "--repeats") options.repeats = atoi(pValue);
+			else return false;
+		}
+		return !options.traceFiles.empty() && options.warmups >= 0 && options.repeats > 0;
+	}
+
+	std::string GetName(const std::string& filePath)
+	{
+		const size_t slash{ filePath.find_last_of("/\\") };
+		const std::string fileName{ slash == std::string::npos ? filePath : filePath.substr(slash + 1) };
+		return fileName.substr(0, fileName.find_last_of('.'));
+	}
+
+	//Plays the trace back to a fresh plugin once, pSamples gets a sample per frame when it is set
+	bool Replay(const Options& options, const std::string& traceFile, const InstructionCounter& counter, Samples* pSamples, Result& result)
+	{
+		TraceReplayer replayer{};
+		if (!replayer.Open(traceFile))
+		{
+			result.error = "Trace not loaded: " + replayer.GetError();
+			return false;
+		}
+
+		PluginHost host{};
+		if (!(options.pluginFile.empty() ? host.Create(&Register) : host.Load(options.pluginFile)))
+		{
+			result.error = "Plugin not loaded: " + host.GetError();
+			return false;
+		}
+
+		GameDebugParams params{};
+		params.Seed = replayer.GetSeed();
+		host.InitGameDebugParams(params);
+		host.Initialize(&replayer);
+
+		using Clock = std::chrono::steady_clock;
+		float dt{};
+		while (replayer.BeginFrame(dt))
+		{
+			//Read in the reverse order they are taken, so the others don't end up in what each one counts
+			const long long instructionsStart{ counter.GetCount() };
+			const long long allocationsStart{ AllocationCounter::GetCount() };
+			const Clock::time_point start{ Clock::now() };
+			const SteeringPlugin_Output steering{ host.UpdateSteering(dt) };
+			const Clock::time_point end{ Clock::now() };
+			const long long allocations{ AllocationCounter::GetCount() - allocationsStart };
+			const long long instructions{ counter.GetCount() - instructionsStart };
+			replayer.EndFrame(steering);
+
+			if (pSamples == nullptr) continue;
+			pSamples->latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+			pSamples->allocations.push_back(double(allocations));
+			pSamples->instructions.push_back(double(instructions));
+		}
+		host.Unload();
+
+		if (!replayer.GetError().empty())
+		{
+			result.error = "Trace damaged after frame " + std::to_string(replayer.GetFrame()) + ": " + replayer.GetError();
+			return false;
+		}
+		if (replayer.HasDiverged())
+		{
+			const int frame{ replayer.GetFrame() };
+			result.divergence = (frame == -1 ? std::string{ "while initializing" } : "at frame " + std::to_string(frame)) + ": " + replayer.GetDivergence();
+			return false;
+		}
+		return true;
+	}
+
+	Result Measure(const Options& options, const std::string& traceFile, const InstructionCounter& counter)
+	{
+		Result result{};
+		result.name = GetName(traceFile);
+		for (int i{}; i < options.warmups; ++i)
+		{
+			if (!Replay(options, traceFile, counter, nullptr, result)) return result;
+		}
+		for (int i{}; i < options.repeats; ++i)
+		{
+			if (!Replay(options, traceFile, counter, &result.samples, result)) return result;
+		}
+		return result;
+	}
+
+	//Nearest rank
+	double GetPercentile(const std::vector<double>& sorted, double percentile)
+	{
+		const size_t rank{ size_t(std::ceil(percentile * sorted.size())) };
+		return sorted[std::min<size_t>(std::max<size_t>(rank, 1), sorted.size()) - 1];
+	}
+
+	double GetMean(const std::vector<double>& values)
+	{
+		double total{};
+		for (double value : values) total += value;
+		return total / values.size();
+	}
+
+	Summary Summarize(Samples samples)
+	{
+		Summary summary{};
+		summary.frames = samples.latencies.size();
+		if (summary.frames == 0) return summary;
+
+		std::sort(samples.latencies.begin(), samples.latencies.end());
+		std::sort(samples.allocations.begin(), samples.allocations.end());
+		std::sort(samples.instructions.begin(), samples.instructions.end());
+
+		summary.latencies[0] = GetMean(samples.latencies);
+		for (int i{ 1 }; i < g_LatencyCount; ++i) summary.latencies[i] = GetPercentile(samples.latencies, g_Percentiles[i - 1]);
+		summary.allocations[0] = GetMean(samples.allocations);
+		summary.allocations[1] = samples.allocations.back();
+		summary.instructions[0] = GetMean(samples.instructions);
+		summary.instructions[1] = GetPercentile(samples.instructions, 0.99);
+		return summary;
+	}
+
+	void PrintSummary(const std::string& name, const Summary& summary, bool hasInstructions)
+	{
+		std::cout << std::left << std::setw(16) << name << std::right << std::setw(8) << summary.frames;
+		for (double latency : summary.latencies) std::cout << std::setw(10) << latency;
+		std::cout << std::setw(10) << summary.allocations[0] << std::setw(10) << summary.allocations[1];
+		if (hasInstructions) std::cout << std::setw(14) << summary.instructions[0] << std::setw(14) << summary.instructions[1];
+		std::cout << '\n';
+	}
+
+	void WriteSummary(std::ofstream& file, const Summary& summary, bool hasInstructions)
+	{
+		file << "\"frames\": " << summary.frames << ", \"latency_us\": {";
+		for (int i{}; i < g_LatencyCount; ++i) file << (i == 0 ? " \"" : ", \"") << g_LatencyNames[i] << "\": " << summary.latencies[i];
+		file << " }, \"allocations_per_frame\": { \"mean\": " << summary.allocations[0] << ", \"max\": " << summary.allocations[1] << " }, \"instructions_per_frame\": ";
+		if (hasInstructions) file << "{ \"mean\": " << summary.instructions[0] << ", \"p99\": " << summary.instructions[1] << " }";
+		else file << "null";
+	}
+
+	std::string Quote(const std::string& text)
+	{
+		std::string quoted{ "\"" };
+		for (char character : text)
+		{
+			if (character == '"' || character == '\\') quoted += '\\';
+			quoted += character;
+		}
+		return quoted + '"';
+	}
+
+	bool WriteJson(const std::string& filePath, const Options& options, const std::vector<Result>& results, const Summary& all, bool hasInstructions)
+	{
+		std::ofstream file{ filePath };
+		if (!file) return false;
+
+		file << std::fixed << std::setprecision(3);
+		file << "{" << '\n' << "\t\"repeats\": " << options.repeats << "," << '\n' << "\t\"traces\": [" << '\n';
+		for (size_t i{}; i < results.size(); ++i)
+		{
+			const Result& result{ results[i] };
+			file << "\t\t{ \"name\": " << Quote(result.name) << ", ";
+			if (!result.error.empty()) file << "\"error\": " << Quote(result.error) << ", ";
+			if (!result.divergence.empty()) file << "\"divergence\": " << Quote(result.divergence) << ", ";
+			WriteSummary(file, Summarize(result.samples), hasInstructions);
+			file << " }" << (i + 1 < results.size() ? "," : "") << '\n';
+		}
+		file << "\t]," << '\n' << "\t\"all\": { ";
+		WriteSummary(file, all, hasInstructions);
+		file << " }" << '\n' << "}" << '\n';
+		return bool(file);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options{};
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	//The same game every replay, without recording over the trace
+#ifdef _WIN32
+	_putenv_s("GPP_DETERMINISTIC", "1");
+	_putenv_s("GPP_TRACE", "");
+#else
+	setenv("GPP_DETERMINISTIC", "1", 1);
+	unsetenv("GPP_TRACE");
+#endif
+
+	InstructionCounter counter{};
+	const bool hasInstructions{ counter.Open() };
+	if (!hasInstructions) std::cout << "Instructions not counted, " << counter.GetError() << '\n';
+
+	//The plugin's own output would be most of what gets measured
+	std::streambuf* pCoutBuffer{ std::cout.rdbuf() };
+	std::vector<Result> results{};
+	Samples all{};
+	for (const std::string& traceFile : options.traceFiles)
+	{
+		std::cout.rdbuf(nullptr);
+		results.push_back(Measure(options, traceFile, counter));
+		std::cout.clear();
+		std::cout.rdbuf(pCoutBuffer);
+
+		const Samples& samples{ results.back().samples };
+		all.latencies.insert(all.latencies.end(), samples.latencies.begin(), samples.latencies.end());
+		all.allocations.insert(all.allocations.end(), samples.allocations.begin(), samples.allocations.end());
+		all.instructions.insert(all.instructions.end(), samples.instructions.begin(), samples.instructions.end());
+	}
+
+	std::cout << std::fixed << std::setprecision(2) << "Frame latency in microseconds, " << options.repeats << " replays per trace" << '\n';
+	std::cout << std::left << std::setw(16) << "Trace" << std::right << std::setw(8) << "Frames";
+	for (const char* pName : g_LatencyNames) std::cout << std::setw(10) << pName;
+	std::cout << std::setw(10) << "Allocs" << std::setw(10) << "Max";
+	if (hasInstructions) std::cout << std::setw(14) << "Instructions" << std::setw(14) << "p99";
+	std::cout << '\n';
+
+	int exitCode{};
+	for (const Result& result : results)
+	{
+		PrintSummary(result.name, Summarize(result.samples), hasInstructions);
+		if (!result.error.empty())
+		{
+			std::cout << "  " << result.error << '\n';
+			exitCode = 1;
+		}
+		else if (!result.divergence.empty())
+		{
+			std::cout << "  Diverged " << result.divergence << ", replay from a directory with the level files it was recorded with" << '\n';
+			if (exitCode == 0) exitCode = 2;
+		}
+	}
+	const Summary allSummary{ Summarize(all) };
+	if (results.size() > 1) PrintSummary("All", allSummary, hasInstructions);
+
+	if (!options.jsonFile.empty() && !WriteJson(options.jsonFile, options, results, allSummary, hasInstructions))
+	{
+		std::cout << "Results could not be written to " << options.jsonFile << '\n';
+		exitCode = 1;
+	}
+	return exitCode;
+}
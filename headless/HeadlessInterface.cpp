@@ -0,0 +1,834 @@
+#include "stdafx.h"
+#include "HeadlessInterface.h"
+
+namespace
+{
+	//The world draws from its own stream, the plugin's behaviours use the low ones
+	const uint64_t g_WorldStream{ 0x5EEDull };
+
+	struct EnemyType
+	{
+		eEnemyType type;
+		float weight; //Chance to spawn
+		float size; //Radius
+		float speed;
+		int health; //Shots to kill
+		float damage; //Per bite
+	};
+
+	const EnemyType g_EnemyTypes[]{
+		{ eEnemyType::DEFAULT, 0.1f, 1.f, 3.5f, 2, 1.f },
+		{ eEnemyType::ZOMBIE_NORMAL, 0.5f, 1.f, 3.5f, 2, 1.f },
+		{ eEnemyType::ZOMBIE_RUNNER, 0.2f, 0.75f, 6.5f, 1, 0.5f },
+		{ eEnemyType::ZOMBIE_HEAVY, 0.2f, 1.5f, 2.5f, 6, 2.f }
+	};
+
+	struct ItemType
+	{
+		eItemType type;
+		float weight;
+		int minValue;
+		int maxValue;
+	};
+
+	const ItemType g_ItemTypes[]{
+		{ eItemType::PISTOL, 0.25f, 5, 15 },
+		{ eItemType::MEDKIT, 0.25f, 2, 6 },
+		{ eItemType::FOOD, 0.3f, 2, 6 },
+		{ eItemType::GARBAGE, 0.2f, 0, 0 }
+	};
+
+	const float g_MaxStat{ 10.f }; //Health, energy and stamina
+
+	float WrapAngle(float angle)
+	{
+		const float pi{ float(E_PI) };
+		while (angle > pi) angle -= 2 * pi;
+		while (angle < -pi) angle += 2 * pi;
+		return angle;
+	}
+
+	//Distance along the ray to the box, range when it misses
+	float RaycastBox(const Elite::Vector2& origin, const Elite::Vector2& direction, const Elite::Vector2& boxMin, const Elite::Vector2& boxMax, float range)
+	{
+		float enter{ 0.f }, exit{ range };
+		for (int axis{}; axis < 2; ++axis)
+		{
+			if (abs(direction[axis]) < FLT_EPSILON)
+			{
+				if (origin[axis] < boxMin[axis] || origin[axis] > boxMax[axis]) return range;
+				continue;
+			}
+
+			float toMin{ (boxMin[axis] - origin[axis]) / direction[axis] };
+			float toMax{ (boxMax[axis] - origin[axis]) / direction[axis] };
+			if (toMin > toMax) std::swap(toMin, toMax);
+			enter = std::max<float>(enter, toMin);
+			exit = std::min<float>(exit, toMax);
+			if (enter > exit) return range;
+		}
+		return enter;
+	}
+}
+
+const int HeadlessInterface::m_InventoryCapacity;
+
+HeadlessInterface::HeadlessInterface()
+{
+	Reset(GameDebugParams{});
+}
+
+HeadlessInterface::~HeadlessInterface()
+{
+	SAFE_DELETE(m_pNavMesh);
+}
+
+void HeadlessInterface::Reset(const GameDebugParams& params)
+{
+	m_Params = params;
+	m_Random.Seed(uint64_t(params.Seed), g_WorldStream);
+	m_NextHash = 1;
+	m_DrawCalls = 0;
+	m_IsShutdownRequested = false;
+	m_PreviousVelocity = Elite::Vector2{};
+	m_WasRunRequested = false;
+	m_DirectionReversals = 0;
+	m_RunToggles = 0;
+
+	LoadHouses(params);
+
+	m_Agent = AgentInfo{};
+	m_Agent.Stamina = g_MaxStat;
+	m_Agent.Health = g_MaxStat;
+	m_Agent.Energy = g_MaxStat;
+	m_Agent.FOV_Angle = float(E_PI_2);
+	m_Agent.FOV_Range = 30.f;
+	m_Agent.MaxLinearSpeed = m_AgentWalkSpeed;
+	m_Agent.MaxAngularSpeed = float(E_PI);
+	m_Agent.GrabRange = 3.f;
+	m_Agent.AgentSize = 1.5f;
+	m_Agent.Position = Collide({}, m_Agent.AgentSize * 0.5f);
+	m_BittenTime = m_BittenMemoryTime;
+
+	m_Stats = StatisticsInfo{};
+	m_Stats.Difficulty = float(params.StartingDifficultyStage);
+	m_Stats.KillCountdown = m_KillCountdownTime;
+
+	std::fill(m_Inventory, m_Inventory + m_InventoryCapacity, Slot{});
+	m_Enemies.clear();
+	m_Items.clear();
+	m_GrabbedItems.clear();
+	m_PurgeZones.clear();
+	for (int i{}; i < params.ItemCount; ++i) SpawnItem();
+	if (params.SpawnDebugPistol) SpawnItem(eItemType::PISTOL, m_Agent.Position, 1000);
+	if (params.SpawnEnemies)
+	{
+		for (int i{}; i < params.EnemyCount; ++i) SpawnEnemy();
+	}
+	m_EnemySpawnTimer = m_EnemySpawnInterval;
+	m_ItemSpawnTimer = m_ItemSpawnInterval;
+	m_PurgeZoneTimer = m_Random.Range(30.f, 60.f);
+
+	UpdateFOV();
+}
+
+void HeadlessInterface::Step(float dt, const SteeringPlugin_Output& steering)
+{
+	if (IsGameOver() || dt <= 0.f) return;
+
+	if (Elite::Dot(steering.LinearVelocity, m_PreviousVelocity) < 0.f) ++m_DirectionReversals;
+	if (steering.RunMode != m_WasRunRequested) ++m_RunToggles;
+	m_PreviousVelocity = steering.LinearVelocity;
+	m_WasRunRequested = steering.RunMode;
+
+	m_Agent.Bitten = false;
+	MoveAgent(dt, steering);
+	UpdateEnemies(dt);
+	UpdatePurgeZones(dt);
+	UpdateAgentStats(dt);
+	SpawnEntities(dt);
+
+	//Grabbed items that never made it into the inventory fall back on the ground
+	for (const Item& item : m_GrabbedItems) SpawnItem(item.info.Type, m_Agent.Position, item.value);
+	m_GrabbedItems.clear();
+
+	UpdateFOV();
+}
+
+#pragma region World
+WorldInfo HeadlessInterface::World_GetInfo() const
+{
+	//Dimensions is the full size, the way the level file stores it
+	return WorldInfo{ Elite::Vector2{}, m_WorldSize };
+}
+
+bool HeadlessInterface::Fov_GetHouseByIndex(UINT index, HouseInfo& houseInfo) const
+{
+	if (index >= m_FovHouses.size()) return false;
+
+	houseInfo = m_FovHouses[index];
+	return true;
+}
+
+bool HeadlessInterface::Fov_GetEntityByIndex(UINT index, EntityInfo& enemyInfo) const
+{
+	if (index >= m_FovEntities.size()) return false;
+
+	enemyInfo = m_FovEntities[index];
+	return true;
+}
+
+bool HeadlessInterface::Enemy_GetInfo(EntityInfo entity, EnemyInfo& enemy)
+{
+	auto foundIt = std::find_if(m_Enemies.begin(), m_Enemies.end(), [&entity](const Enemy& e) { return e.info.EnemyHash == entity.EntityHash; });
+	if (foundIt == m_Enemies.end()) return false;
+
+	enemy = foundIt->info;
+	return true;
+}
+
+bool HeadlessInterface::PurgeZone_GetInfo(EntityInfo entity, PurgeZoneInfo& zone)
+{
+	auto foundIt = std::find_if(m_PurgeZones.begin(), m_PurgeZones.end(), [&entity](const PurgeZone& z) { return z.info.ZoneHash == entity.EntityHash; });
+	if (foundIt == m_PurgeZones.end()) return false;
+
+	zone = foundIt->info;
+	return true;
+}
+
+Elite::Vector2 HeadlessInterface::NavMesh_GetClosestPathPoint(Elite::Vector2 goal) const
+{
+	//The first corner of the path there, the goal itself when it is in sight or can't be reached
+	const Elite::Vector2 halfSize{ m_WorldSize * 0.5f };
+	goal.x = Elite::Clamp(goal.x, -halfSize.x, halfSize.x);
+	goal.y = Elite::Clamp(goal.y, -halfSize.y, halfSize.y);
+	if (!m_pNavMesh->FindPath(m_Agent.Position, goal, m_NavMeshPath) || m_NavMeshPath.empty()) return goal;
+
+	return m_NavMeshPath.front();
+}
+#pragma endregion
+
+#pragma region Inventory
+bool HeadlessInterface::Inventory_AddItem(UINT slotId, ItemInfo item)
+{
+	if (slotId >= UINT(m_InventoryCapacity) || m_Inventory[slotId].inUse) return false;
+
+	//Only what was grabbed this frame goes in
+	auto foundIt = std::find_if(m_GrabbedItems.begin(), m_GrabbedItems.end(), [&item](const Item& i) { return i.info.ItemHash == item.ItemHash; });
+	if (foundIt == m_GrabbedItems.end()) return false;
+
+	m_Inventory[slotId] = Slot{ *foundIt, true };
+	m_GrabbedItems.erase(foundIt);
+	return true;
+}
+
+bool HeadlessInterface::Inventory_UseItem(UINT slotId)
+{
+	if (slotId >= UINT(m_InventoryCapacity) || !m_Inventory[slotId].inUse) return false;
+
+	Item& item{ m_Inventory[slotId].item };
+	if (item.value <= 0) return false;
+
+	switch (item.info.Type)
+	{
+	case eItemType::PISTOL:
+		Shoot(item);
+		return true;
+	case eItemType::MEDKIT:
+		m_Agent.Health = std::min<float>(g_MaxStat, m_Agent.Health + item.value);
+		item.value = 0;
+		return true;
+	case eItemType::FOOD:
+		m_Agent.Energy = std::min<float>(g_MaxStat, m_Agent.Energy + item.value);
+		item.value = 0;
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool HeadlessInterface::Inventory_RemoveItem(UINT slotId)
+{
+	if (slotId >= UINT(m_InventoryCapacity) || !m_Inventory[slotId].inUse) return false;
+
+	m_Inventory[slotId].inUse = false;
+	return true;
+}
+
+bool HeadlessInterface::Inventory_GetItem(UINT slotId, ItemInfo& item)
+{
+	if (slotId >= UINT(m_InventoryCapacity) || !m_Inventory[slotId].inUse) return false;
+
+	item = m_Inventory[slotId].item.info;
+	return true;
+}
+
+bool HeadlessInterface::Item_GetInfo(EntityInfo entity, ItemInfo& item)
+{
+	auto foundIt = std::find_if(m_Items.begin(), m_Items.end(), [&entity](const Item& i) { return i.info.ItemHash == entity.EntityHash; });
+	if (foundIt == m_Items.end()) return false;
+
+	item = foundIt->info;
+	return true;
+}
+
+bool HeadlessInterface::Item_Grab(EntityInfo entity, ItemInfo& item)
+{
+	const float grabRangeSqrd{ m_Agent.GrabRange * m_Agent.GrabRange };
+	auto foundIt = m_Items.end();
+	if (m_Params.AutoGrabClosestItem)
+	{
+		float closestSqrd{ grabRangeSqrd };
+		for (auto it = m_Items.begin(); it != m_Items.end(); ++it)
+		{
+			const float distanceSqrd{ Elite::DistanceSquared(it->info.Location, m_Agent.Position) };
+			if (distanceSqrd <= closestSqrd)
+			{
+				closestSqrd = distanceSqrd;
+				foundIt = it;
+			}
+		}
+	}
+	else
+	{
+		foundIt = std::find_if(m_Items.begin(), m_Items.end(), [&entity](const Item& i) { return i.info.ItemHash == entity.EntityHash; });
+		if (foundIt != m_Items.end() && Elite::DistanceSquared(foundIt->info.Location, m_Agent.Position) > grabRangeSqrd) foundIt = m_Items.end();
+	}
+	if (foundIt == m_Items.end()) return false;
+
+	item = foundIt->info;
+	m_GrabbedItems.push_back(*foundIt);
+	m_Items.erase(foundIt);
+	++m_Stats.NumItemsPickUp;
+	return true;
+}
+
+bool HeadlessInterface::Item_Destroy(EntityInfo entity)
+{
+	auto foundIt = std::find_if(m_Items.begin(), m_Items.end(), [&entity](const Item& i) { return i.info.ItemHash == entity.EntityHash; });
+	if (foundIt == m_Items.end() || Elite::DistanceSquared(foundIt->info.Location, m_Agent.Position) > m_Agent.GrabRange * m_Agent.GrabRange) return false;
+
+	m_Items.erase(foundIt);
+	return true;
+}
+
+int HeadlessInterface::Weapon_GetAmmo(ItemInfo& item)
+{
+	const Item* pItem{ FindItem(item.ItemHash) };
+	return pItem != nullptr && pItem->info.Type == eItemType::PISTOL ? pItem->value : 0;
+}
+
+int HeadlessInterface::Medkit_GetHealth(ItemInfo& item)
+{
+	const Item* pItem{ FindItem(item.ItemHash) };
+	return pItem != nullptr && pItem->info.Type == eItemType::MEDKIT ? pItem->value : 0;
+}
+
+int HeadlessInterface::Food_GetEnergy(ItemInfo& item)
+{
+	const Item* pItem{ FindItem(item.ItemHash) };
+	return pItem != nullptr && pItem->info.Type == eItemType::FOOD ? pItem->value : 0;
+}
+#pragma endregion
+
+#pragma region Level
+void HeadlessInterface::LoadHouses(const GameDebugParams& params)
+{
+	LevelParser parser{};
+	LevelGeometry level{};
+	m_IsLevelLoaded = parser.Parse(params.LevelFile, level);
+	if (!m_IsLevelLoaded)
+	{
+		level = LevelGeometry{};
+		level.WorldSize = Elite::Vector2{ m_DefaultWorldSize, m_DefaultWorldSize };
+		GenerateHouses(level);
+	}
+	m_WorldSize = level.WorldSize;
+
+	SAFE_DELETE(m_pNavMesh);
+	const Elite::Vector2 halfSize{ m_WorldSize * 0.5f };
+	m_pNavMesh = new GridPathfinder(-halfSize, halfSize, m_NavMeshCellSize);
+	m_Houses.clear();
+	AddHouses(level);
+}
+
+void HeadlessInterface::GenerateHouses(LevelGeometry& level)
+{
+	const int houseCount{ 16 };
+	const float minSize{ 18.f }, maxSize{ 42.f };
+	const float spacing{ 8.f };
+	const float doorWidth{ 5.f };
+	const float startClearance{ 10.f }; //Around the center, where the agent starts
+
+	const Elite::Vector2 halfWorld{ level.WorldSize * 0.5f };
+	for (int attempt{}; attempt < 200 && int(level.Houses.size()) < houseCount; ++attempt)
+	{
+		const Elite::Vector2 size{ roundf(m_Random.Range(minSize, maxSize)), roundf(m_Random.Range(minSize, maxSize)) };
+		const Elite::Vector2 half{ size * 0.5f };
+		const Elite::Vector2 center{ roundf(m_Random.Range(-halfWorld.x + half.x + spacing, halfWorld.x - half.x - spacing)),
+			roundf(m_Random.Range(-halfWorld.y + half.y + spacing, halfWorld.y - half.y - spacing)) };
+
+		const bool overlaps{ std::any_of(level.Houses.begin(), level.Houses.end(), [&](const LevelHouse& house) {
+			return abs(house.Center.x - center.x) < (house.Size.x + size.x) * 0.5f + spacing && abs(house.Center.y - center.y) < (house.Size.y + size.y) * 0.5f + spacing;
+		}) };
+		if (overlaps || (abs(center.x) < half.x + startClearance && abs(center.y) < half.y + startClearance)) continue;
+
+		LevelHouse house{};
+		house.Center = center;
+		house.Size = size;
+		const Elite::Vector2 min{ center - half }, max{ center + half };
+		const float t{ m_WallThickness };
+		auto addWall = [&house](const Elite::Vector2& wallMin, const Elite::Vector2& wallMax) {
+			house.Walls.push_back({ wallMin, { wallMin.x, wallMax.y }, wallMax, { wallMax.x, wallMin.y } });
+		};
+
+		//One side gets a door in the middle, that side is built as two pieces
+		const int doorSide{ int(m_Random.Next() % 4u) };
+		const float halfDoor{ doorWidth * 0.5f };
+		if (doorSide == 0) { addWall(min, { center.x - halfDoor, min.y + t }); addWall({ center.x + halfDoor, min.y }, { max.x, min.y + t }); }
+		else addWall(min, { max.x, min.y + t });
+		if (doorSide == 1) { addWall({ min.x, max.y - t }, { center.x - halfDoor, max.y }); addWall({ center.x + halfDoor, max.y - t }, max); }
+		else addWall({ min.x, max.y - t }, max);
+		if (doorSide == 2) { addWall(min, { min.x + t, center.y - halfDoor }); addWall({ min.x, center.y + halfDoor }, { min.x + t, max.y }); }
+		else addWall(min, { min.x + t, max.y });
+		if (doorSide == 3) { addWall({ max.x - t, min.y }, { max.x, center.y - halfDoor }); addWall({ max.x - t, center.y + halfDoor }, max); }
+		else addWall({ max.x - t, min.y }, max);
+
+		level.Houses.push_back(house);
+	}
+}
+
+void HeadlessInterface::AddHouses(const LevelGeometry& level)
+{
+	for (const LevelHouse& levelHouse : level.Houses)
+	{
+		House house{};
+		house.info = HouseInfo{ levelHouse.Center, levelHouse.Size };
+		for (const std::vector<Elite::Vector2>& polygon : levelHouse.Walls)
+		{
+			if (polygon.empty()) continue;
+
+			Wall wall{ polygon.front(), polygon.front() };
+			for (const Elite::Vector2& point : polygon)
+			{
+				wall.min = Elite::Vector2{ std::min<float>(wall.min.x, point.x), std::min<float>(wall.min.y, point.y) };
+				wall.max = Elite::Vector2{ std::max<float>(wall.max.x, point.x), std::max<float>(wall.max.y, point.y) };
+			}
+			house.walls.push_back(wall);
+		}
+
+		m_pNavMesh->AddHouse(house.info);
+		AddDoorways(house);
+		m_Houses.push_back(house);
+	}
+}
+
+void HeadlessInterface::AddDoorways(const House& house)
+{
+	//The navmesh blocks the whole ring of walls, every gap along the middle of the ring is opened as a doorway
+	const Elite::Vector2 half{ house.info.Size * 0.5f };
+	const float inset{ m_WallThickness * 0.5f };
+	const Elite::Vector2 min{ house.info.Center - half + Elite::Vector2{ inset, inset } };
+	const Elite::Vector2 max{ house.info.Center + half - Elite::Vector2{ inset, inset } };
+	const Elite::Vector2 sides[4][2]{ { min, { max.x, min.y } }, { { min.x, max.y }, max }, { min, { min.x, max.y } }, { { max.x, min.y }, max } };
+
+	const float step{ 0.5f };
+	for (const auto& side : sides)
+	{
+		const float length{ Elite::Distance(side[0], side[1]) };
+		const Elite::Vector2 direction{ (side[1] - side[0]) / length };
+		float gapStart{ -1.f }, gapEnd{};
+		for (float distance{ m_WallThickness }; distance <= length - m_WallThickness; distance += step)
+		{
+			const Elite::Vector2 point{ side[0] + direction * distance };
+			const bool isOpen{ std::none_of(house.walls.begin(), house.walls.end(), [&point](const Wall& wall) {
+				return point.x >= wall.min.x && point.x <= wall.max.x && point.y >= wall.min.y && point.y <= wall.max.y;
+			}) };
+
+			if (isOpen)
+			{
+				if (gapStart < 0.f) gapStart = distance;
+				gapEnd = distance;
+			}
+			else if (gapStart >= 0.f)
+			{
+				m_pNavMesh->AddDoorway(side[0] + direction * ((gapStart + gapEnd) * 0.5f));
+				gapStart = -1.f;
+			}
+		}
+		if (gapStart >= 0.f) m_pNavMesh->AddDoorway(side[0] + direction * ((gapStart + gapEnd) * 0.5f));
+	}
+}
+#pragma endregion
+
+#pragma region Simulation
+void HeadlessInterface::MoveAgent(float dt, const SteeringPlugin_Output& steering)
+{
+	const bool isRunning{ steering.RunMode && m_Agent.Stamina > 0.f };
+	const float maxSpeed{ m_AgentWalkSpeed * (isRunning ? m_RunSpeedMultiplier : 1.f) };
+	Elite::Vector2 velocity{ steering.LinearVelocity };
+	const float speed{ velocity.Magnitude() };
+	if (speed > maxSpeed) velocity *= maxSpeed / speed;
+
+	const Elite::Vector2 previousPosition{ m_Agent.Position };
+	m_Agent.Position = Collide(m_Agent.Position + velocity * dt, m_Agent.AgentSize * 0.5f);
+	m_Agent.LinearVelocity = (m_Agent.Position - previousPosition) / dt;
+	m_Agent.CurrentLinearSpeed = m_Agent.LinearVelocity.Magnitude();
+	m_Agent.RunMode = isRunning;
+	m_Agent.MaxLinearSpeed = maxSpeed;
+
+	if (steering.AutoOrient)
+	{
+		m_Agent.AngularVelocity = 0.f;
+		if (m_Agent.CurrentLinearSpeed > 0.f) m_Agent.Orientation = Elite::GetOrientationFromVelocity(m_Agent.LinearVelocity);
+	}
+	else
+	{
+		m_Agent.AngularVelocity = Elite::Clamp(steering.AngularVelocity, -m_Agent.MaxAngularSpeed, m_Agent.MaxAngularSpeed);
+		m_Agent.Orientation = WrapAngle(m_Agent.Orientation + m_Agent.AngularVelocity * dt);
+	}
+
+	m_Agent.IsInHouse = IsInHouse(m_Agent.Position, m_WallThickness);
+}
+
+void HeadlessInterface::UpdateAgentStats(float dt)
+{
+	if (m_Agent.RunMode && m_Agent.CurrentLinearSpeed > 0.f)
+	{
+		if (!m_Params.InfiniteStamina) m_Agent.Stamina = std::max<float>(0.f, m_Agent.Stamina - m_StaminaDrain * dt);
+	}
+	else m_Agent.Stamina = std::min<float>(g_MaxStat, m_Agent.Stamina + m_StaminaRecovery * dt);
+
+	if (!m_Params.IgnoreEnergy) m_Agent.Energy = std::max<float>(0.f, m_Agent.Energy - m_EnergyDrain * dt);
+	if (m_Agent.Energy <= 0.f) Damage(m_StarvationDamage * dt);
+
+	m_BittenTime += dt;
+	m_Agent.WasBitten = m_BittenTime < m_BittenMemoryTime;
+
+	m_Stats.TimeSurvived += dt;
+	m_Stats.Difficulty = m_Params.StartingDifficultyStage + m_Stats.TimeSurvived / m_DifficultyInterval;
+	m_Stats.KillCountdown = std::max<float>(0.f, m_Stats.KillCountdown - dt);
+	//A point per second survived, ten per kill
+	m_Stats.Score = int(m_Stats.TimeSurvived) + 10 * m_Stats.NumEnemiesKilled;
+
+	if (m_Agent.Health <= 0.f) m_Agent.Death = true;
+}
+
+void HeadlessInterface::UpdateEnemies(float dt)
+{
+	const float agentRadius{ m_Agent.AgentSize * 0.5f };
+	const float biteReach{ 0.2f };
+	const float biteCooldown{ 1.f };
+	const float wanderTurnRate{ 2.f };
+	const float wanderSpeedFactor{ 0.5f };
+
+	for (Enemy& enemy : m_Enemies)
+	{
+		EnemyInfo& info{ enemy.info };
+		const Elite::Vector2 toAgent{ m_Agent.Position - info.Location };
+		const float distance{ toAgent.Magnitude() };
+
+		Elite::Vector2 velocity{};
+		if (distance < m_EnemySenseRange && distance > 0.f) velocity = toAgent / distance * enemy.speed;
+		else
+		{
+			enemy.heading = WrapAngle(enemy.heading + m_Random.Range(-1.f, 1.f) * wanderTurnRate * dt);
+			velocity = Elite::OrientationToVector(enemy.heading) * enemy.speed * wanderSpeedFactor;
+		}
+
+		const Elite::Vector2 previousLocation{ info.Location };
+		info.Location = Collide(info.Location + velocity * dt, info.Size);
+		info.LinearVelocity = (info.Location - previousLocation) / dt;
+
+		enemy.biteCooldown -= dt;
+		if (enemy.biteCooldown <= 0.f && Elite::Distance(info.Location, m_Agent.Position) <= info.Size + agentRadius + biteReach)
+		{
+			Damage(enemy.damage);
+			m_Agent.Bitten = true;
+			m_Agent.WasBitten = true;
+			m_BittenTime = 0.f;
+			enemy.biteCooldown = biteCooldown;
+		}
+	}
+}
+
+void HeadlessInterface::UpdatePurgeZones(float dt)
+{
+	for (PurgeZone& zone : m_PurgeZones)
+	{
+		zone.fuse -= dt;
+		if (zone.fuse > 0.f) continue;
+
+		//Everything inside dies, kills by a purge zone don't count
+		const float radiusSqrd{ zone.info.Radius * zone.info.Radius };
+		m_Enemies.erase(std::remove_if(m_Enemies.begin(), m_Enemies.end(), [&zone, radiusSqrd](const Enemy& enemy) {
+			return Elite::DistanceSquared(enemy.info.Location, zone.info.Center) <= radiusSqrd;
+		}), m_Enemies.end());
+		if (Elite::DistanceSquared(m_Agent.Position, zone.info.Center) <= radiusSqrd) Damage(m_Agent.Health);
+	}
+	m_PurgeZones.erase(std::remove_if(m_PurgeZones.begin(), m_PurgeZones.end(), [](const PurgeZone& zone) { return zone.fuse <= 0.f; }), m_PurgeZones.end());
+}
+
+void HeadlessInterface::SpawnEntities(float dt)
+{
+	//More enemies and purge zones the longer the game goes on
+	const float difficultyFactor{ 1.f + 0.5f * m_Stats.Difficulty };
+
+	m_EnemySpawnTimer -= dt;
+	if (m_EnemySpawnTimer <= 0.f)
+	{
+		m_EnemySpawnTimer = m_EnemySpawnInterval;
+		if (m_Params.SpawnEnemies && m_Enemies.size() < size_t(m_Params.EnemyCount * difficultyFactor)) SpawnEnemy();
+	}
+
+	m_ItemSpawnTimer -= dt;
+	if (m_ItemSpawnTimer <= 0.f)
+	{
+		m_ItemSpawnTimer = m_ItemSpawnInterval;
+		if (m_Items.size() < size_t(m_Params.ItemCount)) SpawnItem();
+	}
+
+	m_PurgeZoneTimer -= dt;
+	if (m_PurgeZoneTimer <= 0.f)
+	{
+		m_PurgeZoneTimer = m_Random.Range(40.f, 80.f) / difficultyFactor;
+
+		const float radius{ m_Random.Range(10.f, 20.f) };
+		const float maxOffset{ 40.f };
+		const Elite::Vector2 offset{ Elite::OrientationToVector(m_Random.Range(-float(E_PI), float(E_PI))) * m_Random.Range(0.f, maxOffset) };
+		const Elite::Vector2 halfSize{ m_WorldSize * 0.5f - Elite::Vector2{ radius, radius } };
+		const Elite::Vector2 center{ Elite::Clamp(m_Agent.Position.x + offset.x, -halfSize.x, halfSize.x), Elite::Clamp(m_Agent.Position.y + offset.y, -halfSize.y, halfSize.y) };
+
+		PurgeZone zone{};
+		zone.info.Center = center;
+		zone.info.Radius = radius;
+		zone.info.ZoneHash = CreateHash();
+		zone.fuse = m_PurgeZoneFuse;
+		m_PurgeZones.push_back(zone);
+	}
+}
+
+void HeadlessInterface::UpdateFOV()
+{
+	m_FovEntities.clear();
+	for (const Item& item : m_Items)
+	{
+		if (IsInFOV(item.info.Location)) m_FovEntities.push_back(EntityInfo{ eEntityType::ITEM, item.info.Location, item.info.ItemHash });
+	}
+	for (const Enemy& enemy : m_Enemies)
+	{
+		if (IsInFOV(enemy.info.Location)) m_FovEntities.push_back(EntityInfo{ eEntityType::ENEMY, enemy.info.Location, enemy.info.EnemyHash });
+	}
+	for (const PurgeZone& zone : m_PurgeZones)
+	{
+		const bool isInside{ Elite::DistanceSquared(m_Agent.Position, zone.info.Center) <= zone.info.Radius * zone.info.Radius };
+		if (isInside || IsInFOV(zone.info.Center)) m_FovEntities.push_back(EntityInfo{ eEntityType::PURGEZONE, zone.info.Center, zone.info.ZoneHash });
+	}
+
+	m_FovHouses.clear();
+	for (const House& house : m_Houses)
+	{
+		const Elite::Vector2 half{ house.info.Size * 0.5f };
+		const Elite::Vector2& center{ house.info.Center };
+		const bool isInside{ abs(m_Agent.Position.x - center.x) <= half.x && abs(m_Agent.Position.y - center.y) <= half.y };
+		const bool isSeen{ isInside || IsInFOV(center) || IsInFOV(center + half) || IsInFOV(center - half) ||
+			IsInFOV(center + Elite::Vector2{ half.x, -half.y }) || IsInFOV(center + Elite::Vector2{ -half.x, half.y }) };
+		if (isSeen) m_FovHouses.push_back(house.info);
+	}
+}
+
+void HeadlessInterface::SpawnEnemy()
+{
+	//Out of the houses and not right next to the agent
+	const float minAgentDistance{ 30.f };
+	Elite::Vector2 location{};
+	for (int attempt{}; attempt < 16; ++attempt)
+	{
+		location = GetRandomPosition(5.f);
+		if (!IsInHouse(location, -m_WallThickness) && Elite::DistanceSquared(location, m_Agent.Position) >= minAgentDistance * minAgentDistance) break;
+	}
+
+	float pick{ m_Random.NextFloat() };
+	const EnemyType* pType{ &g_EnemyTypes[0] };
+	for (const EnemyType& type : g_EnemyTypes)
+	{
+		pType = &type;
+		pick -= type.weight;
+		if (pick < 0.f) break;
+	}
+
+	Enemy enemy{};
+	enemy.info.Type = pType->type;
+	enemy.info.Location = location;
+	enemy.info.EnemyHash = CreateHash();
+	enemy.info.Size = pType->size;
+	enemy.info.Health = pType->health;
+	enemy.speed = pType->speed;
+	enemy.damage = pType->damage;
+	enemy.heading = m_Random.Range(-float(E_PI), float(E_PI));
+	m_Enemies.push_back(enemy);
+}
+
+void HeadlessInterface::SpawnItem()
+{
+	float pick{ m_Random.NextFloat() };
+	const ItemType* pType{ &g_ItemTypes[0] };
+	for (const ItemType& type : g_ItemTypes)
+	{
+		pType = &type;
+		pick -= type.weight;
+		if (pick < 0.f) break;
+	}
+	const int value{ pType->minValue + int(m_Random.Next() % uint32_t(pType->maxValue - pType->minValue + 1)) };
+
+	//Somewhere inside a house, anywhere when there are none
+	Elite::Vector2 location{ GetRandomPosition(5.f) };
+	if (!m_Houses.empty())
+	{
+		const House& house{ m_Houses[m_Random.Next() % uint32_t(m_Houses.size())] };
+		const Elite::Vector2 inner{ house.info.Size * 0.5f - Elite::Vector2{ m_WallThickness + 1.f, m_WallThickness + 1.f } };
+		location = house.info.Center + Elite::Vector2{ m_Random.Range(-inner.x, inner.x), m_Random.Range(-inner.y, inner.y) };
+	}
+	SpawnItem(pType->type, location, value);
+}
+
+void HeadlessInterface::SpawnItem(eItemType type, const Elite::Vector2& location, int value)
+{
+	Item item{};
+	item.info.Type = type;
+	item.info.Location = location;
+	item.info.ItemHash = CreateHash();
+	item.value = value;
+	m_Items.push_back(item);
+}
+
+void HeadlessInterface::Shoot(Item& pistol)
+{
+	--pistol.value;
+
+	//The first enemy along the view direction, walls stop the bullet
+	const Elite::Vector2 direction{ Elite::OrientationToVector(m_Agent.Orientation) };
+	const float range{ Raycast(m_Agent.Position, direction, m_ShotRange) };
+	auto hitIt = m_Enemies.end();
+	float hitDistance{ range };
+	for (auto it = m_Enemies.begin(); it != m_Enemies.end(); ++it)
+	{
+		const Elite::Vector2 toEnemy{ it->info.Location - m_Agent.Position };
+		const float along{ Elite::Dot(toEnemy, direction) };
+		if (along < 0.f || along > hitDistance) continue;
+
+		const float sideSqrd{ toEnemy.SqrtMagnitude() - along * along };
+		if (sideSqrd <= it->info.Size * it->info.Size)
+		{
+			hitDistance = along;
+			hitIt = it;
+		}
+	}
+
+	if (hitIt == m_Enemies.end())
+	{
+		++m_Stats.NumMissedShots;
+		return;
+	}
+
+	++m_Stats.NumEnemiesHit;
+	if (--hitIt->info.Health <= 0)
+	{
+		m_Enemies.erase(hitIt);
+		++m_Stats.NumEnemiesKilled;
+		m_Stats.KillCountdown = m_KillCountdownTime;
+	}
+}
+
+void HeadlessInterface::Damage(float damage)
+{
+	if (m_Params.GodMode) return;
+
+	m_Agent.Health = std::max<float>(0.f, m_Agent.Health - damage);
+}
+#pragma endregion
+
+#pragma region Helpers
+Elite::Vector2 HeadlessInterface::Collide(Elite::Vector2 position, float radius) const
+{
+	for (const House& house : m_Houses)
+	{
+		const Elite::Vector2 reach{ house.info.Size * 0.5f + Elite::Vector2{ radius, radius } };
+		if (abs(position.x - house.info.Center.x) > reach.x || abs(position.y - house.info.Center.y) > reach.y) continue;
+
+		for (const Wall& wall : house.walls)
+		{
+			const Elite::Vector2 closest{ Elite::Clamp(position.x, wall.min.x, wall.max.x), Elite::Clamp(position.y, wall.min.y, wall.max.y) };
+			const Elite::Vector2 away{ position - closest };
+			const float distanceSqrd{ away.SqrtMagnitude() };
+			if (distanceSqrd >= radius * radius) continue;
+
+			if (distanceSqrd > 0.f)
+			{
+				position = closest + away / sqrtf(distanceSqrd) * radius;
+				continue;
+			}
+
+			//The center is in the wall, out along the shortest side
+			const float pushes[4]{ position.x - wall.min.x, wall.max.x - position.x, position.y - wall.min.y, wall.max.y - position.y };
+			const int side{ int(std::min_element(pushes, pushes + 4) - pushes) };
+			if (side == 0) position.x = wall.min.x - radius;
+			else if (side == 1) position.x = wall.max.x + radius;
+			else if (side == 2) position.y = wall.min.y - radius;
+			else position.y = wall.max.y + radius;
+		}
+	}
+
+	const Elite::Vector2 halfSize{ m_WorldSize * 0.5f - Elite::Vector2{ radius, radius } };
+	return Elite::Vector2{ Elite::Clamp(position.x, -halfSize.x, halfSize.x), Elite::Clamp(position.y, -halfSize.y, halfSize.y) };
+}
+
+Elite::Vector2 HeadlessInterface::GetRandomPosition(float margin)
+{
+	const Elite::Vector2 halfSize{ m_WorldSize * 0.5f - Elite::Vector2{ margin, margin } };
+	return Elite::Vector2{ m_Random.Range(-halfSize.x, halfSize.x), m_Random.Range(-halfSize.y, halfSize.y) };
+}
+
+bool HeadlessInterface::IsInHouse(const Elite::Vector2& position, float margin) const
+{
+	return std::any_of(m_Houses.begin(), m_Houses.end(), [&position, margin](const House& house) {
+		const Elite::Vector2 half{ house.info.Size * 0.5f - Elite::Vector2{ margin, margin } };
+		return abs(position.x - house.info.Center.x) < half.x && abs(position.y - house.info.Center.y) < half.y;
+	});
+}
+
+bool HeadlessInterface::IsInFOV(const Elite::Vector2& position) const
+{
+	const Elite::Vector2 toPosition{ position - m_Agent.Position };
+	const float distanceSqrd{ toPosition.SqrtMagnitude() };
+	if (distanceSqrd > m_Agent.FOV_Range * m_Agent.FOV_Range) return false;
+	if (distanceSqrd <= FLT_EPSILON) return true;
+
+	const Elite::Vector2 forward{ Elite::OrientationToVector(m_Agent.Orientation) };
+	return Elite::Dot(toPosition, forward) >= cosf(m_Agent.FOV_Angle * 0.5f) * sqrtf(distanceSqrd);
+}
+
+float HeadlessInterface::Raycast(const Elite::Vector2& origin, const Elite::Vector2& direction, float range) const
+{
+	float distance{ range };
+	for (const House& house : m_Houses)
+	{
+		for (const Wall& wall : house.walls) distance = RaycastBox(origin, direction, wall.min, wall.max, distance);
+	}
+	return distance;
+}
+
+HeadlessInterface::Item* HeadlessInterface::FindItem(int hash)
+{
+	for (Slot& slot : m_Inventory)
+	{
+		if (slot.inUse && slot.item.info.ItemHash == hash) return &slot.item;
+	}
+	for (std::vector<Item>* pItems : { &m_GrabbedItems, &m_Items })
+	{
+		auto foundIt = std::find_if(pItems->begin(), pItems->end(), [hash](const Item& item) { return item.info.ItemHash == hash; });
+		if (foundIt != pItems->end()) return &*foundIt;
+	}
+	return nullptr;
+}
+#pragma endregion
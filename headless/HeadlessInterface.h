@@ -0,0 +1,209 @@
+#pragma once
+#include "IExamInterface.h"
+#include "GridPathfinder.h"
+#include "LevelParser.h"
+#include "Random.h"
+
+//Stand-in for the exam framework without a window, so the plugin can run on Linux and faster than real time.
+//It simulates a simplified version of the game: the agent moves with the steering it is given and collides with
+//the house walls, zombies of every type wander and chase it, items lie in the houses and purge zones go off
+//near the agent. The houses come from the level file in GameDebugParams when it can be read, otherwise they are
+//generated from the seed. Everything random draws from one generator seeded with GameDebugParams::Seed, so the
+//same params and the same plugin play the same game.
+//Drawing is ignored (only counted), there is no input and the debug conversions are the identity.
+class HeadlessInterface final : public IExamInterface
+{
+public:
+	HeadlessInterface();
+	~HeadlessInterface();
+	HeadlessInterface(const HeadlessInterface&) = delete;
+	HeadlessInterface& operator=(const HeadlessInterface&) = delete;
+	HeadlessInterface(HeadlessInterface&&) = delete;
+	HeadlessInterface& operator=(HeadlessInterface&&) = delete;
+
+	//Starts a new game, has to be called before the plugin is initialized
+	void Reset(const GameDebugParams& params);
+	//Applies the plugin's steering and advances the world
+	void Step(float dt, const SteeringPlugin_Output& steering);
+	bool IsGameOver() const { return m_Agent.Death || m_IsShutdownRequested; }
+	bool IsLevelLoaded() const { return m_IsLevelLoaded; } //False when the houses were generated
+	int GetDrawCalls() const { return m_DrawCalls; }
+	//How often the plugin changed its mind between frames, a dt too coarse for its decisions makes it dither
+	int GetDirectionReversals() const { return m_DirectionReversals; }
+	int GetRunToggles() const { return m_RunToggles; }
+
+	//WORLD & ENTITIES
+	WorldInfo World_GetInfo() const override;
+	StatisticsInfo World_GetStats() const override { return m_Stats; }
+
+	bool Fov_GetHouseByIndex(UINT index, HouseInfo& houseInfo) const override;
+	bool Fov_GetEntityByIndex(UINT index, EntityInfo& enemyInfo) const override;
+
+	AgentInfo Agent_GetInfo() const override { return m_Agent; }
+	bool Enemy_GetInfo(EntityInfo entity, EnemyInfo& enemy) override;
+
+	//NAVMESH
+	Elite::Vector2 NavMesh_GetClosestPathPoint(Elite::Vector2 goal) const override;
+
+	//INVENTORY
+	bool Inventory_AddItem(UINT slotId, ItemInfo item) override;
+	bool Inventory_UseItem(UINT slotId) override;
+	bool Inventory_RemoveItem(UINT slotId) override;
+	bool Inventory_GetItem(UINT slotId, ItemInfo& item) override;
+	UINT Inventory_GetCapacity() const override { return UINT(m_InventoryCapacity); }
+
+	bool Item_GetInfo(EntityInfo entity, ItemInfo& item) override;
+	bool Item_Grab(EntityInfo entity, ItemInfo& item) override;
+	bool Item_Destroy(EntityInfo entity) override;
+
+	int Weapon_GetAmmo(ItemInfo& item) override;
+	int Medkit_GetHealth(ItemInfo& item) override;
+	int Food_GetEnergy(ItemInfo& item) override;
+
+	//PURGEZONE
+	bool PurgeZone_GetInfo(EntityInfo entity, PurgeZoneInfo& zone) override;
+
+	//DEBUG
+	Elite::Vector2 Debug_ConvertScreenToWorld(Elite::Vector2 screenPos) const override { return screenPos; }
+	Elite::Vector2 Debug_ConvertWorldToScreen(Elite::Vector2 worldPos) const override { return worldPos; }
+
+	//INPUT
+	bool Input_IsKeyboardKeyDown(Elite::InputScancode key) const override { return false; }
+	bool Input_IsKeyboardKeyUp(Elite::InputScancode key) const override { return false; }
+	bool Input_IsMouseButtonDown(Elite::InputMouseButton button) const override { return false; }
+	bool Input_IsMouseButtonUp(Elite::InputMouseButton button) const override { return false; }
+	Elite::MouseData Input_GetMouseData(Elite::InputType type, Elite::InputMouseButton button = Elite::InputMouseButton(0)) const override { return {}; }
+
+	//EVENT
+	void RequestShutdown() const override { m_IsShutdownRequested = true; }
+
+	//RENDERER
+	void Draw_Polygon(const Elite::Vector2* points, int count, const Elite::Vector3& color, float depth) override { ++m_DrawCalls; }
+	void Draw_SolidPolygon(const Elite::Vector2* points, int count, const Elite::Vector3& color, float depth, bool triangulate = false) override { ++m_DrawCalls; }
+	void Draw_Circle(const Elite::Vector2& center, float radius, const Elite::Vector3& color, float depth) override { ++m_DrawCalls; }
+	void Draw_SolidCircle(const Elite::Vector2& center, float32 radius, const Elite::Vector2& axis, const Elite::Vector3& color, float depth) override { ++m_DrawCalls; }
+	void Draw_Segment(const Elite::Vector2& p1, const Elite::Vector2& p2, const Elite::Vector3& color, float depth) override { ++m_DrawCalls; }
+	void Draw_Direction(const Elite::Vector2& p, Elite::Vector2 dir, float length, const Elite::Vector3& color, float depth = 0.9f) override { ++m_DrawCalls; }
+	void Draw_Transform(const b2Transform& xf, float depth) override { ++m_DrawCalls; }
+	void Draw_Point(const Elite::Vector2& p, float size, const Elite::Vector3& color, float depth) override { ++m_DrawCalls; }
+	float NextDepthSlice() override { return 0.f; }
+
+private:
+	struct Wall
+	{
+		Elite::Vector2 min;
+		Elite::Vector2 max;
+	};
+
+	struct House
+	{
+		HouseInfo info;
+		std::vector<Wall> walls;
+	};
+
+	struct Enemy
+	{
+		EnemyInfo info;
+		float speed;
+		float damage;
+		float heading; //Wander direction
+		float biteCooldown;
+	};
+
+	struct Item
+	{
+		ItemInfo info;
+		int value; //Ammo, health or energy
+	};
+
+	struct PurgeZone
+	{
+		PurgeZoneInfo info;
+		float fuse; //Seconds left before everything inside dies
+	};
+
+	struct Slot
+	{
+		Item item;
+		bool inUse;
+	};
+
+	void LoadHouses(const GameDebugParams& params);
+	void GenerateHouses(LevelGeometry& level);
+	void AddHouses(const LevelGeometry& level);
+	void AddDoorways(const House& house);
+
+	void MoveAgent(float dt, const SteeringPlugin_Output& steering);
+	void UpdateAgentStats(float dt);
+	void UpdateEnemies(float dt);
+	void UpdatePurgeZones(float dt);
+	void SpawnEntities(float dt);
+	void UpdateFOV();
+
+	void SpawnEnemy();
+	void SpawnItem();
+	void SpawnItem(eItemType type, const Elite::Vector2& location, int value);
+	void Shoot(Item& pistol);
+	void Damage(float damage);
+
+	Elite::Vector2 Collide(Elite::Vector2 position, float radius) const;
+	Elite::Vector2 GetRandomPosition(float margin);
+	bool IsInHouse(const Elite::Vector2& position, float margin = 0.f) const;
+	bool IsInFOV(const Elite::Vector2& position) const;
+	float Raycast(const Elite::Vector2& origin, const Elite::Vector2& direction, float range) const;
+	Item* FindItem(int hash);
+	int CreateHash() { return m_NextHash++; }
+
+	GameDebugParams m_Params{};
+	Random m_Random{};
+	bool m_IsLevelLoaded{};
+	Elite::Vector2 m_WorldSize{};
+	std::vector<House> m_Houses{};
+	GridPathfinder* m_pNavMesh = nullptr; //The walls with their doorways open, searched for the closest path point
+	mutable std::vector<Elite::Vector2> m_NavMeshPath{};
+
+	AgentInfo m_Agent{};
+	StatisticsInfo m_Stats{};
+	float m_BittenTime{}; //Since the last bite
+
+	std::vector<Enemy> m_Enemies{};
+	std::vector<Item> m_Items{};
+	std::vector<Item> m_GrabbedItems{}; //Grabbed this frame but not in the inventory yet
+	std::vector<PurgeZone> m_PurgeZones{};
+	int m_NextHash{ 1 };
+	float m_EnemySpawnTimer{};
+	float m_ItemSpawnTimer{};
+	float m_PurgeZoneTimer{};
+
+	static const int m_InventoryCapacity{ 5 };
+	Slot m_Inventory[m_InventoryCapacity]{};
+
+	std::vector<EntityInfo> m_FovEntities{};
+	std::vector<HouseInfo> m_FovHouses{};
+
+	mutable bool m_IsShutdownRequested{};
+	int m_DrawCalls{};
+	Elite::Vector2 m_PreviousVelocity{}; //Asked for by the plugin last frame
+	bool m_WasRunRequested{};
+	int m_DirectionReversals{};
+	int m_RunToggles{};
+
+	//Rules of the simulated game, not the real framework's exact numbers
+	const float m_DefaultWorldSize{ 300.f };
+	const float m_WallThickness{ 2.f };
+	const float m_NavMeshCellSize{ 1.f };
+	const float m_AgentWalkSpeed{ 5.f };
+	const float m_RunSpeedMultiplier{ 2.f };
+	const float m_StaminaDrain{ 2.f }; //Per second running
+	const float m_StaminaRecovery{ 1.f }; //Per second not running
+	const float m_EnergyDrain{ 0.1f }; //Per second
+	const float m_StarvationDamage{ 0.5f }; //Health per second without energy
+	const float m_BittenMemoryTime{ 1.f }; //WasBitten stays set this long
+	const float m_EnemySenseRange{ 15.f }; //Enemies closer than this chase the agent
+	const float m_EnemySpawnInterval{ 4.f };
+	const float m_ItemSpawnInterval{ 15.f };
+	const float m_PurgeZoneFuse{ 5.f };
+	const float m_ShotRange{ 50.f };
+	const float m_KillCountdownTime{ 60.f };
+	const float m_DifficultyInterval{ 120.f }; //Seconds per difficulty stage
+};
@@ -0,0 +1,148 @@
+#include "stdafx.h"
+#include <chrono>
+#include "HeadlessInterface.h"
+#include "PluginHost.h"
+
+//Entry point of the plugin linked into this executable, defined in Plugin.h
+extern "C" IPluginBase* Register();
+
+namespace
+{
+	struct Options
+	{
+		int frames{ 100000 }; //Stops earlier when the agent dies
+		std::vector<float> dts{ 1.f / 60.f }; //The same game is played once per dt
+		bool isVerbose{ false }; //Keeps the plugin's own output
+		std::string pluginFile{}; //Loaded at runtime instead of the linked one when set
+		GameDebugParams params{};
+		//Only what was passed overrides what the plugin asks for
+		bool hasEnemyCount{}, hasItemCount{}, hasLevelFile{}, hasDifficulty{};
+	};
+
+	void PrintUsage()
+	{
+		std::cout << "Usage: HeadlessGame [--plugin file] [--frames n] [--dt seconds[,seconds..]] [--seed n] [--enemies n] [--items n] [--level file] [--difficulty n] [--verbose]" << '\n';
+	}
+
+	bool ParseDts(const std::string& list, std::vector<float>& dts)
+	{
+		dts.clear();
+		for (size_t start{}; start <= list.size();)
+		{
+			size_t comma{ list.find(',', start) };
+			if (comma == std::string::npos) comma = list.size();
+			const float dt{ float(atof(list.substr(start, comma - start).c_str())) };
+			if (dt <= 0.f) return false;
+			dts.push_back(dt);
+			start = comma + 1;
+		}
+		return !dts.empty();
+	}
+
+	bool ParseOptions(int argc, char* argv[], Options& options)
+	{
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			const std::string option{ argv[i] };
+			if (option == "--verbose")
+			{
+				options.isVerbose = true;
+				continue;
+			}
+			if (i + 1 >= argc) return false;
+
+			const char* pValue{ argv[++i] };
+			if (option == "--plugin") options.pluginFile = pValue;
+			else if (option == "--frames") options.frames = atoi(pValue);
+			else if (option == "--dt") { if (!ParseDts(pValue, options.dts)) return false; }
+			else if (option == "--seed") options.params.Seed = atoi(pValue);
+			else if (option == "--enemies") { options.params.EnemyCount = atoi(pValue); options.hasEnemyCount = true; }
+			else if (option == "--items") { options.params.ItemCount = atoi(pValue); options.hasItemCount = true; }
+			else if (option == "--level") { options.params.LevelFile = pValue; options.hasLevelFile = true; }
+			else if (option == "--difficulty") { options.params.StartingDifficultyStage = atoi(pValue); options.hasDifficulty = true; }
+			else return false;
+		}
+		return options.frames > 0;
+	}
+
+	//Plays one game at a fixed dt as fast as it goes, Render is never called
+	bool Play(const Options& options, float dt)
+	{
+		PluginHost host{};
+		const bool isLoaded{ options.pluginFile.empty() ? host.Create(&Register) : host.Load(options.pluginFile) };
+		if (!isLoaded)
+		{
+			std::cout << "Plugin not loaded: " << host.GetError() << '\n';
+			return false;
+		}
+
+		//The plugin picks its params first, like it does in the framework, the command line wins.
+		//The level goes in first as well, the plugin bakes its level index from the file it is told about
+		GameDebugParams params{};
+		params.Seed = options.params.Seed;
+		if (options.hasLevelFile) params.LevelFile = options.params.LevelFile;
+		host.InitGameDebugParams(params);
+		if (options.hasEnemyCount) params.EnemyCount = options.params.EnemyCount;
+		if (options.hasItemCount) params.ItemCount = options.params.ItemCount;
+		if (options.hasLevelFile) params.LevelFile = options.params.LevelFile;
+		if (options.hasDifficulty) params.StartingDifficultyStage = options.params.StartingDifficultyStage;
+
+		HeadlessInterface headless{};
+		headless.Reset(params);
+		if (!headless.IsLevelLoaded()) std::cout << "Level " << params.LevelFile << " not found, playing in a generated one" << '\n';
+
+		//The plugin talks a lot every frame, that would be most of what gets measured
+		std::streambuf* pCoutBuffer{ std::cout.rdbuf() };
+		if (!options.isVerbose) std::cout.rdbuf(nullptr);
+
+		host.Initialize(&headless);
+
+		const auto start = std::chrono::steady_clock::now();
+		int frame{};
+		for (; frame < options.frames && !headless.IsGameOver(); ++frame)
+		{
+			headless.Step(dt, host.UpdateSteering(dt));
+		}
+		const std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start };
+
+		std::cout.clear();
+		std::cout.rdbuf(pCoutBuffer);
+		const float loadTime{ host.GetLoadTime() };
+		const float startupTime{ host.GetStartupTime() };
+		host.Unload();
+
+		const StatisticsInfo stats{ headless.World_GetStats() };
+		const AgentInfo agent{ headless.Agent_GetInfo() };
+		const double wallTime{ std::max<double>(elapsed.count(), 1e-9) };
+		const float simulatedTime{ std::max<float>(frame * dt, 1e-6f) };
+		std::cout << "dt " << dt << "s" << '\n';
+		std::cout << "  Plugin loaded in " << loadTime * 1000.f << "ms, first frame done after " << startupTime * 1000.f << "ms" << '\n';
+		std::cout << "  Frames: " << frame << " in " << elapsed.count() << "s, " << frame / wallTime << " frames per second, "
+			<< frame * dt / wallTime << " simulated seconds per second" << '\n';
+		std::cout << "  Survived " << stats.TimeSurvived << "s" << (agent.Death ? ", died" : ", alive") << ", score " << stats.Score
+			<< ", kills " << stats.NumEnemiesKilled << ", hits " << stats.NumEnemiesHit << ", missed shots " << stats.NumMissedShots
+			<< ", items picked up " << stats.NumItemsPickUp << '\n';
+		std::cout << "  Direction reversals " << headless.GetDirectionReversals() / simulatedTime << " per second, run toggles "
+			<< headless.GetRunToggles() / simulatedTime << " per second" << '\n';
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options{};
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	//Game time, not frames, is what gets compared between dts
+	const int frames{ options.frames };
+	for (float dt : options.dts)
+	{
+		if (options.dts.size() > 1) options.frames = int(frames * options.dts.front() / dt);
+		if (!Play(options, dt)) return 1;
+	}
+	return 0;
+}
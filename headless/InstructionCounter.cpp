@@ -0,0 +1,52 @@
+#include "stdafx.h"
+#include "InstructionCounter.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+InstructionCounter::~InstructionCounter()
+{
+#ifdef __linux__
+	if (m_File != -1) close(m_File);
+#endif
+}
+
+bool InstructionCounter::Open()
+{
+#ifdef __linux__
+	if (m_File != -1) return true;
+
+	perf_event_attr attributes{};
+	attributes.type = PERF_TYPE_HARDWARE;
+	attributes.size = sizeof(attributes);
+	attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+	attributes.exclude_kernel = 1; //Also what perf_event_paranoid 2 allows
+	attributes.exclude_hv = 1;
+
+	//This thread, on any CPU it runs on
+	m_File = int(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+	if (m_File == -1)
+	{
+		m_Error = std::string{ "perf_event_open failed: " } + strerror(errno);
+		return false;
+	}
+	return true;
+#else
+	m_Error = "Instructions are only counted on Linux";
+	return false;
+#endif
+}
+
+long long InstructionCounter::GetCount() const
+{
+#ifdef __linux__
+	long long count{};
+	if (m_File != -1 && read(m_File, &count, sizeof(count)) == sizeof(count)) return count;
+#endif
+	return 0;
+}
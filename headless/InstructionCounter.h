@@ -0,0 +1,24 @@
+#pragma once
+
+//Counts the instructions the calling thread retires in user mode, with the CPU's own counter (perf events, Linux only).
+//Containers and virtual machines often don't pass the counter on, Open fails then and GetError says why.
+class InstructionCounter final
+{
+public:
+	InstructionCounter() = default;
+	~InstructionCounter();
+	InstructionCounter(const InstructionCounter&) = delete;
+	InstructionCounter& operator=(const InstructionCounter&) = delete;
+	InstructionCounter(InstructionCounter&&) = delete;
+	InstructionCounter& operator=(InstructionCounter&&) = delete;
+
+	bool Open();
+	bool IsOpen() const { return m_File != -1; }
+	const std::string& GetError() const { return m_Error; }
+	//Since Open, 0 when it isn't open
+	long long GetCount() const;
+
+private:
+	int m_File{ -1 };
+	std::string m_Error{};
+};
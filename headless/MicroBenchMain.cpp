@@ -0,0 +1,1294 @@
+#include "stdafx.h"
+#include <cfloat>
+#include <chrono>
+#include <iomanip>
+#include <map>
+//What Behaviours.h needs, Plugin.h has the same but its Register() would link the whole plugin in
+#include "IExamInterface.h"
+#include "HelperStructs.h"
+#include "SteeringBehaviors.h"
+#include "SteeringPipeline.h"
+#include "SteeringState.h"
+#include "BatchSteering.h"
+#include "Inventory.h"
+#include "InventoryOptimizer.h"
+#include "ExplorationGrid.h"
+#include "GridPathfinder.h"
+#include "PathPlanner.h"
+#include "PathSmoother.h"
+#include "HouseRouteOptimizer.h"
+#include "LevelIndex.h"
+#include "LevelFields.h"
+#include "FleeField.h"
+#include "ContextSteering.h"
+#include "VelocityObstacles.h"
+#include "Behaviours.h"
+#include "AllocationCounter.h"
+#include "ScriptedInterface.h"
+
+namespace
+{
+	struct Options
+	{
+		std::string filter{}; //Only the benchmarks with this in their name
+		std::string only{}; //Only the benchmark with exactly this name, what a suspect is measured again with
+		double runTime{ 0.02 }; //Seconds one run takes at least
+		int runs{ 5 }; //The fastest counts
+		std::string baselineFile{}; //Compared against when set
+		float tolerance{ 20.f }; //Percent slower than the baseline before it counts as a regression
+		int retries{ 5 }; //Times a benchmark over the tolerance is measured again before it counts, the first in this process
+		double minimumChange{ 1.0 }; //Nanoseconds slower than the baseline (relative to the calibration) before it counts
+		std::string resultsFile{}; //Same format as the baseline, to make a new one
+		std::string levelFile{ "GameLevel.gppl" }; //What the level benchmarks run on, they are left out when it doesn't parse
+	};
+
+	struct Benchmark
+	{
+		std::string name;
+		std::function<void(int)> run; //Does the operation this many times
+		std::string note{}; //Printed after the measurement, for what the time alone doesn't tell
+	};
+
+	struct Measurement
+	{
+		double nanoseconds; //Per operation
+		double allocations; //Per operation
+	};
+
+	//Everything the benchmarks work on, set up once like the plugin has it mid game
+	struct Fixture
+	{
+		Elite::Blackboard blackboard{};
+		std::vector<EntityInfo> entities{}; //What a frame sees, filtered in place
+		std::vector<EnemyInfo> enemies{};
+		std::vector<ItemInfo> items{};
+		ScriptedInterface fov{};
+		ScriptedInterface host{};
+		Inventory* pInventory{};
+		std::vector<AgentInfo> agents{}; //A power of two, cycled through
+		std::vector<Elite::Vector2> vectors{}; //A power of two, cycled through
+		LevelGeometry level{};
+		bool hasLevel{};
+	};
+
+#if !defined(__GNUC__)
+	//Where Keep stores the address when there is no inline assembly to hide it behind
+	volatile const void* g_pKept{};
+#endif
+
+	//Keeps the compiler from dropping work whose result isn't used
+	template<typename T>
+	void Keep(const T& value)
+	{
+#if defined(__GNUC__)
+		asm volatile("" : : "g"(&value) : "memory");
+#else
+		g_pKept = &value;
+#endif
+	}
+
+	void PrintUsage()
+	{
+		std::cout << "Usage: HeadlessMicroBench [--filter text] [--time ms] [--runs n] [--baseline file] [--tolerance percent] [--out file]" << '\n'
+			<< "                          [--retries n] [--minimum ns] [--level file] [--only name]" << '\n';
+	}
+
+	bool ParseOptions(int argc, char* argv[], Options& options)
+	{
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			const std::string option{ argv[i] };
+			if (i + 1 >= argc) return false;
+
+			const char* pValue{ argv[++i] };
+			if (option == "--filter") options.filter = pValue;
+			else if (option == "--only") options.only = pValue;
+			else if (option == "--time") options.runTime = atof(pValue) / 1000.0;
+			else if (option == "--runs") options.runs = atoi(pValue);
+			else if (option == "--baseline") options.baselineFile = pValue;
+			else if (option == "--tolerance") options.tolerance = float(atof(pValue));
+			else if (option == "--retries") options.retries = atoi(pValue);
+			else if (option == "--minimum") options.minimumChange = atof(pValue);
+			else if (option == "--out") options.resultsFile = pValue;
+			else if (option == "--level") options.levelFile = pValue;
+			else return false;
+		}
+		return options.runTime > 0.0 && options.runs > 0 && options.tolerance >= 0.f && options.retries >= 0 && options.minimumChange >= 0.0;
+	}
+
+#pragma region Fixture
+	const char* const g_LevelBenchmarkPath{ "MicroBenchLevel" };
+	const char* const g_LevelRetryPath{ "MicroBenchLevelRetry" }; //For --only, so a retry doesn't remove the files of the run that started it
+
+	void SetUpBlackboard(Fixture& fixture)
+	{
+		//The plugin's keys, so the lookups hash and compare what they do in a game
+		for (const char* pName : { "SteeringCooldown", "SteeringCooldownRemaining", "VariableSteeringCooldown", "TimeInHouse",
+			"Parameters", "RememberFleeLocationWeight", "HouseEnteredAt", "PreviousAgentHistoryIndex",
+			"CurrentPathNode", "Inventory", "InventoryOptimizer", "EnteredHouses", "ItemsLeft", "HouseRoute", "Path", "LocationToCheckOut",
+			"WorldInfo", "ExplorationGrid", "ExplorationTarget", "PathPlanner", "PlannedPath", "PathSmoother", "LevelIndex",
+			"LevelFields", "FleeField", "ContextSteering", "EnemiesLastSeen", "RememberFleeLocation", "Interface", "Houses" })
+		{
+			fixture.blackboard.AddData(pName, 0.f);
+		}
+		fixture.blackboard.AddData("Agent", fixture.agents.front());
+		fixture.blackboard.AddData("Target", Elite::Vector2{});
+		fixture.blackboard.AddData("RunMode", false);
+		fixture.blackboard.AddData("Entities", fixture.fov.GetEntities());
+	}
+
+	void SetUpFixture(const Options& options, Fixture& fixture)
+	{
+		Random random{ 7 };
+		for (int i{}; i < 64; ++i)
+		{
+			AgentInfo agent{};
+			agent.Position = Elite::Vector2{ random.Range(-200.f, 200.f), random.Range(-200.f, 200.f) };
+			agent.LinearVelocity = Elite::Vector2{ random.Range(-5.f, 5.f), random.Range(-5.f, 5.f) };
+			agent.Orientation = random.Range(-3.f, 3.f);
+			agent.MaxLinearSpeed = 5.f;
+			agent.MaxAngularSpeed = 3.f;
+			agent.Health = random.Range(1.f, 10.f);
+			agent.Energy = random.Range(1.f, 10.f);
+			fixture.agents.push_back(agent);
+		}
+		for (int i{}; i < 256; ++i) fixture.vectors.push_back(Elite::Vector2{ random.Range(-100.f, 100.f), random.Range(-100.f, 100.f) });
+
+		//A busy FOV: zombies and items mixed, with a purge zone
+		int hash{ 1 };
+		for (int i{}; i < 12; ++i)
+		{
+			const Elite::Vector2 location{ random.Range(-30.f, 30.f), random.Range(-30.f, 30.f) };
+			fixture.fov.AddEnemy(EnemyInfo{ eEnemyType::ZOMBIE_NORMAL, location, Elite::Vector2{}, hash++, 1.f, 5 });
+			fixture.fov.AddItem(ItemInfo{ eItemType(i % 4), location * 0.5f, hash++ }, 5);
+		}
+		fixture.fov.AddPurgeZone(PurgeZoneInfo{ Elite::Vector2{ 10.f, 10.f }, 15.f, hash++ });
+
+		//Two pistols, a medkit and food, one slot left
+		const eItemType inventoryTypes[]{ eItemType::PISTOL, eItemType::MEDKIT, eItemType::FOOD, eItemType::PISTOL };
+		for (eItemType type : inventoryTypes) fixture.host.AddItem(ItemInfo{ type, Elite::Vector2{}, hash++ }, 4);
+		fixture.pInventory = new Inventory(&fixture.host);
+		for (size_t i{}; i < fixture.host.GetEntities().size(); ++i) fixture.pInventory->GrabItem(int(i), fixture.host.GetEntities()[i]);
+
+		SetUpBlackboard(fixture);
+
+		LevelParser parser{};
+		fixture.hasLevel = parser.Parse(options.levelFile, fixture.level);
+		if (!fixture.hasLevel) std::cout << "Level benchmarks left out: " << parser.GetError() << '\n';
+	}
+
+	bool IsInsideHouse(const LevelGeometry& level, const Elite::Vector2& position, float margin)
+	{
+		for (const LevelHouse& house : level.Houses)
+		{
+			const Elite::Vector2 halfSize{ house.Size * 0.5f + Elite::Vector2{ margin, margin } };
+			if (fabsf(position.x - house.Center.x) <= halfSize.x && fabsf(position.y - house.Center.y) <= halfSize.y) return true;
+		}
+		return false;
+	}
+#pragma endregion
+
+#pragma region Benchmarks
+	void AddBlackboardBenchmarks(Fixture& fixture, std::vector<Benchmark>& benchmarks)
+	{
+		Elite::Blackboard& blackboard{ fixture.blackboard };
+		benchmarks.push_back({ "Blackboard/GetData float", [&blackboard](int count)
+			{
+				float value{};
+				for (int i{}; i < count; ++i) { blackboard.GetData("TimeInHouse", value); Keep(value); }
+			} });
+		benchmarks.push_back({ "Blackboard/GetData long name", [&blackboard](int count)
+			{
+				float value{};
+				for (int i{}; i < count; ++i) { blackboard.GetData("PreviousAgentHistoryIndex", value); Keep(value); }
+			} });
+		benchmarks.push_back({ "Blackboard/GetData AgentInfo", [&blackboard](int count)
+			{
+				AgentInfo agent{};
+				for (int i{}; i < count; ++i) { blackboard.GetData("Agent", agent); Keep(agent); }
+			} });
+		benchmarks.push_back({ "Blackboard/GetData entities", [&blackboard](int count)
+			{
+				std::vector<EntityInfo> entities{};
+				for (int i{}; i < count; ++i) { blackboard.GetData("Entities", entities); Keep(entities); }
+			} });
+		benchmarks.push_back({ "Blackboard/ChangeData float", [&blackboard](int count)
+			{
+				for (int i{}; i < count; ++i) blackboard.ChangeData("TimeInHouse", float(i));
+			} });
+		benchmarks.push_back({ "Blackboard/ChangeData entities", [&fixture](int count)
+			{
+				for (int i{}; i < count; ++i) fixture.blackboard.ChangeData("Entities", fixture.fov.GetEntities());
+			} });
+	}
+
+	void AddCompositeBenchmarks(Fixture& fixture, std::vector<Benchmark>& benchmarks)
+	{
+		//Eight children that only answer, so what is measured is the composite
+		auto makeChildren = [](bool (*pCondition)(int)) {
+			std::vector<Elite::IBehavior*> children{};
+			for (int i{}; i < 8; ++i)
+			{
+				const bool isSuccess{ pCondition(i) };
+				children.push_back(new Elite::BehaviorConditional([isSuccess](Elite::Blackboard*) { return isSuccess; }));
+			}
+			return children;
+		};
+		auto pSelector = std::make_shared<Elite::BehaviorSelector>(makeChildren([](int i) { return i == 7; }));
+		auto pSequence = std::make_shared<Elite::BehaviorSequence>(makeChildren([](int) { return true; }));
+		auto pPersistentSequence = std::make_shared<Elite::BehaviorPersistentSequence>(makeChildren([](int i) { return i % 2 == 0; }));
+
+		Elite::Blackboard* pBlackboard{ &fixture.blackboard };
+		benchmarks.push_back({ "BehaviorSelector/8 children", [pSelector, pBlackboard](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(pSelector->Execute(pBlackboard));
+			} });
+		benchmarks.push_back({ "BehaviorSequence/8 children", [pSequence, pBlackboard](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(pSequence->Execute(pBlackboard));
+			} });
+		benchmarks.push_back({ "BehaviorPersistentSequence/8 children", [pPersistentSequence, pBlackboard](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(pPersistentSequence->Execute(pBlackboard));
+			} });
+	}
+
+	template<typename T>
+	void AddSteeringBenchmark(Fixture& fixture, std::vector<Benchmark>& benchmarks, const std::string& name, const T& prototype)
+	{
+		auto pBehavior = std::make_shared<T>(prototype);
+		const std::vector<AgentInfo>& agents{ fixture.agents };
+		benchmarks.push_back({ "CalculateSteering/" + name, [pBehavior, &agents](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(pBehavior->CalculateSteering(1.f / 60.f, agents[i & 63]));
+			} });
+	}
+
+	void AddSteeringBenchmarks(Fixture& fixture, std::vector<Benchmark>& benchmarks)
+	{
+		TargetData target{};
+		target.Position = Elite::Vector2{ 20.f, -15.f };
+		target.LinearVelocity = Elite::Vector2{ 2.f, 1.f };
+
+		Seek seek{};
+		seek.SetTarget(target);
+		AddSteeringBenchmark(fixture, benchmarks, "Seek", seek);
+
+		Wander wander{};
+		wander.SetRandomSeed(7, Random::Stream::Wander);
+		AddSteeringBenchmark(fixture, benchmarks, "Wander", wander);
+
+		Flee flee{};
+		flee.SetTarget(target);
+		AddSteeringBenchmark(fixture, benchmarks, "Flee", flee);
+
+		Arrive arrive{};
+		arrive.SetTarget(target);
+		AddSteeringBenchmark(fixture, benchmarks, "Arrive", arrive);
+
+		Face face{};
+		face.SetTarget(target);
+		AddSteeringBenchmark(fixture, benchmarks, "Face", face);
+
+		Evade evade{};
+		evade.SetTarget(target);
+		AddSteeringBenchmark(fixture, benchmarks, "Evade", evade);
+
+		Pursuit pursuit{};
+		pursuit.SetTarget(target);
+		AddSteeringBenchmark(fixture, benchmarks, "Pursuit", pursuit);
+
+		Avoid avoid{};
+		avoid.SetTarget(target);
+		for (const EntityInfo& entity : fixture.fov.GetEntities())
+		{
+			if (entity.Type == eEntityType::ENEMY) avoid.AddObstacle(entity.Location, 1.f);
+		}
+		AddSteeringBenchmark(fixture, benchmarks, "Avoid", avoid);
+	}
+
+	//How the behaviours were dispatched before SteeringState: one heap object each behind a virtual call
+	class VirtualSteering
+	{
+	public:
+		virtual ~VirtualSteering() = default;
+		virtual SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo) = 0;
+	};
+
+	template<typename T>
+	class VirtualBehavior final : public VirtualSteering
+	{
+	public:
+		explicit VirtualBehavior(const T& behavior) : m_Behavior{ behavior } {}
+		SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo) override { return m_Behavior.CalculateSteering(deltaT, agentInfo); }
+
+	private:
+		T m_Behavior;
+	};
+
+	template<typename T>
+	void AddDispatchedBehavior(const T& behavior, std::vector<SteeringState>& states, std::vector<std::unique_ptr<VirtualSteering>>& behaviors)
+	{
+		states.push_back(SteeringState{ behavior });
+		behaviors.push_back(std::unique_ptr<VirtualSteering>{ new VirtualBehavior<T>(behavior) });
+	}
+
+	void AddSteeringDispatchBenchmarks(Fixture& fixture, std::vector<Benchmark>& benchmarks)
+	{
+		TargetData target{};
+		target.Position = Elite::Vector2{ 20.f, -15.f };
+		target.LinearVelocity = Elite::Vector2{ 2.f, 1.f };
+		Seek seek{};
+		Flee flee{};
+		Arrive arrive{};
+		Face face{};
+		Evade evade{};
+		Pursuit pursuit{};
+		seek.SetTarget(target);
+		flee.SetTarget(target);
+		arrive.SetTarget(target);
+		face.SetTarget(target);
+		evade.SetTarget(target);
+		pursuit.SetTarget(target);
+
+		//The same 64 behaviours both ways, mixed up so the branch predictor can't learn the order
+		auto pStates = std::make_shared<std::vector<SteeringState>>();
+		auto pBehaviors = std::make_shared<std::vector<std::unique_ptr<VirtualSteering>>>();
+		Random random{ 13 };
+		for (int i{}; i < 64; ++i)
+		{
+			switch (random.Next() % 7)
+			{
+			case 0: AddDispatchedBehavior(seek, *pStates, *pBehaviors); break;
+			case 1:
+			{
+				Wander wander{};
+				wander.SetRandomSeed(uint64_t(i), Random::Stream::Wander);
+				AddDispatchedBehavior(wander, *pStates, *pBehaviors);
+				break;
+			}
+			case 2: AddDispatchedBehavior(flee, *pStates, *pBehaviors); break;
+			case 3: AddDispatchedBehavior(arrive, *pStates, *pBehaviors); break;
+			case 4: AddDispatchedBehavior(face, *pStates, *pBehaviors); break;
+			case 5: AddDispatchedBehavior(evade, *pStates, *pBehaviors); break;
+			default: AddDispatchedBehavior(pursuit, *pStates, *pBehaviors); break;
+			}
+		}
+
+		const std::vector<AgentInfo>& agents{ fixture.agents };
+		benchmarks.push_back({ "SteeringDispatch/switch", [pStates, &agents](int count)
+			{
+				for (int i{}; i < count; ++i) Keep((*pStates)[i & 63].CalculateSteering(1.f / 60.f, agents[i & 63]));
+			} });
+		benchmarks.push_back({ "SteeringDispatch/virtual", [pBehaviors, &agents](int count)
+			{
+				for (int i{}; i < count; ++i) Keep((*pBehaviors)[i & 63]->CalculateSteering(1.f / 60.f, agents[i & 63]));
+			} });
+	}
+
+	//The old blended and priority steering: a list of heap behaviours behind virtual calls, combined in one loop
+	struct VirtualPipelineSlot
+	{
+		std::unique_ptr<VirtualSteering> pBehavior;
+		float weight;
+		int priority;
+	};
+
+	SteeringPlugin_Output CalculateVirtualPipeline(std::vector<VirtualPipelineSlot>& slots, SteeringPipeline::Policy policy, const AgentInfo& agentInfo)
+	{
+		SteeringPlugin_Output steering{};
+		const float linearThreshold{ 0.1f * agentInfo.MaxLinearSpeed };
+		const float angularThreshold{ 0.1f * agentInfo.MaxAngularSpeed };
+		for (size_t first{}; first < slots.size();)
+		{
+			size_t last{ first + 1 };
+			while (last < slots.size() && (policy == SteeringPipeline::Policy::Blend || slots[last].priority == slots[first].priority)) ++last;
+
+			steering = SteeringPlugin_Output{};
+			for (size_t slot{ first }; slot < last; ++slot)
+			{
+				const SteeringPlugin_Output output{ slots[slot].pBehavior->CalculateSteering(1.f / 60.f, agentInfo) };
+				steering.LinearVelocity += output.LinearVelocity * slots[slot].weight;
+				steering.AngularVelocity += output.AngularVelocity * slots[slot].weight;
+				if (!output.AutoOrient) steering.AutoOrient = false;
+			}
+			if (steering.LinearVelocity.SqrtMagnitude() > linearThreshold * linearThreshold ||
+				abs(steering.AngularVelocity) > angularThreshold) break;
+			first = last;
+		}
+
+		const float speed{ steering.LinearVelocity.Magnitude() };
+		if (speed > agentInfo.MaxLinearSpeed) steering.LinearVelocity *= agentInfo.MaxLinearSpeed / speed;
+		steering.AngularVelocity = Elite::Clamp(steering.AngularVelocity, -agentInfo.MaxAngularSpeed, agentInfo.MaxAngularSpeed);
+		return steering;
+	}
+
+	void AddSteeringPipelineBenchmarks(Fixture& fixture, std::vector<Benchmark>& benchmarks)
+	{
+		//Every slot filled, refilled each call like the plugin does per frame. Avoidance first, then evading and fleeing,
+		//then the rest, so the priority policy has three groups and usually settles on the first
+		TargetData target{};
+		target.Position = Elite::Vector2{ 20.f, -15.f };
+		target.LinearVelocity = Elite::Vector2{ 2.f, 1.f };
+		Avoid avoid{};
+		avoid.SetTarget(target);
+		for (const EntityInfo& entity : fixture.fov.GetEntities())
+		{
+			if (entity.Type == eEntityType::ENEMY) avoid.AddObstacle(entity.Location, 1.f);
+		}
+		Wander wander{};
+		wander.SetRandomSeed(7, Random::Stream::Wander);
+
+		struct Slots
+		{
+			std::vector<SteeringState> states{};
+			std::vector<int> statePriorities{};
+			Avoid avoid{};
+			std::vector<VirtualPipelineSlot> virtualSlots{};
+		};
+		auto pSlots = std::make_shared<Slots>();
+		pSlots->avoid = avoid;
+		pSlots->virtualSlots.push_back({ std::unique_ptr<VirtualSteering>{ new VirtualBehavior<Avoid>(avoid) }, 2.f, 2 });
+		const auto addState = [&pSlots, &target](const SteeringState& state, int priority)
+		{
+			pSlots->states.push_back(state);
+			pSlots->states.back().SetTarget(target);
+			pSlots->statePriorities.push_back(priority);
+		};
+		addState(Evade{}, 1);
+		addState(Flee{}, 1);
+		addState(Seek{}, 0);
+		addState(Arrive{}, 0);
+		addState(Face{}, 0);
+		addState(Pursuit{}, 0);
+		addState(wander, 0);
+		for (size_t i{}; i < pSlots->states.size(); ++i)
+		{
+			SteeringState state{ pSlots->states[i] };
+			std::unique_ptr<VirtualSteering> pBehavior{};
+			switch (state.GetKind())
+			{
+			case SteeringState::Kind::Seek: pBehavior.reset(new VirtualBehavior<Seek>(state.Get<Seek>())); break;
+			case SteeringState::Kind::Wander: pBehavior.reset(new VirtualBehavior<Wander>(state.Get<Wander>())); break;
+			case SteeringState::Kind::Flee: pBehavior.reset(new VirtualBehavior<Flee>(state.Get<Flee>())); break;
+			case SteeringState::Kind::Arrive: pBehavior.reset(new VirtualBehavior<Arrive>(state.Get<Arrive>())); break;
+			case SteeringState::Kind::Face: pBehavior.reset(new VirtualBehavior<Face>(state.Get<Face>())); break;
+			case SteeringState::Kind::Evade: pBehavior.reset(new VirtualBehavior<Evade>(state.Get<Evade>())); break;
+			case SteeringState::Kind::Pursuit: pBehavior.reset(new VirtualBehavior<Pursuit>(state.Get<Pursuit>())); break;
+			}
+			pSlots->virtualSlots.push_back({ std::move(pBehavior), 1.f, pSlots->statePriorities[i] });
+		}
+
+		const std::vector<AgentInfo>& agents{ fixture.agents };
+		for (SteeringPipeline::Policy policy : { SteeringPipeline::Policy::Blend, SteeringPipeline::Policy::Priority })
+		{
+			const std::string name{ policy == SteeringPipeline::Policy::Blend ? "Blend" : "Priority" };
+			auto pPipeline = std::make_shared<SteeringPipeline>(policy);
+			benchmarks.push_back({ "SteeringPipeline/" + name + " 8 slots", [pPipeline, pSlots, target, &agents](int count)
+				{
+					for (int i{}; i < count; ++i)
+					{
+						pPipeline->Clear();
+						pPipeline->Add(pSlots->avoid, 2.f, 2);
+						for (size_t slot{}; slot < pSlots->states.size(); ++slot)
+							pPipeline->Add(pSlots->states[slot], target, 1.f, pSlots->statePriorities[slot]);
+						Keep(pPipeline->CalculateSteering(1.f / 60.f, agents[i & 63]));
+					}
+				}, "refills the slots and sets every target each call, the virtual loop does neither" });
+			benchmarks.push_back({ "SteeringPipeline/" + name + " 8 slots virtual", [pSlots, policy, &agents](int count)
+				{
+					for (int i{}; i < count; ++i) Keep(CalculateVirtualPipeline(pSlots->virtualSlots, policy, agents[i & 63]));
+				} });
+		}
+	}
+
+	//Structure-of-arrays input and output for BatchSteering
+	struct SteeringBatch
+	{
+		std::vector<float> positionX, positionY, maxSpeed, targetX, targetY, targetVelocityX, targetVelocityY, velocityX, velocityY;
+	};
+
+	using BatchCalculate = void (BatchSteering::*)(size_t, const BatchSteering::Agents&, const BatchSteering::Targets&, const BatchSteering::Output&) const;
+	const std::pair<const char*, BatchCalculate> g_BatchBehaviors[]{
+		{ "Seek", &BatchSteering::CalculateSeek },
+		{ "Flee", &BatchSteering::CalculateFlee },
+		{ "Arrive", &BatchSteering::CalculateArrive },
+		{ "Pursuit", &BatchSteering::CalculatePursuit },
+		{ "Evade", &BatchSteering::CalculateEvade }
+	};
+
+	void FillSteeringBatch(Random& random, size_t agentCount, SteeringBatch& batch)
+	{
+		for (std::vector<float>* pValues : { &batch.positionX, &batch.positionY, &batch.targetX, &batch.targetY })
+		{
+			pValues->clear();
+			for (size_t i{}; i < agentCount; ++i) pValues->push_back(random.Range(-200.f, 200.f));
+		}
+		for (std::vector<float>* pValues : { &batch.maxSpeed, &batch.targetVelocityX, &batch.targetVelocityY })
+		{
+			pValues->clear();
+			for (size_t i{}; i < agentCount; ++i) pValues->push_back(random.Range(1.f, 5.f));
+		}
+		batch.velocityX.assign(agentCount, 0.f);
+		batch.velocityY.assign(agentCount, 0.f);
+	}
+
+	//Runs every behaviour on both paths and compares the bits, the benchmarks only mean something when they match.
+	//Tails that aren't a multiple of eight and targets on, inside the arrival radius of and just around the agent
+	//are in there. False and what differs on the first mismatch, true without AVX2 as there is nothing to compare.
+	bool CheckBatchSteering()
+	{
+		BatchSteering avx2{};
+		avx2.SetUseAvx2(true);
+		BatchSteering scalar{};
+		scalar.SetUseAvx2(false);
+		if (!avx2.IsUsingAvx2())
+		{
+			std::cout << "BatchSteering: no AVX2 on this CPU, the kernels aren't checked" << '\n';
+			return true;
+		}
+
+		Random random{ 42 };
+		SteeringBatch batch{};
+		SteeringBatch expected{};
+		int cases{};
+		for (size_t agentCount : { size_t(1), size_t(7), size_t(8), size_t(9), size_t(15), size_t(16), size_t(17), size_t(1003) })
+		{
+			for (int round{}; round < 4; ++round)
+			{
+				FillSteeringBatch(random, agentCount, batch);
+				for (size_t i{}; i < agentCount; i += 3)
+				{
+					const float offsets[]{ 0.f, 0.5f, 1.f, 10.f, 20.f };
+					const float offset{ offsets[random.Next() % 5] };
+					batch.targetX[i] = batch.positionX[i] + offset;
+					batch.targetY[i] = batch.positionY[i];
+				}
+
+				const BatchSteering::Agents agents{ batch.positionX.data(), batch.positionY.data(), batch.maxSpeed.data() };
+				const BatchSteering::Targets targets{ batch.targetX.data(), batch.targetY.data(), batch.targetVelocityX.data(), batch.targetVelocityY.data() };
+				const BatchSteering::Output output{ batch.velocityX.data(), batch.velocityY.data() };
+				for (const std::pair<const char*, BatchCalculate>& behavior : g_BatchBehaviors)
+				{
+					expected.velocityX.assign(agentCount, 0.f);
+					expected.velocityY.assign(agentCount, 0.f);
+					(scalar.*behavior.second)(agentCount, agents, targets, BatchSteering::Output{ expected.velocityX.data(), expected.velocityY.data() });
+					(avx2.*behavior.second)(agentCount, agents, targets, output);
+					++cases;
+					for (size_t i{}; i < agentCount; ++i)
+					{
+						if (memcmp(&batch.velocityX[i], &expected.velocityX[i], sizeof(float)) == 0 && memcmp(&batch.velocityY[i], &expected.velocityY[i], sizeof(float)) == 0) continue;
+
+						std::cout << std::setprecision(9) << "BatchSteering: " << behavior.first << " with " << agentCount << " agents differs at agent " << i
+							<< ", AVX2 (" << batch.velocityX[i] << ", " << batch.velocityY[i] << ") scalar (" << expected.velocityX[i] << ", " << expected.velocityY[i] << ")" << '\n';
+						return false;
+					}
+				}
+			}
+		}
+		std::cout << "BatchSteering: AVX2 matches the scalar path bit for bit in " << cases << " cases" << '\n';
+		return true;
+	}
+
+	void AddBatchSteeringBenchmarks(std::vector<Benchmark>& benchmarks)
+	{
+		//Per call over every agent, the AVX2 kernels against the scalar path they match bit for bit (CheckBatchSteering)
+		const std::pair<const char*, size_t> sizes[]{ { "1k", 1000 }, { "10k", 10000 }, { "100k", 100000 } };
+		for (const std::pair<const char*, size_t>& size : sizes)
+		{
+			Random random{ uint64_t(size.second) };
+			auto pBatch = std::make_shared<SteeringBatch>();
+			FillSteeringBatch(random, size.second, *pBatch);
+
+			for (bool useAvx2 : { true, false })
+			{
+				auto pSteering = std::make_shared<BatchSteering>();
+				pSteering->SetUseAvx2(useAvx2);
+				const std::string note{ useAvx2 && !pSteering->IsUsingAvx2() ? "no AVX2 on this CPU, scalar" : "" };
+				const std::string name{ std::string{ " " } + size.first + " agents " + (useAvx2 ? "AVX2" : "scalar") };
+				const BatchSteering::Agents agents{ pBatch->positionX.data(), pBatch->positionY.data(), pBatch->maxSpeed.data() };
+				const BatchSteering::Targets targets{ pBatch->targetX.data(), pBatch->targetY.data(), pBatch->targetVelocityX.data(), pBatch->targetVelocityY.data() };
+				const BatchSteering::Output output{ pBatch->velocityX.data(), pBatch->velocityY.data() };
+				const size_t agentCount{ size.second };
+				for (const std::pair<const char*, BatchCalculate>& behavior : g_BatchBehaviors)
+				{
+					const BatchCalculate calculate{ behavior.second };
+					benchmarks.push_back({ std::string{ "BatchSteering/" } + behavior.first + name, [pSteering, pBatch, agentCount, agents, targets, output, calculate](int count)
+						{
+							for (int i{}; i < count; ++i) { ((*pSteering).*calculate)(agentCount, agents, targets, output); Keep(pBatch->velocityX.back()); }
+						}, note });
+				}
+			}
+		}
+	}
+
+	void AddInventoryBenchmarks(Fixture& fixture, std::vector<Benchmark>& benchmarks)
+	{
+		const Inventory& inventory{ *fixture.pInventory };
+		const std::vector<AgentInfo>& agents{ fixture.agents };
+		benchmarks.push_back({ "Inventory/GetAmountOfItemsInInventory", [&inventory](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(inventory.GetAmountOfItemsInInventory());
+			} });
+		benchmarks.push_back({ "Inventory/GetAmountOfItemsHeldOfType", [&inventory](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(inventory.GetAmountOfItemsHeldOfType(eItemType(i & 3)));
+			} });
+		benchmarks.push_back({ "Inventory/GetFirstEmptySpace", [&inventory](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(inventory.GetFirstEmptySpace());
+			} });
+		benchmarks.push_back({ "Inventory/GetDuplicateSlot", [&inventory](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(inventory.GetDuplicateSlot());
+			} });
+		benchmarks.push_back({ "Inventory/GetHealthpack", [&inventory, &agents](int count)
+			{
+				int slot{};
+				for (int i{}; i < count; ++i) { Keep(inventory.GetHealthpack(slot, agents[i & 63].Health)); Keep(slot); }
+			} });
+		benchmarks.push_back({ "Inventory/GetFood", [&inventory, &agents](int count)
+			{
+				int slot{};
+				for (int i{}; i < count; ++i) { Keep(inventory.GetFood(slot, agents[i & 63].Energy)); Keep(slot); }
+			} });
+		benchmarks.push_back({ "Inventory/GetPistol", [&inventory](int count)
+			{
+				int slot{};
+				for (int i{}; i < count; ++i) { Keep(inventory.GetPistol(slot)); Keep(slot); }
+			} });
+	}
+
+	void AddFovBenchmarks(Fixture& fixture, std::vector<Benchmark>& benchmarks)
+	{
+		//A fresh copy of the FOV every time, like every frame has, the vectors keep their capacity
+		benchmarks.push_back({ "FOV/GetEnemiesInFOV", [&fixture](int count)
+			{
+				for (int i{}; i < count; ++i)
+				{
+					fixture.entities.assign(fixture.fov.GetEntities().begin(), fixture.fov.GetEntities().end());
+					GetEnemiesInFOV(fixture.entities, fixture.enemies, &fixture.fov);
+					Keep(fixture.enemies.front());
+				}
+			} });
+		benchmarks.push_back({ "FOV/GetItemsInFOV", [&fixture](int count)
+			{
+				for (int i{}; i < count; ++i)
+				{
+					fixture.entities.assign(fixture.fov.GetEntities().begin(), fixture.fov.GetEntities().end());
+					GetItemsInFOV(fixture.entities, fixture.items, &fixture.fov);
+					Keep(fixture.items.front());
+				}
+			} });
+	}
+
+	void AddPathfinderBenchmarks(Fixture& fixture, std::vector<Benchmark>& benchmarks)
+	{
+		if (!fixture.hasLevel) return;
+
+		//Every house of the level known, the way the grid ends up late in a game
+		const LevelGeometry& level{ fixture.level };
+		auto pPathfinder = std::make_shared<GridPathfinder>(level.WorldSize * -0.5f, level.WorldSize * 0.5f);
+		for (const LevelHouse& house : level.Houses) pPathfinder->AddHouse(HouseInfo{ house.Center, house.Size });
+
+		//From one side of the map to the other and back, outside the houses since their doors aren't known yet
+		auto pQueries = std::make_shared<std::vector<std::pair<Elite::Vector2, Elite::Vector2>>>();
+		Random random{ 11 };
+		const Elite::Vector2 halfSize{ level.WorldSize * 0.5f };
+		while (pQueries->size() < 32)
+		{
+			const float side{ pQueries->size() % 2 == 0 ? 1.f : -1.f };
+			const Elite::Vector2 start{ side * random.Range(0.7f, 0.9f) * halfSize.x, random.Range(-0.9f, 0.9f) * halfSize.y };
+			const Elite::Vector2 goal{ -side * random.Range(0.7f, 0.9f) * halfSize.x, random.Range(-0.9f, 0.9f) * halfSize.y };
+			if (!IsInsideHouse(level, start, 3.f) && !IsInsideHouse(level, goal, 3.f)) pQueries->emplace_back(start, goal);
+		}
+
+		auto pPath = std::make_shared<std::vector<Elite::Vector2>>();
+		pPath->reserve(4096);
+		const std::pair<const char*, GridPathfinder::Algorithm> algorithms[]{ { "A*", GridPathfinder::Algorithm::AStar },
+			{ "JPS", GridPathfinder::Algorithm::JumpPointSearch } };
+		for (const auto& algorithm : algorithms)
+		{
+			const GridPathfinder::Algorithm type{ algorithm.second };
+			benchmarks.push_back({ std::string{ "GridPathfinder/" } + algorithm.first + " cross-map", [pPathfinder, pQueries, pPath, type](int count)
+				{
+					for (int i{}; i < count; ++i)
+					{
+						const std::pair<Elite::Vector2, Elite::Vector2>& query{ (*pQueries)[i & 31] };
+						Keep(pPathfinder->FindPath(query.first, query.second, *pPath, type));
+					}
+				} });
+		}
+	}
+
+	//Zombies walking a frame, bouncing back at the edge of the area around the agent
+	void WalkThreats(std::vector<FleeField::Threat>& threats, std::vector<Elite::Vector2>& velocities)
+	{
+		const float range{ 40.f };
+		for (size_t i{}; i < threats.size(); ++i)
+		{
+			Elite::Vector2& position{ threats[i].position };
+			position += velocities[i] / 60.f;
+			if (fabsf(position.x) > range) velocities[i].x = -velocities[i].x;
+			if (fabsf(position.y) > range) velocities[i].y = -velocities[i].y;
+		}
+	}
+
+	//The direct way to an escape direction, for comparison: rays in 16 directions, marched a meter at a time, every sample
+	//against every threat. For one query it costs less than keeping the field up to date
+	bool CastEscapeRays(const Elite::Vector2& position, const std::vector<FleeField::Threat>& threats, Elite::Vector2& direction)
+	{
+		const int directionCount{ 16 };
+		const int steps{ 8 };
+		float bestClearance{ 0.f };
+		for (int i{}; i < directionCount; ++i)
+		{
+			const Elite::Vector2 candidate{ Elite::OrientationToVector(i * 2 * float(E_PI) / directionCount) };
+			float clearance{ FLT_MAX };
+			for (int step{ 1 }; step <= steps; ++step)
+			{
+				const Elite::Vector2 sample{ position + candidate * float(step) };
+				for (const FleeField::Threat& threat : threats)
+					clearance = std::min<float>(clearance, Elite::Distance(sample, threat.position) - threat.radius);
+			}
+			if (clearance <= bestClearance) continue;
+
+			bestClearance = clearance;
+			direction = candidate;
+		}
+		return bestClearance > 0.f;
+	}
+
+	void AddFleeFieldBenchmarks(std::vector<Benchmark>& benchmarks)
+	{
+		//50 threats around the agent, a purge zone among them, in the default window
+		const int threatCount{ 50 };
+		auto pThreats = std::make_shared<std::vector<FleeField::Threat>>();
+		auto pVelocities = std::make_shared<std::vector<Elite::Vector2>>();
+		auto pJumpedThreats = std::make_shared<std::vector<FleeField::Threat>>();
+		Random random{ 17 };
+		for (int i{}; i < threatCount; ++i)
+		{
+			const float radius{ i == 0 ? 10.f : 0.f };
+			pThreats->push_back(FleeField::Threat{ Elite::Vector2{ random.Range(-40.f, 40.f), random.Range(-40.f, 40.f) }, radius });
+			pVelocities->push_back(Elite::Vector2{ random.Range(-3.f, 3.f), random.Range(-3.f, 3.f) });
+			pJumpedThreats->push_back(FleeField::Threat{ Elite::Vector2{ random.Range(-40.f, 40.f), random.Range(-40.f, 40.f) }, radius });
+		}
+
+		//A few fresh builds and a walk on a copy grow its buckets past what the waves need, after that updates don't allocate
+		auto pField = std::make_shared<FleeField>();
+		for (int i{}; i < 60; ++i)
+		{
+			std::vector<FleeField::Threat> threats{ *pThreats };
+			for (FleeField::Threat& threat : threats) threat.position = Elite::Vector2{ random.Range(-40.f, 40.f), random.Range(-40.f, 40.f) };
+			pField->Update(Elite::Vector2{}, threats);
+		}
+		std::vector<FleeField::Threat> walkedThreats{ *pThreats };
+		std::vector<Elite::Vector2> walkedVelocities{ *pVelocities };
+		for (int i{}; i < 3600; ++i)
+		{
+			WalkThreats(walkedThreats, walkedVelocities);
+			pField->Update(Elite::Vector2{}, walkedThreats);
+		}
+		pField->Update(Elite::Vector2{}, *pThreats);
+
+		benchmarks.push_back({ "FleeField/50 threats walking", [pField, pThreats, pVelocities](int count)
+			{
+				Elite::Vector2 direction{};
+				for (int i{}; i < count; ++i)
+				{
+					WalkThreats(*pThreats, *pVelocities);
+					pField->Update(Elite::Vector2{}, *pThreats);
+					Keep(pField->GetEscapeDirection(Elite::Vector2{}, direction));
+				}
+			} });
+		//Every threat in another cell every frame, a fresh build
+		benchmarks.push_back({ "FleeField/50 threats jumping", [pField, pThreats, pJumpedThreats](int count)
+			{
+				Elite::Vector2 direction{};
+				for (int i{}; i < count; ++i)
+				{
+					pThreats->swap(*pJumpedThreats);
+					pField->Update(Elite::Vector2{}, *pThreats);
+					Keep(pField->GetEscapeDirection(Elite::Vector2{}, direction));
+				}
+			} });
+		benchmarks.push_back({ "FleeField/raycasts 50 threats walking", [pThreats, pVelocities](int count)
+			{
+				Elite::Vector2 direction{};
+				for (int i{}; i < count; ++i)
+				{
+					WalkThreats(*pThreats, *pVelocities);
+					Keep(CastEscapeRays(Elite::Vector2{}, *pThreats, direction));
+				}
+			} });
+	}
+
+	//The flee direction isEnemyInFOV falls back to: away from every enemy, the closer the more
+	Elite::Vector2 BlendFleeDirection(const Elite::Vector2& position, const std::vector<Elite::Vector2>& enemies, float range)
+	{
+		Elite::Vector2 direction{};
+		for (const Elite::Vector2& enemy : enemies)
+		{
+			const float weight{ 1 - Elite::Distance(enemy, position) / range };
+			direction -= weight * (enemy - position).GetNormalized();
+		}
+		return direction.GetNormalized();
+	}
+
+	void AddContextSteeringBenchmarks(std::vector<Benchmark>& benchmarks)
+	{
+		//Enemies as dangers with a goal as interest, against blending one vector away from them
+		const std::pair<int, int> setups[]{ { 12, 32 }, { 100, 32 }, { 1000, 64 } };
+		for (const std::pair<int, int>& setup : setups)
+		{
+			Random random{ uint64_t(setup.first) };
+			auto pEnemies = std::make_shared<std::vector<Elite::Vector2>>();
+			for (int i{}; i < setup.first; ++i) pEnemies->push_back(Elite::Vector2{ random.Range(-30.f, 30.f), random.Range(-30.f, 30.f) });
+
+			auto pContext = std::make_shared<ContextSteering>(setup.second);
+			const std::string entities{ std::to_string(setup.first) + " enemies" };
+			benchmarks.push_back({ "ContextSteering/" + entities + " " + std::to_string(setup.second) + " slots", [pContext, pEnemies](int count)
+				{
+					Elite::Vector2 direction{};
+					float speed{};
+					for (int i{}; i < count; ++i)
+					{
+						pContext->Clear();
+						for (const Elite::Vector2& enemy : *pEnemies) pContext->AddDanger(enemy, 1.f);
+						pContext->AddInterest(Elite::Vector2{ 50.f, 20.f });
+						Keep(pContext->Resolve(Elite::Vector2{}, direction, speed));
+						Keep(direction);
+					}
+				} });
+			benchmarks.push_back({ "WeightedBlend/" + entities, [pEnemies](int count)
+				{
+					for (int i{}; i < count; ++i) Keep(BlendFleeDirection(Elite::Vector2{}, *pEnemies, 50.f));
+				} });
+		}
+	}
+
+	void AddVelocityObstacleBenchmarks(Fixture& fixture, std::vector<Benchmark>& benchmarks)
+	{
+		//Zombies closing in from every side while the agent runs right, the way UpdateSteering fills it every frame
+		AgentInfo agent{ fixture.agents.front() };
+		agent.Position = Elite::Vector2{};
+		agent.LinearVelocity = Elite::Vector2{ agent.MaxLinearSpeed, 0.f };
+		agent.AgentSize = 1.f;
+		for (int zombieCount : { 10, 100, 250 })
+		{
+			Random random{ uint64_t(zombieCount) };
+			auto pZombies = std::make_shared<std::vector<EnemyInfo>>();
+			for (int i{}; i < zombieCount; ++i)
+			{
+				EnemyInfo zombie{};
+				zombie.Location = Elite::Vector2{ random.Range(-20.f, 20.f), random.Range(-20.f, 20.f) };
+				zombie.LinearVelocity = -zombie.Location.GetNormalized() * random.Range(1.f, 3.f);
+				zombie.Size = random.Range(0.5f, 1.5f);
+				pZombies->push_back(zombie);
+			}
+
+			auto pObstacles = std::make_shared<VelocityObstacles>();
+			benchmarks.push_back({ "VelocityObstacles/" + std::to_string(zombieCount) + " zombies", [pObstacles, pZombies, agent](int count)
+				{
+					for (int i{}; i < count; ++i)
+					{
+						pObstacles->Clear();
+						for (const EnemyInfo& zombie : *pZombies) pObstacles->AddNeighbour(zombie.Location, zombie.LinearVelocity, zombie.Size);
+						Keep(pObstacles->GetSafeVelocity(agent, agent.LinearVelocity, 1.f / 60.f));
+					}
+				} });
+		}
+	}
+
+	//What the plugin does when it starts: hashes the level, then bakes what isn't baked yet and maps it
+	bool LoadLevel(const std::string& levelFile, const std::string& basePath, bool isCold)
+	{
+		MappedFile file{};
+		if (!file.Open(levelFile)) return false;
+		const uint64_t levelHash{ LevelIndex::HashSource(file.GetData(), file.GetSize()) };
+
+		LevelIndex index{};
+		LevelFields fields{};
+		if (isCold)
+		{
+			LevelParser parser{};
+			LevelGeometry level{};
+			if (!parser.Parse(file.GetData(), file.GetSize(), level) || !LevelIndex::Bake(level, levelHash, basePath + ".gppli")) return false;
+		}
+		if (!index.Load(basePath + ".gppli", levelHash)) return false;
+		if (isCold && !LevelFields::Bake(index, basePath + ".gpplf")) return false;
+		return fields.Load(basePath + ".gpplf", index);
+	}
+
+	void AddLevelBenchmarks(const Options& options, Fixture& fixture, std::vector<Benchmark>& benchmarks)
+	{
+		if (!fixture.hasLevel) return;
+
+		//Baked next to the working directory under their own name, so the plugin's files aren't touched
+		const std::string levelFile{ options.levelFile };
+		const std::string basePath{ options.only.empty() ? g_LevelBenchmarkPath : g_LevelRetryPath };
+		if (!LoadLevel(levelFile, basePath, true)) return; //A warm start needs the files baked
+		benchmarks.push_back({ "Level/Parse", [levelFile](int count)
+			{
+				LevelParser parser{};
+				for (int i{}; i < count; ++i)
+				{
+					LevelGeometry level{};
+					Keep(parser.Parse(levelFile, level));
+				}
+			} });
+		benchmarks.push_back({ "Level/Cold start", [levelFile, basePath](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(LoadLevel(levelFile, basePath, true));
+			} });
+		benchmarks.push_back({ "Level/Warm start", [levelFile, basePath](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(LoadLevel(levelFile, basePath, false));
+			} });
+	}
+
+	//A route over every house from scratch, moves below 0 improves it all the way to a local optimum
+	float PlanRoute(const std::vector<std::pair<HouseInfo, float>>& houses, int moves)
+	{
+		HouseRouteOptimizer optimizer{};
+		for (const std::pair<HouseInfo, float>& house : houses) optimizer.AddHouse(house.first, house.second);
+		optimizer.Update(0.f, Elite::Vector2{});
+		if (moves > 0)
+		{
+			optimizer.SetEvaluationBudget(moves);
+			optimizer.Improve(0.f);
+		}
+		else if (moves < 0)
+		{
+			while (!optimizer.IsLocalOptimum()) optimizer.Improve(1.f);
+		}
+		return optimizer.GetRouteCost();
+	}
+
+	void AddHouseRouteBenchmarks(std::vector<Benchmark>& benchmarks)
+	{
+		//Route quality against the time spent on it: nearest neighbour alone, a few budgets of moves and the local optimum
+		const int moveBudgets[]{ 0, 1000, 10000, 100000, -1 };
+		for (int houseCount : { 50, 500 })
+		{
+			Random random{ uint64_t(houseCount) };
+			auto pHouses = std::make_shared<std::vector<std::pair<HouseInfo, float>>>();
+			for (int i{}; i < houseCount; ++i)
+			{
+				const HouseInfo house{ Elite::Vector2{ random.Range(-250.f, 250.f), random.Range(-250.f, 250.f) }, Elite::Vector2{ 20.f, 20.f } };
+				pHouses->emplace_back(house, random.Range(0.5f, 2.f));
+			}
+
+			const float optimumCost{ PlanRoute(*pHouses, -1) };
+			for (int moves : moveBudgets)
+			{
+				std::ostringstream name{};
+				name << "HouseRoute/" << houseCount << " houses ";
+				if (moves == 0) name << "nearest neighbour";
+				else if (moves > 0) name << moves << " moves";
+				else name << "local optimum";
+
+				std::ostringstream note{};
+				note << std::fixed << std::setprecision(1) << "cost +" << (PlanRoute(*pHouses, moves) / optimumCost - 1.f) * 100.f << "% over the local optimum";
+				benchmarks.push_back({ name.str(), [pHouses, moves](int count)
+					{
+						for (int i{}; i < count; ++i) Keep(PlanRoute(*pHouses, moves));
+					}, note.str() });
+			}
+		}
+	}
+
+	const char* const g_CalibrationName{ "Calibration/Mixed chains" };
+
+	//Dependent chains of integer multiplies, float divides and square roots and loads around a 256 KB cycle, what the
+	//benchmarks are made of and nothing the compiler can shorten. It only gets slower when the machine does (clock,
+	//a neighbour on the core or the cache), so the other benchmarks are compared relative to it
+	void AddCalibrationBenchmark(std::vector<Benchmark>& benchmarks)
+	{
+		//One random cycle through every entry, so the loads can't be predicted
+		auto pNext = std::make_shared<std::vector<uint32_t>>(1u << 16);
+		std::vector<uint32_t> order(pNext->size());
+		for (uint32_t i{}; i < uint32_t(order.size()); ++i) order[i] = i;
+		Random random{ 7 };
+		for (size_t i{ order.size() - 1 }; i > 0; --i) std::swap(order[i], order[random.Next() % uint32_t(i + 1)]);
+		for (size_t i{}; i < order.size(); ++i) (*pNext)[order[i]] = order[(i + 1) % order.size()];
+
+		benchmarks.push_back({ g_CalibrationName, [pNext](int count)
+			{
+				const uint32_t* pCycle{ pNext->data() };
+				uint32_t state{ 1 };
+				uint32_t index{};
+				float value{ 1.f };
+				for (int i{}; i < count; ++i)
+				{
+					for (int j{}; j < 32; ++j) state = (state * 1664525u + 1013904223u) ^ (state >> 13);
+					for (int j{}; j < 8; ++j) value = sqrtf(value + 1.f / (value + 1.f));
+					for (int j{}; j < 8; ++j) index = pCycle[index];
+				}
+				Keep(state);
+				Keep(value);
+				Keep(index);
+			} });
+	}
+
+	void AddVectorBenchmarks(Fixture& fixture, std::vector<Benchmark>& benchmarks)
+	{
+		const std::vector<Elite::Vector2>& vectors{ fixture.vectors };
+		benchmarks.push_back({ "Vector2/GetNormalized", [&vectors](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(vectors[i & 255].GetNormalized());
+			} });
+		benchmarks.push_back({ "Vector2/Distance", [&vectors](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(Elite::Distance(vectors[i & 255], vectors[(i + 1) & 255]));
+			} });
+		benchmarks.push_back({ "Vector2/Dot and Cross", [&vectors](int count)
+			{
+				for (int i{}; i < count; ++i)
+				{
+					Keep(Elite::Dot(vectors[i & 255], vectors[(i + 1) & 255]));
+					Keep(Elite::Cross(vectors[i & 255], vectors[(i + 1) & 255]));
+				}
+			} });
+		benchmarks.push_back({ "Vector2/Clamp", [&vectors](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(Elite::Clamp(vectors[i & 255], 50.f));
+			} });
+		benchmarks.push_back({ "Vector2/OrientationToVector", [&vectors](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(Elite::OrientationToVector(vectors[i & 255].x));
+			} });
+		benchmarks.push_back({ "Vector2/GetOrientationFromVelocity", [&vectors](int count)
+			{
+				for (int i{}; i < count; ++i) Keep(Elite::GetOrientationFromVelocity(vectors[i & 255]));
+			} });
+	}
+#pragma endregion
+
+#pragma region Measuring
+	//Seconds count operations took, allocations is incremented with the ones they made
+	double Time(const Benchmark& benchmark, int count, long long& allocations)
+	{
+		using Clock = std::chrono::steady_clock;
+		const long long allocationsStart{ AllocationCounter::GetCount() };
+		const Clock::time_point start{ Clock::now() };
+		benchmark.run(count);
+		const std::chrono::duration<double> elapsed{ Clock::now() - start };
+		allocations += AllocationCounter::GetCount() - allocationsStart;
+		return elapsed.count();
+	}
+
+	Measurement Measure(const Options& options, const Benchmark& benchmark)
+	{
+		//Doubles the count until a run takes long enough, that warms the caches up as well
+		int count{ 1 };
+		long long allocations{};
+		while (Time(benchmark, count, allocations) < options.runTime && count < (1 << 30)) count *= 2;
+
+		double fastest{ DBL_MAX };
+		allocations = 0;
+		for (int i{}; i < options.runs; ++i) fastest = std::min<double>(fastest, Time(benchmark, count, allocations));
+		return Measurement{ fastest * 1e9 / count, double(allocations) / (double(count) * options.runs) };
+	}
+#pragma endregion
+
+#pragma region Baseline
+	//benchmark,ns_per_op,allocations_per_op
+	bool ReadBaseline(const std::string& filePath, std::map<std::string, Measurement>& baseline)
+	{
+		std::ifstream file{ filePath };
+		if (!file) return false;
+
+		std::string line{};
+		std::getline(file, line); //Header
+		while (std::getline(file, line))
+		{
+			const size_t first{ line.find(',') };
+			const size_t second{ line.find(',', first + 1) };
+			if (first == std::string::npos || second == std::string::npos) continue;
+			baseline[line.substr(0, first)] = Measurement{ atof(line.substr(first + 1, second - first - 1).c_str()), atof(line.substr(second + 1).c_str()) };
+		}
+		return true;
+	}
+
+	bool WriteResults(const std::string& filePath, const std::vector<Benchmark>& benchmarks, const std::vector<Measurement>& measurements)
+	{
+		std::ofstream file{ filePath };
+		if (!file) return false;
+
+		file << "benchmark,ns_per_op,allocations_per_op" << '\n' << std::fixed << std::setprecision(3);
+		for (size_t i{}; i < benchmarks.size(); ++i)
+			file << benchmarks[i].name << ',' << measurements[i].nanoseconds << ',' << measurements[i].allocations << '\n';
+		return bool(file);
+	}
+
+	//Percent slower than the baseline, relative to the calibration when the baseline has one (baselineCalibration > 0)
+	float GetChange(const Measurement& previous, double nanoseconds, double calibration, double baselineCalibration)
+	{
+		const bool isCalibrated{ baselineCalibration > 0.0 };
+		const double ratio{ isCalibrated ? nanoseconds / std::max<double>(calibration, 1e-3) : nanoseconds };
+		const double previousRatio{ isCalibrated ? previous.nanoseconds / baselineCalibration : previous.nanoseconds };
+		return float((ratio / std::max<double>(previousRatio, 1e-6) - 1.0) * 100.0);
+	}
+
+	//Runs this program again for one benchmark and the calibration. A new process gets another heap and stack layout,
+	//some benchmarks are a lot slower in one layout than in another and no amount of measuring in the same process helps
+	bool MeasureInNewProcess(const std::string& program, const Options& options, const std::string& name, std::map<std::string, Measurement>& results)
+	{
+		const std::string resultsFile{ "MicroBenchRetry.csv" };
+		std::ostringstream command{};
+		command << '"' << program << "\" --only \"" << name << "\" --time " << options.runTime * 1000.0 << " --runs " << options.runs
+			<< " --level \"" << options.levelFile << "\" --out " << resultsFile;
+#ifdef _WIN32
+		//cmd drops the outer quotes
+		const std::string commandLine{ "\"" + command.str() + " > NUL\"" };
+#else
+		const std::string commandLine{ command.str() + " > /dev/null" };
+#endif
+		const bool isMeasured{ std::system(commandLine.c_str()) == 0 && ReadBaseline(resultsFile, results) };
+		std::remove(resultsFile.c_str());
+		return isMeasured;
+	}
+#pragma endregion
+}
+
+int main(int argc, char* argv[])
+{
+	Options options{};
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::map<std::string, Measurement> baseline{};
+	if (!options.baselineFile.empty() && !ReadBaseline(options.baselineFile, baseline))
+	{
+		std::cout << "Baseline " << options.baselineFile << " not found" << '\n';
+		return 1;
+	}
+
+	//A benchmark of kernels that compute something else is worth nothing
+	if (!CheckBatchSteering()) return 3;
+
+	Fixture fixture{};
+	SetUpFixture(options, fixture);
+	std::vector<Benchmark> benchmarks{};
+	AddCalibrationBenchmark(benchmarks);
+	AddBlackboardBenchmarks(fixture, benchmarks);
+	AddCompositeBenchmarks(fixture, benchmarks);
+	AddSteeringBenchmarks(fixture, benchmarks);
+	AddSteeringDispatchBenchmarks(fixture, benchmarks);
+	AddSteeringPipelineBenchmarks(fixture, benchmarks);
+	AddBatchSteeringBenchmarks(benchmarks);
+	AddInventoryBenchmarks(fixture, benchmarks);
+	AddFovBenchmarks(fixture, benchmarks);
+	AddPathfinderBenchmarks(fixture, benchmarks);
+	AddHouseRouteBenchmarks(benchmarks);
+	AddFleeFieldBenchmarks(benchmarks);
+	AddContextSteeringBenchmarks(benchmarks);
+	AddVelocityObstacleBenchmarks(fixture, benchmarks);
+	AddLevelBenchmarks(options, fixture, benchmarks);
+	AddVectorBenchmarks(fixture, benchmarks);
+	//The calibration always runs, everything is compared relative to it
+	benchmarks.erase(std::remove_if(benchmarks.begin() + 1, benchmarks.end(), [&options](const Benchmark& benchmark) {
+		return options.only.empty() ? benchmark.name.find(options.filter) == std::string::npos : benchmark.name != options.only; }), benchmarks.end());
+
+	std::cout << std::fixed << std::setprecision(2) << std::left << std::setw(40) << "Benchmark" << std::right
+		<< std::setw(12) << "ns/op" << std::setw(12) << "allocs/op";
+	if (!baseline.empty()) std::cout << std::setw(12) << "baseline" << std::setw(10) << "change";
+	std::cout << '\n';
+
+	//Changes are of the time relative to the calibration, the same slowdown on both is the machine and not the code.
+	//A baseline without the calibration compares the times as they are.
+	const Benchmark& calibration{ benchmarks.front() };
+	const auto calibrationIt = baseline.find(calibration.name);
+	const double baselineCalibration{ calibrationIt != baseline.end() ? std::max<double>(calibrationIt->second.nanoseconds, 1e-3) : 0.0 };
+	double currentCalibration{};
+	//A few percent of a nanosecond is a different instruction alignment, not slower code
+	auto isOverTolerance = [&options](const Measurement& previous, float change) {
+		return change > options.tolerance && previous.nanoseconds * change * 0.01 > options.minimumChange;
+	};
+
+	std::vector<Measurement> measurements{};
+	std::vector<std::pair<size_t, float>> suspects{}; //Index and change of the benchmarks measured again at the end
+	int regressions{};
+	for (const Benchmark& benchmark : benchmarks)
+	{
+		//The machine changes speed during a run, so each one is compared with the calibration measured right before it
+		const bool isCalibration{ &benchmark == &calibration };
+		if (!isCalibration && baselineCalibration > 0.0) currentCalibration = Measure(options, calibration).nanoseconds;
+		const Measurement measurement{ Measure(options, benchmark) };
+		measurements.push_back(measurement);
+		if (isCalibration) currentCalibration = measurement.nanoseconds;
+		std::cout << std::left << std::setw(40) << benchmark.name << std::right << std::setw(12) << measurement.nanoseconds
+			<< std::setw(12) << measurement.allocations;
+
+		const auto foundIt = baseline.find(benchmark.name);
+		if (foundIt != baseline.end())
+		{
+			//Allocations don't depend on the machine, any more is a regression. The calibration's change is the machine's
+			const Measurement& previous{ foundIt->second };
+			const float change{ GetChange(previous, measurement.nanoseconds, currentCalibration, isCalibration ? 0.0 : baselineCalibration) };
+			const bool isSlower{ isOverTolerance(previous, change) && !isCalibration };
+			const bool isAllocatingMore{ measurement.allocations > previous.allocations + 0.005 };
+			std::cout << std::setw(12) << previous.nanoseconds << std::setw(9) << std::showpos << change << std::noshowpos << '%';
+			if (isSlower && options.retries > 0) std::cout << "  suspect";
+			else if (isSlower) std::cout << "  slower";
+			if (isAllocatingMore) std::cout << "  allocates more (" << previous.allocations << ")";
+			if (isSlower && options.retries > 0 && !isAllocatingMore) suspects.push_back({ measurements.size() - 1, change });
+			else if (isSlower || isAllocatingMore) ++regressions;
+		}
+		else if (!baseline.empty()) std::cout << std::setw(12) << "new";
+		if (!benchmark.note.empty()) std::cout << "  " << benchmark.note;
+		std::cout << '\n';
+	}
+
+	//One slow measurement is often noise or a bad layout, a suspect only counts when it stays slower every time.
+	//The first time again in this process, in the same layout, then in new processes
+	if (!suspects.empty()) std::cout << '\n' << "Suspects measured again, the smallest change counts" << '\n';
+	for (const std::pair<size_t, float>& suspect : suspects)
+	{
+		const Benchmark& benchmark{ benchmarks[suspect.first] };
+		const Measurement& previous{ baseline[benchmark.name] };
+		float change{ suspect.second };
+		int runs{};
+		for (; runs < options.retries && isOverTolerance(previous, change); ++runs)
+		{
+			if (runs == 0)
+			{
+				const double calibrationNanoseconds{ Measure(options, calibration).nanoseconds };
+				change = std::min<float>(change, GetChange(previous, Measure(options, benchmark).nanoseconds, calibrationNanoseconds, baselineCalibration));
+				continue;
+			}
+
+			std::map<std::string, Measurement> results{};
+			if (!MeasureInNewProcess(argv[0], options, benchmark.name, results) || results.count(benchmark.name) == 0 || results.count(calibration.name) == 0) break;
+			change = std::min<float>(change, GetChange(previous, results[benchmark.name].nanoseconds, results[calibration.name].nanoseconds, baselineCalibration));
+		}
+
+		const bool isSlower{ isOverTolerance(previous, change) };
+		std::cout << std::left << std::setw(40) << benchmark.name << std::right << std::setw(9) << std::showpos << change << std::noshowpos << '%'
+			<< "  " << runs << " more runs, " << (isSlower ? "slower" : "noise") << '\n';
+		if (isSlower) ++regressions;
+	}
+	SAFE_DELETE(fixture.pInventory);
+	for (const char* pPath : { g_LevelBenchmarkPath, g_LevelRetryPath })
+	{
+		std::remove((std::string{ pPath } + ".gppli").c_str());
+		std::remove((std::string{ pPath } + ".gpplf").c_str());
+	}
+
+	if (!options.resultsFile.empty() && !WriteResults(options.resultsFile, benchmarks, measurements))
+	{
+		std::cout << "Results could not be written to " << options.resultsFile << '\n';
+		return 1;
+	}
+	if (regressions > 0)
+	{
+		std::cout << regressions << " of " << benchmarks.size() << " benchmarks regressed against " << options.baselineFile << '\n';
+		return 2;
+	}
+	return 0;
+}
@@ -0,0 +1,217 @@
+#include "stdafx.h"
+#include "ParameterTuner.h"
+#include <cmath>
+
+namespace
+{
+	//Over the first count seeds
+	float GetMean(const ParameterTuner::Candidate& candidate, size_t count)
+	{
+		float total{};
+		for (size_t i{}; i < count; ++i) total += candidate.survived[i];
+		return total / count;
+	}
+
+	//The genetic algorithm works on [0, 1] for every parameter, so one mutation size fits all of them
+	float GetNormalized(const AIParameters& parameters, const AIParameters::Field& field)
+	{
+		return (parameters.*field.pValue - field.min) / (field.max - field.min);
+	}
+
+	void SetNormalized(AIParameters& parameters, const AIParameters::Field& field, float value)
+	{
+		parameters.*field.pValue = field.min + (field.max - field.min) * std::min<float>(std::max<float>(value, 0.f), 1.f);
+	}
+}
+
+ParameterTuner::ParameterTuner(BatchRunner& runner, const Settings& settings)
+	: m_Runner{ runner }
+	, m_Settings{ settings }
+	, m_Random{ settings.randomSeed }
+{
+}
+
+bool ParameterTuner::Run()
+{
+	m_Candidates.clear();
+	m_GamesPlayed = 0;
+	m_Error.clear();
+
+	std::vector<int> added{};
+	Add(AIParameters{}, "default", added);
+	AddGrid(added);
+	std::cout << "Grid: " << added.size() << " candidates" << std::flush;
+	if (!Evaluate(added)) return false;
+	PrintBest();
+
+	for (int generation{}; generation < m_Settings.generations; ++generation)
+	{
+		added.clear();
+		AddGeneration(generation, added);
+		std::cout << "Generation " << generation + 1 << ": " << added.size() << " candidates" << std::flush;
+		if (!Evaluate(added)) return false;
+		PrintBest();
+	}
+	return true;
+}
+
+void ParameterTuner::PrintBest() const
+{
+	const Candidate& best{ *GetRanking().front() };
+	std::cout << ", " << m_GamesPlayed << " games played so far, best mean " << GetMean(best, best.survived.size()) << "s" << '\n';
+}
+
+std::vector<const ParameterTuner::Candidate*> ParameterTuner::GetRanking() const
+{
+	std::vector<const Candidate*> ranking{};
+	for (const Candidate& candidate : m_Candidates) ranking.push_back(&candidate);
+
+	std::stable_sort(ranking.begin(), ranking.end(), [](const Candidate* pA, const Candidate* pB) {
+		if (pA->survived.size() != pB->survived.size()) return pA->survived.size() > pB->survived.size();
+		return GetMean(*pA, pA->survived.size()) > GetMean(*pB, pB->survived.size());
+	});
+	return ranking;
+}
+
+void ParameterTuner::Add(AIParameters parameters, const std::string& origin, std::vector<int>& added)
+{
+	std::string error{};
+	parameters.Parse(parameters.ToString(), error);
+	const std::string text{ parameters.ToString() };
+	for (const Candidate& candidate : m_Candidates)
+	{
+		if (candidate.parameters.ToString() == text) return;
+	}
+
+	added.push_back(int(m_Candidates.size()));
+	m_Candidates.push_back(Candidate{ parameters, origin, {}, 0 });
+}
+
+bool ParameterTuner::Evaluate(const std::vector<int>& candidates)
+{
+	const size_t seedCount{ m_Settings.seeds.size() };
+	std::vector<int> active{ candidates };
+	for (size_t start{}; start < seedCount && !active.empty(); start += m_Settings.seedsPerRound)
+	{
+		const size_t end{ std::min<size_t>(start + m_Settings.seedsPerRound, seedCount) };
+		std::vector<BatchRunner::Game> games{};
+		for (int index : active)
+		{
+			const std::string parameters{ m_Candidates[index].parameters.ToString() };
+			for (size_t seed{ start }; seed < end; ++seed)
+			{
+				BatchRunner::Game game{ m_Settings.game };
+				game.seed = m_Settings.seeds[seed];
+				game.parameters = parameters;
+				games.push_back(game);
+			}
+		}
+
+		if (!m_Runner.Run(games, m_Settings.threadCount))
+		{
+			m_Error = m_Runner.GetError();
+			return false;
+		}
+		m_GamesPlayed += int(games.size());
+
+		//Games are in the order of the candidates, then of the seeds
+		const std::vector<BatchRunner::Result>& results{ m_Runner.GetResults() };
+		for (size_t i{}; i < results.size(); ++i)
+		{
+			Candidate& candidate{ m_Candidates[active[i / (end - start)]] };
+			candidate.survived.push_back(results[i].stats.TimeSurvived);
+			candidate.deaths += results[i].isDead ? 1 : 0;
+		}
+		if (end == seedCount) break;
+
+		const float threshold{ GetThreshold(end) };
+		active.erase(std::remove_if(active.begin(), active.end(), [this, threshold, end](int index) {
+			return GetMean(m_Candidates[index], end) < threshold;
+		}), active.end());
+	}
+	return true;
+}
+
+float ParameterTuner::GetThreshold(size_t seedCount) const
+{
+	//Everything that got this far counts, earlier generations included, so a generation of bad children stops early as a whole
+	std::vector<float> means{};
+	for (const Candidate& candidate : m_Candidates)
+	{
+		if (candidate.survived.size() >= seedCount) means.push_back(GetMean(candidate, seedCount));
+	}
+
+	const size_t kept{ std::min<size_t>(means.size(),
+		std::max<size_t>(size_t(m_Settings.minimumKept), size_t(std::ceil(m_Settings.keepFraction * means.size())))) };
+	std::nth_element(means.begin(), means.begin() + (kept - 1), means.end(), std::greater<float>());
+	return means[kept - 1];
+}
+
+void ParameterTuner::AddGrid(std::vector<int>& added)
+{
+	const int levels{ m_Settings.gridLevels };
+	if (levels <= 0) return;
+
+	int count{ 1 };
+	for (int i{}; i < AIParameters::FieldCount; ++i) count *= levels;
+
+	//Every combination, each index read as a number with a digit per parameter
+	for (int index{}; index < count; ++index)
+	{
+		AIParameters parameters{};
+		int digits{ index };
+		for (const AIParameters::Field& field : AIParameters::Fields)
+		{
+			SetNormalized(parameters, field, float(digits % levels + 1) / (levels + 1));
+			digits /= levels;
+		}
+		Add(parameters, "grid", added);
+	}
+}
+
+void ParameterTuner::AddGeneration(int generation, std::vector<int>& added)
+{
+	std::vector<const Candidate*> parents{ GetRanking() };
+	if (int(parents.size()) > m_Settings.population) parents.resize(m_Settings.population);
+
+	//Wide steps first, fine ones at the end
+	const float mutation{ 0.02f + 0.2f * (1.f - float(generation) / m_Settings.generations) };
+	const std::string origin{ "generation " + std::to_string(generation + 1) };
+	for (int i{}; i < m_Settings.population; ++i) Add(Breed(parents, mutation), origin, added);
+}
+
+AIParameters ParameterTuner::Breed(const std::vector<const Candidate*>& parents, float mutation)
+{
+	const Candidate& mother{ Select(parents) };
+	const Candidate& father{ Select(parents) };
+
+	//BLX-0.5: anywhere between the parents, or half their distance beyond either
+	AIParameters child{};
+	for (const AIParameters::Field& field : AIParameters::Fields)
+	{
+		const float a{ GetNormalized(mother.parameters, field) };
+		const float b{ GetNormalized(father.parameters, field) };
+		const float spread{ std::abs(a - b) * 0.5f };
+		float value{ m_Random.Range(std::min<float>(a, b) - spread, std::max<float>(a, b) + spread) };
+		if (m_Random.NextFloat() < 1.f / AIParameters::FieldCount) value += mutation * NextGaussian();
+		SetNormalized(child, field, value);
+	}
+	return child;
+}
+
+const ParameterTuner::Candidate& ParameterTuner::Select(const std::vector<const Candidate*>& parents)
+{
+	//Tournament of three, parents are ranked so the lowest index wins
+	const uint32_t count{ uint32_t(parents.size()) };
+	uint32_t best{ m_Random.Next() % count };
+	for (int i{ 1 }; i < 3; ++i) best = std::min<uint32_t>(best, m_Random.Next() % count);
+	return *parents[best];
+}
+
+float ParameterTuner::NextGaussian()
+{
+	//Box-Muller, the first uniform can't be 0
+	const float u{ 1.f - m_Random.NextFloat() };
+	const float v{ m_Random.NextFloat() };
+	return std::sqrt(-2.f * std::log(u)) * std::cos(6.28318531f * v);
+}
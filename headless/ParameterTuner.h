@@ -0,0 +1,72 @@
+#pragma once
+#include "AIParameters.h"
+#include "BatchRunner.h"
+#include "Random.h"
+
+//Searches AIParameters for the longest survival on the headless simulator: a grid over every parameter first,
+//then a genetic algorithm that breeds from the best sets found so far.
+//Every candidate plays the same seeds in the same order, a few per round, all candidates of a round side by side.
+//After each round only the candidates whose mean so far is in the best part of everything that got that far
+//play on (successive halving), so most of the time goes to the sets that are worth it.
+class ParameterTuner final
+{
+public:
+	struct Settings
+	{
+		BatchRunner::Game game; //Played with every seed, seed and parameters are filled in
+		std::vector<int> seeds;
+		int threadCount;
+		int seedsPerRound{ 4 };
+		float keepFraction{ 0.5f }; //Of the candidates that played as many seeds, those that play on
+		int minimumKept{ 4 };
+		int gridLevels{ 2 }; //Values per parameter, spread over its range without the ends, 0 skips the grid
+		int generations{ 4 };
+		int population{ 16 }; //Parents a generation picks from, and children it plays
+		uint64_t randomSeed{ 1 };
+	};
+
+	struct Candidate
+	{
+		AIParameters parameters;
+		std::string origin; //"default", "grid" or "generation n"
+		std::vector<float> survived; //Seconds, one per seed played, in the order of the seeds
+		int deaths;
+	};
+
+	ParameterTuner(BatchRunner& runner, const Settings& settings);
+	~ParameterTuner() = default;
+	ParameterTuner(const ParameterTuner&) = delete;
+	ParameterTuner& operator=(const ParameterTuner&) = delete;
+	ParameterTuner(ParameterTuner&&) = delete;
+	ParameterTuner& operator=(ParameterTuner&&) = delete;
+
+	bool Run();
+	const std::string& GetError() const { return m_Error; }
+
+	//Best first: the candidates that played every seed by mean survival, then the ones stopped early, furthest first
+	std::vector<const Candidate*> GetRanking() const;
+	bool IsComplete(const Candidate& candidate) const { return candidate.survived.size() == m_Settings.seeds.size(); }
+	int GetGamesPlayed() const { return m_GamesPlayed; }
+	int GetCandidateCount() const { return int(m_Candidates.size()); }
+
+private:
+	//Adds it unless an equal set was tried before, rounded the way it is saved so it plays back the same from a file
+	void Add(AIParameters parameters, const std::string& origin, std::vector<int>& added);
+	bool Evaluate(const std::vector<int>& candidates);
+	//The lowest mean over the first seedCount seeds that still plays on
+	float GetThreshold(size_t seedCount) const;
+	void PrintBest() const;
+
+	void AddGrid(std::vector<int>& added);
+	void AddGeneration(int generation, std::vector<int>& added);
+	AIParameters Breed(const std::vector<const Candidate*>& parents, float mutation);
+	const Candidate& Select(const std::vector<const Candidate*>& parents);
+	float NextGaussian();
+
+	BatchRunner& m_Runner;
+	const Settings m_Settings;
+	std::vector<Candidate> m_Candidates{};
+	Random m_Random;
+	int m_GamesPlayed{};
+	std::string m_Error{};
+};
@@ -0,0 +1,138 @@
+#include "stdafx.h"
+#include "PluginHost.h"
+#include "IExamInterface.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace
+{
+	float GetSeconds(std::chrono::steady_clock::duration duration)
+	{
+		return std::chrono::duration<float>(duration).count();
+	}
+}
+
+PluginHost::~PluginHost()
+{
+	Unload();
+}
+
+bool PluginHost::Load(const std::string& filePath, const std::string& parameters)
+{
+	Unload();
+	m_LoadStart = Clock::now();
+
+	const char* pRegisterName{ parameters.empty() ? "Register" : "RegisterWithParameters" };
+#ifdef _WIN32
+	HMODULE library{ LoadLibraryA(filePath.c_str()) };
+	if (library == nullptr) return Fail("Could not load " + filePath + ", error " + std::to_string(GetLastError()));
+	m_pLibrary = library;
+	void* pRegister{ reinterpret_cast<void*>(GetProcAddress(library, pRegisterName)) };
+#else
+	m_pLibrary = dlopen(filePath.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if (m_pLibrary == nullptr) return Fail(dlerror());
+	void* pRegister{ dlsym(m_pLibrary, pRegisterName) };
+#endif
+	if (pRegister == nullptr) return Fail(filePath + " has no " + pRegisterName + "()");
+
+	if (parameters.empty()) return Create(reinterpret_cast<RegisterFunction>(pRegister));
+	return Create(reinterpret_cast<ParametersRegisterFunction>(pRegister), parameters);
+}
+
+bool PluginHost::Create(RegisterFunction pRegister)
+{
+	BeginCreate();
+	return EndCreate(pRegister(), "Register()");
+}
+
+bool PluginHost::Create(ParametersRegisterFunction pRegister, const std::string& parameters)
+{
+	BeginCreate();
+	return EndCreate(pRegister(parameters.c_str()), "RegisterWithParameters(), check the parameters,");
+}
+
+void PluginHost::BeginCreate()
+{
+	if (m_pLibrary == nullptr)
+	{
+		Unload();
+		m_LoadStart = Clock::now();
+	}
+}
+
+bool PluginHost::EndCreate(IPluginBase* pPlugin, const std::string& registerName)
+{
+	//The framework only loads exam plugins, like it does the cast is taken on trust
+	m_pPlugin = static_cast<IExamPlugin*>(pPlugin);
+	if (m_pPlugin == nullptr) return Fail(registerName + " did not return a plugin");
+
+	m_LoadTime = GetSeconds(Clock::now() - m_LoadStart);
+	return true;
+}
+
+void PluginHost::InitGameDebugParams(GameDebugParams& params)
+{
+	m_pPlugin->InitGameDebugParams(params);
+}
+
+void PluginHost::Initialize(IExamInterface* pInterface)
+{
+	m_pPlugin->Initialize(pInterface, m_Info);
+	m_pPlugin->DllInit();
+	m_IsInitialized = true;
+}
+
+SteeringPlugin_Output PluginHost::UpdateSteering(float dt)
+{
+	m_pPlugin->Update(dt);
+	const SteeringPlugin_Output steering{ m_pPlugin->UpdateSteering(dt) };
+	if (!m_HasStarted)
+	{
+		m_StartupTime = GetSeconds(Clock::now() - m_LoadStart);
+		m_HasStarted = true;
+	}
+	return steering;
+}
+
+void PluginHost::Render(float dt) const
+{
+	m_pPlugin->Render(dt);
+}
+
+void PluginHost::Unload()
+{
+	if (m_pPlugin != nullptr)
+	{
+		if (m_IsInitialized) m_pPlugin->DllShutdown();
+		//Deleted while its code is still loaded
+		delete m_pPlugin;
+		m_pPlugin = nullptr;
+	}
+
+	if (m_pLibrary != nullptr)
+	{
+#ifdef _WIN32
+		FreeLibrary(static_cast<HMODULE>(m_pLibrary));
+#else
+		dlclose(m_pLibrary);
+#endif
+		m_pLibrary = nullptr;
+	}
+
+	m_IsInitialized = false;
+	m_Info = PluginInfo{};
+	m_LoadTime = 0.f;
+	m_StartupTime = 0.f;
+	m_HasStarted = false;
+}
+
+bool PluginHost::Fail(const std::string& error)
+{
+	m_Error = error;
+	Unload();
+	return false;
+}
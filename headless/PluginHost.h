@@ -0,0 +1,65 @@
+#pragma once
+#include <chrono>
+#include "IExamPlugin.h"
+#include "Exam_HelperStructs.h"
+
+class IExamInterface;
+
+//Runs a plugin the way the framework does, against any IExamInterface.
+//The plugin either comes from a library loaded at runtime (GPP_Plugin.dll, GPP_Plugin.so), so variants can be
+//swapped without relinking, or from a Register() linked into the executable.
+//With parameters (AIParameters.txt format) RegisterWithParameters() is used instead, every plugin gets its own.
+//The time from loading to the end of the first frame is measured, that is what a player waits for.
+class PluginHost final
+{
+public:
+	using RegisterFunction = IPluginBase* (*)();
+	using ParametersRegisterFunction = IPluginBase* (*)(const char*);
+
+	PluginHost() = default;
+	~PluginHost();
+	PluginHost(const PluginHost&) = delete;
+	PluginHost& operator=(const PluginHost&) = delete;
+	PluginHost(PluginHost&&) = delete;
+	PluginHost& operator=(PluginHost&&) = delete;
+
+	bool Load(const std::string& filePath, const std::string& parameters = {});
+	bool Create(RegisterFunction pRegister);
+	bool Create(ParametersRegisterFunction pRegister, const std::string& parameters);
+	const std::string& GetError() const { return m_Error; } //Of the last failed load
+
+	//Call order of the framework: the plugin picks its params, the world gets built, then the plugin is initialized
+	void InitGameDebugParams(GameDebugParams& params);
+	void Initialize(IExamInterface* pInterface);
+	//Update (debug input only) and UpdateSteering, the first call ends the startup time
+	SteeringPlugin_Output UpdateSteering(float dt);
+	void Render(float dt) const;
+	//Shuts the plugin down and unloads the library
+	void Unload();
+
+	bool IsLoaded() const { return m_pPlugin != nullptr; }
+	const PluginInfo& GetInfo() const { return m_Info; }
+	//Seconds, only valid once the first frame is done
+	float GetLoadTime() const { return m_LoadTime; }
+	float GetStartupTime() const { return m_StartupTime; }
+	bool HasStarted() const { return m_HasStarted; }
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	bool Fail(const std::string& error);
+	//Around the call to a register function
+	void BeginCreate();
+	bool EndCreate(IPluginBase* pPlugin, const std::string& registerName);
+
+	void* m_pLibrary{};
+	IExamPlugin* m_pPlugin{};
+	PluginInfo m_Info{};
+	bool m_IsInitialized{};
+
+	Clock::time_point m_LoadStart{};
+	float m_LoadTime{};
+	float m_StartupTime{};
+	bool m_HasStarted{};
+	std::string m_Error{};
+};
@@ -0,0 +1,109 @@
+#include "stdafx.h"
+#include <chrono>
+#include "PluginHost.h"
+#include "TraceReplayer.h"
+
+//Entry point of the plugin linked into this executable, defined in Plugin.h
+extern "C" IPluginBase* Register();
+
+namespace
+{
+	void SetEnvironment(const char* name, const char* value)
+	{
+#ifdef _WIN32
+		_putenv_s(name, value);
+#else
+		if (*value == '\0') unsetenv(name);
+		else setenv(name, value, 1);
+#endif
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::string traceFile{}, pluginFile{};
+	bool isVerbose{ false }, isValid{ true };
+	for (int i{ 1 }; i < argc && isValid; ++i)
+	{
+		const std::string option{ argv[i] };
+		if (option == "--verbose") isVerbose = true;
+		else if (option == "--plugin" && i + 1 < argc) pluginFile = argv[++i];
+		else if (traceFile.empty() && option.compare(0, 2, "--") != 0) traceFile = option;
+		else isValid = false;
+	}
+	if (!isValid || traceFile.empty())
+	{
+		std::cout << "Usage: HeadlessReplay trace [--plugin file] [--verbose]" << '\n';
+		return 1;
+	}
+
+	TraceReplayer replayer{};
+	if (!replayer.Open(traceFile))
+	{
+		std::cout << "Trace not loaded: " << replayer.GetError() << '\n';
+		return 1;
+	}
+
+	//The plugin has to play the same game it recorded, without recording over the trace
+	SetEnvironment("GPP_DETERMINISTIC", "1");
+	SetEnvironment("GPP_TRACE", "");
+
+	PluginHost host{};
+	if (!(pluginFile.empty() ? host.Create(&Register) : host.Load(pluginFile)))
+	{
+		std::cout << "Plugin not loaded: " << host.GetError() << '\n';
+		return 1;
+	}
+
+	GameDebugParams params{};
+	params.Seed = replayer.GetSeed();
+	host.InitGameDebugParams(params);
+
+	std::streambuf* pCoutBuffer{ std::cout.rdbuf() };
+	if (!isVerbose) std::cout.rdbuf(nullptr);
+
+	using Clock = std::chrono::steady_clock;
+	const Clock::time_point start{ Clock::now() };
+	host.Initialize(&replayer);
+
+	float dt{};
+	int slowestFrame{ -1 };
+	double slowestTime{};
+	while (replayer.BeginFrame(dt))
+	{
+		const Clock::time_point frameStart{ Clock::now() };
+		const SteeringPlugin_Output steering{ host.UpdateSteering(dt) };
+		const double frameTime{ std::chrono::duration<double>(Clock::now() - frameStart).count() };
+		replayer.EndFrame(steering);
+
+		if (frameTime > slowestTime)
+		{
+			slowestTime = frameTime;
+			slowestFrame = replayer.GetFrame();
+		}
+	}
+	const std::chrono::duration<double> elapsed{ Clock::now() - start };
+
+	std::cout.clear();
+	std::cout.rdbuf(pCoutBuffer);
+	host.Unload();
+
+	const int frames{ replayer.GetFrame() + 1 };
+	std::cout << "Replayed " << frames << " frames of seed " << replayer.GetSeed() << " in " << elapsed.count() << "s";
+	if (slowestFrame != -1) std::cout << ", slowest was frame " << slowestFrame << " at " << slowestTime * 1000.0 << "ms";
+	std::cout << '\n';
+
+	if (!replayer.GetError().empty())
+	{
+		std::cout << "Trace damaged after frame " << replayer.GetFrame() << ": " << replayer.GetError() << '\n';
+		return 1;
+	}
+	if (replayer.HasDiverged())
+	{
+		const int frame{ replayer.GetFrame() };
+		std::cout << "Diverged " << (frame == -1 ? std::string{ "while initializing" } : "at frame " + std::to_string(frame)) << ": " << replayer.GetDivergence() << '\n';
+		return 2;
+	}
+	std::cout << "Every frame matched the trace" << '\n';
+	return 0;
+}
@@ -0,0 +1,85 @@
+#include "stdafx.h"
+#include "ScriptedInterface.h"
+
+void ScriptedInterface::AddEnemy(const EnemyInfo& enemy)
+{
+	m_Enemies.push_back(enemy);
+	m_Entities.push_back(EntityInfo{ eEntityType::ENEMY, enemy.Location, enemy.EnemyHash });
+}
+
+void ScriptedInterface::AddItem(const ItemInfo& item, int value)
+{
+	m_Items.push_back(Item{ item, value });
+	m_Entities.push_back(EntityInfo{ eEntityType::ITEM, item.Location, item.ItemHash });
+}
+
+void ScriptedInterface::AddPurgeZone(const PurgeZoneInfo& zone)
+{
+	m_PurgeZones.push_back(zone);
+	m_Entities.push_back(EntityInfo{ eEntityType::PURGEZONE, zone.Center, zone.ZoneHash });
+}
+
+bool ScriptedInterface::Fov_GetEntityByIndex(UINT index, EntityInfo& entity) const
+{
+	if (index >= UINT(m_Entities.size())) return false;
+
+	entity = m_Entities[index];
+	return true;
+}
+
+bool ScriptedInterface::Enemy_GetInfo(EntityInfo entity, EnemyInfo& enemy)
+{
+	auto foundIt = std::find_if(m_Enemies.begin(), m_Enemies.end(), [&entity](const EnemyInfo& e) { return e.EnemyHash == entity.EntityHash; });
+	if (foundIt == m_Enemies.end()) return false;
+
+	enemy = *foundIt;
+	return true;
+}
+
+bool ScriptedInterface::Inventory_AddItem(UINT slotId, ItemInfo item)
+{
+	if (slotId >= UINT(m_Inventory.size()) || m_Inventory[slotId].ItemHash != 0) return false;
+
+	m_Inventory[slotId] = item;
+	return true;
+}
+
+bool ScriptedInterface::Inventory_RemoveItem(UINT slotId)
+{
+	if (slotId >= UINT(m_Inventory.size()) || m_Inventory[slotId].ItemHash == 0) return false;
+
+	m_Inventory[slotId] = ItemInfo{};
+	return true;
+}
+
+bool ScriptedInterface::Inventory_GetItem(UINT slotId, ItemInfo& item)
+{
+	if (slotId >= UINT(m_Inventory.size()) || m_Inventory[slotId].ItemHash == 0) return false;
+
+	item = m_Inventory[slotId];
+	return true;
+}
+
+bool ScriptedInterface::Item_GetInfo(EntityInfo entity, ItemInfo& item)
+{
+	auto foundIt = std::find_if(m_Items.begin(), m_Items.end(), [&entity](const Item& i) { return i.info.ItemHash == entity.EntityHash; });
+	if (foundIt == m_Items.end()) return false;
+
+	item = foundIt->info;
+	return true;
+}
+
+bool ScriptedInterface::PurgeZone_GetInfo(EntityInfo entity, PurgeZoneInfo& zone)
+{
+	auto foundIt = std::find_if(m_PurgeZones.begin(), m_PurgeZones.end(), [&entity](const PurgeZoneInfo& z) { return z.ZoneHash == entity.EntityHash; });
+	if (foundIt == m_PurgeZones.end()) return false;
+
+	zone = *foundIt;
+	return true;
+}
+
+int ScriptedInterface::GetValue(const ItemInfo& item) const
+{
+	auto foundIt = std::find_if(m_Items.begin(), m_Items.end(), [&item](const Item& i) { return i.info.ItemHash == item.ItemHash; });
+	return foundIt != m_Items.end() ? foundIt->value : 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "IExamInterface.h"
+
+//Stand-in for the framework without a world behind it, it only answers with what it was given.
+//Lets parts of the plugin (inventory, FOV filtering, behaviours) run on their own, see HeadlessMicroBench.
+//Every enemy and item that is added is in the FOV, they are looked up by hash like the framework does.
+class ScriptedInterface final : public IExamInterface
+{
+public:
+	ScriptedInterface() = default;
+	~ScriptedInterface() = default;
+	ScriptedInterface(const ScriptedInterface&) = delete;
+	ScriptedInterface& operator=(const ScriptedInterface&) = delete;
+	ScriptedInterface(ScriptedInterface&&) = delete;
+	ScriptedInterface& operator=(ScriptedInterface&&) = delete;
+
+	void SetAgent(const AgentInfo& agent) { m_Agent = agent; }
+	void AddEnemy(const EnemyInfo& enemy);
+	//Value is the ammo, health or energy
+	void AddItem(const ItemInfo& item, int value);
+	void AddPurgeZone(const PurgeZoneInfo& zone);
+	const std::vector<EntityInfo>& GetEntities() const { return m_Entities; }
+
+	WorldInfo World_GetInfo() const override { return WorldInfo{ Elite::Vector2{}, Elite::Vector2{ 500.f, 500.f } }; }
+	StatisticsInfo World_GetStats() const override { return {}; }
+	bool Fov_GetHouseByIndex(UINT index, HouseInfo& houseInfo) const override { return false; }
+	bool Fov_GetEntityByIndex(UINT index, EntityInfo& entity) const override;
+	AgentInfo Agent_GetInfo() const override { return m_Agent; }
+	bool Enemy_GetInfo(EntityInfo entity, EnemyInfo& enemy) override;
+	Elite::Vector2 NavMesh_GetClosestPathPoint(Elite::Vector2 goal) const override { return goal; }
+
+	bool Inventory_AddItem(UINT slotId, ItemInfo item) override;
+	bool Inventory_UseItem(UINT slotId) override { return slotId < UINT(m_Inventory.size()) && m_Inventory[slotId].ItemHash != 0; }
+	bool Inventory_RemoveItem(UINT slotId) override;
+	bool Inventory_GetItem(UINT slotId, ItemInfo& item) override;
+	UINT Inventory_GetCapacity() const override { return UINT(m_Inventory.size()); }
+
+	bool Item_GetInfo(EntityInfo entity, ItemInfo& item) override;
+	bool Item_Grab(EntityInfo entity, ItemInfo& item) override { return Item_GetInfo(entity, item); }
+	bool Item_Destroy(EntityInfo entity) override { return true; }
+	int Weapon_GetAmmo(ItemInfo& item) override { return GetValue(item); }
+	int Medkit_GetHealth(ItemInfo& item) override { return GetValue(item); }
+	int Food_GetEnergy(ItemInfo& item) override { return GetValue(item); }
+
+	bool PurgeZone_GetInfo(EntityInfo entity, PurgeZoneInfo& zone) override;
+
+	Elite::Vector2 Debug_ConvertScreenToWorld(Elite::Vector2 screenPos) const override { return screenPos; }
+	Elite::Vector2 Debug_ConvertWorldToScreen(Elite::Vector2 worldPos) const override { return worldPos; }
+	bool Input_IsKeyboardKeyDown(Elite::InputScancode key) const override { return false; }
+	bool Input_IsKeyboardKeyUp(Elite::InputScancode key) const override { return false; }
+	bool Input_IsMouseButtonDown(Elite::InputMouseButton button) const override { return false; }
+	bool Input_IsMouseButtonUp(Elite::InputMouseButton button) const override { return false; }
+	Elite::MouseData Input_GetMouseData(Elite::InputType type, Elite::InputMouseButton button = Elite::InputMouseButton(0)) const override { return {}; }
+
+	void RequestShutdown() const override {}
+
+	void Draw_Polygon(const Elite::Vector2* points, int count, const Elite::Vector3& color, float depth) override {}
+	void Draw_SolidPolygon(const Elite::Vector2* points, int count, const Elite::Vector3& color, float depth, bool triangulate = false) override {}
+	void Draw_Circle(const Elite::Vector2& center, float radius, const Elite::Vector3& color, float depth) override {}
+	void Draw_SolidCircle(const Elite::Vector2& center, float32 radius, const Elite::Vector2& axis, const Elite::Vector3& color, float depth) override {}
+	void Draw_Segment(const Elite::Vector2& p1, const Elite::Vector2& p2, const Elite::Vector3& color, float depth) override {}
+	void Draw_Direction(const Elite::Vector2& p, Elite::Vector2 dir, float length, const Elite::Vector3& color, float depth = 0.9f) override {}
+	void Draw_Transform(const b2Transform& xf, float depth) override {}
+	void Draw_Point(const Elite::Vector2& p, float size, const Elite::Vector3& color, float depth) override {}
+	float NextDepthSlice() override { return 0.f; }
+
+private:
+	struct Item
+	{
+		ItemInfo info;
+		int value;
+	};
+
+	int GetValue(const ItemInfo& item) const;
+
+	AgentInfo m_Agent{};
+	std::vector<EntityInfo> m_Entities{};
+	std::vector<EnemyInfo> m_Enemies{};
+	std::vector<Item> m_Items{};
+	std::vector<PurgeZoneInfo> m_PurgeZones{};
+	std::vector<ItemInfo> m_Inventory = std::vector<ItemInfo>(5); //An empty slot has no hash
+};
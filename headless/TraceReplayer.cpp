@@ -0,0 +1,271 @@
+#include "stdafx.h"
+#include "TraceReplayer.h"
+#include <sstream>
+
+namespace
+{
+	std::string Describe(const SteeringPlugin_Output& steering)
+	{
+		std::ostringstream description{};
+		description << "velocity (" << steering.LinearVelocity.x << ", " << steering.LinearVelocity.y << "), angular " << steering.AngularVelocity
+			<< (steering.AutoOrient ? ", auto orient" : "") << (steering.RunMode ? ", running" : "");
+		return description.str();
+	}
+}
+
+bool TraceReplayer::Open(const std::string& filePath)
+{
+	m_Divergence.clear();
+	m_Frame = -1;
+	return m_Reader.Open(filePath);
+}
+
+bool TraceReplayer::BeginFrame(float& dt)
+{
+	if (HasDiverged()) return false;
+
+	TraceRecord record{};
+	if (!m_Reader.Read(record, m_Payload)) return false;
+	//Still in the previous frame (or the initialization), that is where the plugin left something out
+	if (record != TraceRecord::Frame)
+	{
+		Diverge(std::string{ "the plugin never called " } + ToString(record));
+		return false;
+	}
+
+	++m_Frame;
+	return m_Payload.Get(dt);
+}
+
+void TraceReplayer::EndFrame(const SteeringPlugin_Output& steering)
+{
+	if (HasDiverged()) return;
+
+	TraceRecord record{};
+	if (!m_Reader.Read(record, m_Payload))
+	{
+		Diverge("the trace ends in the middle of the frame");
+		return;
+	}
+	if (record != TraceRecord::Output)
+	{
+		Diverge(std::string{ "the plugin never called " } + ToString(record));
+		return;
+	}
+
+	m_Arguments.Clear();
+	m_Arguments.Put(steering);
+	if (m_Payload.Match(m_Arguments)) return;
+
+	SteeringPlugin_Output recorded{};
+	m_Payload.Get(recorded);
+	Diverge("UpdateSteering returned " + Describe(steering) + ", recorded was " + Describe(recorded));
+}
+
+bool TraceReplayer::Replay(TraceRecord record) const
+{
+	if (HasDiverged()) return false;
+
+	TraceRecord recorded{};
+	if (!m_Reader.Read(recorded, m_Payload))
+	{
+		Diverge(std::string{ "the plugin called " } + ToString(record) + " after the trace ended");
+		return false;
+	}
+	if (recorded != record)
+	{
+		Diverge(std::string{ "the plugin called " } + ToString(record) + ", recorded was " + ToString(recorded));
+		return false;
+	}
+	if (!m_Payload.Match(m_Arguments))
+	{
+		Diverge(std::string{ "the plugin called " } + ToString(record) + " with other arguments");
+		return false;
+	}
+	return true;
+}
+
+void TraceReplayer::Diverge(const std::string& divergence) const
+{
+	if (m_Divergence.empty()) m_Divergence = divergence;
+}
+
+#pragma region World
+WorldInfo TraceReplayer::World_GetInfo() const
+{
+	m_Arguments.Clear();
+	WorldInfo info{};
+	if (Replay(TraceRecord::World_GetInfo)) m_Payload.Get(info);
+	return info;
+}
+
+StatisticsInfo TraceReplayer::World_GetStats() const
+{
+	m_Arguments.Clear();
+	StatisticsInfo stats{};
+	if (Replay(TraceRecord::World_GetStats)) m_Payload.Get(stats);
+	return stats;
+}
+
+bool TraceReplayer::Fov_GetHouseByIndex(UINT index, HouseInfo& houseInfo) const
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(index);
+	bool isFound{};
+	if (Replay(TraceRecord::Fov_GetHouseByIndex) && m_Payload.Get(isFound)) m_Payload.Get(houseInfo);
+	return isFound;
+}
+
+bool TraceReplayer::Fov_GetEntityByIndex(UINT index, EntityInfo& enemyInfo) const
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(index);
+	bool isFound{};
+	if (Replay(TraceRecord::Fov_GetEntityByIndex) && m_Payload.Get(isFound)) m_Payload.Get(enemyInfo);
+	return isFound;
+}
+
+AgentInfo TraceReplayer::Agent_GetInfo() const
+{
+	m_Arguments.Clear();
+	AgentInfo agent{};
+	if (Replay(TraceRecord::Agent_GetInfo)) m_Payload.Get(agent);
+	return agent;
+}
+
+bool TraceReplayer::Enemy_GetInfo(EntityInfo entity, EnemyInfo& enemy)
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(entity);
+	bool isFound{};
+	if (Replay(TraceRecord::Enemy_GetInfo) && m_Payload.Get(isFound)) m_Payload.Get(enemy);
+	return isFound;
+}
+
+Elite::Vector2 TraceReplayer::NavMesh_GetClosestPathPoint(Elite::Vector2 goal) const
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(goal);
+	Elite::Vector2 pathPoint{ goal };
+	if (Replay(TraceRecord::NavMesh_GetClosestPathPoint)) m_Payload.Get(pathPoint);
+	return pathPoint;
+}
+#pragma endregion
+
+#pragma region Inventory
+bool TraceReplayer::Inventory_AddItem(UINT slotId, ItemInfo item)
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(slotId);
+	m_Arguments.Put(item);
+	bool isAdded{};
+	if (Replay(TraceRecord::Inventory_AddItem)) m_Payload.Get(isAdded);
+	return isAdded;
+}
+
+bool TraceReplayer::Inventory_UseItem(UINT slotId)
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(slotId);
+	bool isUsed{};
+	if (Replay(TraceRecord::Inventory_UseItem)) m_Payload.Get(isUsed);
+	return isUsed;
+}
+
+bool TraceReplayer::Inventory_RemoveItem(UINT slotId)
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(slotId);
+	bool isRemoved{};
+	if (Replay(TraceRecord::Inventory_RemoveItem)) m_Payload.Get(isRemoved);
+	return isRemoved;
+}
+
+bool TraceReplayer::Inventory_GetItem(UINT slotId, ItemInfo& item)
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(slotId);
+	bool isFound{};
+	if (Replay(TraceRecord::Inventory_GetItem) && m_Payload.Get(isFound)) m_Payload.Get(item);
+	return isFound;
+}
+
+UINT TraceReplayer::Inventory_GetCapacity() const
+{
+	m_Arguments.Clear();
+	UINT capacity{};
+	if (Replay(TraceRecord::Inventory_GetCapacity)) m_Payload.Get(capacity);
+	return capacity;
+}
+#pragma endregion
+
+#pragma region Items
+bool TraceReplayer::Item_GetInfo(EntityInfo entity, ItemInfo& item)
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(entity);
+	bool isFound{};
+	if (Replay(TraceRecord::Item_GetInfo) && m_Payload.Get(isFound)) m_Payload.Get(item);
+	return isFound;
+}
+
+bool TraceReplayer::Item_Grab(EntityInfo entity, ItemInfo& item)
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(entity);
+	bool isGrabbed{};
+	if (Replay(TraceRecord::Item_Grab) && m_Payload.Get(isGrabbed)) m_Payload.Get(item);
+	return isGrabbed;
+}
+
+bool TraceReplayer::Item_Destroy(EntityInfo entity)
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(entity);
+	bool isDestroyed{};
+	if (Replay(TraceRecord::Item_Destroy)) m_Payload.Get(isDestroyed);
+	return isDestroyed;
+}
+
+int TraceReplayer::Weapon_GetAmmo(ItemInfo& item)
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(item);
+	int ammo{};
+	if (Replay(TraceRecord::Weapon_GetAmmo)) m_Payload.Get(ammo);
+	return ammo;
+}
+
+int TraceReplayer::Medkit_GetHealth(ItemInfo& item)
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(item);
+	int health{};
+	if (Replay(TraceRecord::Medkit_GetHealth)) m_Payload.Get(health);
+	return health;
+}
+
+int TraceReplayer::Food_GetEnergy(ItemInfo& item)
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(item);
+	int energy{};
+	if (Replay(TraceRecord::Food_GetEnergy)) m_Payload.Get(energy);
+	return energy;
+}
+#pragma endregion
+
+bool TraceReplayer::PurgeZone_GetInfo(EntityInfo entity, PurgeZoneInfo& zone)
+{
+	m_Arguments.Clear();
+	m_Arguments.Put(entity);
+	bool isFound{};
+	if (Replay(TraceRecord::PurgeZone_GetInfo) && m_Payload.Get(isFound)) m_Payload.Get(zone);
+	return isFound;
+}
+
+void TraceReplayer::RequestShutdown() const
+{
+	m_Arguments.Clear();
+	Replay(TraceRecord::RequestShutdown);
+}
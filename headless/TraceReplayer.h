@@ -0,0 +1,85 @@
+#pragma once
+#include "IExamInterface.h"
+#include "Trace.h"
+
+//Plays a trace written by TraceRecorder back to a fresh plugin, instead of a framework or a simulation.
+//Every call the plugin makes is matched against the next record: the same call with the same arguments gets
+//the recorded answer, anything else is a divergence. So is an UpdateSteering that returns something else than it did.
+//After a divergence every call gets a default answer, the caller stops at the end of that frame.
+class TraceReplayer final : public IExamInterface
+{
+public:
+	TraceReplayer() = default;
+	~TraceReplayer() = default;
+	TraceReplayer(const TraceReplayer&) = delete;
+	TraceReplayer& operator=(const TraceReplayer&) = delete;
+	TraceReplayer(TraceReplayer&&) = delete;
+	TraceReplayer& operator=(TraceReplayer&&) = delete;
+
+	bool Open(const std::string& filePath);
+	const std::string& GetError() const { return m_Reader.GetError(); }
+	int GetSeed() const { return m_Reader.GetSeed(); } //To pass to InitGameDebugParams
+
+	//False at the end of the trace or once diverged
+	bool BeginFrame(float& dt);
+	void EndFrame(const SteeringPlugin_Output& steering);
+
+	bool HasDiverged() const { return !m_Divergence.empty(); }
+	const std::string& GetDivergence() const { return m_Divergence; }
+	int GetFrame() const { return m_Frame; } //-1 while initializing
+
+	WorldInfo World_GetInfo() const override;
+	StatisticsInfo World_GetStats() const override;
+	bool Fov_GetHouseByIndex(UINT index, HouseInfo& houseInfo) const override;
+	bool Fov_GetEntityByIndex(UINT index, EntityInfo& enemyInfo) const override;
+	AgentInfo Agent_GetInfo() const override;
+	bool Enemy_GetInfo(EntityInfo entity, EnemyInfo& enemy) override;
+	Elite::Vector2 NavMesh_GetClosestPathPoint(Elite::Vector2 goal) const override;
+
+	bool Inventory_AddItem(UINT slotId, ItemInfo item) override;
+	bool Inventory_UseItem(UINT slotId) override;
+	bool Inventory_RemoveItem(UINT slotId) override;
+	bool Inventory_GetItem(UINT slotId, ItemInfo& item) override;
+	UINT Inventory_GetCapacity() const override;
+
+	bool Item_GetInfo(EntityInfo entity, ItemInfo& item) override;
+	bool Item_Grab(EntityInfo entity, ItemInfo& item) override;
+	bool Item_Destroy(EntityInfo entity) override;
+	int Weapon_GetAmmo(ItemInfo& item) override;
+	int Medkit_GetHealth(ItemInfo& item) override;
+	int Food_GetEnergy(ItemInfo& item) override;
+
+	bool PurgeZone_GetInfo(EntityInfo entity, PurgeZoneInfo& zone) override;
+
+	//Not recorded, there is no one to give input
+	Elite::Vector2 Debug_ConvertScreenToWorld(Elite::Vector2 screenPos) const override { return screenPos; }
+	Elite::Vector2 Debug_ConvertWorldToScreen(Elite::Vector2 worldPos) const override { return worldPos; }
+	bool Input_IsKeyboardKeyDown(Elite::InputScancode key) const override { return false; }
+	bool Input_IsKeyboardKeyUp(Elite::InputScancode key) const override { return false; }
+	bool Input_IsMouseButtonDown(Elite::InputMouseButton button) const override { return false; }
+	bool Input_IsMouseButtonUp(Elite::InputMouseButton button) const override { return false; }
+	Elite::MouseData Input_GetMouseData(Elite::InputType type, Elite::InputMouseButton button = Elite::InputMouseButton(0)) const override { return {}; }
+
+	void RequestShutdown() const override;
+
+	void Draw_Polygon(const Elite::Vector2* points, int count, const Elite::Vector3& color, float depth) override {}
+	void Draw_SolidPolygon(const Elite::Vector2* points, int count, const Elite::Vector3& color, float depth, bool triangulate = false) override {}
+	void Draw_Circle(const Elite::Vector2& center, float radius, const Elite::Vector3& color, float depth) override {}
+	void Draw_SolidCircle(const Elite::Vector2& center, float32 radius, const Elite::Vector2& axis, const Elite::Vector3& color, float depth) override {}
+	void Draw_Segment(const Elite::Vector2& p1, const Elite::Vector2& p2, const Elite::Vector3& color, float depth) override {}
+	void Draw_Direction(const Elite::Vector2& p, Elite::Vector2 dir, float length, const Elite::Vector3& color, float depth = 0.9f) override {}
+	void Draw_Transform(const b2Transform& xf, float depth) override {}
+	void Draw_Point(const Elite::Vector2& p, float size, const Elite::Vector3& color, float depth) override {}
+	float NextDepthSlice() override { return 0.f; }
+
+private:
+	//Reads the next record, true when it is this call with the arguments in m_Arguments, its answer is left in m_Payload
+	bool Replay(TraceRecord record) const;
+	void Diverge(const std::string& divergence) const;
+
+	mutable TraceReader m_Reader{};
+	mutable TracePayload m_Arguments{};
+	mutable TracePayload m_Payload{};
+	mutable std::string m_Divergence{};
+	int m_Frame{ -1 };
+};
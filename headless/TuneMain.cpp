@@ -0,0 +1,215 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+#include "ParameterTuner.h"
+
+//Entry points of the plugin linked into this executable, defined in Plugin.h
+extern "C" IPluginBase* Register();
+extern "C" IPluginBase* RegisterWithParameters(const char* pParameters);
+
+namespace
+{
+	struct Options
+	{
+		ParameterTuner::Settings settings{ BatchRunner::Game{ 0, -1, -1, "", -1, 1.f / 60.f, 18000, {} }, { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 },
+			std::max<int>(1, int(std::thread::hardware_concurrency())) };
+		std::string pluginFile{};
+		std::string resultsFile{ "TuneResults.csv" };
+		std::string bestFile{ "TunedParameters.txt" };
+		int top{ 10 }; //Printed, the results file holds every candidate
+	};
+
+	//Mean, median, min, max and standard deviation of the seconds survived
+	struct Statistics
+	{
+		float values[5];
+		float deaths; //Percentage
+	};
+
+	void PrintUsage()
+	{
+		std::cout << "Usage: HeadlessTune [--plugin file] [--threads n] [--seeds first-last|a,b,..] [--race n] [--keep fraction]" << '\n'
+			<< "                    [--grid n] [--generations n] [--population n] [--seed n] [--top n] [--out file] [--best file]" << '\n'
+			<< "                    [--frames n] [--dt dt] [--enemies n] [--items n] [--difficulty n] [--level file]" << '\n';
+	}
+
+	bool ParseSeeds(const std::string& list, std::vector<int>& seeds)
+	{
+		seeds.clear();
+		std::istringstream values{ list };
+		std::string value{};
+		while (std::getline(values, value, ','))
+		{
+			//A range, the first character can't be a separator so negative numbers still work
+			const size_t dash{ value.find('-', 1) };
+			if (dash == std::string::npos)
+			{
+				seeds.push_back(atoi(value.c_str()));
+				continue;
+			}
+
+			const int first{ atoi(value.substr(0, dash).c_str()) };
+			const int last{ atoi(value.substr(dash + 1).c_str()) };
+			if (last < first) return false;
+			for (int i{ first }; i <= last; ++i) seeds.push_back(i);
+		}
+		return !seeds.empty();
+	}
+
+	bool ParseOptions(int argc, char* argv[], Options& options)
+	{
+		ParameterTuner::Settings& settings{ options.settings };
+		for (int i{ 1 }; i < argc; ++i)
+		{
+			const std::string option{ argv[i] };
+			if (i + 1 >= argc) return false;
+
+			const char* pValue{ argv[++i] };
+			bool isValid{ true };
+			if (option == "--plugin") options.pluginFile = pValue;
+			else if (option == "--threads") settings.threadCount = atoi(pValue);
+			else if (option == "--seeds") isValid = ParseSeeds(pValue, settings.seeds);
+			else if (option == "--race") settings.seedsPerRound = atoi(pValue);
+			else if (option == "--keep") settings.keepFraction = float(atof(pValue));
+			else if (option == "--grid") settings.gridLevels = atoi(pValue);
+			else if (option == "--generations") settings.generations = atoi(pValue);
+			else if (option == "--population") settings.population = atoi(pValue);
+			else if (option == "--seed") settings.randomSeed = uint64_t(atoll(pValue));
+			else if (option == "--top") options.top = atoi(pValue);
+			else if (option == "--out") options.resultsFile = pValue;
+			else if (option == "--best") options.bestFile = pValue;
+			else if (option == "--frames") settings.game.frames = atoi(pValue);
+			else if (option == "--dt") settings.game.dt = float(atof(pValue));
+			else if (option == "--enemies") settings.game.enemyCount = atoi(pValue);
+			else if (option == "--items") settings.game.itemCount = atoi(pValue);
+			else if (option == "--difficulty") settings.game.difficulty = atoi(pValue);
+			else if (option == "--level") settings.game.levelFile = pValue;
+			else return false;
+			if (!isValid) return false;
+		}
+		//Past 5 levels the grid alone is more games than anyone waits for
+		return settings.threadCount > 0 && settings.seedsPerRound > 0 && settings.keepFraction > 0.f && settings.keepFraction <= 1.f
+			&& settings.gridLevels >= 0 && settings.gridLevels <= 5 && settings.generations >= 0 && settings.population > 0
+			&& settings.game.frames > 0 && settings.game.dt > 0.f;
+	}
+
+	Statistics GetStatistics(const ParameterTuner::Candidate& candidate)
+	{
+		std::vector<float> survived{ candidate.survived };
+		std::sort(survived.begin(), survived.end());
+
+		const size_t count{ survived.size() };
+		float total{};
+		for (float time : survived) total += time;
+		const float mean{ total / count };
+		float variance{};
+		for (float time : survived) variance += (time - mean) * (time - mean);
+
+		Statistics statistics{};
+		statistics.values[0] = mean;
+		statistics.values[1] = count % 2 == 1 ? survived[count / 2] : (survived[count / 2 - 1] + survived[count / 2]) * 0.5f;
+		statistics.values[2] = survived.front();
+		statistics.values[3] = survived.back();
+		statistics.values[4] = count > 1 ? std::sqrt(variance / (count - 1)) : 0.f;
+		statistics.deaths = candidate.deaths * 100.f / count;
+		return statistics;
+	}
+
+	bool WriteResults(const std::string& filePath, const std::vector<const ParameterTuner::Candidate*>& ranking)
+	{
+		std::ofstream file{ filePath };
+		if (!file) return false;
+
+		file << "rank,origin,seeds,survived_mean,survived_median,survived_min,survived_max,survived_stddev,died_percent";
+		for (const AIParameters::Field& field : AIParameters::Fields) file << ',' << field.name;
+		file << '\n';
+		for (size_t i{}; i < ranking.size(); ++i)
+		{
+			const ParameterTuner::Candidate& candidate{ *ranking[i] };
+			const Statistics statistics{ GetStatistics(candidate) };
+			file << i + 1 << ',' << candidate.origin << ',' << candidate.survived.size();
+			for (float value : statistics.values) file << ',' << value;
+			file << ',' << statistics.deaths;
+			for (const AIParameters::Field& field : AIParameters::Fields) file << ',' << candidate.parameters.*field.pValue;
+			file << '\n';
+		}
+		return bool(file);
+	}
+
+	void PrintRanking(const ParameterTuner& tuner, const std::vector<const ParameterTuner::Candidate*>& ranking, int top)
+	{
+		std::cout << std::fixed << std::setprecision(1) << "Seconds survived, best first" << '\n'
+			<< std::setw(5) << "Rank" << "  " << std::left << std::setw(14) << "Origin" << std::right << std::setw(6) << "Seeds"
+			<< std::setw(8) << "Mean" << std::setw(8) << "Median" << std::setw(8) << "Min" << std::setw(8) << "Max"
+			<< std::setw(8) << "StdDev" << std::setw(8) << "Died%" << "  Parameters" << '\n';
+		for (int i{}; i < std::min<int>(top, int(ranking.size())); ++i)
+		{
+			const ParameterTuner::Candidate& candidate{ *ranking[i] };
+			const Statistics statistics{ GetStatistics(candidate) };
+			std::cout << std::setw(5) << i + 1 << "  " << std::left << std::setw(14) << candidate.origin << std::right
+				<< std::setw(6) << (std::to_string(candidate.survived.size()) + (tuner.IsComplete(candidate) ? "" : "*"));
+			for (float value : statistics.values) std::cout << std::setw(8) << value;
+			std::cout << std::setw(8) << statistics.deaths;
+
+			//Each on one line, the way it is saved
+			std::string parameters{ candidate.parameters.ToString() };
+			std::replace(parameters.begin(), parameters.end(), '\n', ' ');
+			std::cout << "  " << parameters << '\n';
+		}
+		std::cout << "* stopped early" << '\n';
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	Options options{};
+	if (!ParseOptions(argc, argv, options))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	//The same seed has to play the same game for every candidate, and nothing may overrule the candidate's parameters
+#ifdef _WIN32
+	_putenv_s("GPP_DETERMINISTIC", "1");
+	_putenv_s("GPP_PARAMETERS", "");
+	_putenv_s("GPP_TRACE", "");
+#else
+	setenv("GPP_DETERMINISTIC", "1", 1);
+	unsetenv("GPP_PARAMETERS");
+	unsetenv("GPP_TRACE");
+#endif
+
+	const ParameterTuner::Settings& settings{ options.settings };
+	BatchRunner runner{ &Register, options.pluginFile, &RegisterWithParameters };
+	ParameterTuner tuner{ runner, settings };
+	std::cout << "Tuning on " << settings.seeds.size() << " seeds, " << settings.seedsPerRound << " per round, on "
+		<< settings.threadCount << " threads" << '\n';
+	if (!tuner.Run())
+	{
+		std::cout << '\n' << "Tuning failed: " << tuner.GetError() << '\n';
+		return 1;
+	}
+
+	const std::vector<const ParameterTuner::Candidate*> ranking{ tuner.GetRanking() };
+	const int fullGames{ tuner.GetCandidateCount() * int(settings.seeds.size()) };
+	std::cout << tuner.GetCandidateCount() << " candidates in " << tuner.GetGamesPlayed() << " games, "
+		<< fullGames - tuner.GetGamesPlayed() << " saved by stopping early" << '\n';
+	PrintRanking(tuner, ranking, options.top);
+
+	int exitCode{};
+	if (!WriteResults(options.resultsFile, ranking))
+	{
+		std::cout << "Results could not be written to " << options.resultsFile << '\n';
+		exitCode = 1;
+	}
+	if (!ranking.front()->parameters.Save(options.bestFile))
+	{
+		std::cout << "Best parameters could not be written to " << options.bestFile << '\n';
+		exitCode = 1;
+	}
+	return exitCode;
+}
@@ -0,0 +1,63 @@
+#include "stdafx.h"
+#include "AIParameters.h"
+
+const int AIParameters::FieldCount;
+const AIParameters::Field AIParameters::Fields[AIParameters::FieldCount]{
+	{ "EnemyMemoryTime", &AIParameters::EnemyMemoryTime, 0.5f, 10.f },
+	{ "RememberedEnemyFleeRange", &AIParameters::RememberedEnemyFleeRange, 5.f, 60.f },
+	{ "HouseMemoryTime", &AIParameters::HouseMemoryTime, 20.f, 300.f },
+	{ "WorldBoundsRange", &AIParameters::WorldBoundsRange, 5.f, 100.f },
+	{ "ShootAngle", &AIParameters::ShootAngle, 0.01f, 0.3f },
+	{ "HouseSearchTime", &AIParameters::HouseSearchTime, 0.5f, 20.f },
+	{ "ItemLeftMemoryTime", &AIParameters::ItemLeftMemoryTime, 5.f, 300.f },
+};
+
+bool AIParameters::Parse(const std::string& text, std::string& error)
+{
+	std::istringstream lines{ text };
+	std::string line{};
+	for (int lineNumber{ 1 }; std::getline(lines, line); ++lineNumber)
+	{
+		std::istringstream words{ line.substr(0, line.find('#')) };
+		std::string name{};
+		if (!(words >> name)) continue;
+
+		const Field* pField{ std::find_if(Fields, Fields + FieldCount, [&name](const Field& field) { return name == field.name; }) };
+		float value{};
+		if (pField == Fields + FieldCount || !(words >> value))
+		{
+			error = "Line " + std::to_string(lineNumber) + " isn't a parameter and a value: " + line;
+			return false;
+		}
+		this->*pField->pValue = value;
+	}
+	return true;
+}
+
+bool AIParameters::Load(const std::string& filePath, std::string& error)
+{
+	std::ifstream file{ filePath };
+	if (!file)
+	{
+		error = filePath + " could not be opened";
+		return false;
+	}
+
+	std::stringstream text{};
+	text << file.rdbuf();
+	return Parse(text.str(), error);
+}
+
+std::string AIParameters::ToString() const
+{
+	std::ostringstream text{};
+	for (const Field& field : Fields) text << field.name << ' ' << this->*field.pValue << '\n';
+	return text.str();
+}
+
+bool AIParameters::Save(const std::string& filePath) const
+{
+	std::ofstream file{ filePath };
+	file << ToString();
+	return bool(file);
+}
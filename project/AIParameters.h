@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+
+//The constants the AI's decisions hang on, in one place so they can be tuned (HeadlessTune) without rebuilding.
+//Written as one "name value" per line, '#' starts a comment and what isn't mentioned keeps its default.
+//The plugin loads AIParameters.txt from the working directory when it starts, GPP_PARAMETERS names another file.
+struct AIParameters
+{
+	float EnemyMemoryTime{ 2.5f }; //Seconds positions enemies were last seen at are remembered
+	float RememberedEnemyFleeRange{ 20.f }; //Remembered enemies further away than this are no worry anymore
+	float HouseMemoryTime{ 120.f }; //Seconds before a house that was searched is worth another look
+	float WorldBoundsRange{ 25.f }; //Closer than this to the edge of the world the agent heads back to the center
+	float ShootAngle{ 0.06f }; //Radians the aim may be off at the edge of the FOV, up to twice that up close
+	float HouseSearchTime{ 5.f }; //Seconds in a house before it counts as searched
+	float ItemLeftMemoryTime{ 60.f }; //Seconds an item the agent left on the ground is ignored
+
+	//What a tuner may change, every parameter with the range that still makes sense
+	struct Field
+	{
+		const char* name;
+		float AIParameters::* pValue;
+		float min;
+		float max;
+	};
+	static const int FieldCount{ 7 };
+	static const Field Fields[FieldCount];
+
+	//False on a name that isn't a parameter or a value that isn't a number, error says which line
+	bool Parse(const std::string& text, std::string& error);
+	bool Load(const std::string& filePath, std::string& error);
+	std::string ToString() const;
+	bool Save(const std::string& filePath) const;
+};
@@ -0,0 +1,285 @@
+#include "stdafx.h"
+#include "BatchSteering.h"
+#if BATCH_STEERING_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if BATCH_STEERING_AVX2 && defined(__GNUC__)
+#define BATCH_STEERING_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define BATCH_STEERING_AVX2_TARGET
+#endif
+
+namespace
+{
+	const float g_Epsilon{ FLT_EPSILON }; //Vector2::Normalize treats anything this short as zero
+
+	//Normalized like Vector2::Normalize, then scaled to the speed
+	void SeekOne(float directionX, float directionY, float speed, float& velocityX, float& velocityY)
+	{
+		const float magnitude{ sqrtf(directionX * directionX + directionY * directionY) };
+		if (magnitude > g_Epsilon)
+		{
+			const float inverse{ 1.f / magnitude };
+			directionX *= inverse;
+			directionY *= inverse;
+		}
+		else
+		{
+			directionX = 0.f;
+			directionY = 0.f;
+		}
+		velocityX = directionX * speed;
+		velocityY = directionY * speed;
+	}
+
+#if BATCH_STEERING_AVX2
+	struct Lanes
+	{
+		__m256 positionX, positionY, maxSpeed, targetX, targetY;
+	};
+
+	BATCH_STEERING_AVX2_TARGET inline Lanes Load(size_t i, const BatchSteering::Agents& agents, const BatchSteering::Targets& targets)
+	{
+		return Lanes{ _mm256_loadu_ps(agents.pPositionX + i), _mm256_loadu_ps(agents.pPositionY + i), _mm256_loadu_ps(agents.pMaxSpeed + i),
+			_mm256_loadu_ps(targets.pPositionX + i), _mm256_loadu_ps(targets.pPositionY + i) };
+	}
+
+	BATCH_STEERING_AVX2_TARGET inline void Store(size_t i, const BatchSteering::Output& output, const __m256& velocityX, const __m256& velocityY)
+	{
+		_mm256_storeu_ps(output.pVelocityX + i, velocityX);
+		_mm256_storeu_ps(output.pVelocityY + i, velocityY);
+	}
+
+	BATCH_STEERING_AVX2_TARGET inline __m256 Magnitude(const __m256& x, const __m256& y)
+	{
+		return _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)));
+	}
+
+	//Zero where the vector is too short, like Vector2::Normalize
+	BATCH_STEERING_AVX2_TARGET inline void Normalize(__m256& x, __m256& y)
+	{
+		const __m256 magnitude{ Magnitude(x, y) };
+		const __m256 isLongEnough{ _mm256_cmp_ps(magnitude, _mm256_set1_ps(g_Epsilon), _CMP_GT_OQ) };
+		const __m256 inverse{ _mm256_div_ps(_mm256_set1_ps(1.f), magnitude) };
+		x = _mm256_and_ps(_mm256_mul_ps(x, inverse), isLongEnough);
+		y = _mm256_and_ps(_mm256_mul_ps(y, inverse), isLongEnough);
+	}
+
+	BATCH_STEERING_AVX2_TARGET inline void SeekLanes(__m256 directionX, __m256 directionY, const __m256& speed, __m256& velocityX, __m256& velocityY)
+	{
+		Normalize(directionX, directionY);
+		velocityX = _mm256_mul_ps(directionX, speed);
+		velocityY = _mm256_mul_ps(directionY, speed);
+	}
+
+	BATCH_STEERING_AVX2_TARGET size_t SeekAvx2(size_t count, const BatchSteering::Agents& agents, const BatchSteering::Targets& targets, const BatchSteering::Output& output, bool isFleeing)
+	{
+		const __m256 sign{ _mm256_set1_ps(isFleeing ? -1.f : 1.f) };
+		size_t i{};
+		for (; i + 8 <= count; i += 8)
+		{
+			const Lanes lanes{ Load(i, agents, targets) };
+			__m256 velocityX, velocityY;
+			SeekLanes(_mm256_sub_ps(lanes.targetX, lanes.positionX), _mm256_sub_ps(lanes.targetY, lanes.positionY), lanes.maxSpeed, velocityX, velocityY);
+			if (isFleeing)
+			{
+				velocityX = _mm256_mul_ps(velocityX, sign);
+				velocityY = _mm256_mul_ps(velocityY, sign);
+			}
+			Store(i, output, velocityX, velocityY);
+		}
+		return i;
+	}
+
+	BATCH_STEERING_AVX2_TARGET size_t ArriveAvx2(size_t count, const BatchSteering::Agents& agents, const BatchSteering::Targets& targets, const BatchSteering::Output& output, float arrivalRadius, float slowRadius)
+	{
+		const __m256 arrival{ _mm256_set1_ps(arrivalRadius) }, slow{ _mm256_set1_ps(slowRadius) };
+		size_t i{};
+		for (; i + 8 <= count; i += 8)
+		{
+			const Lanes lanes{ Load(i, agents, targets) };
+			const __m256 directionX{ _mm256_sub_ps(lanes.targetX, lanes.positionX) }, directionY{ _mm256_sub_ps(lanes.targetY, lanes.positionY) };
+			const __m256 distance{ Magnitude(directionX, directionY) };
+			const __m256 isSlowing{ _mm256_cmp_ps(distance, slow, _CMP_LT_OQ) };
+			const __m256 speed{ _mm256_blendv_ps(lanes.maxSpeed, _mm256_mul_ps(lanes.maxSpeed, _mm256_div_ps(distance, slow)), isSlowing) };
+			__m256 velocityX, velocityY;
+			SeekLanes(directionX, directionY, speed, velocityX, velocityY);
+
+			const __m256 hasArrived{ _mm256_cmp_ps(distance, arrival, _CMP_LT_OQ) };
+			Store(i, output, _mm256_andnot_ps(hasArrived, velocityX), _mm256_andnot_ps(hasArrived, velocityY));
+		}
+		return i;
+	}
+
+	BATCH_STEERING_AVX2_TARGET size_t PursuitAvx2(size_t count, const BatchSteering::Agents& agents, const BatchSteering::Targets& targets, const BatchSteering::Output& output)
+	{
+		size_t i{};
+		for (; i + 8 <= count; i += 8)
+		{
+			const Lanes lanes{ Load(i, agents, targets) };
+			const __m256 predictedX{ _mm256_add_ps(lanes.targetX, _mm256_loadu_ps(targets.pVelocityX + i)) };
+			const __m256 predictedY{ _mm256_add_ps(lanes.targetY, _mm256_loadu_ps(targets.pVelocityY + i)) };
+			__m256 velocityX, velocityY;
+			SeekLanes(_mm256_sub_ps(predictedX, lanes.positionX), _mm256_sub_ps(predictedY, lanes.positionY), lanes.maxSpeed, velocityX, velocityY);
+			Store(i, output, velocityX, velocityY);
+		}
+		return i;
+	}
+
+	BATCH_STEERING_AVX2_TARGET size_t EvadeAvx2(size_t count, const BatchSteering::Agents& agents, const BatchSteering::Targets& targets, const BatchSteering::Output& output, float evadeRadius)
+	{
+		const __m256 radius{ _mm256_set1_ps(evadeRadius) }, half{ _mm256_set1_ps(0.5f) }, sign{ _mm256_set1_ps(-1.f) };
+		size_t i{};
+		for (; i + 8 <= count; i += 8)
+		{
+			const Lanes lanes{ Load(i, agents, targets) };
+			const __m256 distance{ Magnitude(_mm256_sub_ps(lanes.targetX, lanes.positionX), _mm256_sub_ps(lanes.targetY, lanes.positionY)) };
+			__m256 targetVelocityX{ _mm256_loadu_ps(targets.pVelocityX + i) }, targetVelocityY{ _mm256_loadu_ps(targets.pVelocityY + i) };
+			Normalize(targetVelocityX, targetVelocityY);
+			const __m256 predictedX{ _mm256_add_ps(lanes.targetX, _mm256_mul_ps(_mm256_mul_ps(targetVelocityX, distance), half)) };
+			const __m256 predictedY{ _mm256_add_ps(lanes.targetY, _mm256_mul_ps(_mm256_mul_ps(targetVelocityY, distance), half)) };
+			__m256 velocityX, velocityY;
+			SeekLanes(_mm256_sub_ps(predictedX, lanes.positionX), _mm256_sub_ps(predictedY, lanes.positionY), lanes.maxSpeed, velocityX, velocityY);
+
+			const __m256 isOutOfRange{ _mm256_cmp_ps(distance, radius, _CMP_GT_OQ) };
+			Store(i, output, _mm256_andnot_ps(isOutOfRange, _mm256_mul_ps(velocityX, sign)), _mm256_andnot_ps(isOutOfRange, _mm256_mul_ps(velocityY, sign)));
+		}
+		return i;
+	}
+#endif
+}
+
+BatchSteering::BatchSteering()
+	: m_UseAvx2{ IsAvx2Supported() }
+{
+}
+
+bool BatchSteering::IsAvx2Supported()
+{
+#if BATCH_STEERING_AVX2 && defined(_MSC_VER)
+	int info[4]{};
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+
+	//The OS has to save the ymm registers too
+	__cpuid(info, 1);
+	const bool hasOsxsave{ (info[2] & (1 << 27)) != 0 }, hasAvx{ (info[2] & (1 << 28)) != 0 };
+	if (!hasOsxsave || !hasAvx || (_xgetbv(0) & 6) != 6) return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#elif BATCH_STEERING_AVX2
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") != 0;
+#else
+	return false;
+#endif
+}
+
+void BatchSteering::CalculateSeek(size_t count, const Agents& agents, const Targets& targets, const Output& output) const
+{
+	Calculate(Behavior::Seek, count, agents, targets, output);
+}
+
+void BatchSteering::CalculateFlee(size_t count, const Agents& agents, const Targets& targets, const Output& output) const
+{
+	Calculate(Behavior::Flee, count, agents, targets, output);
+}
+
+void BatchSteering::CalculateArrive(size_t count, const Agents& agents, const Targets& targets, const Output& output) const
+{
+	Calculate(Behavior::Arrive, count, agents, targets, output);
+}
+
+void BatchSteering::CalculatePursuit(size_t count, const Agents& agents, const Targets& targets, const Output& output) const
+{
+	Calculate(Behavior::Pursuit, count, agents, targets, output);
+}
+
+void BatchSteering::CalculateEvade(size_t count, const Agents& agents, const Targets& targets, const Output& output) const
+{
+	Calculate(Behavior::Evade, count, agents, targets, output);
+}
+
+void BatchSteering::Calculate(Behavior behavior, size_t count, const Agents& agents, const Targets& targets, const Output& output) const
+{
+	//The scalar loop does whatever is left after the eight wide one
+	size_t i{ m_UseAvx2 ? CalculateAvx2(behavior, count, agents, targets, output) : 0 };
+	for (; i < count; ++i)
+	{
+		const float positionX{ agents.pPositionX[i] }, positionY{ agents.pPositionY[i] }, maxSpeed{ agents.pMaxSpeed[i] };
+		const float targetX{ targets.pPositionX[i] }, targetY{ targets.pPositionY[i] };
+		float& velocityX{ output.pVelocityX[i] };
+		float& velocityY{ output.pVelocityY[i] };
+		switch (behavior)
+		{
+		case Behavior::Seek:
+			SeekOne(targetX - positionX, targetY - positionY, maxSpeed, velocityX, velocityY);
+			break;
+		case Behavior::Flee:
+			SeekOne(targetX - positionX, targetY - positionY, maxSpeed, velocityX, velocityY);
+			velocityX *= -1.f;
+			velocityY *= -1.f;
+			break;
+		case Behavior::Arrive:
+		{
+			const float directionX{ targetX - positionX }, directionY{ targetY - positionY };
+			const float distance{ sqrtf(directionX * directionX + directionY * directionY) };
+			if (distance < m_ArrivalRadius)
+			{
+				velocityX = 0.f;
+				velocityY = 0.f;
+				break;
+			}
+			const float speed{ distance < m_SlowRadius ? maxSpeed * (distance / m_SlowRadius) : maxSpeed };
+			SeekOne(directionX, directionY, speed, velocityX, velocityY);
+			break;
+		}
+		case Behavior::Pursuit:
+			SeekOne(targetX + targets.pVelocityX[i] - positionX, targetY + targets.pVelocityY[i] - positionY, maxSpeed, velocityX, velocityY);
+			break;
+		case Behavior::Evade:
+		{
+			const float directionX{ targetX - positionX }, directionY{ targetY - positionY };
+			const float distance{ sqrtf(directionX * directionX + directionY * directionY) };
+			if (distance > m_EvadeRadius)
+			{
+				velocityX = 0.f;
+				velocityY = 0.f;
+				break;
+			}
+			float targetVelocityX{}, targetVelocityY{};
+			SeekOne(targets.pVelocityX[i], targets.pVelocityY[i], 1.f, targetVelocityX, targetVelocityY);
+			const float predictedX{ targetX + targetVelocityX * distance * 0.5f }, predictedY{ targetY + targetVelocityY * distance * 0.5f };
+			SeekOne(predictedX - positionX, predictedY - positionY, maxSpeed, velocityX, velocityY);
+			velocityX *= -1.f;
+			velocityY *= -1.f;
+			break;
+		}
+		}
+	}
+}
+
+size_t BatchSteering::CalculateAvx2(Behavior behavior, size_t count, const Agents& agents, const Targets& targets, const Output& output) const
+{
+#if BATCH_STEERING_AVX2
+	switch (behavior)
+	{
+	case Behavior::Seek:
+		return SeekAvx2(count, agents, targets, output, false);
+	case Behavior::Flee:
+		return SeekAvx2(count, agents, targets, output, true);
+	case Behavior::Arrive:
+		return ArriveAvx2(count, agents, targets, output, m_ArrivalRadius, m_SlowRadius);
+	case Behavior::Pursuit:
+		return PursuitAvx2(count, agents, targets, output);
+	case Behavior::Evade:
+		return EvadeAvx2(count, agents, targets, output, m_EvadeRadius);
+	}
+#endif
+	return 0;
+}
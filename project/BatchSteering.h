@@ -0,0 +1,78 @@
+#pragma once
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define BATCH_STEERING_AVX2 1
+#else
+#define BATCH_STEERING_AVX2 0
+#endif
+
+//Seek, flee, arrive, pursuit and evade for many agents at once, for offline evaluation and squad experiments.
+//Agents and targets come in as structure-of-arrays spans, the linear velocities go out the same way (auto orient
+//is always on for these behaviours). Eight agents at a time with AVX2 when the CPU has it (checked once with cpuid),
+//one at a time otherwise and for the tail. Both paths do the same float operations in the same order as the
+//behaviours in SteeringBehaviors.cpp, so the results are bit for bit the same as running those per agent.
+class BatchSteering final
+{
+public:
+	struct Agents
+	{
+		const float* pPositionX{};
+		const float* pPositionY{};
+		const float* pMaxSpeed{};
+	};
+
+	struct Targets
+	{
+		const float* pPositionX{};
+		const float* pPositionY{};
+		const float* pVelocityX{}; //Only used by pursuit and evade
+		const float* pVelocityY{};
+	};
+
+	struct Output
+	{
+		float* pVelocityX{};
+		float* pVelocityY{};
+	};
+
+	BatchSteering();
+	~BatchSteering() = default;
+	BatchSteering(const BatchSteering&) = delete;
+	BatchSteering& operator=(const BatchSteering&) = delete;
+	BatchSteering(BatchSteering&&) = delete;
+	BatchSteering& operator=(BatchSteering&&) = delete;
+
+	static bool IsAvx2Supported();
+	void SetUseAvx2(bool useAvx2) { m_UseAvx2 = useAvx2 && IsAvx2Supported(); } //To compare against the scalar path
+	bool IsUsingAvx2() const { return m_UseAvx2; }
+
+	//Same defaults as Arrive and Evade
+	void SetArrivalRadius(float radius) { m_ArrivalRadius = radius; }
+	void SetSlowRadius(float radius) { m_SlowRadius = radius; }
+	void SetEvadeRadius(float radius) { m_EvadeRadius = radius; }
+
+	void CalculateSeek(size_t count, const Agents& agents, const Targets& targets, const Output& output) const;
+	void CalculateFlee(size_t count, const Agents& agents, const Targets& targets, const Output& output) const;
+	void CalculateArrive(size_t count, const Agents& agents, const Targets& targets, const Output& output) const;
+	void CalculatePursuit(size_t count, const Agents& agents, const Targets& targets, const Output& output) const;
+	void CalculateEvade(size_t count, const Agents& agents, const Targets& targets, const Output& output) const;
+
+private:
+	enum class Behavior
+	{
+		Seek,
+		Flee,
+		Arrive,
+		Pursuit,
+		Evade
+	};
+
+	void Calculate(Behavior behavior, size_t count, const Agents& agents, const Targets& targets, const Output& output) const;
+	//Returns how many agents it did, a multiple of eight
+	size_t CalculateAvx2(Behavior behavior, size_t count, const Agents& agents, const Targets& targets, const Output& output) const;
+
+	bool m_UseAvx2{};
+	float m_ArrivalRadius{ 1.f };
+	float m_SlowRadius{ 20.f };
+	float m_EvadeRadius{ 20.f };
+};
@@ -12,6 +12,7 @@
 #include "stdafx.h"
 #include "EBehaviorTree.h"
 #include "SteeringBehaviors.h"
+#include "AIParameters.h"
 //-----------------------------------------------------------------
 // Helper functions
 //-----------------------------------------------------------------
@@ -81,34 +82,10 @@ bool AgentIsHoldingItem(Elite::Blackboard* pBlackboard, eItemType itemType, bool
 //Returns index to duplicate
 int AgentIsHoldingDuplicate(Elite::Blackboard* pBlackboard)
 {
-	IExamInterface* pInterface = nullptr;
-	pBlackboard->GetData("Interface", pInterface);
-
-	UINT capacity{ pInterface->Inventory_GetCapacity() };
-	int amountOfFood{}, amountOfMedkits{}, amountOfPistols{};
-	for (UINT i = 0; i < capacity; i++)
-	{
-		ItemInfo item{};
-		if (!pInterface->Inventory_GetItem(i, item)) continue;
-
-		switch (item.Type)
-		{
-		case eItemType::FOOD:
-			amountOfFood++;
-			if (amountOfFood > 1) return i;
-			break;
-		case eItemType::MEDKIT:
-			amountOfMedkits++;
-			if (amountOfMedkits > 1) return i;
-			break;
-		case eItemType::PISTOL:
-			amountOfPistols++;
-			if (amountOfPistols > 1) return i;
-			break;
-		}
-	}
+	Inventory* pInventory = nullptr;
+	pBlackboard->GetData("Inventory", pInventory);
 
-	return -1;
+	return pInventory->GetDuplicateSlot();
 }
 
 void AddHouseToEnteredHouses(Elite::Blackboard* pBlackboard, const HouseInfo& house)
@@ -117,6 +94,26 @@ void AddHouseToEnteredHouses(Elite::Blackboard* pBlackboard, const HouseInfo& ho
 	std::vector<LastSeen>* pHousesEntered = nullptr;
 	pBlackboard->GetData("EnteredHouses", pHousesEntered);
 
+	HouseRouteOptimizer* pHouseRoute = nullptr;
+	pBlackboard->GetData("HouseRoute", pHouseRoute);
+	if (pHouseRoute != nullptr)
+	{
+		//Houses that had loot tend to get it again: expect the most items seen inside during this visit
+		int lootSeen{};
+		std::vector<EntityInfo> entities{};
+		pBlackboard->GetData("HouseLootSeen", lootSeen);
+		pBlackboard->GetData("Entities", entities);
+		const Elite::Vector2 halfSize{ house.Size * 0.5f };
+		const int itemsInHouse{ int(std::count_if(entities.begin(), entities.end(), [&house, &halfSize](const EntityInfo& entity) {
+			return entity.Type == eEntityType::ITEM && abs(entity.Location.x - house.Center.x) <= halfSize.x && abs(entity.Location.y - house.Center.y) <= halfSize.y;
+		})) };
+		lootSeen = std::max<int>(lootSeen, itemsInHouse);
+		pBlackboard->ChangeData("HouseLootSeen", lootSeen);
+
+		pHouseRoute->MarkVisited(house.Center);
+		pHouseRoute->SetLootExpectation(house.Center, 0.5f + lootSeen);
+	}
+
 	if (pHousesEntered->size() == 0)
 	{
 		pHousesEntered->push_back({ house.Center });
@@ -161,6 +158,174 @@ void AddEnemySeenLocation(Elite::Blackboard* pBlackboard, const EnemyInfo& enemy
 	foundIt->timeElapsed = 0.f;
 }
 
+//Sets nextPoint to the point to seek towards on the planned path to goal.
+//While the planner is still working on it nextPoint is the goal itself, the agent heads straight for it in the meantime.
+//Never Running: the root sequence would stop there and skip shooting, healing and the rest until the plan is in.
+void FollowPlannedPath(Elite::Blackboard* pBlackboard, const AgentInfo& agent, const Elite::Vector2& goal, Elite::Vector2& nextPoint)
+{
+	nextPoint = goal;
+
+	PathPlanner* pPathPlanner = nullptr;
+	PlannedPath* pPlannedPath = nullptr;
+	pBlackboard->GetData("PathPlanner", pPathPlanner);
+	pBlackboard->GetData("PlannedPath", pPlannedPath);
+	if (pPathPlanner == nullptr || pPlannedPath == nullptr) return;
+
+	const float sameGoalMargin{ pPathPlanner->GetCellSize() };
+	if (!pPlannedPath->Plan.IsValid() || pPlannedPath->Version != pPathPlanner->GetVersion() ||
+		Elite::DistanceSquared(pPlannedPath->Goal, goal) > sameGoalMargin * sameGoalMargin)
+	{
+		//The old plan is stale, don't let the planner waste time on it
+		pPlannedPath->Plan.Cancel();
+		pPlannedPath->Plan = pPathPlanner->RequestPath(agent.Position, goal);
+		pPlannedPath->Goal = goal;
+		pPlannedPath->Version = pPathPlanner->GetVersion();
+		pPlannedPath->Points.clear();
+		pPlannedPath->CurrentPoint = 0;
+	}
+
+	switch (pPlannedPath->Plan.GetState())
+	{
+	case PathPlanner::PlanState::Pending:
+		return;
+	case PathPlanner::PlanState::Ready:
+		if (pPlannedPath->Points.empty())
+		{
+			const std::vector<Elite::Vector2>& path{ pPlannedPath->Plan.GetPath() };
+			pPlannedPath->Points.assign(path.begin(), path.end());
+
+			//Grid paths zig-zag, cut them short once when they come in
+			PathSmoother* pPathSmoother = nullptr;
+			pBlackboard->GetData("PathSmoother", pPathSmoother);
+			if (pPathSmoother != nullptr) pPathSmoother->Smooth(agent.Position, pPlannedPath->Points);
+		}
+		break;
+	default:
+		//No path (goal behind walls without a known door), the navmesh handles it
+		return;
+	}
+	if (pPlannedPath->Points.empty()) return;
+
+	//Skip the points the agent already reached
+	const float closeEnoughRange{ 2 * pPathPlanner->GetCellSize() };
+	while (pPlannedPath->CurrentPoint + 1 < pPlannedPath->Points.size() &&
+		Elite::DistanceSquared(agent.Position, pPlannedPath->Points[pPlannedPath->CurrentPoint]) <= closeEnoughRange * closeEnoughRange)
+	{
+		++pPlannedPath->CurrentPoint;
+	}
+
+	nextPoint = pPlannedPath->Points[pPlannedPath->CurrentPoint];
+}
+
+float GetWeight(const AgentInfo& agentInfo, const LastSeen& enemyLastSeen, float memoryFleeRange, float memoryTime)
+{
+	float distance{ Elite::Distance(enemyLastSeen.SeenLocation, agentInfo.Position) };
+	float distanceWeight{ 1 - distance / memoryFleeRange };
+	float timeWeight{ 1 - enemyLastSeen.timeElapsed / memoryTime };
+
+	return distanceWeight * timeWeight;
+}
+
+//Dangers around the agent for context steering: enemies in view, remembered enemies, purge zones in view and the nearest wall
+void AddContextDangers(Elite::Blackboard* pBlackboard, const AgentInfo& agent, ContextSteering* pContext)
+{
+	std::vector<EntityInfo> entities{};
+	IExamInterface* pInterface = nullptr;
+	pBlackboard->GetData("Entities", entities);
+	pBlackboard->GetData("Interface", pInterface);
+	for (const EntityInfo& entity : entities)
+	{
+		if (entity.Type == eEntityType::ENEMY)
+		{
+			EnemyInfo enemy{};
+			pInterface->Enemy_GetInfo(entity, enemy);
+			const float weight{ 1 - Elite::Distance(enemy.Location, agent.Position) / agent.FOV_Range };
+			if (weight > 0.f) pContext->AddDanger(enemy.Location, enemy.Size + agent.AgentSize * 0.5f, weight);
+		}
+		else if (entity.Type == eEntityType::PURGEZONE)
+		{
+			PurgeZoneInfo purgeZone{};
+			pInterface->PurgeZone_GetInfo(entity, purgeZone);
+			pContext->AddDanger(purgeZone.Center, purgeZone.Radius);
+		}
+	}
+
+	std::vector<LastSeen>* pEnemiesLastSeen = nullptr;
+	const AIParameters* pParameters = nullptr;
+	pBlackboard->GetData("EnemiesLastSeen", pEnemiesLastSeen);
+	pBlackboard->GetData("Parameters", pParameters);
+	if (pEnemiesLastSeen != nullptr && pParameters != nullptr)
+	{
+		for (const LastSeen& enemyLastSeen : *pEnemiesLastSeen)
+		{
+			const float weight{ GetWeight(agent, enemyLastSeen, pParameters->RememberedEnemyFleeRange, pParameters->EnemyMemoryTime) };
+			if (weight > 0.f) pContext->AddDanger(enemyLastSeen.PredictedLocation, agent.AgentSize, weight);
+		}
+	}
+
+	LevelFields* pLevelFields = nullptr;
+	pBlackboard->GetData("LevelFields", pLevelFields);
+	const float wallRange{ 3.f };
+	if (pLevelFields != nullptr && pLevelFields->IsLoaded())
+	{
+		const float wallDistance{ pLevelFields->GetDistance(agent.Position) };
+		if (wallDistance < wallRange)
+			pContext->AddDanger(agent.Position - pLevelFields->GetDistanceGradient(agent.Position) * wallDistance, 1.f, 1 - wallDistance / wallRange);
+	}
+}
+
+//Sets a flee target in the safest direction, preferring the flee field's way out.
+//The target goes on the threat side of the agent since fleeing steers away from it.
+bool SetContextFleeTarget(Elite::Blackboard* pBlackboard, const AgentInfo& agent)
+{
+	ContextSteering* pContext = nullptr;
+	pBlackboard->GetData("ContextSteering", pContext);
+	if (pContext == nullptr) return false;
+
+	pContext->Clear();
+	AddContextDangers(pBlackboard, agent, pContext);
+
+	FleeField* pFleeField = nullptr;
+	LevelIndex* pLevelIndex = nullptr;
+	pBlackboard->GetData("FleeField", pFleeField);
+	pBlackboard->GetData("LevelIndex", pLevelIndex);
+	Elite::Vector2 escapeDirection{};
+	if (pFleeField != nullptr && pFleeField->GetEscapeDirection(agent.Position, escapeDirection, pLevelIndex))
+		pContext->AddInterest(agent.Position + escapeDirection);
+
+	Elite::Vector2 direction{};
+	float speed{};
+	if (!pContext->Resolve(agent.Position, direction, speed)) return false;
+
+	const float fleeDistance{ 5.f };
+	TargetData target{};
+	target.Position = agent.Position - direction * fleeDistance;
+	pBlackboard->ChangeData("Target", target);
+	pBlackboard->ChangeData("IntermediateTarget", target);
+	return true;
+}
+
+//Sets a seek target towards goal that bends around the dangers
+bool SetContextSeekTarget(Elite::Blackboard* pBlackboard, const AgentInfo& agent, const Elite::Vector2& goal)
+{
+	ContextSteering* pContext = nullptr;
+	pBlackboard->GetData("ContextSteering", pContext);
+	if (pContext == nullptr) return false;
+
+	pContext->Clear();
+	AddContextDangers(pBlackboard, agent, pContext);
+	pContext->AddInterest(goal);
+
+	Elite::Vector2 direction{};
+	float speed{};
+	if (!pContext->Resolve(agent.Position, direction, speed)) return false;
+
+	TargetData target{};
+	target.Position = agent.Position + direction * Elite::Distance(agent.Position, goal);
+	pBlackboard->ChangeData("Target", target);
+	return true;
+}
+
 //-----------------------------------------------------------------
 //Agent Conditionals
 //-----------------------------------------------------------------
@@ -285,14 +450,17 @@ bool agentInPurgeZone(Elite::Blackboard* pBlackboard)
 		{
 			agentInPurgeZone = true;
 			target.Position = purgeZone.Center;
-
-			pBlackboard->ChangeData("Target", target);
-			pBlackboard->ChangeData("IntermediateTarget", target);
-			pBlackboard->ChangeData("SteeringCooldownRemaining", 0.f);
 		}
 	}
+	if (!agentInPurgeZone) return false;
 
-	return agentInPurgeZone;
+	if (!SetContextFleeTarget(pBlackboard, agent))
+	{
+		pBlackboard->ChangeData("Target", target);
+		pBlackboard->ChangeData("IntermediateTarget", target);
+	}
+	pBlackboard->ChangeData("SteeringCooldownRemaining", 0.f);
+	return true;
 }
 
 bool agentEnteredHouseNow(Elite::Blackboard* pBlackboard)
@@ -316,6 +484,13 @@ bool agentEnteredHouseNow(Elite::Blackboard* pBlackboard)
 		AgentInfo agent{};
 		pBlackboard->GetData("Agent", agent);
 		pBlackboard->ChangeData("HouseEnteredAt", agent.Position);
+		pBlackboard->ChangeData("HouseLootSeen", 0);
+		PathPlanner* pPathPlanner = nullptr;
+		pBlackboard->GetData("PathPlanner", pPathPlanner);
+		if (pPathPlanner != nullptr) pPathPlanner->AddDoorway(agent.Position);
+		PathSmoother* pPathSmoother = nullptr;
+		pBlackboard->GetData("PathSmoother", pPathSmoother);
+		if (pPathSmoother != nullptr) pPathSmoother->AddDoorway(agent.Position);
 		pBlackboard->ChangeData("LocationToCheckOut", TargetData{});
 		std::cout << "House entered" << '\n';
 		if (houses.size() > 0) AddHouseToEnteredHouses(pBlackboard, houses[0]);
@@ -331,14 +506,17 @@ bool agentIsReachingWorldBounds(Elite::Blackboard* pBlackboard)
 	pBlackboard->GetData("WorldInfo", worldInfo);
 	AgentInfo agent{};
 	pBlackboard->GetData("Agent", agent);
+	const AIParameters* pParameters = nullptr;
+	pBlackboard->GetData("Parameters", pParameters);
 
-	const float tooCloseRange{ 125.f };
+	const float tooCloseRange{ pParameters->WorldBoundsRange };
 	const float tooCloseSqrd{ tooCloseRange * tooCloseRange };
+	const Elite::Vector2 worldHalfSize{ worldInfo.Dimensions * 0.5f }; //Dimensions is the full size
 	if (
-		agent.Position.y > (worldInfo.Center.y + worldInfo.Dimensions.y - tooCloseRange) ||
-		agent.Position.y < (worldInfo.Center.y - worldInfo.Dimensions.y + tooCloseRange) ||
-		agent.Position.x > (worldInfo.Center.x + worldInfo.Dimensions.x - tooCloseRange) ||
-		agent.Position.x < (worldInfo.Center.x - worldInfo.Dimensions.x + tooCloseRange))
+		agent.Position.y > (worldInfo.Center.y + worldHalfSize.y - tooCloseRange) ||
+		agent.Position.y < (worldInfo.Center.y - worldHalfSize.y + tooCloseRange) ||
+		agent.Position.x > (worldInfo.Center.x + worldHalfSize.x - tooCloseRange) ||
+		agent.Position.x < (worldInfo.Center.x - worldHalfSize.x + tooCloseRange))
 	{
 		std::cout << "Agent is reaching world bounds" << '\n';
 		TargetData target{};
@@ -367,7 +545,9 @@ bool agentShouldShoot(Elite::Blackboard* pBlackboard)
 	std::vector<EnemyInfo> enemies{};
 	GetEnemiesInFOV(entities, enemies, pInterface);
 
-	const float closeEnoughAngle{ 0.06f };
+	const AIParameters* pParameters = nullptr;
+	pBlackboard->GetData("Parameters", pParameters);
+	const float closeEnoughAngle{ pParameters->ShootAngle };
 
 	for (const EnemyInfo& enemy : enemies)
 	{
@@ -388,8 +568,10 @@ bool agentBeenInHouseLongEnough(Elite::Blackboard* pBlackboard)
 {
 	float timeInHouse{};
 	pBlackboard->GetData("TimeInHouse", timeInHouse);
+	const AIParameters* pParameters = nullptr;
+	pBlackboard->GetData("Parameters", pParameters);
 
-	const float longEnough{ 5.f };
+	const float longEnough{ pParameters->HouseSearchTime };
 	return timeInHouse >= longEnough;
 }
 //-----------------------------------------------------------------
@@ -397,13 +579,10 @@ bool agentBeenInHouseLongEnough(Elite::Blackboard* pBlackboard)
 //-----------------------------------------------------------------
 bool SteeringIsFace(Elite::Blackboard* pBlackboard)
 {
-	ISteeringBehavior** pSteering = nullptr;
-	Face* pFace = nullptr;
-
-	pBlackboard->GetData("SteeringBehavior", pSteering);
-	pBlackboard->GetData("Face", pFace);
+	SteeringState steering{};
+	pBlackboard->GetData("Steering", steering);
 
-	return *pSteering == pFace;
+	return steering.Is(SteeringState::Kind::Face);
 }
 
 bool SteeringOnCooldown(Elite::Blackboard* pBlackboard)
@@ -442,6 +621,22 @@ bool isHouseInFOV(Elite::Blackboard* pBlackboard)
 		[&agentInfo](const HouseInfo& left, const HouseInfo& right){
 			return Elite::DistanceSquared(left.Center, agentInfo.Position) < Elite::DistanceSquared(right.Center, agentInfo.Position);
 		});
+
+	//Prefer the house that comes first on the route, the nearest one might be better left for later
+	HouseRouteOptimizer* pHouseRoute = nullptr;
+	pBlackboard->GetData("HouseRoute", pHouseRoute);
+	if (pHouseRoute != nullptr)
+	{
+		int bestRoutePosition{ INT_MAX };
+		for (auto houseIt = houses.begin(); houseIt != houses.end(); ++houseIt)
+		{
+			const int routePosition{ pHouseRoute->GetRoutePosition(houseIt->Center) };
+			if (routePosition == -1 || routePosition >= bestRoutePosition) continue;
+
+			bestRoutePosition = routePosition;
+			nearestHouse = houseIt;
+		}
+	}
 	target.Position = (*nearestHouse).Center;
 
 	pBlackboard->ChangeData("Target", target);
@@ -469,7 +664,7 @@ bool isEnemyInFOV(Elite::Blackboard* pBlackboard)
 
 	if (enemies.size() <= 0) return false;
 
-	TargetData target{};
+	//The closer an enemy, the more it weighs in the plain flee target
 	Elite::Vector2 direction{};
 	for (const EnemyInfo& enemy : enemies)
 	{
@@ -482,12 +677,15 @@ bool isEnemyInFOV(Elite::Blackboard* pBlackboard)
 
 		AddEnemySeenLocation(pBlackboard, enemy);
 	}
-	direction.Normalize();
-
-	target.Position = agent.Position + direction;
-	pBlackboard->ChangeData("Target", target);
-	pBlackboard->ChangeData("IntermediateTarget", target);
 
+	if (!SetContextFleeTarget(pBlackboard, agent))
+	{
+		direction.Normalize();
+		TargetData target{};
+		target.Position = agent.Position + direction;
+		pBlackboard->ChangeData("Target", target);
+		pBlackboard->ChangeData("IntermediateTarget", target);
+	}
 	return true;
 }
 
@@ -566,15 +764,6 @@ bool isPurgeZoneInFOV(Elite::Blackboard* pBlackboard)
 	return true;
 }
 
-float GetWeight(const AgentInfo& agentInfo, const LastSeen& enemyLastSeen, float memoryFleeRange, float memoryTime)
-{
-	float distance{ Elite::Distance(enemyLastSeen.SeenLocation, agentInfo.Position) };
-	float distanceWeight{ 1 - distance / memoryFleeRange };
-	float timeWeight{ 1 - enemyLastSeen.timeElapsed / memoryTime };
-
-	return distanceWeight * timeWeight;
-}
-
 bool remembersEnemies(Elite::Blackboard* pBlackboard)
 {
 	std::vector<LastSeen>* pEnemiesLastSeen = nullptr;
@@ -582,10 +771,10 @@ bool remembersEnemies(Elite::Blackboard* pBlackboard)
 	
 	if (pEnemiesLastSeen->size() <= 0) return false;
 	
-	float enemyMemoryTime{};
-	pBlackboard->GetData("EnemyMemoryTime", enemyMemoryTime);
-	float rememberedEnemyFleeRange{};
-	pBlackboard->GetData("RememberedEnemyFleeRange", rememberedEnemyFleeRange);
+	const AIParameters* pParameters = nullptr;
+	pBlackboard->GetData("Parameters", pParameters);
+	const float enemyMemoryTime{ pParameters->EnemyMemoryTime };
+	const float rememberedEnemyFleeRange{ pParameters->RememberedEnemyFleeRange };
 	AgentInfo agent{};
 	pBlackboard->GetData("Agent", agent);
 
@@ -658,20 +847,21 @@ BehaviorState StopRunning(Elite::Blackboard* pBlackboard)
 	return Success;
 }
 
-BehaviorState ChangeSteering(Elite::Blackboard* pBlackboard, ISteeringBehavior* pNewBehavior)
+BehaviorState ChangeSteering(Elite::Blackboard* pBlackboard, const SteeringState& newSteering)
 {
-	ISteeringBehavior** pSteering = nullptr;
+	SteeringState steering{};
 	float SteeringCooldownRemaining{};
-	pBlackboard->GetData("SteeringBehavior", pSteering);
 	pBlackboard->GetData("SteeringCooldownRemaining", SteeringCooldownRemaining);
 
-	if (pSteering == nullptr || pNewBehavior == nullptr || SteeringCooldownRemaining > 0.f) return Failure;
+	if (!pBlackboard->GetData("Steering", steering) || SteeringCooldownRemaining > 0.f) return Failure;
 
 	float SteeringCooldown{}, variableSteeringCooldown{};
 	pBlackboard->GetData("SteeringCooldown", SteeringCooldown);
 	pBlackboard->GetData("VariableSteeringCooldown", variableSteeringCooldown);
 
-	*pSteering = pNewBehavior;
+	//Keep the wandering so it carries on with the same random stream next time
+	if (steering.Is(SteeringState::Kind::Wander)) pBlackboard->ChangeData("Wander", steering.Get<Wander>());
+	pBlackboard->ChangeData("Steering", newSteering);
 	if (variableSteeringCooldown > 0.f)
 	{
 		pBlackboard->ChangeData("SteeringCooldownRemaining", variableSteeringCooldown);
@@ -683,102 +873,89 @@ BehaviorState ChangeSteering(Elite::Blackboard* pBlackboard, ISteeringBehavior*
 
 BehaviorState ChangeToSeek(Elite::Blackboard* pBlackboard)
 {
-	Seek* pSeek = nullptr;
-	pBlackboard->GetData("Seek", pSeek);
-
-	if (pSeek == nullptr) return Failure;
-
-	return ChangeSteering(pBlackboard, pSeek);
+	return ChangeSteering(pBlackboard, Seek{});
 }
 
 BehaviorState ChangeToWander(Elite::Blackboard* pBlackboard)
 {
-	ISteeringBehavior** pSteering = nullptr;
-	Wander* pWander = nullptr;
+	SteeringState steering{};
+	Wander wander{};
 	AgentInfo agent{};
-	pBlackboard->GetData("SteeringBehavior", pSteering);
-	pBlackboard->GetData("Wander", pWander);
 	pBlackboard->GetData("Agent", agent);
 
-	if (pSteering == nullptr || pWander == nullptr) return Failure;
+	if (!pBlackboard->GetData("Steering", steering) || !pBlackboard->GetData("Wander", wander)) return Failure;
 
-	if(*pSteering != pWander)
-		pWander->SetWanderAngle(agent.Orientation);
+	if (steering.Is(SteeringState::Kind::Wander))
+		return ChangeSteering(pBlackboard, steering);
 
-	return ChangeSteering(pBlackboard, pWander);
+	wander.SetWanderAngle(agent.Orientation);
+	return ChangeSteering(pBlackboard, wander);
 }
 
 BehaviorState ChangeToFlee(Elite::Blackboard* pBlackboard)
 {
-	Flee* pFlee = nullptr;
-	pBlackboard->GetData("Flee", pFlee);
-
-	if (pFlee == nullptr) return Failure;
-
-	return ChangeSteering(pBlackboard, pFlee);
+	return ChangeSteering(pBlackboard, Flee{});
 }
 
 BehaviorState ChangeToFace(Elite::Blackboard* pBlackboard)
 {
-	Face* pFace = nullptr;
-	pBlackboard->GetData("Face", pFace);
-
-	if (pFace == nullptr) return Failure;
-
-
-	return ChangeSteering(pBlackboard, pFace);
+	return ChangeSteering(pBlackboard, Face{});
 }
 
 BehaviorState UpdateTargetWithEnemyMemory(Elite::Blackboard* pBlackboard)
 {
-	ISteeringBehavior** pSteering = nullptr;
-	Seek* pSeek = nullptr;
-	Flee* pFlee = nullptr;
-	Wander* pWander = nullptr;
-	Face* pFace = nullptr;
+	SteeringState steering{};
 	TargetData intermediateTarget{};
 	Elite::Vector2 rememberedFleeLocation{};
 	float rememberedFleeLocationWeight{};
 
-	pBlackboard->GetData("SteeringBehavior", pSteering);
-	pBlackboard->GetData("Seek", pSeek);
-	pBlackboard->GetData("Flee", pFlee);
-	pBlackboard->GetData("Wander", pWander);
+	const bool hasSteering{ pBlackboard->GetData("Steering", steering) };
 	pBlackboard->GetData("IntermediateTarget", intermediateTarget);
 	pBlackboard->GetData("RememberFleeLocation", rememberedFleeLocation);
 	pBlackboard->GetData("RememberFleeLocationWeight", rememberedFleeLocationWeight);
 
-	if (pSteering == nullptr || pSeek == nullptr || pFlee == nullptr || pWander == nullptr || pFace == nullptr || *pSteering == pFace) return Failure;
+	if (!hasSteering || steering.Is(SteeringState::Kind::Face)) return Failure;
 
-	if (*pSteering == pFlee)
+	AgentInfo agent{};
+	pBlackboard->GetData("Agent", agent);
+	if (steering.Is(SteeringState::Kind::Flee))
 	{
-		Elite::Vector2 fleeTargetToRememberedFleeLocation{ rememberedFleeLocation - intermediateTarget.Position };
-		intermediateTarget.Position += rememberedFleeLocationWeight * fleeTargetToRememberedFleeLocation.Magnitude() * Elite::GetNormalized(fleeTargetToRememberedFleeLocation);
-		pBlackboard->ChangeData("Target", intermediateTarget);
+		if (!SetContextFleeTarget(pBlackboard, agent))
+		{
+			Elite::Vector2 fleeTargetToRememberedFleeLocation{ rememberedFleeLocation - intermediateTarget.Position };
+			intermediateTarget.Position += rememberedFleeLocationWeight * fleeTargetToRememberedFleeLocation.Magnitude() * Elite::GetNormalized(fleeTargetToRememberedFleeLocation);
+			pBlackboard->ChangeData("Target", intermediateTarget);
+		}
 		return Success;
 	}
-	if (*pSteering == pWander)
+	if (steering.Is(SteeringState::Kind::Wander))
 	{
-		TargetData Td{};
-		Td.Position = rememberedFleeLocation;
-		pBlackboard->ChangeData("Target", Td);
+		if (!SetContextFleeTarget(pBlackboard, agent))
+		{
+			TargetData Td{};
+			Td.Position = rememberedFleeLocation;
+			pBlackboard->ChangeData("Target", Td);
+		}
 		return ChangeToFlee(pBlackboard);
 	}
-	if (*pSteering == pSeek)
+	if (steering.Is(SteeringState::Kind::Seek))
 	{
-		AgentInfo agent{};
-		pBlackboard->GetData("Agent", agent);
-		Elite::Vector2 agentToSeekTarget{ intermediateTarget.Position - agent.Position };
-		Elite::Vector2 agentToRememberedFleeLocation{ rememberedFleeLocation - agent.Position };
-		bool isSeekingTowardsRememberedEnemies{ Elite::Dot(agentToSeekTarget, agentToRememberedFleeLocation) > 0 };
-
-		//If agent is not seeking towards remembered enemies, don't interfere
-		if (!isSeekingTowardsRememberedEnemies) return Success;
-
-		//Else agent is seeking towards enemies -> Update seek position
-		Elite::Vector2 rememberedFleeLocationToSeekTarget{ intermediateTarget.Position - rememberedFleeLocation };
-		intermediateTarget.Position += rememberedFleeLocationToSeekTarget;
-		pBlackboard->ChangeData("Target", intermediateTarget);
+		//Only a remembered enemy in a cone towards the waypoint bends the way there, the walls and zones the
+		//context map also holds would otherwise turn the agent around in every doorway
+		std::vector<LastSeen>* pEnemiesLastSeen = nullptr;
+		const AIParameters* pParameters = nullptr;
+		pBlackboard->GetData("EnemiesLastSeen", pEnemiesLastSeen);
+		pBlackboard->GetData("Parameters", pParameters);
+		if (pEnemiesLastSeen == nullptr || pParameters == nullptr) return Success;
+
+		const float coneCos{ cosf(Elite::ToRadians(30.f)) };
+		const Elite::Vector2 agentToWaypoint{ (intermediateTarget.Position - agent.Position).GetNormalized() };
+		const bool isEnemyInTheWay{ std::any_of(pEnemiesLastSeen->begin(), pEnemiesLastSeen->end(), [&agent, pParameters, &agentToWaypoint, coneCos](const LastSeen& enemyLastSeen)
+			{
+				if (GetWeight(agent, enemyLastSeen, pParameters->RememberedEnemyFleeRange, pParameters->EnemyMemoryTime) <= 0.f) return false;
+				return Elite::Dot((enemyLastSeen.PredictedLocation - agent.Position).GetNormalized(), agentToWaypoint) >= coneCos;
+			}) };
+		if (isEnemyInTheWay) SetContextSeekTarget(pBlackboard, agent, intermediateTarget.Position);
 		return Success;
 	}
 
@@ -789,12 +966,15 @@ BehaviorState UpdateTargetWithEnemyMemory(Elite::Blackboard* pBlackboard)
 BehaviorState ExitHouse(Elite::Blackboard* pBlackboard)
 {
 	Elite::Vector2 houseEnteredAt{};
+	AgentInfo agent{};
 	pBlackboard->GetData("HouseEnteredAt", houseEnteredAt);
+	pBlackboard->GetData("Agent", agent);
 
 	TargetData target{};
-	target.Position = houseEnteredAt;
+	FollowPlannedPath(pBlackboard, agent, houseEnteredAt, target.Position);
 	pBlackboard->ChangeData("Target", target);
 	pBlackboard->ChangeData("IntermediateTarget", target);
+
 	return ChangeToSeek(pBlackboard);
 }
 
@@ -856,6 +1036,46 @@ BehaviorState UpdateWorldPath(Elite::Blackboard* pBlackboard)
 
 	if (pPath == nullptr || pCurrentPathNode == nullptr) return Failure;
 
+	//Known houses that are due for a visit come first, in route order
+	HouseRouteOptimizer* pHouseRoute = nullptr;
+	Elite::Vector2 nextHouse{};
+	pBlackboard->GetData("HouseRoute", pHouseRoute);
+	if (pHouseRoute != nullptr && pHouseRoute->GetNextHouse(nextHouse))
+	{
+		TargetData target{};
+		FollowPlannedPath(pBlackboard, agent, nextHouse, target.Position);
+		pBlackboard->ChangeData("Target", target);
+		pBlackboard->ChangeData("IntermediateTarget", target);
+
+		return ChangeToSeek(pBlackboard);
+	}
+
+	//Head for the nearest unexplored area, keep the same frontier cell until it has been seen or reached
+	ExplorationGrid* pExplorationGrid = nullptr;
+	Elite::Vector2 explorationTarget{};
+	bool hasExplorationTarget{};
+	pBlackboard->GetData("ExplorationGrid", pExplorationGrid);
+	pBlackboard->GetData("ExplorationTarget", explorationTarget);
+	pBlackboard->GetData("HasExplorationTarget", hasExplorationTarget);
+	const float minFrontierRange{ pExplorationGrid != nullptr ? 3 * pExplorationGrid->GetCellSize() : 0.f };
+	hasExplorationTarget = hasExplorationTarget && pExplorationGrid != nullptr && pExplorationGrid->IsFrontier(explorationTarget)
+		&& Elite::DistanceSquared(agent.Position, explorationTarget) >= minFrontierRange * minFrontierRange;
+	if (!hasExplorationTarget && pExplorationGrid != nullptr)
+		hasExplorationTarget = pExplorationGrid->GetNearestFrontier(agent.Position, explorationTarget, minFrontierRange);
+	pBlackboard->ChangeData("HasExplorationTarget", hasExplorationTarget);
+	if (hasExplorationTarget)
+	{
+		pBlackboard->ChangeData("ExplorationTarget", explorationTarget);
+
+		TargetData target{};
+		FollowPlannedPath(pBlackboard, agent, explorationTarget, target.Position);
+		pBlackboard->ChangeData("Target", target);
+		pBlackboard->ChangeData("IntermediateTarget", target);
+
+		return ChangeToSeek(pBlackboard);
+	}
+
+	//Everything has been seen, fall back to cycling the world path
 	Elite::Vector2 currentNode{ pPath->at(*pCurrentPathNode) };
 	const float closeEnoughRange{ 10.f };
 	const float closeEnoughSqrd{ closeEnoughRange * closeEnoughRange };
@@ -868,7 +1088,7 @@ BehaviorState UpdateWorldPath(Elite::Blackboard* pBlackboard)
 	}
 
 	TargetData target{};
-	target.Position = currentNode;
+	FollowPlannedPath(pBlackboard, agent, currentNode, target.Position);
 	pBlackboard->ChangeData("Target", target);
 	pBlackboard->ChangeData("IntermediateTarget", target);
 
@@ -891,7 +1111,12 @@ BehaviorState GrabItem(Elite::Blackboard* pBlackboard)
 	if (entities.size() <= 0) return Failure;
 
 	Inventory* pInventory = nullptr;
+	InventoryOptimizer* pInventoryOptimizer = nullptr;
+	std::vector<LastSeen>* pItemsLeft = nullptr;
 	pBlackboard->GetData("Inventory", pInventory);
+	pBlackboard->GetData("InventoryOptimizer", pInventoryOptimizer);
+	pBlackboard->GetData("ItemsLeft", pItemsLeft);
+	if (pInventory == nullptr || pInventoryOptimizer == nullptr || pItemsLeft == nullptr) return Failure;
 
 	float grabRangeSqrd{ agent.GrabRange * agent.GrabRange };
 	//Remove all items not in range
@@ -904,52 +1129,54 @@ BehaviorState GrabItem(Elite::Blackboard* pBlackboard)
 	for (const EntityInfo& entity : entities)
 	{
 		int amountOfItemsInInventory{ pInventory->GetAmountOfItemsInInventory() };
-		UINT capacity{ pInterface->Inventory_GetCapacity() };
+		int capacity{ pInventory->GetCapacity() };
 		ItemInfo itemInfo{};
 		pInterface->Item_GetInfo(entity, itemInfo);
 
-		//If it's garbage, just destroy it
+		//If it's garbage, leave it where it is and stop looking at it
 		if (itemInfo.Type == eItemType::GARBAGE)
 		{
-			pInterface->Item_Destroy(entity);
+			pItemsLeft->push_back({ entity.Location });
 			continue;
 		}
 
 		//If we still have space, pick it up for later
-		if (amountOfItemsInInventory < int(capacity))
+		if (amountOfItemsInInventory < capacity)
 		{
 			int itemSlot = pInventory->GetFirstEmptySpace();
 			pInventory->GrabItem(itemSlot, entity);
 			continue;
 		}
 
-		//No space available -> Use item in inventory to make space
-		int amountFoodHeld{ pInventory->GetAmountOfItemsHeldOfType(eItemType::FOOD) };
-		int amountMedkitHeld{ pInventory->GetAmountOfItemsHeldOfType(eItemType::MEDKIT) };
-		int amountPistolHeld{ pInventory->GetAmountOfItemsHeldOfType(eItemType::PISTOL) };
-
-		int max{ std::max<int>(amountFoodHeld, std::max<int>(amountMedkitHeld, amountPistolHeld)) };
-		//If it's food or medkit, use it before picking up the other thing
-		if (max == amountFoodHeld || max == amountMedkitHeld)
+		//No space available -> the optimizer's table says what to give up, if anything
+		const InventoryOptimizer::Decision decision{ pInventoryOptimizer->Decide(*pInventory, itemInfo.Type, pInventory->ReadValue(itemInfo), agent) };
+		int itemSlot{ -1 };
+		switch (decision.slotType)
 		{
-			int itemSlot = 0; 
+		case eItemType::PISTOL:
+			pInventory->GetPistol(itemSlot);
+			break;
+		case eItemType::MEDKIT:
 			pInventory->GetHealthpack(itemSlot, agent.Health, true);
-			//Prefer dropping food over medkit (in case holding equal amount of food and medkits)
-			if (max == amountFoodHeld || itemInfo.Type == eItemType::FOOD) pInventory->GetFood(itemSlot, agent.Energy, true);
-			pInventory->UseItem(itemSlot);
-			pInventory->GrabItem(itemSlot, entity);
+			break;
+		case eItemType::FOOD:
+			pInventory->GetFood(itemSlot, agent.Energy, true);
+			break;
+		default:
+			//Garbage is never kept, so there is no slot of that type to give up
+			break;
+		}
+
+		//Not worth it, it stays on the ground and is remembered so it doesn't keep pulling the agent back
+		if (decision.action == InventoryOptimizer::Action::Discard || itemSlot < 0)
+		{
+			pItemsLeft->push_back({ entity.Location });
 			continue;
 		}
 
-		//Amount of pistols held is highest
-		int gunSlot{0};
-		pInventory->GetPistol(gunSlot);
-		//Get gun and its ammo
-		ItemInfo gun{};
-		pInterface->Inventory_GetItem(gunSlot, gun);
-		
-		pInventory->RemoveItem(gunSlot);
-		pInventory->GrabItem(gunSlot, entity);
+		if (decision.action == InventoryOptimizer::Action::Use) pInventory->UseItem(itemSlot);
+		else pInventory->RemoveItem(itemSlot);
+		pInventory->GrabItem(itemSlot, entity);
 	}
 
 	return Success;
@@ -0,0 +1,152 @@
+#include "stdafx.h"
+#include "ContextSteering.h"
+#if CONTEXT_STEERING_SSE
+#include <emmintrin.h>
+#endif
+
+const int ContextSteering::m_MaxSlots;
+
+ContextSteering::ContextSteering(int slotCount)
+	: m_SlotCount{ std::min<int>(m_MaxSlots, std::max<int>(4, (slotCount + 3) / 4 * 4)) }
+{
+	m_SlotAngle = 2 * float(E_PI) / m_SlotCount;
+	for (int slot{}; slot < m_SlotCount; ++slot)
+	{
+		m_SlotX[slot] = cosf(slot * m_SlotAngle);
+		m_SlotY[slot] = sinf(slot * m_SlotAngle);
+	}
+}
+
+void ContextSteering::Clear()
+{
+	m_InterestX.clear();
+	m_InterestY.clear();
+	m_InterestWeight.clear();
+	m_DangerX.clear();
+	m_DangerY.clear();
+	m_DangerRadius.clear();
+	m_DangerWeight.clear();
+}
+
+void ContextSteering::AddInterest(const Elite::Vector2& position, float weight)
+{
+	m_InterestX.push_back(position.x);
+	m_InterestY.push_back(position.y);
+	m_InterestWeight.push_back(weight);
+}
+
+void ContextSteering::AddDanger(const Elite::Vector2& position, float radius, float weight)
+{
+	m_DangerX.push_back(position.x);
+	m_DangerY.push_back(position.y);
+	m_DangerRadius.push_back(radius);
+	m_DangerWeight.push_back(weight);
+}
+
+bool ContextSteering::Resolve(const Elite::Vector2& agentPosition, Elite::Vector2& direction, float& speed)
+{
+	FillInterest(agentPosition);
+	FillDanger(agentPosition);
+	if (m_InterestX.empty() && m_DangerX.empty()) return false;
+
+	int safestSlot{};
+	for (int slot{ 1 }; slot < m_SlotCount; ++slot)
+	{
+		if (m_Danger[slot] < m_Danger[safestSlot]) safestSlot = slot;
+	}
+
+	//Only the slots about as safe as the safest one keep their interest
+	const float maxDanger{ m_Danger[safestSlot] + m_DangerTolerance };
+	int bestSlot{ -1 };
+	for (int slot{}; slot < m_SlotCount; ++slot)
+	{
+		if (m_Danger[slot] > maxDanger) m_Interest[slot] = 0.f;
+		else if (m_Interest[slot] > 0.f && (bestSlot < 0 || m_Interest[slot] > m_Interest[bestSlot])) bestSlot = slot;
+	}
+
+	if (bestSlot < 0)
+	{
+		//Nothing to go to, head for the middle of the widest safe gap
+		int gapSlot{ safestSlot }, gapDistance{};
+		for (int slot{}; slot < m_SlotCount; ++slot)
+		{
+			int distance{};
+			while (distance < m_SlotCount / 2 &&
+				m_Danger[(slot + distance + 1) % m_SlotCount] <= maxDanger && m_Danger[(slot + m_SlotCount - distance - 1) % m_SlotCount] <= maxDanger) ++distance;
+			if (m_Danger[slot] <= maxDanger && distance > gapDistance)
+			{
+				gapSlot = slot;
+				gapDistance = distance;
+			}
+		}
+		direction = Elite::Vector2{ m_SlotX[gapSlot], m_SlotY[gapSlot] };
+		speed = 1.f;
+		return true;
+	}
+
+	//Fit a parabola through the best slot and its neighbours to land in between slots
+	const float left{ m_Interest[(bestSlot + m_SlotCount - 1) % m_SlotCount] };
+	const float right{ m_Interest[(bestSlot + 1) % m_SlotCount] };
+	const float center{ m_Interest[bestSlot] };
+	const float curvature{ left - 2 * center + right };
+	const float offset{ curvature < 0.f ? Elite::Clamp(0.5f * (left - right) / curvature, -0.5f, 0.5f) : 0.f };
+	const float angle{ (bestSlot + offset) * m_SlotAngle };
+	direction = Elite::Vector2{ cosf(angle), sinf(angle) };
+	speed = std::min<float>(1.f, center) * (1.f - std::min<float>(1.f, m_Danger[bestSlot]));
+	return true;
+}
+
+void ContextSteering::FillInterest(const Elite::Vector2& agentPosition)
+{
+	std::fill(m_Interest, m_Interest + m_SlotCount, 0.f);
+	for (size_t i{}; i < m_InterestX.size(); ++i)
+	{
+		const float dx{ m_InterestX[i] - agentPosition.x }, dy{ m_InterestY[i] - agentPosition.y };
+		const float distance{ sqrtf(dx * dx + dy * dy) };
+		if (distance <= 0.f) continue;
+
+		WriteSlots(m_Interest, dx / distance, dy / distance, m_InterestWeight[i], 0.f, m_InterestWeight[i]);
+	}
+}
+
+void ContextSteering::FillDanger(const Elite::Vector2& agentPosition)
+{
+	std::fill(m_Danger, m_Danger + m_SlotCount, 0.f);
+	for (size_t i{}; i < m_DangerX.size(); ++i)
+	{
+		const float dx{ m_DangerX[i] - agentPosition.x }, dy{ m_DangerY[i] - agentPosition.y };
+		const float distance{ sqrtf(dx * dx + dy * dy) };
+		if (distance <= 0.f)
+		{
+			//Standing on it, every direction is as dangerous
+			for (int slot{}; slot < m_SlotCount; ++slot) m_Danger[slot] = std::max<float>(m_Danger[slot], m_DangerWeight[i]);
+			continue;
+		}
+
+		//Full danger inside the cone the danger covers (a half plane when inside it), fading out over a margin around it
+		const float coneAngle{ asinf(std::min<float>(1.f, m_DangerRadius[i] / distance)) };
+		const float coneCosine{ cosf(coneAngle) }, marginCosine{ cosf(coneAngle + m_DangerMargin) };
+		WriteSlots(m_Danger, dx / distance, dy / distance, m_DangerWeight[i], marginCosine, m_DangerWeight[i] / (coneCosine - marginCosine));
+	}
+}
+
+void ContextSteering::WriteSlots(float* pMap, float directionX, float directionY, float weight, float bias, float scale) const
+{
+#if CONTEXT_STEERING_SSE
+	const __m128 x{ _mm_set1_ps(directionX) }, y{ _mm_set1_ps(directionY) };
+	const __m128 offset{ _mm_set1_ps(bias) }, factor{ _mm_set1_ps(scale) }, cap{ _mm_set1_ps(weight) }, zero{ _mm_setzero_ps() };
+	for (int slot{}; slot < m_SlotCount; slot += 4)
+	{
+		const __m128 dot{ _mm_add_ps(_mm_mul_ps(x, _mm_loadu_ps(m_SlotX + slot)), _mm_mul_ps(y, _mm_loadu_ps(m_SlotY + slot))) };
+		const __m128 value{ _mm_min_ps(cap, _mm_mul_ps(_mm_max_ps(_mm_sub_ps(dot, offset), zero), factor)) };
+		_mm_storeu_ps(pMap + slot, _mm_max_ps(_mm_loadu_ps(pMap + slot), value));
+	}
+#else
+	for (int slot{}; slot < m_SlotCount; ++slot)
+	{
+		const float dot{ directionX * m_SlotX[slot] + directionY * m_SlotY[slot] };
+		const float value{ std::min<float>(weight, std::max<float>(dot - bias, 0.f) * scale) };
+		pMap[slot] = std::max<float>(pMap[slot], value);
+	}
+#endif
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "Exam_HelperStructs.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CONTEXT_STEERING_SSE 1
+#else
+#define CONTEXT_STEERING_SSE 0
+#endif
+
+//Context steering: a ring of direction slots around the agent holds how interesting and how dangerous every direction is.
+//Interests and dangers are gathered per frame and written into the slots in one batch, a dot product per
+//slot and entity (SSE, four slots at a time). Resolving masks every slot that is more dangerous than the
+//safest one and takes the most interesting slot left, so dangers are never averaged into a direction
+//that runs right between two of them.
+class ContextSteering final
+{
+public:
+	explicit ContextSteering(int slotCount = 32); //Rounded to a multiple of 4, at most 64
+	~ContextSteering() = default;
+	ContextSteering(const ContextSteering&) = delete;
+	ContextSteering& operator=(const ContextSteering&) = delete;
+	ContextSteering(ContextSteering&&) = delete;
+	ContextSteering& operator=(ContextSteering&&) = delete;
+
+	void Clear();
+	void AddInterest(const Elite::Vector2& position, float weight = 1.f);
+	//Slots pointing within the radius around the position get the full weight
+	void AddDanger(const Elite::Vector2& position, float radius, float weight = 1.f);
+
+	//Direction to go in and how fast, as a fraction of the max speed.
+	//Without any interest it is the safest direction at full speed, false without interests and dangers.
+	bool Resolve(const Elite::Vector2& agentPosition, Elite::Vector2& direction, float& speed);
+
+	int GetSlotCount() const { return m_SlotCount; }
+	float GetInterest(int slot) const { return m_Interest[slot]; } //Of the last resolve
+	float GetDanger(int slot) const { return m_Danger[slot]; }
+
+private:
+	static const int m_MaxSlots{ 64 };
+
+	void FillInterest(const Elite::Vector2& agentPosition);
+	void FillDanger(const Elite::Vector2& agentPosition);
+	//map[slot] = max(map[slot], min(weight, max(0, dot(direction, slot) - bias) * scale))
+	void WriteSlots(float* pMap, float directionX, float directionY, float weight, float bias, float scale) const;
+
+	int m_SlotCount{};
+	float m_SlotAngle{};
+	float m_DangerTolerance{ 0.05f }; //Slots this close to the safest one are not masked
+	float m_DangerMargin{ 0.5f }; //Radians around a danger's cone it fades out over
+	float m_SlotX[m_MaxSlots]{};
+	float m_SlotY[m_MaxSlots]{};
+	float m_Interest[m_MaxSlots]{};
+	float m_Danger[m_MaxSlots]{};
+
+	std::vector<float> m_InterestX{};
+	std::vector<float> m_InterestY{};
+	std::vector<float> m_InterestWeight{};
+	std::vector<float> m_DangerX{};
+	std::vector<float> m_DangerY{};
+	std::vector<float> m_DangerRadius{};
+	std::vector<float> m_DangerWeight{};
+};
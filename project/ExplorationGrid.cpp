@@ -0,0 +1,249 @@
+#include "stdafx.h"
+#include "ExplorationGrid.h"
+
+namespace
+{
+	//Index of the lowest set bit, de Bruijn lookup so it also works on 32-bit builds
+	int LowestSetBit(uint64_t bits)
+	{
+		static const int debruijnTable[64] = {
+			0, 1, 48, 2, 57, 49, 28, 3, 61, 58, 50, 42, 38, 29, 17, 4,
+			62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12, 5,
+			63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+			46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6
+		};
+		return debruijnTable[((bits & (~bits + 1)) * 0x03f79d71b4cb0a89ull) >> 58];
+	}
+}
+
+ExplorationGrid::ExplorationGrid(const Elite::Vector2& worldMin, const Elite::Vector2& worldMax, float cellSize)
+	: m_WorldMin{ worldMin }
+	, m_CellSize{ cellSize }
+{
+	m_Columns = std::max<int>(1, int(ceilf((worldMax.x - worldMin.x) / cellSize)));
+	m_Rows = std::max<int>(1, int(ceilf((worldMax.y - worldMin.y) / cellSize)));
+	m_WordsPerRow = (m_Columns + m_BitsPerWord - 1) / m_BitsPerWord;
+
+	m_Seen.resize(size_t(m_WordsPerRow) * m_Rows, 0);
+	m_Frontier.resize(size_t(m_WordsPerRow) * m_Rows, 0);
+
+	m_ReachableMaxColumn = m_Columns - 1;
+	m_ReachableMaxRow = m_Rows - 1;
+}
+
+void ExplorationGrid::MarkFOV(const AgentInfo& agentInfo)
+{
+	MarkCone(agentInfo.Position, agentInfo.Orientation, agentInfo.FOV_Angle, agentInfo.FOV_Range);
+}
+
+void ExplorationGrid::MarkCone(const Elite::Vector2& origin, float orientation, float fovAngle, float fovRange)
+{
+	//The cell the agent stands in is always seen, even when the cone is too narrow to cover its center
+	int originColumn{}, originRow{};
+	if (GetCell(origin, originColumn, originRow)) MarkRow(originRow, originColumn, originColumn);
+
+	if (fovRange <= 0.f || fovAngle <= 0.f) return;
+
+	const Elite::Vector2 forward{ Elite::OrientationToVector(orientation) };
+	const float halfAngle{ fovAngle * 0.5f };
+	const float cosHalf{ cosf(halfAngle) }, sinHalf{ sinf(halfAngle) };
+
+	//Inward normals of both cone edges, a point lies in the wedge when it is on the inner side of both
+	//(only holds for cones up to 180 degrees, wider cones get tested per cell)
+	const Elite::Vector2 leftEdge{ forward.x * cosHalf - forward.y * sinHalf, forward.x * sinHalf + forward.y * cosHalf };
+	const Elite::Vector2 rightEdge{ forward.x * cosHalf + forward.y * sinHalf, -forward.x * sinHalf + forward.y * cosHalf };
+	const Elite::Vector2 leftNormal{ leftEdge.y, -leftEdge.x };
+	const Elite::Vector2 rightNormal{ -rightEdge.y, rightEdge.x };
+	const bool isConvex{ halfAngle <= float(E_PI_2) };
+
+	const int firstRow{ std::max<int>(0, int(ceilf((origin.y - fovRange - m_WorldMin.y) / m_CellSize - 0.5f))) };
+	const int lastRow{ std::min<int>(m_Rows - 1, int(floorf((origin.y + fovRange - m_WorldMin.y) / m_CellSize - 0.5f))) };
+	const float rangeSqrd{ fovRange * fovRange };
+
+	//Scanline: every row is the intersection of the range circle with both edge half planes
+	for (int row = firstRow; row <= lastRow; ++row)
+	{
+		const float dy{ m_WorldMin.y + (row + 0.5f) * m_CellSize - origin.y };
+		const float circleSqrd{ rangeSqrd - dy * dy };
+		if (circleSqrd < 0.f) continue;
+
+		float low{ -sqrtf(circleSqrd) }, high{ -low };
+		bool isEmpty{ false };
+		if (isConvex)
+		{
+			for (const Elite::Vector2& normal : { leftNormal, rightNormal })
+			{
+				//normal.x * dx + normal.y * dy >= 0
+				const float rhs{ -normal.y * dy };
+				if (abs(normal.x) <= FLT_EPSILON)
+				{
+					isEmpty |= rhs > 0.f;
+					continue;
+				}
+				if (normal.x > 0.f) low = std::max<float>(low, rhs / normal.x);
+				else high = std::min<float>(high, rhs / normal.x);
+			}
+		}
+		if (isEmpty || low > high) continue;
+
+		const int firstColumn{ std::max<int>(0, int(ceilf((origin.x + low - m_WorldMin.x) / m_CellSize - 0.5f))) };
+		const int lastColumn{ std::min<int>(m_Columns - 1, int(floorf((origin.x + high - m_WorldMin.x) / m_CellSize - 0.5f))) };
+		if (firstColumn > lastColumn) continue;
+
+		if (isConvex)
+		{
+			MarkRow(row, firstColumn, lastColumn);
+			continue;
+		}
+
+		for (int column = firstColumn; column <= lastColumn; ++column)
+		{
+			const Elite::Vector2 toCell{ GetCellCenter(column, row) - origin };
+			if (Elite::Dot(toCell, forward) >= cosHalf * toCell.Magnitude()) MarkRow(row, column, column);
+		}
+	}
+}
+
+void ExplorationGrid::SetReachableBounds(const Elite::Vector2& reachableMin, const Elite::Vector2& reachableMax)
+{
+	m_ReachableMinColumn = std::max<int>(0, int(ceilf((reachableMin.x - m_WorldMin.x) / m_CellSize - 0.5f)));
+	m_ReachableMinRow = std::max<int>(0, int(ceilf((reachableMin.y - m_WorldMin.y) / m_CellSize - 0.5f)));
+	m_ReachableMaxColumn = std::min<int>(m_Columns - 1, int(floorf((reachableMax.x - m_WorldMin.x) / m_CellSize - 0.5f)));
+	m_ReachableMaxRow = std::min<int>(m_Rows - 1, int(floorf((reachableMax.y - m_WorldMin.y) / m_CellSize - 0.5f)));
+}
+
+bool ExplorationGrid::IsSeen(const Elite::Vector2& position) const
+{
+	int column{}, row{};
+	return GetCell(position, column, row) && TestBit(m_Seen, column, row);
+}
+
+bool ExplorationGrid::IsFrontier(const Elite::Vector2& position) const
+{
+	int column{}, row{};
+	return GetCell(position, column, row) && TestBit(m_Frontier, column, row);
+}
+
+bool ExplorationGrid::GetNearestFrontier(const Elite::Vector2& position, Elite::Vector2& frontier, float minRange, float maxRange) const
+{
+	if (m_AmountOfFrontierCells <= 0) return false;
+
+	const int column{ Elite::Clamp(int((position.x - m_WorldMin.x) / m_CellSize), 0, m_Columns - 1) };
+	const int row{ Elite::Clamp(int((position.y - m_WorldMin.y) / m_CellSize), 0, m_Rows - 1) };
+
+	float bestDistanceSqrd{ maxRange < FLT_MAX ? maxRange * maxRange : FLT_MAX };
+	const float minDistanceSqrd{ minRange * minRange };
+	bool found{ false };
+
+	//Search square rings around the agent cell, stop as soon as no cell in the next ring can be closer
+	const int maxRing{ std::max<int>(m_Columns, m_Rows) };
+	for (int ring = 1; ring <= maxRing; ++ring)
+	{
+		const float ringDistance{ (ring - 0.5f) * m_CellSize };
+		if (ringDistance > 0.f && ringDistance * ringDistance > bestDistanceSqrd) break;
+
+		const int minRow{ std::max<int>(row - ring, m_ReachableMinRow) }, maxRow{ std::min<int>(row + ring, m_ReachableMaxRow) };
+		for (int currentRow = minRow; currentRow <= maxRow; ++currentRow)
+		{
+			//Rows on the ring edge are scanned fully, others only have their two ring cells
+			const bool isEdgeRow{ abs(currentRow - row) == ring };
+			const int step{ isEdgeRow ? 1 : 2 * ring };
+			for (int currentColumn = column - ring; currentColumn <= column + ring; currentColumn += step)
+			{
+				if (currentColumn < m_ReachableMinColumn || currentColumn > m_ReachableMaxColumn) continue;
+				if (!TestBit(m_Frontier, currentColumn, currentRow)) continue;
+
+				const Elite::Vector2 cellCenter{ GetCellCenter(currentColumn, currentRow) };
+				const float distanceSqrd{ Elite::DistanceSquared(cellCenter, position) };
+				if (distanceSqrd >= minDistanceSqrd && distanceSqrd < bestDistanceSqrd)
+				{
+					bestDistanceSqrd = distanceSqrd;
+					frontier = cellCenter;
+					found = true;
+				}
+			}
+		}
+	}
+
+	return found;
+}
+
+Elite::Vector2 ExplorationGrid::GetCellCenter(int column, int row) const
+{
+	return { m_WorldMin.x + (column + 0.5f) * m_CellSize, m_WorldMin.y + (row + 0.5f) * m_CellSize };
+}
+
+bool ExplorationGrid::GetCell(const Elite::Vector2& position, int& column, int& row) const
+{
+	column = int(floorf((position.x - m_WorldMin.x) / m_CellSize));
+	row = int(floorf((position.y - m_WorldMin.y) / m_CellSize));
+	return column >= 0 && column < m_Columns && row >= 0 && row < m_Rows;
+}
+
+bool ExplorationGrid::TestBit(const std::vector<Word>& bits, int column, int row) const
+{
+	return (bits[size_t(row) * m_WordsPerRow + column / m_BitsPerWord] >> (column % m_BitsPerWord)) & 1;
+}
+
+void ExplorationGrid::MarkRow(int row, int firstColumn, int lastColumn)
+{
+	Word* pRow{ &m_Seen[size_t(row) * m_WordsPerRow] };
+	for (int word = firstColumn / m_BitsPerWord; word <= lastColumn / m_BitsPerWord; ++word)
+	{
+		const int wordStart{ word * m_BitsPerWord };
+		const int from{ std::max<int>(firstColumn, wordStart) - wordStart };
+		const int to{ std::min<int>(lastColumn, wordStart + m_BitsPerWord - 1) - wordStart };
+		const Word mask{ to - from == m_BitsPerWord - 1 ? ~Word(0) : ((Word(1) << (to - from + 1)) - 1) << from };
+
+		Word newBits{ mask & ~pRow[word] };
+		if (newBits == 0) continue;
+		pRow[word] |= newBits;
+
+		//Only cells that were not seen before can change the frontier
+		while (newBits != 0)
+		{
+			const int column{ wordStart + LowestSetBit(newBits) };
+			newBits &= newBits - 1;
+			++m_AmountOfSeenCells;
+			UpdateFrontierAround(column, row);
+		}
+	}
+}
+
+void ExplorationGrid::UpdateFrontier(int column, int row)
+{
+	bool isFrontier{ false };
+	if (TestBit(m_Seen, column, row))
+	{
+		isFrontier =
+			(column > 0 && !TestBit(m_Seen, column - 1, row)) ||
+			(column < m_Columns - 1 && !TestBit(m_Seen, column + 1, row)) ||
+			(row > 0 && !TestBit(m_Seen, column, row - 1)) ||
+			(row < m_Rows - 1 && !TestBit(m_Seen, column, row + 1));
+	}
+
+	Word& word{ m_Frontier[size_t(row) * m_WordsPerRow + column / m_BitsPerWord] };
+	const Word bit{ Word(1) << (column % m_BitsPerWord) };
+	const bool wasFrontier{ (word & bit) != 0 };
+	if (isFrontier == wasFrontier) return;
+
+	if (isFrontier)
+	{
+		word |= bit;
+		++m_AmountOfFrontierCells;
+	}
+	else
+	{
+		word &= ~bit;
+		--m_AmountOfFrontierCells;
+	}
+}
+
+void ExplorationGrid::UpdateFrontierAround(int column, int row)
+{
+	UpdateFrontier(column, row);
+	if (column > 0) UpdateFrontier(column - 1, row);
+	if (column < m_Columns - 1) UpdateFrontier(column + 1, row);
+	if (row > 0) UpdateFrontier(column, row - 1);
+	if (row < m_Rows - 1) UpdateFrontier(column, row + 1);
+}
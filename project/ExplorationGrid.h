@@ -0,0 +1,58 @@
+#pragma once
+#include "Exam_HelperStructs.h"
+
+//Packed bitset over the world that records which cells have been inside the agent's FOV cone.
+//Frontier cells (seen cells that border unseen ones) are kept up to date while marking,
+//so exploration can head for the nearest frontier instead of a fixed waypoint loop.
+class ExplorationGrid final
+{
+public:
+	ExplorationGrid(const Elite::Vector2& worldMin, const Elite::Vector2& worldMax, float cellSize = 4.f);
+	~ExplorationGrid() = default;
+	ExplorationGrid(const ExplorationGrid&) = delete;
+	ExplorationGrid& operator=(const ExplorationGrid&) = delete;
+	ExplorationGrid(ExplorationGrid&&) = delete;
+	ExplorationGrid& operator=(ExplorationGrid&&) = delete;
+
+	void MarkFOV(const AgentInfo& agentInfo);
+	void MarkCone(const Elite::Vector2& origin, float orientation, float fovAngle, float fovRange);
+
+	//Frontier queries only consider cells inside these bounds (defaults to the whole grid)
+	void SetReachableBounds(const Elite::Vector2& reachableMin, const Elite::Vector2& reachableMax);
+
+	bool IsSeen(const Elite::Vector2& position) const;
+	bool IsFrontier(const Elite::Vector2& position) const;
+	//Never the cell position is in, it always borders the unseen cells behind the agent, nor one closer than minRange
+	bool GetNearestFrontier(const Elite::Vector2& position, Elite::Vector2& frontier, float minRange = 0.f, float maxRange = FLT_MAX) const;
+
+	int GetAmountOfFrontierCells() const { return m_AmountOfFrontierCells; }
+	float GetCoverage() const { return float(m_AmountOfSeenCells) / float(m_Columns * m_Rows); }
+	float GetCellSize() const { return m_CellSize; }
+	Elite::Vector2 GetCellCenter(int column, int row) const;
+
+private:
+	using Word = uint64_t;
+	static const int m_BitsPerWord{ 64 };
+
+	bool GetCell(const Elite::Vector2& position, int& column, int& row) const;
+	bool TestBit(const std::vector<Word>& bits, int column, int row) const;
+	void MarkRow(int row, int firstColumn, int lastColumn);
+	void UpdateFrontier(int column, int row);
+	void UpdateFrontierAround(int column, int row);
+
+	Elite::Vector2 m_WorldMin{};
+	float m_CellSize{};
+	int m_Columns{};
+	int m_Rows{};
+	int m_WordsPerRow{};
+
+	int m_ReachableMinColumn{};
+	int m_ReachableMinRow{};
+	int m_ReachableMaxColumn{};
+	int m_ReachableMaxRow{};
+
+	std::vector<Word> m_Seen{};
+	std::vector<Word> m_Frontier{};
+	int m_AmountOfSeenCells{};
+	int m_AmountOfFrontierCells{};
+};
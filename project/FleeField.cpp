@@ -0,0 +1,262 @@
+#include "stdafx.h"
+#include "FleeField.h"
+
+namespace
+{
+	const int g_NoSource{ -1 };
+	const int g_NeighbourColumns[8]{ 1, 1, 0, -1, -1, -1, 0, 1 };
+	const int g_NeighbourRows[8]{ 0, 1, 1, 1, 0, -1, -1, -1 };
+}
+
+const int FleeField::m_LookAheadCells;
+
+FleeField::FleeField(int windowSize, float cellSize, float maxDistance)
+	: m_CellSize{ cellSize }
+	, m_MaxDistance{ maxDistance }
+{
+	const int maxDistanceInCells{ int(ceilf(maxDistance / cellSize)) };
+	m_MaxDistanceSqrd = maxDistanceInCells * maxDistanceInCells;
+	m_WindowSize = std::max<int>(windowSize, 2 * (maxDistanceInCells + m_LookAheadCells) + 8);
+	m_RecenterDistance = m_WindowSize / 2 - maxDistanceInCells - m_LookAheadCells - 1;
+
+	const size_t cellCount{ size_t(m_WindowSize) * m_WindowSize };
+	m_Cells.resize(cellCount, Cell{ g_NoSource, INT_MAX, 0, false, false, false });
+	m_IsNextSource.resize(cellCount, false);
+	//A wave seldom pushes more than a row's worth of cells into one bucket, so updates don't allocate
+	m_Buckets.resize(m_MaxDistanceSqrd + 1);
+	for (std::vector<int>& bucket : m_Buckets) bucket.reserve(m_WindowSize);
+}
+
+void FleeField::Update(const Elite::Vector2& agentPosition, const std::vector<Threat>& threats)
+{
+	m_UpdatedCells = 0;
+
+	//Recenter before the escape direction's samples could reach past the window
+	const int agentColumn{ int(floorf(agentPosition.x / m_CellSize)) }, agentRow{ int(floorf(agentPosition.y / m_CellSize)) };
+	const int centerColumn{ m_OriginColumn + m_WindowSize / 2 }, centerRow{ m_OriginRow + m_WindowSize / 2 };
+	const bool isCentered{ m_IsCentered && abs(agentColumn - centerColumn) <= m_RecenterDistance && abs(agentRow - centerRow) <= m_RecenterDistance };
+	if (isCentered && IsSameThreats(threats)) return;
+	if (!isCentered) Recenter(agentPosition);
+	m_Threats.assign(threats.begin(), threats.end());
+
+	//Stamp the threats, only the difference with the previous sources gets propagated
+	for (const Threat& threat : threats)
+	{
+		const int radiusInCells{ int(ceilf(threat.radius / m_CellSize)) };
+		const int threatColumn{ int(floorf(threat.position.x / m_CellSize)) - m_OriginColumn };
+		const int threatRow{ int(floorf(threat.position.y / m_CellSize)) - m_OriginRow };
+		const int firstRow{ std::max<int>(0, threatRow - radiusInCells) }, lastRow{ std::min<int>(m_WindowSize - 1, threatRow + radiusInCells) };
+		const int firstColumn{ std::max<int>(0, threatColumn - radiusInCells) }, lastColumn{ std::min<int>(m_WindowSize - 1, threatColumn + radiusInCells) };
+		for (int row{ firstRow }; row <= lastRow; ++row)
+		{
+			for (int column{ firstColumn }; column <= lastColumn; ++column)
+			{
+				const int dx{ column - threatColumn }, dy{ row - threatRow };
+				if (dx * dx + dy * dy > radiusInCells * radiusInCells) continue;
+
+				const int cell{ row * m_WindowSize + column };
+				if (m_IsNextSource[cell]) continue;
+				m_IsNextSource[cell] = true;
+				m_NextSourceCells.push_back(cell);
+			}
+		}
+	}
+
+	//Raising a source's cells and lowering them again costs about twice a fresh build of those cells
+	int coveredCells{}, raisedCells{};
+	for (int cell : m_SourceCells)
+	{
+		coveredCells += m_Cells[cell].ownedCells;
+		if (!m_IsNextSource[cell]) raisedCells += m_Cells[cell].ownedCells;
+	}
+	if (raisedCells * 2 > coveredCells) Clear();
+
+	for (int cell : m_SourceCells)
+	{
+		if (!m_IsNextSource[cell]) RemoveSource(cell);
+	}
+	for (int cell : m_NextSourceCells)
+	{
+		if (!m_Cells[cell].isSource) AddSource(cell);
+		m_IsNextSource[cell] = false;
+	}
+	m_SourceCells.swap(m_NextSourceCells);
+	m_NextSourceCells.clear();
+
+	Propagate();
+}
+
+float FleeField::GetThreatDistance(const Elite::Vector2& position) const
+{
+	int column{}, row{};
+	if (!GetCell(position, column, row)) return m_MaxDistance;
+
+	const Cell& cell{ m_Cells[row * m_WindowSize + column] };
+	if (cell.nearestSource == g_NoSource) return m_MaxDistance;
+	return std::min<float>(sqrtf(float(cell.distanceSqrd)) * m_CellSize, m_MaxDistance);
+}
+
+bool FleeField::GetEscapeDirection(const Elite::Vector2& position, Elite::Vector2& direction, const LevelIndex* pLevel) const
+{
+	const float currentDistance{ GetThreatDistance(position) };
+	if (currentDistance >= m_MaxDistance) return false;
+
+	//Look a few cells ahead in every direction, a single cell step is too noisy on a grid
+	const int directionCount{ 16 };
+	const float lookAhead{ m_LookAheadCells * m_CellSize };
+	float bestDistance{ currentDistance };
+	for (int i{}; i < directionCount; ++i)
+	{
+		const Elite::Vector2 candidate{ Elite::OrientationToVector(i * 2 * float(E_PI) / directionCount) };
+		const Elite::Vector2 samplePosition{ position + candidate * lookAhead };
+		const float distance{ GetThreatDistance(samplePosition) };
+		if (distance <= bestDistance) continue;
+		if (pLevel != nullptr && pLevel->IsLoaded() && !pLevel->IsSegmentClear(position, samplePosition)) continue;
+
+		bestDistance = distance;
+		direction = candidate;
+	}
+	return bestDistance > currentDistance;
+}
+
+bool FleeField::IsSameThreats(const std::vector<Threat>& threats) const
+{
+	if (threats.size() != m_Threats.size()) return false;
+	for (size_t i{}; i < threats.size(); ++i)
+	{
+		if (threats[i].position != m_Threats[i].position || threats[i].radius != m_Threats[i].radius) return false;
+	}
+	return true;
+}
+
+bool FleeField::GetCell(const Elite::Vector2& position, int& column, int& row) const
+{
+	if (!m_IsCentered) return false;
+
+	column = int(floorf(position.x / m_CellSize)) - m_OriginColumn;
+	row = int(floorf(position.y / m_CellSize)) - m_OriginRow;
+	return column >= 0 && row >= 0 && column < m_WindowSize && row < m_WindowSize;
+}
+
+void FleeField::Recenter(const Elite::Vector2& agentPosition)
+{
+	m_OriginColumn = int(floorf(agentPosition.x / m_CellSize)) - m_WindowSize / 2;
+	m_OriginRow = int(floorf(agentPosition.y / m_CellSize)) - m_WindowSize / 2;
+	m_IsCentered = true;
+
+	//Every cell moved, start over, the sources get stamped again right after
+	Clear();
+}
+
+void FleeField::Clear()
+{
+	std::fill(m_Cells.begin(), m_Cells.end(), Cell{ g_NoSource, INT_MAX, 0, false, false, false });
+	m_SourceCells.clear();
+	for (std::vector<int>& bucket : m_Buckets) bucket.clear();
+	m_QueueSize = 0;
+}
+
+void FleeField::Push(int cell, int distanceSqrd)
+{
+	const int bucket{ std::min<int>(distanceSqrd, m_MaxDistanceSqrd) };
+	m_Buckets[bucket].push_back(cell);
+	m_CurrentBucket = std::min<int>(m_CurrentBucket, bucket);
+	m_Cells[cell].isQueued = true;
+	++m_QueueSize;
+}
+
+void FleeField::SetNearestSource(Cell& cell, int source)
+{
+	if (cell.nearestSource != g_NoSource) --m_Cells[cell.nearestSource].ownedCells;
+	if (source != g_NoSource) ++m_Cells[source].ownedCells;
+	cell.nearestSource = source;
+}
+
+void FleeField::AddSource(int cell)
+{
+	Cell& source{ m_Cells[cell] };
+	source.isSource = true;
+	source.isRaising = false;
+	SetNearestSource(source, cell);
+	source.distanceSqrd = 0;
+	Push(cell, 0);
+}
+
+void FleeField::RemoveSource(int cell)
+{
+	Cell& source{ m_Cells[cell] };
+	source.isSource = false;
+	source.isRaising = true;
+	SetNearestSource(source, g_NoSource);
+	source.distanceSqrd = INT_MAX;
+	Push(cell, 0);
+}
+
+void FleeField::Propagate()
+{
+	while (m_QueueSize > 0)
+	{
+		while (m_Buckets[m_CurrentBucket].empty()) ++m_CurrentBucket;
+		const int cell{ m_Buckets[m_CurrentBucket].back() };
+		m_Buckets[m_CurrentBucket].pop_back();
+		--m_QueueSize;
+		++m_UpdatedCells;
+
+		Cell& current{ m_Cells[cell] };
+		current.isQueued = false;
+		if (current.isRaising) Raise(cell);
+		else if (current.nearestSource != g_NoSource && m_Cells[current.nearestSource].isSource) Lower(cell);
+	}
+}
+
+void FleeField::Raise(int cell)
+{
+	//Clear the neighbours that were fed by a removed source, the others start lowering into the cleared area
+	const int column{ cell % m_WindowSize }, row{ cell / m_WindowSize };
+	for (int neighbour{}; neighbour < 8; ++neighbour)
+	{
+		const int neighbourColumn{ column + g_NeighbourColumns[neighbour] }, neighbourRow{ row + g_NeighbourRows[neighbour] };
+		if (neighbourColumn < 0 || neighbourRow < 0 || neighbourColumn >= m_WindowSize || neighbourRow >= m_WindowSize) continue;
+
+		const int neighbourCell{ neighbourRow * m_WindowSize + neighbourColumn };
+		Cell& other{ m_Cells[neighbourCell] };
+		if (other.nearestSource == g_NoSource || other.isRaising) continue;
+
+		if (!m_Cells[other.nearestSource].isSource)
+		{
+			Push(neighbourCell, other.distanceSqrd);
+			SetNearestSource(other, g_NoSource);
+			other.distanceSqrd = INT_MAX;
+			other.isRaising = true;
+		}
+		else if (!other.isQueued)
+		{
+			Push(neighbourCell, other.distanceSqrd);
+		}
+	}
+	m_Cells[cell].isRaising = false;
+}
+
+void FleeField::Lower(int cell)
+{
+	const int source{ m_Cells[cell].nearestSource };
+	const int sourceColumn{ source % m_WindowSize }, sourceRow{ source / m_WindowSize };
+	const int column{ cell % m_WindowSize }, row{ cell / m_WindowSize };
+	for (int neighbour{}; neighbour < 8; ++neighbour)
+	{
+		const int neighbourColumn{ column + g_NeighbourColumns[neighbour] }, neighbourRow{ row + g_NeighbourRows[neighbour] };
+		if (neighbourColumn < 0 || neighbourRow < 0 || neighbourColumn >= m_WindowSize || neighbourRow >= m_WindowSize) continue;
+
+		const int neighbourCell{ neighbourRow * m_WindowSize + neighbourColumn };
+		Cell& other{ m_Cells[neighbourCell] };
+		if (other.isRaising) continue;
+
+		const int dx{ neighbourColumn - sourceColumn }, dy{ neighbourRow - sourceRow };
+		const int distanceSqrd{ dx * dx + dy * dy };
+		if (distanceSqrd > m_MaxDistanceSqrd || distanceSqrd >= other.distanceSqrd) continue;
+
+		other.distanceSqrd = distanceSqrd;
+		SetNearestSource(other, source);
+		Push(neighbourCell, distanceSqrd);
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "Exam_HelperStructs.h"
+#include "LevelIndex.h"
+
+//Distance to the nearest live threat over a square window of cells around the agent.
+//Threats become source cells of a dynamic brushfire (Lau et al.): when threats move, only the cells whose nearest
+//source changed are touched, through a raise wave from the removed sources and a lower wave from the new ones.
+//The window moves along with the agent, which rebuilds it from scratch, as does a frame where the removed sources
+//own so much of the window that the waves would touch more cells than a fresh build.
+//The window only has to reach the max distance past the cells the escape direction samples, so a threat outside
+//it can never be closer than the cap. An update with the same threats and no recentring does nothing.
+class FleeField final
+{
+public:
+	struct Threat
+	{
+		Elite::Vector2 position;
+		float radius; //0 for a single cell
+	};
+
+	FleeField(int windowSize = 80, float cellSize = 1.f, float maxDistance = 32.f); //The window grows to fit the max distance
+	~FleeField() = default;
+	FleeField(const FleeField&) = delete;
+	FleeField& operator=(const FleeField&) = delete;
+	FleeField(FleeField&&) = delete;
+	FleeField& operator=(FleeField&&) = delete;
+
+	void Update(const Elite::Vector2& agentPosition, const std::vector<Threat>& threats);
+
+	//Capped at the max distance, also returned outside the window
+	float GetThreatDistance(const Elite::Vector2& position) const;
+	//Direction that gains the most distance from the threats, walls in the level (when given) block directions
+	bool GetEscapeDirection(const Elite::Vector2& position, Elite::Vector2& direction, const LevelIndex* pLevel = nullptr) const;
+	int GetUpdatedCells() const { return m_UpdatedCells; } //Of the last update
+
+private:
+	struct Cell
+	{
+		int nearestSource;
+		int distanceSqrd; //In cells
+		int ownedCells; //Of a source, cells it is the nearest source of
+		bool isSource;
+		bool isRaising;
+		bool isQueued;
+	};
+
+	static const int m_LookAheadCells{ 3 }; //How far from the agent the escape direction samples
+
+	bool IsSameThreats(const std::vector<Threat>& threats) const;
+	bool GetCell(const Elite::Vector2& position, int& column, int& row) const;
+	void Recenter(const Elite::Vector2& agentPosition);
+	void Clear();
+	void Push(int cell, int distanceSqrd);
+	void SetNearestSource(Cell& cell, int source);
+	void AddSource(int cell);
+	void RemoveSource(int cell);
+	void Propagate();
+	void Raise(int cell);
+	void Lower(int cell);
+
+	int m_WindowSize{};
+	float m_CellSize{};
+	int m_MaxDistanceSqrd{}; //In cells
+	float m_MaxDistance{};
+	int m_RecenterDistance{}; //In cells from the center, further and the samples could see past the window
+	int m_OriginColumn{}; //World cell of the window's first cell
+	int m_OriginRow{};
+	bool m_IsCentered{ false };
+
+	std::vector<Threat> m_Threats{}; //Of the last update
+	std::vector<Cell> m_Cells{};
+	std::vector<int> m_SourceCells{};
+	std::vector<int> m_NextSourceCells{};
+	std::vector<bool> m_IsNextSource{};
+	//Bucket queue on squared distance, the raise wave can push below the current bucket
+	std::vector<std::vector<int>> m_Buckets{};
+	int m_CurrentBucket{};
+	int m_QueueSize{};
+	int m_UpdatedCells{};
+};
@@ -0,0 +1,423 @@
+#include "stdafx.h"
+#include "GridPathfinder.h"
+
+namespace
+{
+	const float sqrt2{ 1.41421356f };
+
+	float GetOctileDistance(int dx, int dy)
+	{
+		dx = abs(dx);
+		dy = abs(dy);
+		return float(std::max<int>(dx, dy)) + (sqrt2 - 1.f) * float(std::min<int>(dx, dy));
+	}
+
+	const int directions[8][2] = { {1,0}, {-1,0}, {0,1}, {0,-1}, {1,1}, {1,-1}, {-1,1}, {-1,-1} };
+}
+
+GridPathfinder::GridPathfinder(const Elite::Vector2& worldMin, const Elite::Vector2& worldMax, float cellSize)
+	: m_WorldMin{ worldMin }
+	, m_CellSize{ cellSize }
+{
+	m_Columns = std::max<int>(1, int(ceilf((worldMax.x - worldMin.x) / cellSize)));
+	m_Rows = std::max<int>(1, int(ceilf((worldMax.y - worldMin.y) / cellSize)));
+
+	const size_t amountOfCells{ size_t(m_Columns) * m_Rows };
+	m_Blocked.resize(amountOfCells, 0);
+	m_Nodes.resize(amountOfCells, Node{});
+	m_Heap.resize(amountOfCells, -1);
+}
+
+void GridPathfinder::AddHouse(const HouseInfo& house)
+{
+	const float sameHouseMargin{ 1.f };
+	auto foundIt = std::find_if(m_Houses.begin(), m_Houses.end(), [&house, sameHouseMargin](const HouseInfo& knownHouse) {
+		return Elite::DistanceSquared(knownHouse.Center, house.Center) <= sameHouseMargin * sameHouseMargin;
+	});
+	if (foundIt != m_Houses.end()) return;
+	m_Houses.push_back(house);
+
+	//Houses are a ring of walls, the doors are unknown until the agent walks through one
+	const float wallThickness{ 2.f };
+	const Elite::Vector2 halfSize{ house.Size * 0.5f };
+	const Elite::Vector2 wallOffset{ wallThickness, wallThickness };
+	BlockRectangle(house.Center - halfSize, house.Center + halfSize, house.Center - halfSize + wallOffset, house.Center + halfSize - wallOffset);
+
+	for (const Elite::Vector2& doorway : m_Doorways)
+	{
+		if (abs(doorway.x - house.Center.x) <= halfSize.x + m_CellSize && abs(doorway.y - house.Center.y) <= halfSize.y + m_CellSize)
+			OpenCircle(doorway, std::max<float>(3.f, 2 * m_CellSize));
+	}
+
+	++m_Version;
+}
+
+void GridPathfinder::AddDoorway(const Elite::Vector2& position)
+{
+	m_Doorways.push_back(position);
+	OpenCircle(position, std::max<float>(3.f, 2 * m_CellSize));
+	++m_Version;
+}
+
+bool GridPathfinder::FindPath(const Elite::Vector2& start, const Elite::Vector2& goal, std::vector<Elite::Vector2>& path, Algorithm algorithm)
+{
+	path.clear();
+	m_ExpandedNodes = 0;
+
+	const int startCell{ FindWalkableCell(start) };
+	const int goalCell{ FindWalkableCell(goal) };
+	if (startCell < 0 || goalCell < 0) return false;
+
+	StartSearch(startCell, goalCell);
+	while (m_HeapSize > 0)
+	{
+		const int cell{ HeapPop() };
+		m_Nodes[cell].isClosed = true;
+		++m_ExpandedNodes;
+
+		if (cell == goalCell)
+		{
+			//Walk back to the start, then flip so the path starts at the first point to visit
+			for (int pathCell = goalCell; pathCell != startCell; pathCell = m_Nodes[pathCell].parent)
+				path.push_back(GetCellCenter(pathCell));
+			std::reverse(path.begin(), path.end());
+
+			if (path.empty()) path.push_back(goal);
+			else if (GetCell(goal) == goalCell) path.back() = goal;
+			return true;
+		}
+
+		if (algorithm == Algorithm::AStar) ExpandAStar(cell);
+		else ExpandJumpPointSearch(cell);
+	}
+
+	return false;
+}
+
+bool GridPathfinder::IsBlocked(const Elite::Vector2& position) const
+{
+	return m_Blocked[GetCell(position)] != 0;
+}
+
+Elite::Vector2 GridPathfinder::GetCellCenter(int cell) const
+{
+	return { m_WorldMin.x + (cell % m_Columns + 0.5f) * m_CellSize, m_WorldMin.y + (cell / m_Columns + 0.5f) * m_CellSize };
+}
+
+int GridPathfinder::GetCell(const Elite::Vector2& position) const
+{
+	const int column{ Elite::Clamp(int(floorf((position.x - m_WorldMin.x) / m_CellSize)), 0, m_Columns - 1) };
+	const int row{ Elite::Clamp(int(floorf((position.y - m_WorldMin.y) / m_CellSize)), 0, m_Rows - 1) };
+	return row * m_Columns + column;
+}
+
+int GridPathfinder::FindWalkableCell(const Elite::Vector2& position) const
+{
+	const int cell{ GetCell(position) };
+	if (!m_Blocked[cell]) return cell;
+
+	//Positions on a wall (agent standing in a doorway) snap to the closest open cell nearby
+	const int column{ cell % m_Columns }, row{ cell / m_Columns };
+	const int maxRing{ 2 };
+	int bestCell{ -1 };
+	float bestDistanceSqrd{ FLT_MAX };
+	for (int dy = -maxRing; dy <= maxRing; ++dy)
+	{
+		for (int dx = -maxRing; dx <= maxRing; ++dx)
+		{
+			if (!IsWalkable(column + dx, row + dy)) continue;
+
+			const int neighbour{ (row + dy) * m_Columns + column + dx };
+			const float distanceSqrd{ Elite::DistanceSquared(GetCellCenter(neighbour), position) };
+			if (distanceSqrd < bestDistanceSqrd)
+			{
+				bestDistanceSqrd = distanceSqrd;
+				bestCell = neighbour;
+			}
+		}
+	}
+
+	return bestCell;
+}
+
+bool GridPathfinder::IsWalkable(int column, int row) const
+{
+	return column >= 0 && column < m_Columns && row >= 0 && row < m_Rows && !m_Blocked[row * m_Columns + column];
+}
+
+float GridPathfinder::GetHeuristic(int column, int row) const
+{
+	return GetOctileDistance(m_GoalColumn - column, m_GoalRow - row);
+}
+
+void GridPathfinder::BlockRectangle(const Elite::Vector2& outerMin, const Elite::Vector2& outerMax, const Elite::Vector2& innerMin, const Elite::Vector2& innerMax)
+{
+	//Every cell touching the outer rectangle that does not fit completely inside the inner one
+	const int firstColumn{ std::max<int>(0, int(floorf((outerMin.x - m_WorldMin.x) / m_CellSize))) };
+	const int lastColumn{ std::min<int>(m_Columns - 1, int(ceilf((outerMax.x - m_WorldMin.x) / m_CellSize)) - 1) };
+	const int firstRow{ std::max<int>(0, int(floorf((outerMin.y - m_WorldMin.y) / m_CellSize))) };
+	const int lastRow{ std::min<int>(m_Rows - 1, int(ceilf((outerMax.y - m_WorldMin.y) / m_CellSize)) - 1) };
+
+	for (int row = firstRow; row <= lastRow; ++row)
+	{
+		const float cellMinY{ m_WorldMin.y + row * m_CellSize };
+		const bool isInsideY{ cellMinY >= innerMin.y && cellMinY + m_CellSize <= innerMax.y };
+		for (int column = firstColumn; column <= lastColumn; ++column)
+		{
+			const float cellMinX{ m_WorldMin.x + column * m_CellSize };
+			const bool isInsideX{ cellMinX >= innerMin.x && cellMinX + m_CellSize <= innerMax.x };
+			if (!isInsideX || !isInsideY) m_Blocked[row * m_Columns + column] = 1;
+		}
+	}
+}
+
+void GridPathfinder::OpenCircle(const Elite::Vector2& center, float radius)
+{
+	const int cell{ GetCell(center) };
+	const int column{ cell % m_Columns }, row{ cell / m_Columns };
+	const int cellRadius{ int(ceilf(radius / m_CellSize)) };
+	for (int dy = -cellRadius; dy <= cellRadius; ++dy)
+	{
+		for (int dx = -cellRadius; dx <= cellRadius; ++dx)
+		{
+			const int currentColumn{ column + dx }, currentRow{ row + dy };
+			if (currentColumn < 0 || currentColumn >= m_Columns || currentRow < 0 || currentRow >= m_Rows) continue;
+
+			const int currentCell{ currentRow * m_Columns + currentColumn };
+			if (Elite::DistanceSquared(GetCellCenter(currentCell), center) <= radius * radius) m_Blocked[currentCell] = 0;
+		}
+	}
+}
+
+void GridPathfinder::StartSearch(int startCell, int goalCell)
+{
+	//Bumping the generation invalidates every node of the previous search at once
+	++m_Generation;
+	if (m_Generation == 0)
+	{
+		for (Node& node : m_Nodes) node.generation = 0;
+		m_Generation = 1;
+	}
+
+	m_HeapSize = 0;
+	m_GoalColumn = goalCell % m_Columns;
+	m_GoalRow = goalCell / m_Columns;
+	Relax(startCell, -1, 0.f);
+}
+
+void GridPathfinder::Relax(int cell, int parent, float cost)
+{
+	Node& node{ m_Nodes[cell] };
+	if (node.generation != m_Generation)
+	{
+		node.generation = m_Generation;
+		node.isClosed = false;
+		node.cost = cost;
+		node.parent = parent;
+		node.estimate = cost + GetHeuristic(cell % m_Columns, cell / m_Columns);
+		HeapPush(cell);
+		return;
+	}
+
+	if (node.isClosed || cost >= node.cost) return;
+
+	node.estimate += cost - node.cost;
+	node.cost = cost;
+	node.parent = parent;
+	HeapDecrease(cell);
+}
+
+void GridPathfinder::ExpandAStar(int cell)
+{
+	const int column{ cell % m_Columns }, row{ cell / m_Columns };
+	const float cost{ m_Nodes[cell].cost };
+
+	for (const auto& direction : directions)
+	{
+		const int dx{ direction[0] }, dy{ direction[1] };
+		if (!IsWalkable(column + dx, row + dy)) continue;
+
+		//Diagonal moves are not allowed to cut corners
+		const bool isDiagonal{ dx != 0 && dy != 0 };
+		if (isDiagonal && (!IsWalkable(column + dx, row) || !IsWalkable(column, row + dy))) continue;
+
+		Relax((row + dy) * m_Columns + column + dx, cell, cost + (isDiagonal ? sqrt2 : 1.f));
+	}
+}
+
+void GridPathfinder::ExpandJumpPointSearch(int cell)
+{
+	const Node& node{ m_Nodes[cell] };
+	const int column{ cell % m_Columns }, row{ cell / m_Columns };
+	const float cost{ node.cost };
+
+	//Prune the neighbours using the direction the node was reached from
+	int neighbours[8][2]{};
+	int amountOfNeighbours{};
+	auto addNeighbour = [&neighbours, &amountOfNeighbours](int dx, int dy) {
+		neighbours[amountOfNeighbours][0] = dx;
+		neighbours[amountOfNeighbours][1] = dy;
+		++amountOfNeighbours;
+	};
+
+	if (node.parent < 0)
+	{
+		for (const auto& direction : directions)
+		{
+			const int dx{ direction[0] }, dy{ direction[1] };
+			if (!IsWalkable(column + dx, row + dy)) continue;
+			if (dx != 0 && dy != 0 && (!IsWalkable(column + dx, row) || !IsWalkable(column, row + dy))) continue;
+			addNeighbour(dx, dy);
+		}
+	}
+	else
+	{
+		const int dx{ Elite::sign(column - node.parent % m_Columns) };
+		const int dy{ Elite::sign(row - node.parent / m_Columns) };
+
+		if (dx != 0 && dy != 0)
+		{
+			const bool isVerticalWalkable{ IsWalkable(column, row + dy) };
+			const bool isHorizontalWalkable{ IsWalkable(column + dx, row) };
+			if (isVerticalWalkable) addNeighbour(0, dy);
+			if (isHorizontalWalkable) addNeighbour(dx, 0);
+			if (isVerticalWalkable && isHorizontalWalkable) addNeighbour(dx, dy);
+		}
+		else if (dx != 0)
+		{
+			const bool isNextWalkable{ IsWalkable(column + dx, row) };
+			const bool isTopWalkable{ IsWalkable(column, row + 1) };
+			const bool isBottomWalkable{ IsWalkable(column, row - 1) };
+			if (isNextWalkable)
+			{
+				addNeighbour(dx, 0);
+				if (isTopWalkable) addNeighbour(dx, 1);
+				if (isBottomWalkable) addNeighbour(dx, -1);
+			}
+			if (isTopWalkable) addNeighbour(0, 1);
+			if (isBottomWalkable) addNeighbour(0, -1);
+		}
+		else
+		{
+			const bool isNextWalkable{ IsWalkable(column, row + dy) };
+			const bool isRightWalkable{ IsWalkable(column + 1, row) };
+			const bool isLeftWalkable{ IsWalkable(column - 1, row) };
+			if (isNextWalkable)
+			{
+				addNeighbour(0, dy);
+				if (isRightWalkable) addNeighbour(1, dy);
+				if (isLeftWalkable) addNeighbour(-1, dy);
+			}
+			if (isRightWalkable) addNeighbour(1, 0);
+			if (isLeftWalkable) addNeighbour(-1, 0);
+		}
+	}
+
+	for (int i = 0; i < amountOfNeighbours; ++i)
+	{
+		const int jumpPoint{ Jump(column + neighbours[i][0], row + neighbours[i][1], neighbours[i][0], neighbours[i][1]) };
+		if (jumpPoint < 0) continue;
+
+		const int jumpColumn{ jumpPoint % m_Columns }, jumpRow{ jumpPoint / m_Columns };
+		Relax(jumpPoint, cell, cost + GetOctileDistance(jumpColumn - column, jumpRow - row));
+	}
+}
+
+int GridPathfinder::Jump(int column, int row, int dx, int dy) const
+{
+	while (true)
+	{
+		if (!IsWalkable(column, row)) return -1;
+		const int cell{ row * m_Columns + column };
+		if (column == m_GoalColumn && row == m_GoalRow) return cell;
+
+		if (dx != 0 && dy != 0)
+		{
+			//A diagonal step is a jump point when one of its straight scans finds something
+			if (Jump(column + dx, row, dx, 0) >= 0 || Jump(column, row + dy, 0, dy) >= 0) return cell;
+		}
+		else if (dx != 0)
+		{
+			if ((IsWalkable(column, row - 1) && !IsWalkable(column - dx, row - 1)) ||
+				(IsWalkable(column, row + 1) && !IsWalkable(column - dx, row + 1))) return cell;
+		}
+		else
+		{
+			if ((IsWalkable(column - 1, row) && !IsWalkable(column - 1, row - dy)) ||
+				(IsWalkable(column + 1, row) && !IsWalkable(column + 1, row - dy))) return cell;
+		}
+
+		if (!IsWalkable(column + dx, row) || !IsWalkable(column, row + dy)) return -1;
+		column += dx;
+		row += dy;
+	}
+}
+
+void GridPathfinder::HeapPush(int cell)
+{
+	m_Heap[m_HeapSize] = cell;
+	m_Nodes[cell].heapIndex = m_HeapSize;
+	++m_HeapSize;
+	HeapSiftUp(m_HeapSize - 1);
+}
+
+void GridPathfinder::HeapDecrease(int cell)
+{
+	HeapSiftUp(m_Nodes[cell].heapIndex);
+}
+
+int GridPathfinder::HeapPop()
+{
+	const int cell{ m_Heap[0] };
+	--m_HeapSize;
+	if (m_HeapSize > 0)
+	{
+		m_Heap[0] = m_Heap[m_HeapSize];
+		m_Nodes[m_Heap[0]].heapIndex = 0;
+		HeapSiftDown(0);
+	}
+	return cell;
+}
+
+void GridPathfinder::HeapSiftUp(int index)
+{
+	const int cell{ m_Heap[index] };
+	while (index > 0)
+	{
+		const int parentIndex{ (index - 1) / 2 };
+		if (!HeapLess(cell, m_Heap[parentIndex])) break;
+
+		m_Heap[index] = m_Heap[parentIndex];
+		m_Nodes[m_Heap[index]].heapIndex = index;
+		index = parentIndex;
+	}
+	m_Heap[index] = cell;
+	m_Nodes[cell].heapIndex = index;
+}
+
+void GridPathfinder::HeapSiftDown(int index)
+{
+	const int cell{ m_Heap[index] };
+	while (true)
+	{
+		int childIndex{ 2 * index + 1 };
+		if (childIndex >= m_HeapSize) break;
+		if (childIndex + 1 < m_HeapSize && HeapLess(m_Heap[childIndex + 1], m_Heap[childIndex])) ++childIndex;
+		if (!HeapLess(m_Heap[childIndex], cell)) break;
+
+		m_Heap[index] = m_Heap[childIndex];
+		m_Nodes[m_Heap[index]].heapIndex = index;
+		index = childIndex;
+	}
+	m_Heap[index] = cell;
+	m_Nodes[cell].heapIndex = index;
+}
+
+bool GridPathfinder::HeapLess(int left, int right) const
+{
+	//Ties go to the node closest to the goal
+	const Node& leftNode{ m_Nodes[left] };
+	const Node& rightNode{ m_Nodes[right] };
+	if (leftNode.estimate != rightNode.estimate) return leftNode.estimate < rightNode.estimate;
+	return leftNode.cost > rightNode.cost;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "Exam_HelperStructs.h"
+
+//Occupancy grid over the world built from the known house walls, searched with A* or Jump Point Search.
+//All search state lives in arrays that are sized once with the grid. Node state is stamped with the
+//search generation, so nothing gets cleared between queries and a query does not allocate
+//(as long as the output path has enough capacity).
+class GridPathfinder final
+{
+public:
+	enum class Algorithm
+	{
+		AStar,
+		JumpPointSearch
+	};
+
+	GridPathfinder(const Elite::Vector2& worldMin, const Elite::Vector2& worldMax, float cellSize = 2.f);
+	~GridPathfinder() = default;
+	GridPathfinder(const GridPathfinder&) = delete;
+	GridPathfinder& operator=(const GridPathfinder&) = delete;
+	GridPathfinder(GridPathfinder&&) = delete;
+	GridPathfinder& operator=(GridPathfinder&&) = delete;
+
+	//Blocks the walls of the house, houses that are already known are ignored
+	void AddHouse(const HouseInfo& house);
+	//Opens the walls around a position the agent walked through
+	void AddDoorway(const Elite::Vector2& position);
+
+	//Fills path with the points to visit after start, the last point is the goal itself
+	bool FindPath(const Elite::Vector2& start, const Elite::Vector2& goal, std::vector<Elite::Vector2>& path, Algorithm algorithm = Algorithm::JumpPointSearch);
+
+	bool IsBlocked(const Elite::Vector2& position) const;
+	size_t GetAmountOfHouses() const { return m_Houses.size(); }
+	int GetExpandedNodes() const { return m_ExpandedNodes; } //Of the last query
+	unsigned int GetVersion() const { return m_Version; } //Changes whenever the occupancy changes
+	float GetCellSize() const { return m_CellSize; }
+	Elite::Vector2 GetCellCenter(int cell) const;
+
+private:
+	struct Node
+	{
+		float cost;
+		float estimate;
+		int parent;
+		int heapIndex;
+		unsigned int generation;
+		bool isClosed;
+	};
+
+	int GetCell(const Elite::Vector2& position) const;
+	int FindWalkableCell(const Elite::Vector2& position) const;
+	bool IsWalkable(int column, int row) const;
+	float GetHeuristic(int column, int row) const;
+	void BlockRectangle(const Elite::Vector2& outerMin, const Elite::Vector2& outerMax, const Elite::Vector2& innerMin, const Elite::Vector2& innerMax);
+	void OpenCircle(const Elite::Vector2& center, float radius);
+
+	void StartSearch(int startCell, int goalCell);
+	void Relax(int cell, int parent, float cost);
+	void ExpandAStar(int cell);
+	void ExpandJumpPointSearch(int cell);
+	int Jump(int column, int row, int dx, int dy) const;
+
+	void HeapPush(int cell);
+	void HeapDecrease(int cell);
+	int HeapPop();
+	void HeapSiftUp(int index);
+	void HeapSiftDown(int index);
+	bool HeapLess(int left, int right) const;
+
+	Elite::Vector2 m_WorldMin{};
+	float m_CellSize{};
+	int m_Columns{};
+	int m_Rows{};
+
+	std::vector<uint8_t> m_Blocked{};
+	std::vector<HouseInfo> m_Houses{};
+	std::vector<Elite::Vector2> m_Doorways{};
+	unsigned int m_Version{ 1 };
+
+	//Search arena
+	std::vector<Node> m_Nodes{};
+	std::vector<int> m_Heap{};
+	int m_HeapSize{};
+	unsigned int m_Generation{};
+	int m_GoalColumn{};
+	int m_GoalRow{};
+	int m_ExpandedNodes{};
+};
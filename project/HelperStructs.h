@@ -31,6 +31,11 @@ struct LastSeen
 	{
 		return Elite::DistanceSquared(SeenLocation, house.Center) <= (sameLocationMargin * sameLocationMargin);
 	}
+
+	bool operator==(const EntityInfo& entity)
+	{
+		return Elite::DistanceSquared(SeenLocation, entity.Location) <= (sameLocationMargin * sameLocationMargin);
+	}
 };
 
 const float LastSeen::sameLocationMargin = 1.f;
\ No newline at end of file
@@ -0,0 +1,336 @@
+#include "stdafx.h"
+#include "HouseRouteOptimizer.h"
+#include <chrono>
+
+namespace
+{
+	const float g_MaxStaleness{ 4.f }; //Never visited houses count as this many revisit times old
+	const float g_MinImprovement{ 0.0001f };
+	const size_t g_MaxOrOptLength{ 3 };
+	const int g_EvaluationsPerClockCheck{ 32 };
+}
+
+const int HouseRouteOptimizer::m_AgentNode;
+
+HouseRouteOptimizer::HouseRouteOptimizer(float revisitTime)
+	: m_RevisitTime{ std::max<float>(revisitTime, 0.001f) }
+{
+	m_Route.push_back(m_AgentNode);
+}
+
+void HouseRouteOptimizer::AddHouse(const HouseInfo& house, float lootExpectation)
+{
+	if (FindHouse(house.Center) != -1) return;
+
+	m_Houses.push_back(House{ house.Center, lootExpectation, FLT_MAX, false });
+}
+
+void HouseRouteOptimizer::SetLootExpectation(const Elite::Vector2& houseCenter, float lootExpectation)
+{
+	const int house{ FindHouse(houseCenter) };
+	if (house == -1) return;
+
+	m_Houses[house].lootExpectation = lootExpectation;
+	if (m_Houses[house].isOnRoute) Restart();
+}
+
+void HouseRouteOptimizer::MarkVisited(const Elite::Vector2& houseCenter)
+{
+	const int house{ FindHouse(houseCenter) };
+	if (house == -1) return;
+
+	m_Houses[house].timeSinceVisit = 0.f;
+	if (m_Houses[house].isOnRoute) RemoveFromRoute(house);
+}
+
+void HouseRouteOptimizer::Update(float dt, const Elite::Vector2& agentPosition)
+{
+	for (House& house : m_Houses)
+	{
+		if (house.timeSinceVisit < FLT_MAX) house.timeSinceVisit += dt;
+	}
+
+	m_AgentPosition = agentPosition;
+	AddDueHouses();
+
+	//The first leg changes as the agent walks, once it has moved far enough the old optimum is worth revisiting
+	const float reoptimizeDistance{ 10.f };
+	if (m_IsLocalOptimum && Elite::DistanceSquared(m_OptimizedFrom, m_AgentPosition) > reoptimizeDistance * reoptimizeDistance) Restart();
+}
+
+void HouseRouteOptimizer::Improve(float timeBudget)
+{
+	AddDueHouses();
+	if (m_IsLocalOptimum) return;
+	if (m_Route.size() < 3)
+	{
+		m_IsLocalOptimum = true;
+		m_OptimizedFrom = m_AgentPosition;
+		return;
+	}
+
+	using Clock = std::chrono::steady_clock;
+	const Clock::time_point end{ Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(timeBudget)) };
+	int evaluations{};
+
+	while (!m_IsLocalOptimum)
+	{
+		const bool isImproved{ m_Move == Move::TwoOpt ? TryTwoOpt(m_CursorFirst, m_CursorSecond) : TryOrOpt(m_CursorFirst, m_CursorLength, m_CursorSecond) };
+		m_HasImproved = m_HasImproved || isImproved;
+		AdvanceCursor();
+
+		++evaluations;
+		if (m_EvaluationBudget > 0)
+		{
+			if (evaluations >= m_EvaluationBudget) break;
+		}
+		else if (evaluations % g_EvaluationsPerClockCheck == 0 && Clock::now() >= end) break;
+	}
+}
+
+bool HouseRouteOptimizer::GetNextHouse(Elite::Vector2& houseCenter) const
+{
+	if (m_Route.size() < 2) return false;
+
+	houseCenter = m_Houses[m_Route[1]].center;
+	return true;
+}
+
+int HouseRouteOptimizer::GetRoutePosition(const Elite::Vector2& houseCenter) const
+{
+	const int house{ FindHouse(houseCenter) };
+	if (house == -1 || !m_Houses[house].isOnRoute) return -1;
+
+	auto foundIt = std::find(m_Route.begin(), m_Route.end(), house);
+	return int(foundIt - m_Route.begin()) - 1;
+}
+
+void HouseRouteOptimizer::GetRoute(std::vector<Elite::Vector2>& houseCenters) const
+{
+	houseCenters.clear();
+	for (size_t i{ 1 }; i < m_Route.size(); ++i) houseCenters.push_back(m_Houses[m_Route[i]].center);
+}
+
+float HouseRouteOptimizer::GetRouteCost() const
+{
+	float cost{};
+	for (size_t i{ 1 }; i < m_Route.size(); ++i) cost += GetRouteCost(i - 1, i);
+	return cost;
+}
+
+int HouseRouteOptimizer::FindHouse(const Elite::Vector2& houseCenter) const
+{
+	const float sameHouseMargin{ 1.f };
+	auto foundIt = std::find_if(m_Houses.begin(), m_Houses.end(), [&houseCenter, sameHouseMargin](const House& house) {
+		return Elite::DistanceSquared(house.center, houseCenter) <= sameHouseMargin * sameHouseMargin;
+	});
+	if (foundIt == m_Houses.end()) return -1;
+	return int(foundIt - m_Houses.begin());
+}
+
+float HouseRouteOptimizer::GetValue(int house) const
+{
+	if (house == m_AgentNode) return 1.f;
+
+	const House& info{ m_Houses[house] };
+	const float staleness{ std::min<float>(info.timeSinceVisit / m_RevisitTime, g_MaxStaleness) };
+	return std::max<float>(info.lootExpectation * staleness, 0.01f);
+}
+
+float HouseRouteOptimizer::GetCost(int from, int to) const
+{
+	//Symmetric, so reversing a part of the route keeps its cost
+	const Elite::Vector2& fromPosition{ from == m_AgentNode ? m_AgentPosition : m_Houses[from].center };
+	const Elite::Vector2& toPosition{ to == m_AgentNode ? m_AgentPosition : m_Houses[to].center };
+	return Elite::Distance(fromPosition, toPosition) / sqrtf(GetValue(from) * GetValue(to));
+}
+
+float HouseRouteOptimizer::GetRouteCost(size_t index, size_t nextIndex) const
+{
+	//The route is open ended, there is no leg after the last house
+	if (nextIndex >= m_Route.size()) return 0.f;
+	return GetCost(m_Route[index], m_Route[nextIndex]);
+}
+
+bool HouseRouteOptimizer::IsDue(int house) const
+{
+	return m_Houses[house].timeSinceVisit >= m_RevisitTime;
+}
+
+void HouseRouteOptimizer::AddDueHouses()
+{
+	std::vector<int> dueHouses{};
+	for (int i{}; i < int(m_Houses.size()); ++i)
+	{
+		if (!m_Houses[i].isOnRoute && IsDue(i)) dueHouses.push_back(i);
+	}
+	if (dueHouses.empty()) return;
+
+	//Many new houses at once get a fresh construction, a few get slotted into the existing route
+	const size_t housesOnRoute{ m_Route.size() - 1 };
+	if (dueHouses.size() > 1 && dueHouses.size() * 4 > housesOnRoute)
+	{
+		BuildNearestNeighbour();
+	}
+	else
+	{
+		for (int house : dueHouses) InsertCheapest(house);
+	}
+
+	Restart();
+}
+
+void HouseRouteOptimizer::InsertCheapest(int house)
+{
+	size_t bestIndex{ m_Route.size() };
+	float bestCost{ GetCost(m_Route.back(), house) };
+	for (size_t i{ 1 }; i < m_Route.size(); ++i)
+	{
+		const float cost{ GetCost(m_Route[i - 1], house) + GetCost(house, m_Route[i]) - GetRouteCost(i - 1, i) };
+		if (cost < bestCost)
+		{
+			bestCost = cost;
+			bestIndex = i;
+		}
+	}
+
+	m_Route.insert(m_Route.begin() + bestIndex, house);
+	m_Houses[house].isOnRoute = true;
+}
+
+void HouseRouteOptimizer::RemoveFromRoute(int house)
+{
+	m_Route.erase(std::remove(m_Route.begin(), m_Route.end(), house), m_Route.end());
+	m_Houses[house].isOnRoute = false;
+	Restart();
+}
+
+void HouseRouteOptimizer::BuildNearestNeighbour()
+{
+	m_Route.clear();
+	m_Route.push_back(m_AgentNode);
+
+	std::vector<int> remaining{};
+	for (int i{}; i < int(m_Houses.size()); ++i)
+	{
+		m_Houses[i].isOnRoute = false;
+		if (IsDue(i)) remaining.push_back(i);
+	}
+
+	while (!remaining.empty())
+	{
+		const int current{ m_Route.back() };
+		auto nearestIt = std::min_element(remaining.begin(), remaining.end(), [this, current](int left, int right) {
+			return GetCost(current, left) < GetCost(current, right);
+		});
+
+		m_Route.push_back(*nearestIt);
+		m_Houses[*nearestIt].isOnRoute = true;
+		*nearestIt = remaining.back();
+		remaining.pop_back();
+	}
+}
+
+bool HouseRouteOptimizer::TryTwoOpt(size_t first, size_t last)
+{
+	//Reverse [first, last], the agent at index 0 never moves
+	const size_t routeSize{ m_Route.size() };
+	if (first < 1 || last <= first || last >= routeSize) return false;
+
+	const float before{ GetRouteCost(first - 1, first) + GetRouteCost(last, last + 1) };
+	float after{ GetCost(m_Route[first - 1], m_Route[last]) };
+	if (last + 1 < routeSize) after += GetCost(m_Route[first], m_Route[last + 1]);
+	if (after >= before - g_MinImprovement) return false;
+
+	std::reverse(m_Route.begin() + first, m_Route.begin() + last + 1);
+	return true;
+}
+
+bool HouseRouteOptimizer::TryOrOpt(size_t first, size_t length, size_t insertAfter)
+{
+	//Move [first, last] in between insertAfter and the house after it, possibly reversed
+	const size_t routeSize{ m_Route.size() };
+	const size_t last{ first + length - 1 };
+	if (first < 1 || last >= routeSize || insertAfter >= routeSize) return false;
+	if (insertAfter + 1 >= first && insertAfter <= last) return false;
+
+	const int segmentFirst{ m_Route[first] }, segmentLast{ m_Route[last] };
+	float removeGain{ GetRouteCost(first - 1, first) + GetRouteCost(last, last + 1) };
+	if (last + 1 < routeSize) removeGain -= GetCost(m_Route[first - 1], m_Route[last + 1]);
+
+	const int before{ m_Route[insertAfter] };
+	const bool hasAfter{ insertAfter + 1 < routeSize };
+	const int after{ hasAfter ? m_Route[insertAfter + 1] : m_AgentNode };
+	const float brokenCost{ hasAfter ? GetCost(before, after) : 0.f };
+	const float forwardCost{ GetCost(before, segmentFirst) + (hasAfter ? GetCost(segmentLast, after) : 0.f) - brokenCost };
+	const float reversedCost{ GetCost(before, segmentLast) + (hasAfter ? GetCost(segmentFirst, after) : 0.f) - brokenCost };
+	const bool isReversed{ reversedCost < forwardCost };
+	if (std::min<float>(forwardCost, reversedCost) >= removeGain - g_MinImprovement) return false;
+
+	int segment[g_MaxOrOptLength]{};
+	std::copy(m_Route.begin() + first, m_Route.begin() + last + 1, segment);
+	if (isReversed) std::reverse(segment, segment + length);
+
+	m_Route.erase(m_Route.begin() + first, m_Route.begin() + last + 1);
+	const size_t insertIndex{ insertAfter > last ? insertAfter - length + 1 : insertAfter + 1 };
+	m_Route.insert(m_Route.begin() + insertIndex, segment, segment + length);
+	return true;
+}
+
+void HouseRouteOptimizer::AdvanceCursor()
+{
+	const size_t routeSize{ m_Route.size() };
+	bool isPassDone{ false };
+
+	if (m_Move == Move::TwoOpt)
+	{
+		if (++m_CursorSecond >= routeSize)
+		{
+			++m_CursorFirst;
+			m_CursorSecond = m_CursorFirst + 1;
+		}
+		isPassDone = m_CursorFirst + 1 >= routeSize;
+	}
+	else
+	{
+		if (++m_CursorSecond >= routeSize)
+		{
+			m_CursorSecond = 0;
+			if (++m_CursorLength > g_MaxOrOptLength || m_CursorFirst + m_CursorLength > routeSize)
+			{
+				m_CursorLength = 1;
+				++m_CursorFirst;
+			}
+		}
+		isPassDone = m_CursorFirst >= routeSize;
+	}
+
+	if (!isPassDone) return;
+
+	//2-opt pass, then Or-opt pass, repeated until a full round finds nothing better
+	if (m_Move == Move::TwoOpt)
+	{
+		m_Move = Move::OrOpt;
+		m_CursorFirst = 1;
+		m_CursorLength = 1;
+		m_CursorSecond = 0;
+		return;
+	}
+
+	const bool hasImproved{ m_HasImproved };
+	Restart();
+	if (hasImproved) return;
+
+	m_IsLocalOptimum = true;
+	m_OptimizedFrom = m_AgentPosition;
+}
+
+void HouseRouteOptimizer::Restart()
+{
+	m_Move = Move::TwoOpt;
+	m_CursorFirst = 1;
+	m_CursorSecond = 2;
+	m_CursorLength = 1;
+	m_HasImproved = false;
+	m_IsLocalOptimum = false;
+}
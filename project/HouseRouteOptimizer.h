@@ -0,0 +1,82 @@
+#pragma once
+#include "Exam_HelperStructs.h"
+
+//Keeps a visiting order over every known house that is due for a (re)visit.
+//The route starts at the agent and is built with nearest neighbour, then improved with 2-opt and Or-opt moves
+//in small time slices, so the best route found so far can be asked for at any moment.
+//Edges between valuable houses (long unvisited, lots of loot expected) are cheaper, so those get grouped up front.
+class HouseRouteOptimizer final
+{
+public:
+	explicit HouseRouteOptimizer(float revisitTime = 120.f);
+	~HouseRouteOptimizer() = default;
+	HouseRouteOptimizer(const HouseRouteOptimizer&) = delete;
+	HouseRouteOptimizer& operator=(const HouseRouteOptimizer&) = delete;
+	HouseRouteOptimizer(HouseRouteOptimizer&&) = delete;
+	HouseRouteOptimizer& operator=(HouseRouteOptimizer&&) = delete;
+
+	void AddHouse(const HouseInfo& house, float lootExpectation = 1.f);
+	void SetLootExpectation(const Elite::Vector2& houseCenter, float lootExpectation);
+	void MarkVisited(const Elite::Vector2& houseCenter);
+
+	//Ages the houses and puts those that are due again back on the route
+	void Update(float dt, const Elite::Vector2& agentPosition);
+	//Spends at most timeBudget seconds improving the route, picks up where the previous call stopped
+	void Improve(float timeBudget);
+	//Counts moves instead of looking at the clock when above 0, so the same game always gets the same route
+	void SetEvaluationBudget(int evaluations) { m_EvaluationBudget = evaluations; }
+
+	bool GetNextHouse(Elite::Vector2& houseCenter) const;
+	//Position of the house on the route, -1 when it is not on it
+	int GetRoutePosition(const Elite::Vector2& houseCenter) const;
+	void GetRoute(std::vector<Elite::Vector2>& houseCenters) const;
+	float GetRouteCost() const;
+	bool IsLocalOptimum() const { return m_IsLocalOptimum; }
+
+private:
+	struct House
+	{
+		Elite::Vector2 center;
+		float lootExpectation;
+		float timeSinceVisit;
+		bool isOnRoute;
+	};
+
+	enum class Move
+	{
+		TwoOpt,
+		OrOpt
+	};
+
+	int FindHouse(const Elite::Vector2& houseCenter) const;
+	float GetValue(int house) const;
+	float GetCost(int from, int to) const;
+	float GetRouteCost(size_t index, size_t nextIndex) const;
+	bool IsDue(int house) const;
+	void AddDueHouses();
+	void InsertCheapest(int house);
+	void RemoveFromRoute(int house);
+	void BuildNearestNeighbour();
+
+	bool TryTwoOpt(size_t first, size_t last);
+	bool TryOrOpt(size_t first, size_t length, size_t insertAfter);
+	void AdvanceCursor();
+	void Restart();
+
+	static const int m_AgentNode{ -1 };
+
+	std::vector<House> m_Houses{};
+	std::vector<int> m_Route{}; //Starts with m_AgentNode
+	Elite::Vector2 m_AgentPosition{};
+	Elite::Vector2 m_OptimizedFrom{}; //Agent position the current local optimum was reached at
+	float m_RevisitTime{};
+
+	//Improvement cursor, resumed every time slice
+	Move m_Move{ Move::TwoOpt };
+	size_t m_CursorFirst{ 1 };
+	size_t m_CursorSecond{ 2 };
+	size_t m_CursorLength{ 1 };
+	bool m_HasImproved{ false };
+	bool m_IsLocalOptimum{ true };
+	int m_EvaluationBudget{};
+};
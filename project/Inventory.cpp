@@ -2,12 +2,32 @@
 #include "Inventory.h"
 #include "IExamInterface.h"
 
-int Inventory::m_AmountOfItems{ 5 };
+namespace
+{
+	int BitCount(uint32_t bits)
+	{
+		int count{};
+		for (; bits != 0; bits &= bits - 1) ++count;
+		return count;
+	}
+
+	int LowestBit(uint32_t bits)
+	{
+		if (bits == 0) return -1;
+
+		int index{};
+		for (; (bits & 1u) == 0; bits >>= 1) ++index;
+		return index;
+	}
+}
+
+const int Inventory::m_TypeCount;
 
 Inventory::Inventory(IExamInterface* pInterface)
 	: m_pInterface{pInterface}
 {
 	m_AmountOfItems = m_pInterface->Inventory_GetCapacity();
+	assert(m_AmountOfItems <= 32 && "Slots are kept in 32 bit masks");
 	for (int i = 0; i < m_AmountOfItems; i++)
 	{
 		ItemSlot itemSlot{};
@@ -15,15 +35,16 @@ Inventory::Inventory(IExamInterface* pInterface)
 		itemSlot.inUse = false;
 		m_Items.push_back(itemSlot);
 	}
+	std::fill(m_BestSlots, m_BestSlots + m_TypeCount, -1);
 }
 
 void Inventory::GrabItem(int id, const EntityInfo& entityInfo)
 {
-	m_Items[id].inUse = true;
 	ItemInfo itemInfo{};
-	m_pInterface->Item_Grab(entityInfo, itemInfo);
-	m_Items[id].itemType = itemInfo.Type;
-	m_pInterface->Inventory_AddItem(UINT(id), itemInfo);
+	if (!m_pInterface->Item_Grab(entityInfo, itemInfo) || !m_pInterface->Inventory_AddItem(UINT(id), itemInfo)) return;
+
+	//The only time the value is read, after that the shadow follows every use
+	SetSlot(id, true, itemInfo.Type, ReadValue(itemInfo));
 }
 
 void Inventory::UseItem(int id)
@@ -34,20 +55,26 @@ void Inventory::UseItem(int id)
 	case eItemType::FOOD:
 	case eItemType::MEDKIT:
 		m_pInterface->Inventory_RemoveItem(UINT(id));
-		m_Items[id].inUse = false;
+		SetSlot(id, false, m_Items[id].itemType, 0);
 		break;
 	case eItemType::PISTOL:
+	{
 		ItemInfo gun{};
 		m_pInterface->Inventory_GetItem(UINT(id), gun);
 		int ammo = m_pInterface->Weapon_GetAmmo(gun);
 		if (ammo <= 0)
 		{
 			m_pInterface->Inventory_RemoveItem(UINT(id));
-			m_Items[id].inUse = false;
+			SetSlot(id, false, eItemType::PISTOL, 0);
 		}
+		else if (m_Items[id].inUse) SetSlot(id, true, eItemType::PISTOL, ammo);
 		break;
 	}
-	
+	default:
+		//Garbage is never picked up, so it can't be used
+		break;
+	}
+
 }
 
 void Inventory::RemoveItem(int id)
@@ -55,98 +82,131 @@ void Inventory::RemoveItem(int id)
 	if (!m_Items[id].inUse) return;
 
 	m_pInterface->Inventory_RemoveItem(UINT(id));
-	m_Items[id].inUse = false;
+	SetSlot(id, false, m_Items[id].itemType, 0);
 }
 
 int Inventory::GetAmountOfItemsInInventory() const
 {
-	int filledSpaces{};
-	for (int i = 0; i < m_AmountOfItems; i++)
-	{
-		if (m_Items[i].inUse) filledSpaces++;
-	}
-	return filledSpaces;
+	return BitCount(m_UsedMask);
 }
 
 int Inventory::GetFirstEmptySpace() const
 {
-	for (int i = 0; i < m_AmountOfItems; i++)
-	{
-		if (!m_Items[i].inUse) return i;
-	}
-
-	return -1;
+	const uint32_t slotsMask{ m_AmountOfItems >= 32 ? ~0u : (1u << m_AmountOfItems) - 1 };
+	return LowestBit(~m_UsedMask & slotsMask);
 }
 
 int Inventory::GetAmountOfItemsHeldOfType(const eItemType& itemType) const
 {
-	int amountOfItemsHeld{};
-	for (int i = 0; i < m_AmountOfItems; i++)
+	if (int(itemType) >= m_TypeCount) return 0;
+	return BitCount(m_TypeMasks[int(itemType)]);
+}
+
+int Inventory::GetDuplicateSlot() const
+{
+	int duplicateSlot{ -1 };
+	for (eItemType itemType : { eItemType::FOOD, eItemType::MEDKIT, eItemType::PISTOL })
 	{
-		if (m_Items[i].inUse && m_Items[i].itemType == itemType) amountOfItemsHeld++;
+		//Without its lowest bit, the lowest one left is the second slot of the type
+		const uint32_t mask{ m_TypeMasks[int(itemType)] };
+		const int slot{ LowestBit(mask & (mask - 1)) };
+		if (slot >= 0 && (duplicateSlot < 0 || slot < duplicateSlot)) duplicateSlot = slot;
 	}
-	return amountOfItemsHeld;
+	return duplicateSlot;
 }
 
 bool Inventory::GetHealthpack(int& slotId, float agentHealth, bool ignoreAgentHealth) const
 {
-	int lowestHealthRestore = INT_MAX;
+	return GetBestSlot(eItemType::MEDKIT, slotId, agentHealth, ignoreAgentHealth);
+}
+
+bool Inventory::GetFood(int& slotId, float agentFood, bool ignoreAgentEnergy) const
+{
+	return GetBestSlot(eItemType::FOOD, slotId, agentFood, ignoreAgentEnergy);
+}
+
+bool Inventory::GetPistol(int& slotId) const
+{
+	return GetBestSlot(eItemType::PISTOL, slotId, 0.f, true);
+}
+
+int Inventory::Validate()
+{
+	int mismatches{};
 	for (int i = 0; i < m_AmountOfItems; i++)
 	{
-		if (m_Items[i].inUse && m_Items[i].itemType == eItemType::MEDKIT)
-		{
-			ItemInfo medkit{};
-			m_pInterface->Inventory_GetItem(UINT(i), medkit);
-			int healthRestore = m_pInterface->Medkit_GetHealth(medkit);
-			if (healthRestore < lowestHealthRestore && (healthRestore + agentHealth <= 10.f || ignoreAgentHealth))
-			{
-				lowestHealthRestore = healthRestore;
-				slotId = i;
-			}
-		}
+		ItemInfo item{};
+		const bool inUse{ m_pInterface->Inventory_GetItem(UINT(i), item) };
+		const int value{ inUse ? ReadValue(item) : 0 };
+		const ItemSlot& slot{ m_Items[i] };
+		if (slot.inUse == inUse && (!inUse || (slot.itemType == item.Type && slot.value == value))) continue;
+
+		std::cout << "Inventory slot " << i << " is out of sync with the host" << '\n';
+		SetSlot(i, inUse, inUse ? item.Type : slot.itemType, value);
+		++mismatches;
 	}
+	return mismatches;
+}
 
-	return slotId >= 0 && slotId <= m_AmountOfItems;
+int Inventory::GetLowestValue(eItemType itemType) const
+{
+	if (int(itemType) >= m_TypeCount) return 0;
+
+	const int bestSlot{ m_BestSlots[int(itemType)] };
+	return bestSlot >= 0 ? m_Items[bestSlot].value : 0;
 }
 
-bool Inventory::GetFood(int& slotId, float agentFood, bool ignoreAgentEnergy) const
+int Inventory::ReadValue(const ItemInfo& item) const
 {
-	int lowestFoodRestore = INT_MAX;
-	for (int i = 0; i < m_AmountOfItems; i++)
+	ItemInfo itemInfo{ item };
+	switch (item.Type)
 	{
-		if (m_Items[i].inUse && m_Items[i].itemType == eItemType::FOOD)
-		{
-			ItemInfo food{};
-			m_pInterface->Inventory_GetItem(UINT(i), food);
-			int foodRestore = m_pInterface->Food_GetEnergy(food);
-			if (foodRestore < lowestFoodRestore && (foodRestore + agentFood <= 10.f || ignoreAgentEnergy))
-			{
-				lowestFoodRestore = foodRestore;
-				slotId = i;
-			}
-		}
+	case eItemType::PISTOL:
+		return m_pInterface->Weapon_GetAmmo(itemInfo);
+	case eItemType::MEDKIT:
+		return m_pInterface->Medkit_GetHealth(itemInfo);
+	case eItemType::FOOD:
+		return m_pInterface->Food_GetEnergy(itemInfo);
+	default:
+		return 0;
 	}
+}
 
-	return slotId >= 0 && slotId <= m_AmountOfItems;
+void Inventory::SetSlot(int id, bool inUse, eItemType itemType, int value)
+{
+	ItemSlot& slot{ m_Items[id] };
+	const bool wasInUse{ slot.inUse };
+	const eItemType previousType{ slot.itemType };
+	slot.inUse = inUse;
+	slot.itemType = itemType;
+	slot.value = value;
+
+	const uint32_t bit{ 1u << id };
+	m_UsedMask = inUse ? m_UsedMask | bit : m_UsedMask & ~bit;
+	for (uint32_t& typeMask : m_TypeMasks) typeMask &= ~bit;
+	if (inUse && int(itemType) < m_TypeCount) m_TypeMasks[int(itemType)] |= bit;
+
+	if (wasInUse && int(previousType) < m_TypeCount) UpdateBestSlot(previousType);
+	if (inUse && int(itemType) < m_TypeCount) UpdateBestSlot(itemType);
 }
 
-bool Inventory::GetPistol(int& slotId) const
+void Inventory::UpdateBestSlot(eItemType itemType)
 {
-	int lowestAmmoPistol = INT_MAX;
-	for (int i = 0; i < m_AmountOfItems; i++)
+	//Lowest value, the first slot on a tie
+	int& bestSlot{ m_BestSlots[int(itemType)] };
+	bestSlot = -1;
+	for (uint32_t mask{ m_TypeMasks[int(itemType)] }; mask != 0; mask &= mask - 1)
 	{
-		if (m_Items[i].inUse && m_Items[i].itemType == eItemType::PISTOL)
-		{
-			ItemInfo pistol{};
-			m_pInterface->Inventory_GetItem(UINT(i), pistol);
-			int ammo = m_pInterface->Weapon_GetAmmo(pistol);
-			if (ammo < lowestAmmoPistol)
-			{
-				lowestAmmoPistol = ammo;
-				slotId = i;
-			}
-		}
+		const int slot{ LowestBit(mask) };
+		if (bestSlot < 0 || m_Items[slot].value < m_Items[bestSlot].value) bestSlot = slot;
 	}
+}
+
+bool Inventory::GetBestSlot(eItemType itemType, int& slotId, float agentValue, bool ignoreAgentValue) const
+{
+	//Nothing can be used when the lowest one restores too much already
+	const int bestSlot{ m_BestSlots[int(itemType)] };
+	if (bestSlot >= 0 && (m_Items[bestSlot].value + agentValue <= 10.f || ignoreAgentValue)) slotId = bestSlot;
 
 	return slotId >= 0 && slotId <= m_AmountOfItems;
 }
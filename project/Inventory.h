@@ -3,6 +3,10 @@
 
 class IExamInterface;
 
+//Keeps a shadow copy of every slot (type and ammo, health or energy) next to the host's inventory.
+//The shadow only changes when the agent grabs, uses or removes an item, so queries never go through the interface.
+//Per type there is a bitmask of the slots holding it and the slot with the lowest value, which is all the
+//"best slot of type" queries need. Validate cross-checks the shadow against the host.
 class Inventory final
 {
 public:
@@ -17,23 +21,40 @@ public:
 	void UseItem(int id);
 	void RemoveItem(int id);
 
+	int GetCapacity() const { return m_AmountOfItems; }
 	int GetAmountOfItemsInInventory() const;
 	int GetFirstEmptySpace() const;
 	int GetAmountOfItemsHeldOfType(const eItemType& itemType) const;
+	int GetDuplicateSlot() const; //Second slot holding a type that is held more than once, -1 if there is none
+	int GetLowestValue(eItemType itemType) const; //Value of the slot the "best slot" queries give, 0 if none is held
+	int ReadValue(const ItemInfo& item) const; //Ammo, health or energy of any item, also one on the ground
 
 	bool GetHealthpack(int& slotId, float agentHealth, bool ignoreAgentHealth = false) const;
 	bool GetFood(int& slotId, float agentFood, bool ignoreAgentEnergy = false) const;
 	bool GetPistol(int& slotId) const;
+
+	//Compares every slot with the host and takes the host's over when they differ, returns the amount of slots that did
+	int Validate();
+
 private:
 	struct ItemSlot
 	{
 		int id;
 		eItemType itemType;
 		bool inUse;
+		int value; //Ammo, health or energy
 	};
-	static int m_AmountOfItems;
+	int m_AmountOfItems{ 5 }; //Per inventory, every plugin instance reads its own host
+	static const int m_TypeCount{ int(eItemType::_LAST) + 1 };
+
+	void SetSlot(int id, bool inUse, eItemType itemType, int value);
+	void UpdateBestSlot(eItemType itemType);
+	//Best (lowest value) slot of the type if it can be used
+	bool GetBestSlot(eItemType itemType, int& slotId, float agentValue, bool ignoreAgentValue) const;
 
 	IExamInterface* m_pInterface = nullptr;
 	std::vector<ItemSlot> m_Items{};
+	uint32_t m_UsedMask{};
+	uint32_t m_TypeMasks[m_TypeCount]{};
+	int m_BestSlots[m_TypeCount]{};
 };
-
@@ -0,0 +1,155 @@
+#include "stdafx.h"
+#include "InventoryOptimizer.h"
+
+const int InventoryOptimizer::m_TypeCount;
+const int InventoryOptimizer::m_NeedLevels;
+const int InventoryOptimizer::m_ValueLevels;
+
+InventoryOptimizer::InventoryOptimizer(int capacity)
+	: m_Capacity{ capacity }
+{
+	const size_t countStates{ size_t(m_Capacity + 1) * size_t(m_Capacity + 1) };
+	const size_t valueStates{ size_t(m_ValueLevels) * m_ValueLevels * m_ValueLevels * m_ValueLevels };
+	m_Table.resize(countStates * m_TypeCount * valueStates * m_NeedLevels * m_NeedLevels, uint8_t(int(Action::Discard) * m_TypeCount));
+
+	//Every full inventory, the food is whatever the pistols and medkits leave
+	for (int pistols{}; pistols <= m_Capacity; ++pistols)
+	{
+		for (int medkits{}; pistols + medkits <= m_Capacity; ++medkits)
+		{
+			const int counts[m_TypeCount]{ pistols, medkits, m_Capacity - pistols - medkits };
+			for (int newItemType{}; newItemType < m_TypeCount; ++newItemType)
+			{
+				for (int newValueLevel{}; newValueLevel < m_ValueLevels; ++newValueLevel)
+				{
+					for (int weakestState{}; weakestState < m_ValueLevels * m_ValueLevels * m_ValueLevels; ++weakestState)
+					{
+						const int weakestLevels[m_TypeCount]{ weakestState % m_ValueLevels, weakestState / m_ValueLevels % m_ValueLevels, weakestState / (m_ValueLevels * m_ValueLevels) };
+						for (int healthNeed{}; healthNeed < m_NeedLevels; ++healthNeed)
+						{
+							for (int energyNeed{}; energyNeed < m_NeedLevels; ++energyNeed)
+							{
+								const Decision decision{ Search(counts, weakestLevels, newItemType, newValueLevel, healthNeed, energyNeed) };
+								m_Table[GetIndex(pistols, medkits, newItemType, newValueLevel, weakestLevels, healthNeed, energyNeed)] =
+									uint8_t(int(decision.action) * m_TypeCount + int(decision.slotType));
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+InventoryOptimizer::Decision InventoryOptimizer::Decide(const Inventory& inventory, eItemType newItemType, int newItemValue, const AgentInfo& agentInfo) const
+{
+	int counts[m_TypeCount]{};
+	int weakestLevels[m_TypeCount]{};
+	for (int type{}; type < m_TypeCount; ++type)
+	{
+		counts[type] = inventory.GetAmountOfItemsHeldOfType(eItemType(type));
+		weakestLevels[type] = GetValueLevel(type, inventory.GetLowestValue(eItemType(type)));
+	}
+	assert(counts[0] + counts[1] + counts[2] == m_Capacity && "Only decides for a full inventory");
+	if (int(newItemType) >= m_TypeCount || counts[0] + counts[1] > m_Capacity) return Decision{ Action::Discard, eItemType::PISTOL };
+
+	const int newValueLevel{ GetValueLevel(int(newItemType), newItemValue) };
+	const uint8_t entry{ m_Table[GetIndex(counts[0], counts[1], int(newItemType), newValueLevel, weakestLevels, GetNeedLevel(agentInfo.Health), GetNeedLevel(agentInfo.Energy))] };
+	return Decision{ Action(entry / m_TypeCount), eItemType(entry % m_TypeCount) };
+}
+
+int InventoryOptimizer::GetNeedLevel(float stat)
+{
+	//Out of 10
+	const float missing{ 10.f - stat };
+	if (missing < 3.f) return 0;
+	if (missing < 6.f) return 1;
+	return 2;
+}
+
+int InventoryOptimizer::GetValueLevel(int type, int value) const
+{
+	int level{};
+	while (level < m_ValueLevels - 1 && value >= m_ValueThresholds[type][level]) ++level;
+	return level;
+}
+
+size_t InventoryOptimizer::GetIndex(int pistols, int medkits, int newItemType, int newValueLevel, const int* pWeakestLevels, int healthNeed, int energyNeed) const
+{
+	size_t index{ size_t(pistols) * size_t(m_Capacity + 1) + size_t(medkits) };
+	index = index * m_TypeCount + newItemType;
+	index = index * m_ValueLevels + newValueLevel;
+	for (int type{}; type < m_TypeCount; ++type) index = index * m_ValueLevels + pWeakestLevels[type];
+	return (index * m_NeedLevels + healthNeed) * m_NeedLevels + energyNeed;
+}
+
+InventoryOptimizer::Decision InventoryOptimizer::Search(const int* pCounts, const int* pWeakestLevels, int newItemType, int newValueLevel, int healthNeed, int energyNeed) const
+{
+	float weakestFactors[m_TypeCount]{};
+	for (int type{}; type < m_TypeCount; ++type) weakestFactors[type] = m_ValueFactors[pWeakestLevels[type]];
+	const float newFactor{ m_ValueFactors[newValueLevel] };
+
+	//Slots holding the same type only differ in value and the weakest one is always the one given up,
+	//so every action is tried once per type held
+	Decision best{ Action::Discard, eItemType::PISTOL };
+	float bestValue{ GetUtility(pCounts, weakestFactors, -1, 0.f) };
+	for (int type{}; type < m_TypeCount; ++type)
+	{
+		if (pCounts[type] <= 0) continue;
+
+		int counts[m_TypeCount]{};
+		float factors[m_TypeCount]{};
+		std::copy(pCounts, pCounts + m_TypeCount, counts);
+		std::copy(weakestFactors, weakestFactors + m_TypeCount, factors);
+		--counts[type];
+		factors[type] = std::max<float>(1.f, weakestFactors[type]);
+		const float value{ GetUtility(counts, factors, newItemType, newFactor) };
+
+		//A pistol can only be dropped, using it fires it
+		const eItemType itemType{ eItemType(type) };
+		const int need{ itemType == eItemType::MEDKIT ? healthNeed : itemType == eItemType::FOOD ? energyNeed : -1 };
+		const float useBenefit{ need >= 0 ? m_UseBenefits[need] * weakestFactors[type] : 0.f };
+		if (need >= 0 && value + useBenefit > bestValue)
+		{
+			best = Decision{ Action::Use, itemType };
+			bestValue = value + useBenefit;
+		}
+		else if (need < 0 && value > bestValue)
+		{
+			best = Decision{ Action::Drop, itemType };
+			bestValue = value;
+		}
+	}
+	return best;
+}
+
+float InventoryOptimizer::GetUtility(const int* pCounts, const float* pWeakestFactors, int newItemType, float newFactor) const
+{
+	float utility{};
+	for (int type{}; type < m_TypeCount; ++type)
+	{
+		utility += GetTypeUtility(pCounts[type], pWeakestFactors[type], type == newItemType ? newFactor : 0.f);
+	}
+	return utility;
+}
+
+float InventoryOptimizer::GetTypeUtility(int count, float weakestFactor, float newFactor) const
+{
+	//Only the weakest item of a type is known, the others hold at least as much and count as average or better.
+	//The fullest items are worth the most, the decay goes to the emptier ones.
+	float known[2]{};
+	int knownCount{};
+	if (count > 0) known[knownCount++] = weakestFactor;
+	if (newFactor > 0.f) known[knownCount++] = newFactor;
+	if (knownCount == 2 && known[1] > known[0]) std::swap(known[0], known[1]);
+	const float othersFactor{ std::max<float>(1.f, weakestFactor) };
+	const int others{ std::max<int>(0, count - 1) };
+
+	float utility{};
+	float worth{ 1.f };
+	int nextKnown{};
+	for (; nextKnown < knownCount && known[nextKnown] > othersFactor; ++nextKnown, worth *= m_Decay) utility += worth * known[nextKnown];
+	for (int i{}; i < others; ++i, worth *= m_Decay) utility += worth * othersFactor;
+	for (; nextKnown < knownCount; ++nextKnown, worth *= m_Decay) utility += worth * known[nextKnown];
+	return utility;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "Inventory.h"
+
+//Decides what to give up for a new item when the inventory is full.
+//The model knows how many pistols, medkits and food the inventory holds, how much the weakest one of each type holds
+//and how much the new item holds (three value levels of ammo, health or energy each), the new item's type and how
+//badly the agent needs health and energy (three levels each). Holding more of a type is worth less every time, a
+//fuller item is worth more and using a medkit or food is worth more the more the agent needs it and the more it holds.
+//Every action is searched for every one of those states when the optimizer is built and the best one goes in a table,
+//deciding is an index computation and a lookup.
+class InventoryOptimizer final
+{
+public:
+	enum class Action
+	{
+		Discard, //Keep the inventory as it is and leave the new item on the ground
+		Use, //Use an item of the slot type to make room
+		Drop //Remove the weakest item of the slot type to make room, a swap when it is the new item's type
+	};
+
+	struct Decision
+	{
+		Action action;
+		eItemType slotType;
+	};
+
+	explicit InventoryOptimizer(int capacity);
+	~InventoryOptimizer() = default;
+	InventoryOptimizer(const InventoryOptimizer&) = delete;
+	InventoryOptimizer& operator=(const InventoryOptimizer&) = delete;
+	InventoryOptimizer(InventoryOptimizer&&) = delete;
+	InventoryOptimizer& operator=(InventoryOptimizer&&) = delete;
+
+	//The inventory has to be full, newItemValue is the new item's ammo, health or energy
+	Decision Decide(const Inventory& inventory, eItemType newItemType, int newItemValue, const AgentInfo& agentInfo) const;
+
+	size_t GetTableSize() const { return m_Table.size(); }
+
+private:
+	static const int m_TypeCount{ 3 }; //Pistol, medkit and food, in eItemType order
+	static const int m_NeedLevels{ 3 };
+	static const int m_ValueLevels{ 3 };
+
+	static int GetNeedLevel(float stat);
+	int GetValueLevel(int type, int value) const;
+	size_t GetIndex(int pistols, int medkits, int newItemType, int newValueLevel, const int* pWeakestLevels, int healthNeed, int energyNeed) const;
+	Decision Search(const int* pCounts, const int* pWeakestLevels, int newItemType, int newValueLevel, int healthNeed, int energyNeed) const;
+	float GetUtility(const int* pCounts, const float* pWeakestFactors, int newItemType, float newFactor) const;
+	float GetTypeUtility(int count, float weakestFactor, float newFactor) const;
+
+	int m_Capacity{};
+	std::vector<uint8_t> m_Table{}; //Action * m_TypeCount + slot type, there are a lot of states
+
+	const float m_Decay{ 0.5f }; //Every extra item of a type is worth this much of the one before
+	const float m_UseBenefits[m_NeedLevels]{ 0.f, 0.6f, 1.2f }; //For an average item
+	//Values from the first threshold on are average, from the second one on full, below that the item is nearly empty
+	const int m_ValueThresholds[m_TypeCount][m_ValueLevels - 1]{ { 9, 12 }, { 3, 5 }, { 3, 5 } };
+	const float m_ValueFactors[m_ValueLevels]{ 0.5f, 1.f, 1.5f };
+};
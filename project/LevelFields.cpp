@@ -0,0 +1,362 @@
+#include "stdafx.h"
+#include "LevelFields.h"
+#include <cstring>
+
+namespace
+{
+	const float g_Infinity{ 1e20f };
+	const float g_WallClearance{ 2.f }; //Flow fields prefer to stay this far from walls
+	const float g_WallPenalty{ 2.f };
+	const uint16_t g_Unreachable{ 0xFFFF };
+	const uint8_t g_NoDirection{ 0xFF };
+	const int g_NeighbourColumns[8]{ 1, 1, 0, -1, -1, -1, 0, 1 };
+	const int g_NeighbourRows[8]{ 0, 1, 1, 1, 0, -1, -1, -1 };
+
+	uint32_t AlignOffset(size_t offset)
+	{
+		return uint32_t((offset + 7) & ~size_t(7));
+	}
+
+	template<typename T>
+	void WriteSection(std::vector<char>& data, uint32_t offset, const std::vector<T>& section)
+	{
+		if (section.empty()) return;
+		memcpy(data.data() + offset, section.data(), section.size() * sizeof(T));
+	}
+
+	//Squared distance transform of one line (Felzenszwalb & Huttenlocher), result written back into values
+	void TransformLine(float* pValues, int count, size_t stride, std::vector<float>& line, std::vector<int>& parabolas, std::vector<float>& bounds)
+	{
+		for (int i{}; i < count; ++i) line[i] = pValues[i * stride];
+
+		auto getIntersection = [&line](int right, int left) {
+			return ((line[right] + right * right) - (line[left] + left * left)) / (2.f * (right - left));
+		};
+
+		int parabola{};
+		parabolas[0] = 0;
+		bounds[0] = -FLT_MAX;
+		bounds[1] = FLT_MAX;
+		for (int i{ 1 }; i < count; ++i)
+		{
+			float intersection{ getIntersection(i, parabolas[parabola]) };
+			while (intersection <= bounds[parabola])
+			{
+				--parabola;
+				intersection = getIntersection(i, parabolas[parabola]);
+			}
+
+			++parabola;
+			parabolas[parabola] = i;
+			bounds[parabola] = intersection;
+			bounds[parabola + 1] = FLT_MAX;
+		}
+
+		parabola = 0;
+		for (int i{}; i < count; ++i)
+		{
+			while (bounds[parabola + 1] < i) ++parabola;
+			const int vertex{ parabolas[parabola] };
+			pValues[i * stride] = float((i - vertex) * (i - vertex)) + line[vertex];
+		}
+	}
+
+	void TransformGrid(std::vector<float>& values, int columns, int rows)
+	{
+		const int longest{ std::max<int>(columns, rows) };
+		std::vector<float> line(longest), bounds(longest + 1);
+		std::vector<int> parabolas(longest);
+		for (int column{}; column < columns; ++column) TransformLine(values.data() + column, rows, size_t(columns), line, parabolas, bounds);
+		for (int row{}; row < rows; ++row) TransformLine(values.data() + size_t(row) * columns, columns, 1, line, parabolas, bounds);
+	}
+}
+
+const int LevelFields::m_FlowFieldCount;
+const uint32_t LevelFields::m_Magic;
+const uint32_t LevelFields::m_Version;
+
+bool LevelFields::Bake(const LevelIndex& index, const std::string& filePath, float mapCenterRadius)
+{
+	if (!index.IsLoaded()) return false;
+
+	const int columns{ index.GetColumns() }, rows{ index.GetRows() };
+	const size_t cellCount{ size_t(columns) * rows };
+	const float cellSize{ index.GetCellSize() };
+	const Elite::Vector2 worldMin{ index.GetWorldMin() };
+	const Elite::Vector2 worldCenter{ (index.GetWorldMin() + index.GetWorldMax()) * 0.5f };
+
+	std::vector<float> distances{};
+	BakeDistances(index, distances);
+
+	//Safe regions, every walkable cell inside a house, and the walkable cells around the world center
+	std::vector<int> sources[m_FlowFieldCount]{};
+	for (int row{}; row < rows; ++row)
+	{
+		for (int column{}; column < columns; ++column)
+		{
+			if (index.IsCellBlocked(column, row)) continue;
+
+			const int cell{ row * columns + column };
+			const Elite::Vector2 cellCenter{ worldMin.x + (column + 0.5f) * cellSize, worldMin.y + (row + 0.5f) * cellSize };
+			if (index.GetHouseAt(cellCenter) != -1) sources[int(FlowField::HouseInteriors)].push_back(cell);
+			if (Elite::DistanceSquared(cellCenter, worldCenter) <= mapCenterRadius * mapCenterRadius) sources[int(FlowField::MapCenter)].push_back(cell);
+		}
+	}
+
+	std::vector<uint16_t> flowDistances[m_FlowFieldCount]{};
+	std::vector<uint8_t> flowDirections[m_FlowFieldCount]{};
+	for (int field{}; field < m_FlowFieldCount; ++field)
+	{
+		BakeFlowField(index, distances, sources[field], flowDistances[field], flowDirections[field]);
+	}
+
+	std::vector<int16_t> quantizedDistances(cellCount);
+	for (size_t cell{}; cell < cellCount; ++cell)
+	{
+		quantizedDistances[cell] = int16_t(std::max<float>(-32767.f, std::min<float>(32767.f, roundf(distances[cell] * 100.f))));
+	}
+
+	FileHeader header{};
+	header.magic = m_Magic;
+	header.version = m_Version;
+	header.cellSize = cellSize;
+	header.sourceHash = index.GetSourceHash();
+	header.worldMin = worldMin;
+	header.columns = uint32_t(columns);
+	header.rows = uint32_t(rows);
+	header.distanceOffset = AlignOffset(sizeof(FileHeader));
+	size_t offset{ header.distanceOffset + cellCount * sizeof(int16_t) };
+	for (int field{}; field < m_FlowFieldCount; ++field)
+	{
+		header.flowDistanceOffsets[field] = AlignOffset(offset);
+		offset = header.flowDistanceOffsets[field] + cellCount * sizeof(uint16_t);
+	}
+	for (int field{}; field < m_FlowFieldCount; ++field)
+	{
+		header.flowDirectionOffsets[field] = AlignOffset(offset);
+		offset = header.flowDirectionOffsets[field] + cellCount * sizeof(uint8_t);
+	}
+	header.fileSize = AlignOffset(offset);
+
+	std::vector<char> data(header.fileSize, 0);
+	memcpy(data.data(), &header, sizeof(header));
+	WriteSection(data, header.distanceOffset, quantizedDistances);
+	for (int field{}; field < m_FlowFieldCount; ++field)
+	{
+		WriteSection(data, header.flowDistanceOffsets[field], flowDistances[field]);
+		WriteSection(data, header.flowDirectionOffsets[field], flowDirections[field]);
+	}
+
+	return MappedFile::Replace(filePath, data.data(), data.size());
+}
+
+bool LevelFields::Load(const std::string& filePath, const LevelIndex& index)
+{
+	Unload();
+	if (!index.IsLoaded()) return false;
+
+	//Same check as the index, the header has to describe the whole file before it's mapped
+	FileHeader header{};
+	size_t fileSize{};
+	if (!MappedFile::ReadPrefix(filePath, &header, sizeof(header), fileSize) || header.magic != m_Magic || header.version != m_Version ||
+		header.fileSize != fileSize) return false;
+	if (!m_File.Open(filePath)) return false;
+
+	if (m_File.GetSize() < sizeof(FileHeader) || !Validate(m_File.GetData(), m_File.GetSize(), index))
+	{
+		Unload();
+		return false;
+	}
+	return true;
+}
+
+void LevelFields::Unload()
+{
+	m_File.Close();
+	m_pHeader = nullptr;
+	m_pDistances = nullptr;
+	for (int field{}; field < m_FlowFieldCount; ++field)
+	{
+		m_pFlowDistances[field] = nullptr;
+		m_pFlowDirections[field] = nullptr;
+	}
+}
+
+float LevelFields::GetDistance(const Elite::Vector2& position) const
+{
+	if (m_pHeader == nullptr) return FLT_MAX;
+
+	const float x{ (position.x - m_pHeader->worldMin.x) / m_pHeader->cellSize - 0.5f };
+	const float y{ (position.y - m_pHeader->worldMin.y) / m_pHeader->cellSize - 0.5f };
+	const int column{ int(floorf(x)) }, row{ int(floorf(y)) };
+	const float tx{ x - column }, ty{ y - row };
+
+	const float bottom{ GetCellDistance(column, row) * (1.f - tx) + GetCellDistance(column + 1, row) * tx };
+	const float top{ GetCellDistance(column, row + 1) * (1.f - tx) + GetCellDistance(column + 1, row + 1) * tx };
+	return bottom * (1.f - ty) + top * ty;
+}
+
+Elite::Vector2 LevelFields::GetDistanceGradient(const Elite::Vector2& position) const
+{
+	if (m_pHeader == nullptr) return Elite::Vector2{};
+
+	const int column{ int(floorf((position.x - m_pHeader->worldMin.x) / m_pHeader->cellSize)) };
+	const int row{ int(floorf((position.y - m_pHeader->worldMin.y) / m_pHeader->cellSize)) };
+	Elite::Vector2 gradient{
+		GetCellDistance(column + 1, row) - GetCellDistance(column - 1, row),
+		GetCellDistance(column, row + 1) - GetCellDistance(column, row - 1)
+	};
+	if (gradient.SqrtMagnitude() > 0.f) gradient.Normalize();
+	return gradient;
+}
+
+bool LevelFields::GetFlowDirection(FlowField field, const Elite::Vector2& position, Elite::Vector2& direction) const
+{
+	const int cell{ GetCell(position) };
+	if (cell == -1) return false;
+
+	const uint8_t neighbour{ m_pFlowDirections[int(field)][cell] };
+	if (neighbour >= 8) return false;
+
+	direction = Elite::Vector2{ float(g_NeighbourColumns[neighbour]), float(g_NeighbourRows[neighbour]) }.GetNormalized();
+	return true;
+}
+
+float LevelFields::GetFlowDistance(FlowField field, const Elite::Vector2& position) const
+{
+	const int cell{ GetCell(position) };
+	if (cell == -1) return FLT_MAX;
+
+	const uint16_t distance{ m_pFlowDistances[int(field)][cell] };
+	return distance == g_Unreachable ? FLT_MAX : distance * 0.1f;
+}
+
+void LevelFields::BakeDistances(const LevelIndex& index, std::vector<float>& distances)
+{
+	//Squared cell distances to the nearest blocked cell, and for blocked cells to the nearest open cell
+	const int columns{ index.GetColumns() }, rows{ index.GetRows() };
+	const size_t cellCount{ size_t(columns) * rows };
+	std::vector<float> toBlocked(cellCount), toOpen(cellCount);
+	for (int row{}; row < rows; ++row)
+	{
+		for (int column{}; column < columns; ++column)
+		{
+			const bool isBlocked{ index.IsCellBlocked(column, row) };
+			toBlocked[size_t(row) * columns + column] = isBlocked ? 0.f : g_Infinity;
+			toOpen[size_t(row) * columns + column] = isBlocked ? g_Infinity : 0.f;
+		}
+	}
+	TransformGrid(toBlocked, columns, rows);
+	TransformGrid(toOpen, columns, rows);
+
+	//Measured from cell centers, half a cell gets the distance to the edge of the nearest cell
+	const float cellSize{ index.GetCellSize() };
+	distances.resize(cellCount);
+	for (size_t cell{}; cell < cellCount; ++cell)
+	{
+		distances[cell] = toOpen[cell] > 0.f ?
+			-(sqrtf(toOpen[cell]) - 0.5f) * cellSize :
+			(sqrtf(toBlocked[cell]) - 0.5f) * cellSize;
+	}
+}
+
+void LevelFields::BakeFlowField(const LevelIndex& index, const std::vector<float>& distances, const std::vector<int>& sources,
+	std::vector<uint16_t>& flowDistances, std::vector<uint8_t>& flowDirections)
+{
+	//Multi source Dijkstra, 8 way without cutting corners, cells close to walls cost more
+	const int columns{ index.GetColumns() }, rows{ index.GetRows() };
+	const size_t cellCount{ size_t(columns) * rows };
+	const float cellSize{ index.GetCellSize() };
+	std::vector<float> costs(cellCount, FLT_MAX);
+	flowDirections.assign(cellCount, g_NoDirection);
+
+	using QueueEntry = std::pair<float, int>;
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> open{};
+	for (int cell : sources)
+	{
+		costs[cell] = 0.f;
+		open.push(QueueEntry{ 0.f, cell });
+	}
+
+	while (!open.empty())
+	{
+		const QueueEntry entry{ open.top() };
+		open.pop();
+		if (entry.first > costs[entry.second]) continue;
+
+		const int column{ entry.second % columns }, row{ entry.second / columns };
+		for (int neighbour{}; neighbour < 8; ++neighbour)
+		{
+			const int neighbourColumn{ column + g_NeighbourColumns[neighbour] }, neighbourRow{ row + g_NeighbourRows[neighbour] };
+			if (index.IsCellBlocked(neighbourColumn, neighbourRow)) continue;
+
+			const bool isDiagonal{ g_NeighbourColumns[neighbour] != 0 && g_NeighbourRows[neighbour] != 0 };
+			if (isDiagonal && (index.IsCellBlocked(neighbourColumn, row) || index.IsCellBlocked(column, neighbourRow))) continue;
+
+			const int neighbourCell{ neighbourRow * columns + neighbourColumn };
+			const float clearancePenalty{ std::max<float>(0.f, g_WallClearance - distances[neighbourCell]) / g_WallClearance };
+			const float cost{ entry.first + (isDiagonal ? 1.41421356f : 1.f) * cellSize * (1.f + g_WallPenalty * clearancePenalty) };
+			if (cost >= costs[neighbourCell]) continue;
+
+			//Walking from the neighbour back to this cell is the opposite direction
+			costs[neighbourCell] = cost;
+			flowDirections[neighbourCell] = uint8_t((neighbour + 4) % 8);
+			open.push(QueueEntry{ cost, neighbourCell });
+		}
+	}
+
+	flowDistances.resize(cellCount);
+	for (size_t cell{}; cell < cellCount; ++cell)
+	{
+		flowDistances[cell] = costs[cell] == FLT_MAX ? g_Unreachable : uint16_t(std::min<float>(costs[cell] * 10.f, g_Unreachable - 1.f));
+	}
+}
+
+bool LevelFields::Validate(const char* pData, size_t size, const LevelIndex& index)
+{
+	const FileHeader* pHeader{ reinterpret_cast<const FileHeader*>(pData) };
+	if (pHeader->magic != m_Magic || pHeader->version != m_Version || pHeader->fileSize != size) return false;
+
+	//Baked from a different level or grid
+	if (pHeader->sourceHash != index.GetSourceHash() ||
+		pHeader->columns != uint32_t(index.GetColumns()) || pHeader->rows != uint32_t(index.GetRows()) ||
+		pHeader->cellSize != index.GetCellSize() || pHeader->worldMin != index.GetWorldMin()) return false;
+
+	const uint64_t cellCount{ uint64_t(pHeader->columns) * pHeader->rows };
+	auto isSectionValid = [size, cellCount](uint32_t offset, size_t elementSize) {
+		return offset % 8 == 0 && offset >= sizeof(FileHeader) && offset <= size && cellCount <= (size - offset) / elementSize;
+	};
+	if (!isSectionValid(pHeader->distanceOffset, sizeof(int16_t))) return false;
+	for (int field{}; field < m_FlowFieldCount; ++field)
+	{
+		if (!isSectionValid(pHeader->flowDistanceOffsets[field], sizeof(uint16_t)) ||
+			!isSectionValid(pHeader->flowDirectionOffsets[field], sizeof(uint8_t))) return false;
+	}
+
+	m_pHeader = pHeader;
+	m_pDistances = reinterpret_cast<const int16_t*>(pData + pHeader->distanceOffset);
+	for (int field{}; field < m_FlowFieldCount; ++field)
+	{
+		m_pFlowDistances[field] = reinterpret_cast<const uint16_t*>(pData + pHeader->flowDistanceOffsets[field]);
+		m_pFlowDirections[field] = reinterpret_cast<const uint8_t*>(pData + pHeader->flowDirectionOffsets[field]);
+	}
+	return true;
+}
+
+int LevelFields::GetCell(const Elite::Vector2& position) const
+{
+	if (m_pHeader == nullptr) return -1;
+
+	const int column{ int(floorf((position.x - m_pHeader->worldMin.x) / m_pHeader->cellSize)) };
+	const int row{ int(floorf((position.y - m_pHeader->worldMin.y) / m_pHeader->cellSize)) };
+	if (column < 0 || row < 0 || column >= int(m_pHeader->columns) || row >= int(m_pHeader->rows)) return -1;
+	return row * int(m_pHeader->columns) + column;
+}
+
+float LevelFields::GetCellDistance(int column, int row) const
+{
+	//Clamped to the border cells
+	column = std::max<int>(0, std::min<int>(column, int(m_pHeader->columns) - 1));
+	row = std::max<int>(0, std::min<int>(row, int(m_pHeader->rows) - 1));
+	return m_pDistances[size_t(row) * m_pHeader->columns + column] * 0.01f;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include "Exam_HelperStructs.h"
+#include "LevelIndex.h"
+#include "MappedFile.h"
+
+//Per level fields baked from a LevelIndex on its occupancy grid, memory mapped like the index.
+//The signed distance field holds the distance to the nearest wall (negative inside walls) in centimeters.
+//Every flow field holds the walking distance to the nearest cell of a safe region in decimeters and,
+//per cell, which neighbour to walk to, so steering along a field is a single lookup.
+//File layout, all sections 8 byte aligned:
+//	FileHeader
+//	int16[rows * columns]						signed distance
+//	per flow field: uint16[rows * columns]		walking distance, 0xFFFF when unreachable
+//	per flow field: uint8[rows * columns]		neighbour to walk to, 0xFF inside the region or when unreachable
+class LevelFields final
+{
+public:
+	enum class FlowField
+	{
+		HouseInteriors,
+		MapCenter
+	};
+
+	LevelFields() = default;
+	~LevelFields() = default;
+	LevelFields(const LevelFields&) = delete;
+	LevelFields& operator=(const LevelFields&) = delete;
+	LevelFields(LevelFields&&) = delete;
+	LevelFields& operator=(LevelFields&&) = delete;
+
+	static bool Bake(const LevelIndex& index, const std::string& filePath, float mapCenterRadius = 15.f);
+	//Fails when the file is not baked from an index with the same grid
+	bool Load(const std::string& filePath, const LevelIndex& index);
+	void Unload();
+	bool IsLoaded() const { return m_pHeader != nullptr; }
+
+	float GetDistance(const Elite::Vector2& position) const; //Bilinear between cell centers
+	Elite::Vector2 GetDistanceGradient(const Elite::Vector2& position) const; //Points away from the nearest wall
+	bool GetFlowDirection(FlowField field, const Elite::Vector2& position, Elite::Vector2& direction) const;
+	float GetFlowDistance(FlowField field, const Elite::Vector2& position) const; //FLT_MAX when unreachable
+
+private:
+	static const int m_FlowFieldCount{ 2 };
+
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t fileSize;
+		float cellSize;
+		uint64_t sourceHash; //Of the level the index was baked from
+		Elite::Vector2 worldMin;
+		uint32_t columns;
+		uint32_t rows;
+		uint32_t distanceOffset;
+		uint32_t flowDistanceOffsets[m_FlowFieldCount];
+		uint32_t flowDirectionOffsets[m_FlowFieldCount];
+	};
+
+	static const uint32_t m_Magic{ 0x46465047 }; //"GPFF"
+	static const uint32_t m_Version{ 2 };
+
+	static void BakeDistances(const LevelIndex& index, std::vector<float>& distances);
+	static void BakeFlowField(const LevelIndex& index, const std::vector<float>& distances, const std::vector<int>& sources,
+		std::vector<uint16_t>& flowDistances, std::vector<uint8_t>& flowDirections);
+	bool Validate(const char* pData, size_t size, const LevelIndex& index);
+	int GetCell(const Elite::Vector2& position) const; //-1 outside the grid
+	float GetCellDistance(int column, int row) const;
+
+	MappedFile m_File{};
+	const FileHeader* m_pHeader{};
+	const int16_t* m_pDistances{};
+	const uint16_t* m_pFlowDistances[m_FlowFieldCount]{};
+	const uint8_t* m_pFlowDirections[m_FlowFieldCount]{};
+};
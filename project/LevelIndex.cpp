@@ -0,0 +1,449 @@
+#include "stdafx.h"
+#include "LevelIndex.h"
+#include <cstring>
+
+namespace
+{
+	const uint32_t g_MaxWallsPerLeaf{ 4 };
+	const float g_DoorwaySampleStep{ 0.25f };
+	const float g_MinDoorwayWidth{ 1.f };
+
+	uint32_t AlignOffset(size_t offset)
+	{
+		return uint32_t((offset + 7) & ~size_t(7));
+	}
+
+	template<typename T>
+	void WriteSection(std::vector<char>& data, uint32_t offset, const std::vector<T>& section)
+	{
+		if (section.empty()) return;
+		memcpy(data.data() + offset, section.data(), section.size() * sizeof(T));
+	}
+
+	bool IsSegmentOverlappingBox(const Elite::Vector2& from, const Elite::Vector2& direction, const Elite::Vector2& min, const Elite::Vector2& max)
+	{
+		//Slab test, the segment runs from t = 0 to t = 1
+		float tMin{ 0.f }, tMax{ 1.f };
+		const float origin[2]{ from.x, from.y };
+		const float delta[2]{ direction.x, direction.y };
+		const float boxMin[2]{ min.x, min.y };
+		const float boxMax[2]{ max.x, max.y };
+		for (int axis{}; axis < 2; ++axis)
+		{
+			if (fabsf(delta[axis]) < 1e-8f)
+			{
+				if (origin[axis] <= boxMin[axis] || origin[axis] >= boxMax[axis]) return false;
+				continue;
+			}
+
+			const float inverse{ 1.f / delta[axis] };
+			float t0{ (boxMin[axis] - origin[axis]) * inverse }, t1{ (boxMax[axis] - origin[axis]) * inverse };
+			if (t0 > t1) std::swap(t0, t1);
+			tMin = std::max<float>(tMin, t0);
+			tMax = std::min<float>(tMax, t1);
+			if (tMin >= tMax) return false;
+		}
+		return true;
+	}
+
+	bool IsPointInBox(const Elite::Vector2& point, const Elite::Vector2& min, const Elite::Vector2& max)
+	{
+		return point.x > min.x && point.x < max.x && point.y > min.y && point.y < max.y;
+	}
+}
+
+const uint32_t LevelIndex::m_Magic;
+const uint32_t LevelIndex::m_Version;
+const int LevelIndex::m_MaxTreeDepth;
+
+LevelIndex::~LevelIndex()
+{
+	Unload();
+}
+
+uint64_t LevelIndex::HashSource(const char* pData, size_t size)
+{
+	uint64_t hash{ 14695981039346656037ull };
+	for (size_t i{}; i < size; ++i) hash = (hash ^ uint8_t(pData[i])) * 1099511628211ull;
+	return hash;
+}
+
+bool LevelIndex::Bake(const LevelGeometry& level, uint64_t sourceHash, const std::string& filePath, float cellSize)
+{
+	static_assert(sizeof(Elite::Vector2) == 2 * sizeof(float), "Vector2 is stored as is in the level index");
+
+	std::vector<House> houses{};
+	std::vector<Doorway> doorways{};
+	std::vector<Wall> walls{};
+	for (const LevelHouse& levelHouse : level.Houses)
+	{
+		const uint32_t houseIndex{ uint32_t(houses.size()) };
+		houses.push_back(House{ levelHouse.Center, levelHouse.Size, uint32_t(doorways.size()), 0 });
+		FindDoorways(levelHouse, houseIndex, doorways);
+		houses.back().doorwayCount = uint32_t(doorways.size()) - houses.back().firstDoorway;
+
+		for (const std::vector<Elite::Vector2>& polygon : levelHouse.Walls)
+		{
+			if (polygon.empty()) continue;
+
+			Wall wall{ polygon[0], polygon[0] };
+			for (const Elite::Vector2& vertex : polygon)
+			{
+				wall.min = Elite::Vector2{ std::min<float>(wall.min.x, vertex.x), std::min<float>(wall.min.y, vertex.y) };
+				wall.max = Elite::Vector2{ std::max<float>(wall.max.x, vertex.x), std::max<float>(wall.max.y, vertex.y) };
+			}
+			walls.push_back(wall);
+		}
+	}
+
+	std::vector<Node> nodes{};
+	if (!walls.empty()) BuildTree(walls, 0, uint32_t(walls.size()), nodes);
+
+	FileHeader header{};
+	header.magic = m_Magic;
+	header.version = m_Version;
+	header.cellSize = cellSize;
+	header.sourceHash = sourceHash;
+	header.worldMin = level.WorldSize * -0.5f;
+	header.worldMax = level.WorldSize * 0.5f;
+	header.columns = uint32_t(std::max<int>(1, int(ceilf(level.WorldSize.x / cellSize))));
+	header.rows = uint32_t(std::max<int>(1, int(ceilf(level.WorldSize.y / cellSize))));
+	header.wordsPerRow = (header.columns + 63) / 64;
+	header.houseCount = uint32_t(houses.size());
+	header.doorwayCount = uint32_t(doorways.size());
+	header.wallCount = uint32_t(walls.size());
+	header.nodeCount = uint32_t(nodes.size());
+	header.housesOffset = AlignOffset(sizeof(FileHeader));
+	header.doorwaysOffset = AlignOffset(header.housesOffset + houses.size() * sizeof(House));
+	header.wallsOffset = AlignOffset(header.doorwaysOffset + doorways.size() * sizeof(Doorway));
+	header.nodesOffset = AlignOffset(header.wallsOffset + walls.size() * sizeof(Wall));
+	header.gridOffset = AlignOffset(header.nodesOffset + nodes.size() * sizeof(Node));
+
+	//Occupancy, a cell is blocked when any wall overlaps it
+	std::vector<uint64_t> grid(size_t(header.rows) * header.wordsPerRow, 0);
+	for (const Wall& wall : walls)
+	{
+		const int firstColumn{ std::max<int>(0, int(floorf((wall.min.x - header.worldMin.x) / cellSize))) };
+		const int lastColumn{ std::min<int>(int(header.columns) - 1, int(ceilf((wall.max.x - header.worldMin.x) / cellSize)) - 1) };
+		const int firstRow{ std::max<int>(0, int(floorf((wall.min.y - header.worldMin.y) / cellSize))) };
+		const int lastRow{ std::min<int>(int(header.rows) - 1, int(ceilf((wall.max.y - header.worldMin.y) / cellSize)) - 1) };
+		for (int row{ firstRow }; row <= lastRow; ++row)
+		{
+			for (int column{ firstColumn }; column <= lastColumn; ++column)
+			{
+				grid[size_t(row) * header.wordsPerRow + column / 64] |= uint64_t(1) << (column % 64);
+			}
+		}
+	}
+	header.fileSize = uint32_t(header.gridOffset + grid.size() * sizeof(uint64_t));
+
+	std::vector<char> data(header.fileSize, 0);
+	memcpy(data.data(), &header, sizeof(header));
+	WriteSection(data, header.housesOffset, houses);
+	WriteSection(data, header.doorwaysOffset, doorways);
+	WriteSection(data, header.wallsOffset, walls);
+	WriteSection(data, header.nodesOffset, nodes);
+	WriteSection(data, header.gridOffset, grid);
+
+	return MappedFile::Replace(filePath, data.data(), data.size());
+}
+
+bool LevelIndex::Load(const std::string& filePath, uint64_t sourceHash)
+{
+	Unload();
+
+	//A file another process is still writing or truncating must never be mapped, reading past its end would fault
+	FileHeader header{};
+	size_t fileSize{};
+	if (!MappedFile::ReadPrefix(filePath, &header, sizeof(header), fileSize) || header.magic != m_Magic || header.version != m_Version ||
+		header.fileSize != fileSize || header.sourceHash != sourceHash) return false;
+	if (!m_File.Open(filePath)) return false;
+
+	if (m_File.GetSize() < sizeof(FileHeader) || !Validate(m_File.GetData(), m_File.GetSize()) || m_pHeader->sourceHash != sourceHash)
+	{
+		Unload();
+		return false;
+	}
+	return true;
+}
+
+void LevelIndex::Unload()
+{
+	m_File.Close();
+	m_pHeader = nullptr;
+	m_pHouses = nullptr;
+	m_pDoorways = nullptr;
+	m_pWalls = nullptr;
+	m_pNodes = nullptr;
+	m_pGrid = nullptr;
+}
+
+uint64_t LevelIndex::GetSourceHash() const
+{
+	return m_pHeader != nullptr ? m_pHeader->sourceHash : 0;
+}
+
+Elite::Vector2 LevelIndex::GetWorldMin() const
+{
+	return m_pHeader != nullptr ? m_pHeader->worldMin : Elite::Vector2{};
+}
+
+Elite::Vector2 LevelIndex::GetWorldMax() const
+{
+	return m_pHeader != nullptr ? m_pHeader->worldMax : Elite::Vector2{};
+}
+
+float LevelIndex::GetCellSize() const
+{
+	return m_pHeader != nullptr ? m_pHeader->cellSize : 0.f;
+}
+
+int LevelIndex::GetColumns() const
+{
+	return m_pHeader != nullptr ? int(m_pHeader->columns) : 0;
+}
+
+int LevelIndex::GetRows() const
+{
+	return m_pHeader != nullptr ? int(m_pHeader->rows) : 0;
+}
+
+uint32_t LevelIndex::GetAmountOfHouses() const
+{
+	return m_pHeader != nullptr ? m_pHeader->houseCount : 0;
+}
+
+HouseInfo LevelIndex::GetHouseInfo(uint32_t house) const
+{
+	HouseInfo houseInfo{};
+	houseInfo.Center = m_pHouses[house].center;
+	houseInfo.Size = m_pHouses[house].size;
+	return houseInfo;
+}
+
+int LevelIndex::GetHouseAt(const Elite::Vector2& position) const
+{
+	for (uint32_t i{}; i < GetAmountOfHouses(); ++i)
+	{
+		const Elite::Vector2 halfSize{ m_pHouses[i].size * 0.5f };
+		if (IsPointInBox(position, m_pHouses[i].center - halfSize, m_pHouses[i].center + halfSize)) return int(i);
+	}
+	return -1;
+}
+
+int LevelIndex::FindHouse(const Elite::Vector2& center, float margin) const
+{
+	for (uint32_t i{}; i < GetAmountOfHouses(); ++i)
+	{
+		if (Elite::DistanceSquared(m_pHouses[i].center, center) <= margin * margin) return int(i);
+	}
+	return -1;
+}
+
+bool LevelIndex::IsBlocked(const Elite::Vector2& position) const
+{
+	if (m_pHeader == nullptr) return false;
+
+	const int column{ int(floorf((position.x - m_pHeader->worldMin.x) / m_pHeader->cellSize)) };
+	const int row{ int(floorf((position.y - m_pHeader->worldMin.y) / m_pHeader->cellSize)) };
+	return IsCellBlocked(column, row);
+}
+
+bool LevelIndex::IsCellBlocked(int column, int row) const
+{
+	if (m_pHeader == nullptr) return false;
+	if (column < 0 || row < 0 || column >= int(m_pHeader->columns) || row >= int(m_pHeader->rows)) return true;
+
+	return (m_pGrid[size_t(row) * m_pHeader->wordsPerRow + column / 64] >> (column % 64)) & 1;
+}
+
+bool LevelIndex::IsInsideWall(const Elite::Vector2& position) const
+{
+	if (m_pHeader == nullptr || m_pHeader->nodeCount == 0) return false;
+
+	uint32_t stack[m_MaxTreeDepth]{};
+	int stackSize{};
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const uint32_t nodeIndex{ stack[--stackSize] };
+		const Node& node{ m_pNodes[nodeIndex] };
+		if (!IsPointInBox(position, node.min, node.max)) continue;
+
+		if (node.count > 0)
+		{
+			for (uint32_t i{ node.index }; i < node.index + node.count; ++i)
+			{
+				if (IsPointInBox(position, m_pWalls[i].min, m_pWalls[i].max)) return true;
+			}
+			continue;
+		}
+
+		if (stackSize + 2 > m_MaxTreeDepth) return true;
+		stack[stackSize++] = node.index;
+		stack[stackSize++] = nodeIndex + 1;
+	}
+	return false;
+}
+
+bool LevelIndex::IsSegmentClear(const Elite::Vector2& from, const Elite::Vector2& to) const
+{
+	if (m_pHeader == nullptr || m_pHeader->nodeCount == 0) return true;
+
+	const Elite::Vector2 direction{ to - from };
+	uint32_t stack[m_MaxTreeDepth]{};
+	int stackSize{};
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const uint32_t nodeIndex{ stack[--stackSize] };
+		const Node& node{ m_pNodes[nodeIndex] };
+		if (!IsSegmentOverlappingBox(from, direction, node.min, node.max)) continue;
+
+		if (node.count > 0)
+		{
+			for (uint32_t i{ node.index }; i < node.index + node.count; ++i)
+			{
+				if (IsSegmentOverlappingBox(from, direction, m_pWalls[i].min, m_pWalls[i].max)) return false;
+			}
+			continue;
+		}
+
+		if (stackSize + 2 > m_MaxTreeDepth) return false;
+		stack[stackSize++] = node.index;
+		stack[stackSize++] = nodeIndex + 1;
+	}
+	return true;
+}
+
+void LevelIndex::FindDoorways(const LevelHouse& house, uint32_t houseIndex, std::vector<Doorway>& doorways)
+{
+	//Walk each side of the house along the middle of its walls, every gap in the walls is a doorway
+	std::vector<Wall> walls{};
+	float wallThickness{ FLT_MAX };
+	for (const std::vector<Elite::Vector2>& polygon : house.Walls)
+	{
+		if (polygon.empty()) continue;
+
+		Wall wall{ polygon[0], polygon[0] };
+		for (const Elite::Vector2& vertex : polygon)
+		{
+			wall.min = Elite::Vector2{ std::min<float>(wall.min.x, vertex.x), std::min<float>(wall.min.y, vertex.y) };
+			wall.max = Elite::Vector2{ std::max<float>(wall.max.x, vertex.x), std::max<float>(wall.max.y, vertex.y) };
+		}
+		wallThickness = std::min<float>(wallThickness, std::min<float>(wall.max.x - wall.min.x, wall.max.y - wall.min.y));
+		walls.push_back(wall);
+	}
+	if (walls.empty()) return;
+
+	const Elite::Vector2 houseMin{ house.Center - house.Size * 0.5f }, houseMax{ house.Center + house.Size * 0.5f };
+	const float inset{ wallThickness * 0.5f };
+	struct Side
+	{
+		Elite::Vector2 start;
+		Elite::Vector2 end;
+		Elite::Vector2 normal;
+	};
+	const Side sides[4]{
+		{ { houseMin.x + wallThickness, houseMin.y + inset }, { houseMax.x - wallThickness, houseMin.y + inset }, { 0.f, -1.f } },
+		{ { houseMin.x + wallThickness, houseMax.y - inset }, { houseMax.x - wallThickness, houseMax.y - inset }, { 0.f, 1.f } },
+		{ { houseMin.x + inset, houseMin.y + wallThickness }, { houseMin.x + inset, houseMax.y - wallThickness }, { -1.f, 0.f } },
+		{ { houseMax.x - inset, houseMin.y + wallThickness }, { houseMax.x - inset, houseMax.y - wallThickness }, { 1.f, 0.f } }
+	};
+
+	for (const Side& side : sides)
+	{
+		const float length{ Elite::Distance(side.start, side.end) };
+		if (length <= 0.f) continue;
+
+		const Elite::Vector2 direction{ (side.end - side.start) / length };
+		const int sampleCount{ int(ceilf(length / g_DoorwaySampleStep)) + 1 };
+		float gapStart{ -1.f }, gapEnd{};
+		for (int sample{}; sample <= sampleCount; ++sample)
+		{
+			//One sample past the end closes the last gap
+			const float distance{ std::min<float>(sample * g_DoorwaySampleStep, length) };
+			const Elite::Vector2 position{ side.start + direction * distance };
+			const bool isOpen{ sample < sampleCount && std::none_of(walls.begin(), walls.end(), [&position](const Wall& wall) {
+				return IsPointInBox(position, wall.min, wall.max);
+			}) };
+
+			if (isOpen)
+			{
+				if (gapStart < 0.f) gapStart = distance;
+				gapEnd = distance;
+				continue;
+			}
+
+			if (gapStart >= 0.f && gapEnd - gapStart >= g_MinDoorwayWidth)
+			{
+				const Elite::Vector2 center{ side.start + direction * ((gapStart + gapEnd) * 0.5f) };
+				doorways.push_back(Doorway{ center, side.normal, gapEnd - gapStart, houseIndex });
+			}
+			gapStart = -1.f;
+		}
+	}
+}
+
+uint32_t LevelIndex::BuildTree(std::vector<Wall>& walls, uint32_t first, uint32_t last, std::vector<Node>& nodes)
+{
+	const uint32_t nodeIndex{ uint32_t(nodes.size()) };
+	Node node{ walls[first].min, walls[first].max, first, last - first };
+	for (uint32_t i{ first }; i < last; ++i)
+	{
+		node.min = Elite::Vector2{ std::min<float>(node.min.x, walls[i].min.x), std::min<float>(node.min.y, walls[i].min.y) };
+		node.max = Elite::Vector2{ std::max<float>(node.max.x, walls[i].max.x), std::max<float>(node.max.y, walls[i].max.y) };
+	}
+	nodes.push_back(node);
+	if (last - first <= g_MaxWallsPerLeaf) return nodeIndex;
+
+	//Median split along the longest axis
+	const bool isSplitOnX{ node.max.x - node.min.x >= node.max.y - node.min.y };
+	const uint32_t middle{ first + (last - first) / 2 };
+	std::nth_element(walls.begin() + first, walls.begin() + middle, walls.begin() + last, [isSplitOnX](const Wall& left, const Wall& right) {
+		return isSplitOnX ? left.min.x + left.max.x < right.min.x + right.max.x : left.min.y + left.max.y < right.min.y + right.max.y;
+	});
+
+	BuildTree(walls, first, middle, nodes);
+	const uint32_t rightIndex{ BuildTree(walls, middle, last, nodes) };
+	nodes[nodeIndex].index = rightIndex;
+	nodes[nodeIndex].count = 0;
+	return nodeIndex;
+}
+
+bool LevelIndex::Validate(const char* pData, size_t size)
+{
+	const FileHeader* pHeader{ reinterpret_cast<const FileHeader*>(pData) };
+	if (pHeader->magic != m_Magic || pHeader->version != m_Version || pHeader->fileSize != size) return false;
+	if (pHeader->cellSize <= 0.f || pHeader->columns == 0 || pHeader->rows == 0 || pHeader->wordsPerRow != (pHeader->columns + 63) / 64) return false;
+
+	auto isSectionValid = [size](uint32_t offset, uint64_t count, size_t elementSize) {
+		return offset % 8 == 0 && offset >= sizeof(FileHeader) && offset <= size && count <= (size - offset) / elementSize;
+	};
+	if (!isSectionValid(pHeader->housesOffset, pHeader->houseCount, sizeof(House)) ||
+		!isSectionValid(pHeader->doorwaysOffset, pHeader->doorwayCount, sizeof(Doorway)) ||
+		!isSectionValid(pHeader->wallsOffset, pHeader->wallCount, sizeof(Wall)) ||
+		!isSectionValid(pHeader->nodesOffset, pHeader->nodeCount, sizeof(Node)) ||
+		!isSectionValid(pHeader->gridOffset, uint64_t(pHeader->rows) * pHeader->wordsPerRow, sizeof(uint64_t))) return false;
+
+	m_pHeader = pHeader;
+	m_pHouses = reinterpret_cast<const House*>(pData + pHeader->housesOffset);
+	m_pDoorways = reinterpret_cast<const Doorway*>(pData + pHeader->doorwaysOffset);
+	m_pWalls = reinterpret_cast<const Wall*>(pData + pHeader->wallsOffset);
+	m_pNodes = reinterpret_cast<const Node*>(pData + pHeader->nodesOffset);
+	m_pGrid = reinterpret_cast<const uint64_t*>(pData + pHeader->gridOffset);
+
+	//Tree links and doorway ranges are only followed after this check
+	for (uint32_t i{}; i < pHeader->nodeCount; ++i)
+	{
+		const Node& node{ m_pNodes[i] };
+		if (node.count > 0 && (node.index > pHeader->wallCount || node.count > pHeader->wallCount - node.index)) return false;
+		if (node.count == 0 && (i + 1 >= pHeader->nodeCount || node.index <= i + 1 || node.index >= pHeader->nodeCount)) return false;
+	}
+	for (uint32_t i{}; i < pHeader->houseCount; ++i)
+	{
+		const House& house{ m_pHouses[i] };
+		if (house.firstDoorway > pHeader->doorwayCount || house.doorwayCount > pHeader->doorwayCount - house.firstDoorway) return false;
+	}
+	return true;
+}
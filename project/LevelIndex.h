@@ -0,0 +1,125 @@
+#pragma once
+#include <cstdint>
+#include "Exam_HelperStructs.h"
+#include "LevelParser.h"
+#include "MappedFile.h"
+
+//Read-only level knowledge baked from a .gppl file into one flat file that is memory mapped as is.
+//Loading only maps the file and checks the header, nothing gets parsed or allocated.
+//The header holds a hash of the .gppl it was baked from, a file baked from another version of the level doesn't load.
+//File layout, all sections 8 byte aligned and addressed by offsets in the header:
+//	FileHeader
+//	House[houseCount]		center, size and the range of its doorways
+//	Doorway[doorwayCount]	center of the gap in the walls, outward normal and width
+//	Wall[wallCount]			wall boxes, ordered so every tree leaf covers a contiguous range
+//	Node[nodeCount]			AABB tree over the walls, depth first with the left child right after its parent
+//	uint64[rows * wordsPerRow]	occupancy grid, one bit per cell, set when a wall overlaps the cell
+class LevelIndex final
+{
+public:
+	struct House
+	{
+		Elite::Vector2 center;
+		Elite::Vector2 size;
+		uint32_t firstDoorway;
+		uint32_t doorwayCount;
+	};
+
+	struct Doorway
+	{
+		Elite::Vector2 center;
+		Elite::Vector2 normal;
+		float width;
+		uint32_t house;
+	};
+
+	struct Wall
+	{
+		Elite::Vector2 min;
+		Elite::Vector2 max;
+	};
+
+	LevelIndex() = default;
+	~LevelIndex();
+	LevelIndex(const LevelIndex&) = delete;
+	LevelIndex& operator=(const LevelIndex&) = delete;
+	LevelIndex(LevelIndex&&) = delete;
+	LevelIndex& operator=(LevelIndex&&) = delete;
+
+	//FNV-1a over the level file as the framework reads it
+	static uint64_t HashSource(const char* pData, size_t size);
+	static bool Bake(const LevelGeometry& level, uint64_t sourceHash, const std::string& filePath, float cellSize = 1.f);
+	//False when the file is missing, damaged or baked from another source
+	bool Load(const std::string& filePath, uint64_t sourceHash);
+	void Unload();
+	bool IsLoaded() const { return m_pHeader != nullptr; }
+	uint64_t GetSourceHash() const;
+
+	Elite::Vector2 GetWorldMin() const;
+	Elite::Vector2 GetWorldMax() const;
+	float GetCellSize() const; //Of the occupancy grid
+	int GetColumns() const;
+	int GetRows() const;
+	uint32_t GetAmountOfHouses() const;
+	const House& GetHouse(uint32_t house) const { return m_pHouses[house]; }
+	HouseInfo GetHouseInfo(uint32_t house) const;
+	const Doorway& GetDoorway(uint32_t doorway) const { return m_pDoorways[doorway]; }
+	//Index of the house whose bounds contain the position, -1 when outside every house
+	int GetHouseAt(const Elite::Vector2& position) const;
+	int FindHouse(const Elite::Vector2& center, float margin = 1.f) const;
+
+	bool IsBlocked(const Elite::Vector2& position) const; //Occupancy grid lookup
+	bool IsCellBlocked(int column, int row) const; //Outside the grid counts as blocked
+	bool IsInsideWall(const Elite::Vector2& position) const;
+	bool IsSegmentClear(const Elite::Vector2& from, const Elite::Vector2& to) const;
+
+private:
+	struct FileHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint32_t fileSize;
+		float cellSize;
+		uint64_t sourceHash;
+		Elite::Vector2 worldMin;
+		Elite::Vector2 worldMax;
+		uint32_t columns;
+		uint32_t rows;
+		uint32_t wordsPerRow;
+		uint32_t houseCount;
+		uint32_t doorwayCount;
+		uint32_t wallCount;
+		uint32_t nodeCount;
+		uint32_t housesOffset;
+		uint32_t doorwaysOffset;
+		uint32_t wallsOffset;
+		uint32_t nodesOffset;
+		uint32_t gridOffset;
+	};
+
+	struct Node
+	{
+		Elite::Vector2 min;
+		Elite::Vector2 max;
+		uint32_t index; //First wall of a leaf, right child of an inner node
+		uint32_t count; //Walls in a leaf, 0 for inner nodes
+	};
+
+	static const uint32_t m_Magic{ 0x49565047 }; //"GPVI"
+	static const uint32_t m_Version{ 2 };
+	static const int m_MaxTreeDepth{ 64 };
+
+	static void FindDoorways(const LevelHouse& house, uint32_t houseIndex, std::vector<Doorway>& doorways);
+	static uint32_t BuildTree(std::vector<Wall>& walls, uint32_t first, uint32_t last, std::vector<Node>& nodes);
+	bool Validate(const char* pData, size_t size);
+
+	MappedFile m_File{};
+
+	//Views into the mapping
+	const FileHeader* m_pHeader{};
+	const House* m_pHouses{};
+	const Doorway* m_pDoorways{};
+	const Wall* m_pWalls{};
+	const Node* m_pNodes{};
+	const uint64_t* m_pGrid{};
+};
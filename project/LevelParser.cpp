@@ -0,0 +1,97 @@
+#include "stdafx.h"
+#include "LevelParser.h"
+#include <cstring>
+
+bool LevelParser::Parse(const std::string& filePath, LevelGeometry& level)
+{
+	std::ifstream file{ filePath, std::ios::binary | std::ios::ate };
+	if (!file.is_open()) return Fail("Could not open " + filePath);
+
+	const std::streamsize size{ file.tellg() };
+	if (size <= 0) return Fail(filePath + " is empty");
+
+	std::vector<char> data(static_cast<size_t>(size));
+	file.seekg(0);
+	if (!file.read(data.data(), size)) return Fail("Could not read " + filePath);
+
+	return Parse(data.data(), data.size(), level);
+}
+
+bool LevelParser::Parse(const char* pData, size_t size, LevelGeometry& level)
+{
+	m_pData = pData;
+	m_Size = size;
+	m_Offset = 0;
+	m_Error.clear();
+	level.Houses.clear();
+
+	uint32_t houseCount{};
+	if (!ReadVector(level.WorldSize) || !ReadUInt(houseCount)) return false;
+	if (level.WorldSize.x <= 0.f || level.WorldSize.y <= 0.f) return Fail("Invalid world size");
+
+	//Every house takes at least its center, size and two counts
+	const size_t minHouseSize{ 2 * sizeof(Elite::Vector2) + 2 * sizeof(uint32_t) };
+	if (houseCount > (m_Size - m_Offset) / minHouseSize) return Fail("House count does not fit the file");
+
+	level.Houses.resize(houseCount);
+	for (LevelHouse& house : level.Houses)
+	{
+		if (!ReadVector(house.Center) || !ReadVector(house.Size)) return false;
+		if (!ReadPolygons(house.Walls) || !ReadPolygons(house.Outlines)) return false;
+	}
+
+	if (m_Offset != m_Size) return Fail("Unexpected data after the last house");
+	return true;
+}
+
+bool LevelParser::ReadUInt(uint32_t& value)
+{
+	if (m_Size - m_Offset < sizeof(value)) return Fail("Unexpected end of file");
+
+	memcpy(&value, m_pData + m_Offset, sizeof(value));
+	m_Offset += sizeof(value);
+	return true;
+}
+
+bool LevelParser::ReadFloat(float& value)
+{
+	if (m_Size - m_Offset < sizeof(value)) return Fail("Unexpected end of file");
+
+	memcpy(&value, m_pData + m_Offset, sizeof(value));
+	m_Offset += sizeof(value);
+	if (!isfinite(value)) return Fail("Invalid number in level");
+	return true;
+}
+
+bool LevelParser::ReadVector(Elite::Vector2& value)
+{
+	return ReadFloat(value.x) && ReadFloat(value.y);
+}
+
+bool LevelParser::ReadPolygons(std::vector<std::vector<Elite::Vector2>>& polygons)
+{
+	uint32_t polygonCount{};
+	if (!ReadUInt(polygonCount)) return false;
+	if (polygonCount > (m_Size - m_Offset) / sizeof(uint32_t)) return Fail("Polygon count does not fit the file");
+
+	polygons.resize(polygonCount);
+	for (std::vector<Elite::Vector2>& polygon : polygons)
+	{
+		uint32_t vertexCount{};
+		if (!ReadUInt(vertexCount)) return false;
+		if (vertexCount > (m_Size - m_Offset) / sizeof(Elite::Vector2)) return Fail("Vertex count does not fit the file");
+
+		polygon.resize(vertexCount);
+		for (Elite::Vector2& vertex : polygon)
+		{
+			if (!ReadVector(vertex)) return false;
+		}
+	}
+	return true;
+}
+
+bool LevelParser::Fail(const std::string& error)
+{
+	m_Error = error;
+	return false;
+}
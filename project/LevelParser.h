@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include "Exam_HelperStructs.h"
+
+struct LevelHouse
+{
+	Elite::Vector2 Center;
+	Elite::Vector2 Size; //Including the walls
+	std::vector<std::vector<Elite::Vector2>> Walls; //Axis aligned wall pieces, 4 corners each
+	std::vector<std::vector<Elite::Vector2>> Outlines; //Inside and outside of the walls traced as one loop
+};
+
+struct LevelGeometry
+{
+	Elite::Vector2 WorldSize{}; //Full size, centered around the origin
+	std::vector<LevelHouse> Houses{};
+};
+
+//Reads the .gppl level files the framework loads.
+//Everything is little endian and tightly packed:
+//	float worldWidth, float worldHeight, uint32 houseCount
+//	per house: Vector2 center, Vector2 size, uint32 wallCount, wallCount polygons, uint32 outlineCount, outlineCount polygons
+//	per polygon: uint32 vertexCount, vertexCount * Vector2
+class LevelParser final
+{
+public:
+	LevelParser() = default;
+	~LevelParser() = default;
+	LevelParser(const LevelParser&) = delete;
+	LevelParser& operator=(const LevelParser&) = delete;
+	LevelParser(LevelParser&&) = delete;
+	LevelParser& operator=(LevelParser&&) = delete;
+
+	bool Parse(const std::string& filePath, LevelGeometry& level);
+	bool Parse(const char* pData, size_t size, LevelGeometry& level);
+
+	const std::string& GetError() const { return m_Error; } //Of the last failed parse
+
+private:
+	bool ReadUInt(uint32_t& value);
+	bool ReadFloat(float& value);
+	bool ReadVector(Elite::Vector2& value);
+	bool ReadPolygons(std::vector<std::vector<Elite::Vector2>>& polygons);
+	bool Fail(const std::string& error);
+
+	const char* m_pData{};
+	size_t m_Size{};
+	size_t m_Offset{};
+	std::string m_Error{};
+};
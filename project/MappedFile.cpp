@@ -0,0 +1,127 @@
+#include "stdafx.h"
+#include "MappedFile.h"
+#include <cstdio>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file{ CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+	if (file == INVALID_HANDLE_VALUE) return false;
+	m_pFile = file;
+
+	LARGE_INTEGER fileSize{};
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_pMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_pMapping == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_pData = static_cast<const char*>(MapViewOfFile(m_pMapping, FILE_MAP_READ, 0, 0, 0));
+	m_Size = size_t(fileSize.QuadPart);
+#else
+	const int file{ open(filePath.c_str(), O_RDONLY) };
+	if (file == -1) return false;
+
+	struct stat fileStat {};
+	void* pMapped{ MAP_FAILED };
+	if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0)
+	{
+		m_Size = size_t(fileStat.st_size);
+		pMapped = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+	}
+	close(file);
+	m_pData = pMapped == MAP_FAILED ? nullptr : static_cast<const char*>(pMapped);
+#endif
+
+	if (m_pData == nullptr)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (m_pData != nullptr) UnmapViewOfFile(m_pData);
+	if (m_pMapping != nullptr) CloseHandle(m_pMapping);
+	if (m_pFile != nullptr) CloseHandle(m_pFile);
+#else
+	if (m_pData != nullptr) munmap(const_cast<char*>(m_pData), m_Size);
+#endif
+
+	m_pFile = nullptr;
+	m_pMapping = nullptr;
+	m_pData = nullptr;
+	m_Size = 0;
+}
+
+bool MappedFile::Replace(const std::string& filePath, const char* pData, size_t size)
+{
+	//Unique per process and thread, two bakes of the same level never share a temporary file
+	std::stringstream tempPath{};
+#ifdef _WIN32
+	tempPath << filePath << '.' << _getpid() << '.' << std::this_thread::get_id() << ".tmp";
+#else
+	tempPath << filePath << '.' << getpid() << '.' << std::this_thread::get_id() << ".tmp";
+#endif
+
+	{
+		std::ofstream file{ tempPath.str(), std::ios::binary | std::ios::trunc };
+		if (!file.is_open()) return false;
+		file.write(pData, std::streamsize(size));
+		file.close();
+		if (!file)
+		{
+			std::remove(tempPath.str().c_str());
+			return false;
+		}
+	}
+
+#ifdef _WIN32
+	const bool isReplaced{ MoveFileExA(tempPath.str().c_str(), filePath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0 };
+#else
+	const bool isReplaced{ std::rename(tempPath.str().c_str(), filePath.c_str()) == 0 };
+#endif
+	if (!isReplaced) std::remove(tempPath.str().c_str());
+	return isReplaced;
+}
+
+bool MappedFile::ReadPrefix(const std::string& filePath, void* pData, size_t size, size_t& fileSize)
+{
+	std::ifstream file{ filePath, std::ios::binary | std::ios::ate };
+	if (!file.is_open()) return false;
+
+	const std::streamoff length{ file.tellg() };
+	if (length < std::streamoff(size)) return false;
+	fileSize = size_t(length);
+
+	file.seekg(0);
+	file.read(static_cast<char*>(pData), std::streamsize(size));
+	return bool(file);
+}
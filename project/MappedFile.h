@@ -0,0 +1,31 @@
+#pragma once
+
+//Read-only view of a whole file, the pages are loaded on first access and shared with the file cache
+class MappedFile final
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&&) = delete;
+	MappedFile& operator=(MappedFile&&) = delete;
+
+	bool Open(const std::string& filePath);
+	void Close();
+
+	//Writes the file next to the target and renames it over it, readers see either the old or the new file but never a partial one
+	static bool Replace(const std::string& filePath, const char* pData, size_t size);
+	//Reads the start of a file without mapping it, to check its header before anything is mapped
+	static bool ReadPrefix(const std::string& filePath, void* pData, size_t size, size_t& fileSize);
+
+	bool IsOpen() const { return m_pData != nullptr; }
+	const char* GetData() const { return m_pData; }
+	size_t GetSize() const { return m_Size; }
+
+private:
+	void* m_pFile{};
+	void* m_pMapping{};
+	const char* m_pData{};
+	size_t m_Size{};
+};
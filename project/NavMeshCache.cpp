@@ -0,0 +1,73 @@
+#include "stdafx.h"
+#include "NavMeshCache.h"
+#include "IExamInterface.h"
+
+NavMeshCache::NavMeshCache(IExamInterface* pInterface, float cellSize, size_t capacity)
+	: m_pInterface{ pInterface }
+	, m_CellSize{ cellSize }
+{
+	m_Entries.resize(std::max<size_t>(1, capacity), Entry{});
+}
+
+Elite::Vector2 NavMeshCache::GetClosestPathPoint(const Elite::Vector2& goal, const Elite::Vector2& agentPosition)
+{
+	int agentColumn{}, agentRow{};
+	Quantize(agentPosition, agentColumn, agentRow);
+	if (agentColumn != m_AgentColumn || agentRow != m_AgentRow)
+	{
+		Invalidate();
+		m_AgentColumn = agentColumn;
+		m_AgentRow = agentRow;
+	}
+
+	int goalColumn{}, goalRow{};
+	Quantize(goal, goalColumn, goalRow);
+	++m_UseCounter;
+
+	Entry* pLeastRecentlyUsed{ &m_Entries[0] };
+	for (Entry& entry : m_Entries)
+	{
+		if (entry.isValid && entry.goalColumn == goalColumn && entry.goalRow == goalRow)
+		{
+			entry.lastUsed = m_UseCounter;
+			++m_Hits;
+			return entry.pathPoint;
+		}
+
+		if (!pLeastRecentlyUsed->isValid) continue;
+		if (!entry.isValid || entry.lastUsed < pLeastRecentlyUsed->lastUsed) pLeastRecentlyUsed = &entry;
+	}
+
+	++m_Misses;
+	pLeastRecentlyUsed->goalColumn = goalColumn;
+	pLeastRecentlyUsed->goalRow = goalRow;
+	pLeastRecentlyUsed->pathPoint = m_pInterface->NavMesh_GetClosestPathPoint(goal);
+	pLeastRecentlyUsed->lastUsed = m_UseCounter;
+	pLeastRecentlyUsed->isValid = true;
+	return pLeastRecentlyUsed->pathPoint;
+}
+
+void NavMeshCache::Invalidate()
+{
+	for (Entry& entry : m_Entries) entry.isValid = false;
+}
+
+void NavMeshCache::SetCellSize(float cellSize)
+{
+	m_CellSize = cellSize;
+	m_AgentColumn = INT_MIN;
+	m_AgentRow = INT_MIN;
+	Invalidate();
+}
+
+float NavMeshCache::GetHitRate() const
+{
+	const int requests{ m_Hits + m_Misses };
+	return requests > 0 ? float(m_Hits) / float(requests) : 0.f;
+}
+
+void NavMeshCache::Quantize(const Elite::Vector2& position, int& column, int& row) const
+{
+	column = int(floorf(position.x / m_CellSize));
+	row = int(floorf(position.y / m_CellSize));
+}
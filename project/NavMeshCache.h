@@ -0,0 +1,49 @@
+#pragma once
+#include "Exam_HelperStructs.h"
+
+class IExamInterface;
+
+//Memoizes IExamInterface::NavMesh_GetClosestPathPoint.
+//Goals are quantized to cells and the most recent answers are kept in a small LRU.
+//The answer depends on where the agent stands, so every entry is dropped when the agent crosses into another cell.
+class NavMeshCache final
+{
+public:
+	NavMeshCache(IExamInterface* pInterface, float cellSize = 1.f, size_t capacity = 16);
+	~NavMeshCache() = default;
+	NavMeshCache(const NavMeshCache&) = delete;
+	NavMeshCache& operator=(const NavMeshCache&) = delete;
+	NavMeshCache(NavMeshCache&&) = delete;
+	NavMeshCache& operator=(NavMeshCache&&) = delete;
+
+	Elite::Vector2 GetClosestPathPoint(const Elite::Vector2& goal, const Elite::Vector2& agentPosition);
+	void Invalidate();
+
+	void SetCellSize(float cellSize);
+	int GetHits() const { return m_Hits; }
+	int GetMisses() const { return m_Misses; }
+	float GetHitRate() const;
+
+private:
+	struct Entry
+	{
+		int goalColumn;
+		int goalRow;
+		Elite::Vector2 pathPoint;
+		unsigned int lastUsed;
+		bool isValid;
+	};
+
+	void Quantize(const Elite::Vector2& position, int& column, int& row) const;
+
+	IExamInterface* m_pInterface = nullptr;
+	float m_CellSize{};
+	std::vector<Entry> m_Entries{};
+	unsigned int m_UseCounter{};
+
+	int m_AgentColumn{ INT_MIN };
+	int m_AgentRow{ INT_MIN };
+
+	int m_Hits{};
+	int m_Misses{};
+};
@@ -0,0 +1,164 @@
+#include "stdafx.h"
+#include "PathPlanner.h"
+
+PathPlanner::PlanState PathPlanner::PlanHandle::GetState() const
+{
+	if (m_pRequest == nullptr) return PlanState::Failed;
+	return PlanState(m_pRequest->state.load(std::memory_order_acquire));
+}
+
+const std::vector<Elite::Vector2>& PathPlanner::PlanHandle::GetPath() const
+{
+	static const std::vector<Elite::Vector2> noPath{};
+	if (GetState() != PlanState::Ready) return noPath;
+	return m_pRequest->path;
+}
+
+void PathPlanner::PlanHandle::Cancel()
+{
+	if (m_pRequest == nullptr) return;
+
+	int expected{ int(PlanState::Pending) };
+	m_pRequest->state.compare_exchange_strong(expected, int(PlanState::Cancelled));
+}
+
+PathPlanner::PathPlanner(const Elite::Vector2& worldMin, const Elite::Vector2& worldMax, float cellSize, size_t cacheCapacity, bool isAsync)
+	: m_Pathfinder{ worldMin, worldMax, cellSize }
+	, m_CellSize{ cellSize }
+{
+	m_Cache.resize(std::max<size_t>(1, cacheCapacity), CacheEntry{});
+	m_FoundPath.reserve(512);
+	if (isAsync) m_Worker = std::thread{ &PathPlanner::Run, this };
+}
+
+PathPlanner::~PathPlanner()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_IsRunning = false;
+	}
+	m_Condition.notify_one();
+	if (m_Worker.joinable()) m_Worker.join();
+}
+
+PathPlanner::PlanHandle PathPlanner::RequestPath(const Elite::Vector2& start, const Elite::Vector2& goal)
+{
+	//Starts are quantized coarser than goals, a path from a few meters back is still a good path
+	const float startCellSize{ 2 * m_CellSize };
+	const int startColumn{ int(floorf(start.x / startCellSize)) }, startRow{ int(floorf(start.y / startCellSize)) };
+	const int goalColumn{ int(floorf(goal.x / m_CellSize)) }, goalRow{ int(floorf(goal.y / m_CellSize)) };
+	++m_UseCounter;
+
+	CacheEntry* pLeastRecentlyUsed{ &m_Cache[0] };
+	for (CacheEntry& entry : m_Cache)
+	{
+		const bool isSameQuery{ entry.pRequest != nullptr && entry.version == m_Version &&
+			entry.startColumn == startColumn && entry.startRow == startRow && entry.goalColumn == goalColumn && entry.goalRow == goalRow };
+		if (isSameQuery && PlanState(entry.pRequest->state.load()) != PlanState::Cancelled)
+		{
+			entry.lastUsed = m_UseCounter;
+			++m_CacheHits;
+			return PlanHandle{ entry.pRequest };
+		}
+
+		if (pLeastRecentlyUsed->pRequest == nullptr) continue;
+		if (entry.pRequest == nullptr || entry.lastUsed < pLeastRecentlyUsed->lastUsed) pLeastRecentlyUsed = &entry;
+	}
+
+	std::shared_ptr<PlanRequest> pRequest{ std::make_shared<PlanRequest>() };
+	pRequest->start = start;
+	pRequest->goal = goal;
+	*pLeastRecentlyUsed = CacheEntry{ startColumn, startRow, goalColumn, goalRow, m_Version, m_UseCounter, pRequest };
+
+	Command command{};
+	command.type = CommandType::Plan;
+	command.pRequest = pRequest;
+	PushCommand(command);
+
+	return PlanHandle{ pRequest };
+}
+
+void PathPlanner::AddHouse(const HouseInfo& house)
+{
+	const float sameHouseMargin{ 1.f };
+	auto foundIt = std::find_if(m_Houses.begin(), m_Houses.end(), [&house, sameHouseMargin](const HouseInfo& knownHouse) {
+		return Elite::DistanceSquared(knownHouse.Center, house.Center) <= sameHouseMargin * sameHouseMargin;
+	});
+	if (foundIt != m_Houses.end()) return;
+	m_Houses.push_back(house);
+	++m_Version;
+
+	Command command{};
+	command.type = CommandType::AddHouse;
+	command.house = house;
+	PushCommand(command);
+}
+
+void PathPlanner::AddDoorway(const Elite::Vector2& position)
+{
+	++m_Version;
+
+	Command command{};
+	command.type = CommandType::AddDoorway;
+	command.position = position;
+	PushCommand(command);
+}
+
+void PathPlanner::PushCommand(const Command& command)
+{
+	if (!m_Worker.joinable())
+	{
+		Execute(command);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_Commands.push_back(command);
+	}
+	m_Condition.notify_one();
+}
+
+void PathPlanner::Run()
+{
+	while (true)
+	{
+		Command command{};
+		{
+			std::unique_lock<std::mutex> lock{ m_Mutex };
+			m_Condition.wait(lock, [this]() { return !m_IsRunning || !m_Commands.empty(); });
+			if (!m_IsRunning) return;
+
+			command = m_Commands.front();
+			m_Commands.pop_front();
+		}
+
+		Execute(command);
+	}
+}
+
+void PathPlanner::Execute(const Command& command)
+{
+	switch (command.type)
+	{
+	case CommandType::AddHouse:
+		m_Pathfinder.AddHouse(command.house);
+		break;
+	case CommandType::AddDoorway:
+		m_Pathfinder.AddDoorway(command.position);
+		break;
+	case CommandType::Plan:
+	{
+		PlanRequest& request{ *command.pRequest };
+		if (PlanState(request.state.load()) == PlanState::Cancelled) break;
+
+		const bool isFound{ m_Pathfinder.FindPath(request.start, request.goal, m_FoundPath) };
+		if (isFound) request.path = m_FoundPath;
+
+		//Publishing fails when the plan got cancelled while it was being worked on
+		int expected{ int(PlanState::Pending) };
+		request.state.compare_exchange_strong(expected, int(isFound ? PlanState::Ready : PlanState::Failed), std::memory_order_release);
+		break;
+	}
+	}
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "Exam_HelperStructs.h"
+#include "GridPathfinder.h"
+
+//Background path planning service.
+//Queries run on a worker thread that owns its own GridPathfinder, the main thread only pushes requests
+//and world updates and polls the returned handles, so a slow query can never stall UpdateSteering.
+//Re-issuing the same query (same start/goal cells and world knowledge) hands back the same plan.
+//Without the worker (isAsync false) every query is done before RequestPath returns, the game then can't depend on timing.
+class PathPlanner final
+{
+	struct PlanRequest;
+
+public:
+	enum class PlanState
+	{
+		Pending,
+		Ready,
+		Failed,
+		Cancelled
+	};
+
+	class PlanHandle final
+	{
+	public:
+		PlanHandle() = default;
+
+		bool IsValid() const { return m_pRequest != nullptr; }
+		PlanState GetState() const;
+		//Only filled in once the state is Ready
+		const std::vector<Elite::Vector2>& GetPath() const;
+		//Pending plans are dropped by the worker, finished plans are not affected
+		void Cancel();
+
+	private:
+		friend class PathPlanner;
+		explicit PlanHandle(const std::shared_ptr<PlanRequest>& pRequest) : m_pRequest{ pRequest } {}
+
+		std::shared_ptr<PlanRequest> m_pRequest{};
+	};
+
+	PathPlanner(const Elite::Vector2& worldMin, const Elite::Vector2& worldMax, float cellSize = 2.f, size_t cacheCapacity = 16, bool isAsync = true);
+	~PathPlanner();
+	PathPlanner(const PathPlanner&) = delete;
+	PathPlanner& operator=(const PathPlanner&) = delete;
+	PathPlanner(PathPlanner&&) = delete;
+	PathPlanner& operator=(PathPlanner&&) = delete;
+
+	PlanHandle RequestPath(const Elite::Vector2& start, const Elite::Vector2& goal);
+	void AddHouse(const HouseInfo& house);
+	void AddDoorway(const Elite::Vector2& position);
+
+	unsigned int GetVersion() const { return m_Version; } //Changes whenever the known world changes
+	float GetCellSize() const { return m_CellSize; }
+	int GetCacheHits() const { return m_CacheHits; }
+
+private:
+	struct PlanRequest
+	{
+		Elite::Vector2 start;
+		Elite::Vector2 goal;
+		std::atomic<int> state{ int(PlanState::Pending) };
+		std::vector<Elite::Vector2> path;
+	};
+
+	enum class CommandType
+	{
+		AddHouse,
+		AddDoorway,
+		Plan
+	};
+
+	struct Command
+	{
+		CommandType type;
+		HouseInfo house;
+		Elite::Vector2 position;
+		std::shared_ptr<PlanRequest> pRequest;
+	};
+
+	struct CacheEntry
+	{
+		int startColumn;
+		int startRow;
+		int goalColumn;
+		int goalRow;
+		unsigned int version;
+		unsigned int lastUsed;
+		std::shared_ptr<PlanRequest> pRequest;
+	};
+
+	void PushCommand(const Command& command);
+	void Run();
+	void Execute(const Command& command);
+
+	//Worker
+	GridPathfinder m_Pathfinder;
+	std::vector<Elite::Vector2> m_FoundPath{};
+	std::thread m_Worker{};
+	std::mutex m_Mutex{};
+	std::condition_variable m_Condition{};
+	std::deque<Command> m_Commands{};
+	bool m_IsRunning{ true };
+
+	//Main thread
+	float m_CellSize{};
+	std::vector<HouseInfo> m_Houses{};
+	unsigned int m_Version{ 1 };
+	std::vector<CacheEntry> m_Cache{};
+	unsigned int m_UseCounter{};
+	int m_CacheHits{};
+};
+
+//Route the agent is following, owned by the plugin and shared through the blackboard
+struct PlannedPath
+{
+	PathPlanner::PlanHandle Plan{};
+	std::vector<Elite::Vector2> Points{};
+	size_t CurrentPoint{};
+	Elite::Vector2 Goal{};
+	unsigned int Version{}; //Planner version the path was requested with
+};
@@ -0,0 +1,217 @@
+#include "stdafx.h"
+#include "PathSmoother.h"
+#include <chrono>
+
+PathSmoother::PathSmoother(float clearance, float doorwayRadius, float sampleSpacing)
+	: m_Clearance{ clearance }
+	, m_DoorwayRadius{ doorwayRadius }
+	, m_SampleSpacing{ sampleSpacing }
+{
+}
+
+void PathSmoother::AddHouse(const HouseInfo& house)
+{
+	const float sameHouseMargin{ 1.f };
+	auto foundIt = std::find_if(m_Houses.begin(), m_Houses.end(), [&house, sameHouseMargin](const HouseInfo& knownHouse) {
+		return Elite::DistanceSquared(knownHouse.Center, house.Center) <= sameHouseMargin * sameHouseMargin;
+	});
+	if (foundIt != m_Houses.end()) return;
+	m_Houses.push_back(house);
+
+	//A ring of four walls, the doors are cut out once they are known
+	const float wallThickness{ 2.f };
+	const Elite::Vector2 min{ house.Center - house.Size * 0.5f }, max{ house.Center + house.Size * 0.5f };
+	AddWall(min, Elite::Vector2{ max.x, min.y + wallThickness });
+	AddWall(Elite::Vector2{ min.x, max.y - wallThickness }, max);
+	AddWall(Elite::Vector2{ min.x, min.y + wallThickness }, Elite::Vector2{ min.x + wallThickness, max.y - wallThickness });
+	AddWall(Elite::Vector2{ max.x - wallThickness, min.y + wallThickness }, Elite::Vector2{ max.x, max.y - wallThickness });
+
+	for (const Elite::Vector2& doorway : m_Doorways)
+	{
+		OpenDoorway(doorway);
+	}
+}
+
+void PathSmoother::AddDoorway(const Elite::Vector2& position)
+{
+	m_Doorways.push_back(position);
+	OpenDoorway(position);
+}
+
+void PathSmoother::Smooth(const Elite::Vector2& start, std::vector<Elite::Vector2>& path)
+{
+	if (path.empty()) return;
+
+	using Clock = std::chrono::steady_clock;
+	const Clock::time_point begin{ Clock::now() };
+	const float plannedLength{ GetLength(start, path) };
+
+	PullString(start, path);
+
+	//Round every corner, the tangents come from the corners before and after
+	m_Smoothed.clear();
+	const size_t cornerCount{ m_Corners.size() };
+	for (size_t i{}; i < cornerCount; ++i)
+	{
+		const Elite::Vector2& from{ i == 0 ? start : m_Corners[i - 1] };
+		const Elite::Vector2& before{ i <= 1 ? start : m_Corners[i - 2] };
+		const Elite::Vector2& after{ i + 1 < cornerCount ? m_Corners[i + 1] : m_Corners[i] };
+		AddSpline(before, from, m_Corners[i], after);
+	}
+	path.assign(m_Smoothed.begin(), m_Smoothed.end());
+
+	++m_SmoothedPaths;
+	m_PlannedLength += plannedLength;
+	m_SmoothedLength += GetLength(start, path);
+	m_Seconds += std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+bool PathSmoother::IsSegmentClear(const Elite::Vector2& from, const Elite::Vector2& to) const
+{
+	return TestSegment(from, to, m_Clearance);
+}
+
+float PathSmoother::GetLengthReduction() const
+{
+	if (m_PlannedLength <= 0.0) return 0.f;
+	return float(1.0 - m_SmoothedLength / m_PlannedLength);
+}
+
+float PathSmoother::GetAverageCost() const
+{
+	if (m_SmoothedPaths == 0) return 0.f;
+	return float(m_Seconds / m_SmoothedPaths);
+}
+
+void PathSmoother::AddWall(const Elite::Vector2& min, const Elite::Vector2& max)
+{
+	m_WallCenterX.push_back((min.x + max.x) * 0.5f);
+	m_WallCenterY.push_back((min.y + max.y) * 0.5f);
+	m_WallHalfWidth.push_back((max.x - min.x) * 0.5f);
+	m_WallHalfHeight.push_back((max.y - min.y) * 0.5f);
+}
+
+void PathSmoother::OpenDoorway(const Elite::Vector2& position)
+{
+	//Cut the doorway out of every wall it touches along the length of that wall
+	const size_t wallCount{ m_WallCenterX.size() };
+	for (size_t i{}; i < wallCount; ++i)
+	{
+		if (abs(position.x - m_WallCenterX[i]) > m_WallHalfWidth[i] + m_DoorwayRadius ||
+			abs(position.y - m_WallCenterY[i]) > m_WallHalfHeight[i] + m_DoorwayRadius) continue;
+
+		const Elite::Vector2 min{ m_WallCenterX[i] - m_WallHalfWidth[i], m_WallCenterY[i] - m_WallHalfHeight[i] };
+		const Elite::Vector2 max{ m_WallCenterX[i] + m_WallHalfWidth[i], m_WallCenterY[i] + m_WallHalfHeight[i] };
+		const bool isHorizontal{ m_WallHalfWidth[i] >= m_WallHalfHeight[i] };
+		const float along{ isHorizontal ? position.x : position.y };
+		const float first{ isHorizontal ? min.x : min.y }, last{ isHorizontal ? max.x : max.y };
+
+		//The part before the doorway takes the wall's place, the part after goes at the back
+		m_WallHalfWidth[i] = 0.f;
+		m_WallHalfHeight[i] = 0.f;
+		if (along - m_DoorwayRadius > first)
+		{
+			const Elite::Vector2 pieceMax{ isHorizontal ? Elite::Vector2{ along - m_DoorwayRadius, max.y } : Elite::Vector2{ max.x, along - m_DoorwayRadius } };
+			m_WallCenterX[i] = (min.x + pieceMax.x) * 0.5f;
+			m_WallCenterY[i] = (min.y + pieceMax.y) * 0.5f;
+			m_WallHalfWidth[i] = (pieceMax.x - min.x) * 0.5f;
+			m_WallHalfHeight[i] = (pieceMax.y - min.y) * 0.5f;
+		}
+		if (along + m_DoorwayRadius < last)
+		{
+			const Elite::Vector2 pieceMin{ isHorizontal ? Elite::Vector2{ along + m_DoorwayRadius, min.y } : Elite::Vector2{ min.x, along + m_DoorwayRadius } };
+			AddWall(pieceMin, max);
+		}
+	}
+
+	//Drop the walls that were cut away completely
+	size_t keptCount{};
+	for (size_t i{}; i < m_WallCenterX.size(); ++i)
+	{
+		if (m_WallHalfWidth[i] <= 0.f && m_WallHalfHeight[i] <= 0.f) continue;
+		m_WallCenterX[keptCount] = m_WallCenterX[i];
+		m_WallCenterY[keptCount] = m_WallCenterY[i];
+		m_WallHalfWidth[keptCount] = m_WallHalfWidth[i];
+		m_WallHalfHeight[keptCount] = m_WallHalfHeight[i];
+		++keptCount;
+	}
+	m_WallCenterX.resize(keptCount);
+	m_WallCenterY.resize(keptCount);
+	m_WallHalfWidth.resize(keptCount);
+	m_WallHalfHeight.resize(keptCount);
+}
+
+bool PathSmoother::TestSegment(const Elite::Vector2& from, const Elite::Vector2& to, float clearance) const
+{
+	//Separating axis test of the segment against every grown wall box: both box axes and the segment's normal.
+	//No early out so the loop stays branch free and the compiler can vectorize it.
+	const float middleX{ (from.x + to.x) * 0.5f }, middleY{ (from.y + to.y) * 0.5f };
+	const float halfX{ (to.x - from.x) * 0.5f }, halfY{ (to.y - from.y) * 0.5f };
+	const float extentX{ abs(halfX) }, extentY{ abs(halfY) };
+
+	const float* pCenterX{ m_WallCenterX.data() };
+	const float* pCenterY{ m_WallCenterY.data() };
+	const float* pHalfWidth{ m_WallHalfWidth.data() };
+	const float* pHalfHeight{ m_WallHalfHeight.data() };
+	const int wallCount{ int(m_WallCenterX.size()) };
+	int hits{};
+	for (int i{}; i < wallCount; ++i)
+	{
+		const float width{ pHalfWidth[i] + clearance }, height{ pHalfHeight[i] + clearance };
+		const float dx{ middleX - pCenterX[i] }, dy{ middleY - pCenterY[i] };
+		hits += int(abs(dx) <= width + extentX) & int(abs(dy) <= height + extentY) &
+			int(abs(halfX * dy - halfY * dx) <= width * extentY + height * extentX);
+	}
+	return hits == 0;
+}
+
+void PathSmoother::PullString(const Elite::Vector2& start, const std::vector<Elite::Vector2>& path)
+{
+	//Walk from every kept corner to the furthest point it still sees
+	m_Corners.clear();
+	Elite::Vector2 anchor{ start };
+	size_t i{};
+	while (i < path.size())
+	{
+		while (i + 1 < path.size() && IsSegmentClear(anchor, path[i + 1])) ++i;
+		m_Corners.push_back(path[i]);
+		anchor = path[i];
+		++i;
+	}
+}
+
+void PathSmoother::AddSpline(const Elite::Vector2& before, const Elite::Vector2& from, const Elite::Vector2& to, const Elite::Vector2& after)
+{
+	const int sampleCount{ std::max<int>(1, int(Elite::Distance(from, to) / m_SampleSpacing)) };
+	const size_t firstSample{ m_Smoothed.size() };
+	Elite::Vector2 previous{ from };
+	for (int sample{ 1 }; sample <= sampleCount; ++sample)
+	{
+		const float t{ float(sample) / sampleCount }, t2{ t * t }, t3{ t2 * t };
+		const Elite::Vector2 position{ 0.5f * (2.f * from + (to - before) * t + (2.f * before - 5.f * from + 4.f * to - after) * t2 +
+			(3.f * from - before - 3.f * to + after) * t3) };
+
+		//A curve that swings into a wall falls back to the straight corner
+		if (!IsSegmentClear(previous, position))
+		{
+			m_Smoothed.resize(firstSample);
+			m_Smoothed.push_back(to);
+			return;
+		}
+		m_Smoothed.push_back(position);
+		previous = position;
+	}
+	m_Smoothed.back() = to;
+}
+
+float PathSmoother::GetLength(const Elite::Vector2& start, const std::vector<Elite::Vector2>& path)
+{
+	float length{};
+	Elite::Vector2 previous{ start };
+	for (const Elite::Vector2& point : path)
+	{
+		length += Elite::Distance(previous, point);
+		previous = point;
+	}
+	return length;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include "Exam_HelperStructs.h"
+
+//Post-processing for planned paths: string pulling drops every point the agent can see past, then the remaining
+//corners are rounded with a Catmull-Rom spline wherever the curve stays clear of the walls.
+//Line of sight is tested against the same walls the path planner knows about, kept as arrays of box bounds so
+//the test against all of them is a single branch free loop. That is cheap enough to run on every segment as it is.
+class PathSmoother final
+{
+public:
+	PathSmoother(float clearance = 1.f, float doorwayRadius = 4.f, float sampleSpacing = 2.f);
+	~PathSmoother() = default;
+	PathSmoother(const PathSmoother&) = delete;
+	PathSmoother& operator=(const PathSmoother&) = delete;
+	PathSmoother(PathSmoother&&) = delete;
+	PathSmoother& operator=(PathSmoother&&) = delete;
+
+	//Same walls as the path planner, see GridPathfinder
+	void AddHouse(const HouseInfo& house);
+	void AddDoorway(const Elite::Vector2& position);
+
+	//path holds the points to visit after start, like the planner output, and is replaced by the smoothed points
+	void Smooth(const Elite::Vector2& start, std::vector<Elite::Vector2>& path);
+	bool IsSegmentClear(const Elite::Vector2& from, const Elite::Vector2& to) const; //Keeps the clearance from the walls
+
+	//Statistics over every smoothed path
+	int GetSmoothedPaths() const { return m_SmoothedPaths; }
+	float GetLengthReduction() const; //Fraction of the planned length that was cut
+	float GetAverageCost() const; //Seconds per path
+
+private:
+	void AddWall(const Elite::Vector2& min, const Elite::Vector2& max);
+	void OpenDoorway(const Elite::Vector2& position);
+	bool TestSegment(const Elite::Vector2& from, const Elite::Vector2& to, float clearance) const;
+	void PullString(const Elite::Vector2& start, const std::vector<Elite::Vector2>& path);
+	void AddSpline(const Elite::Vector2& before, const Elite::Vector2& from, const Elite::Vector2& to, const Elite::Vector2& after);
+	static float GetLength(const Elite::Vector2& start, const std::vector<Elite::Vector2>& path);
+
+	float m_Clearance{};
+	float m_DoorwayRadius{};
+	float m_SampleSpacing{};
+
+	//Known walls, one box per entry
+	std::vector<float> m_WallCenterX{};
+	std::vector<float> m_WallCenterY{};
+	std::vector<float> m_WallHalfWidth{};
+	std::vector<float> m_WallHalfHeight{};
+	std::vector<HouseInfo> m_Houses{};
+	std::vector<Elite::Vector2> m_Doorways{};
+
+	std::vector<Elite::Vector2> m_Corners{};
+	std::vector<Elite::Vector2> m_Smoothed{};
+
+	int m_SmoothedPaths{};
+	double m_PlannedLength{};
+	double m_SmoothedLength{};
+	double m_Seconds{};
+};
@@ -3,6 +3,25 @@
 #include "IExamInterface.h"
 #include "Behaviours.h"
 
+namespace
+{
+	//Empty when it isn't set
+	std::string ReadEnvironment(const char* name)
+	{
+#ifdef _WIN32
+		char* pValue{};
+		size_t length{};
+		if (_dupenv_s(&pValue, &length, name) != 0 || pValue == nullptr) return {};
+		const std::string value{ pValue };
+		free(pValue);
+		return value;
+#else
+		const char* pValue{ getenv(name) };
+		return pValue != nullptr ? pValue : std::string{};
+#endif
+	}
+}
+
 //Called only once, during initialization
 void Plugin::Initialize(IBaseInterface* pInterface, PluginInfo& info)
 {
@@ -10,6 +29,27 @@ void Plugin::Initialize(IBaseInterface* pInterface, PluginInfo& info)
 	//This interface gives you access to certain actions the AI_Framework can perform for you
 	m_pInterface = static_cast<IExamInterface*>(pInterface);
 
+	//Before anything asks the framework, everything it answers goes in the trace
+	const std::string traceFile{ ReadEnvironment("GPP_TRACE") };
+	if (!traceFile.empty())
+	{
+		m_pTraceRecorder = new TraceRecorder(m_pInterface, traceFile, m_Seed);
+		m_pInterface = m_pTraceRecorder;
+	}
+	m_IsDeterministic = m_pTraceRecorder != nullptr || !ReadEnvironment("GPP_DETERMINISTIC").empty();
+	m_ValidateInventory = !ReadEnvironment("GPP_VALIDATE_INVENTORY").empty();
+
+	//Without a file every parameter keeps its default, only one that was asked for has to be there
+	if (!m_HasParameters)
+	{
+		const std::string namedFile{ ReadEnvironment("GPP_PARAMETERS") };
+		const std::string parametersFile{ namedFile.empty() ? "AIParameters.txt" : namedFile };
+		AIParameters parameters{};
+		std::string error{};
+		if (parameters.Load(parametersFile, error)) m_Parameters = parameters;
+		else if (!namedFile.empty() || std::ifstream{ parametersFile }) std::cout << "Parameters not loaded: " << error << '\n';
+	}
+
 	//Bit information about the plugin
 	//Please fill this in!!
 	info.BotName = "BotNameTEST";
@@ -18,19 +58,17 @@ void Plugin::Initialize(IBaseInterface* pInterface, PluginInfo& info)
 	info.Student_Class = "2DAE07";
 
 	//Called when the plugin is loaded
-	m_pSeek = new Seek();
-	m_pWander = new Wander();
-	m_pFlee = new Flee();
-	m_pFace = new Face();
+	m_pAvoid = new Avoid();
+	m_pSteeringPipeline = new SteeringPipeline();
+	m_pVelocityObstacles = new VelocityObstacles();
 
 	//Setups blackboard
 	m_pBlackboard = new Blackboard();
 	//Steering
-	m_pBlackboard->AddData("SteeringBehavior", &m_pSteeringBehavior);
-	m_pBlackboard->AddData("Seek", m_pSeek);
-	m_pBlackboard->AddData("Wander", m_pWander);
-	m_pBlackboard->AddData("Flee", m_pFlee);
-	m_pBlackboard->AddData("Face", m_pFace);
+	Wander wander{};
+	wander.SetRandomSeed(uint64_t(m_Seed), Random::Stream::Wander);
+	m_pBlackboard->AddData("Steering", SteeringState{});
+	m_pBlackboard->AddData("Wander", wander); //Picks up where it left off every time the agent starts wandering again
 	m_pBlackboard->AddData("SteeringCooldown", 0.f);
 	m_pBlackboard->AddData("SteeringCooldownRemaining", 0.f);
 	m_pBlackboard->AddData("VariableSteeringCooldown", 0.f);
@@ -50,14 +88,21 @@ void Plugin::Initialize(IBaseInterface* pInterface, PluginInfo& info)
 	//Inventory
 	m_pInventory = new Inventory(m_pInterface);
 	m_pBlackboard->AddData("Inventory", m_pInventory);
+	m_pInventoryOptimizer = new InventoryOptimizer(m_pInventory->GetCapacity());
+	m_pBlackboard->AddData("InventoryOptimizer", m_pInventoryOptimizer);
 
 	//World info
 	std::vector<HouseInfo> houses{};
 	Elite::Vector2 houseEnteredAt{};
 	m_pBlackboard->AddData("Houses", houses);
 	m_pBlackboard->AddData("HouseEnteredAt", houseEnteredAt);
+	m_pBlackboard->AddData("HouseLootSeen", 0); //Most items seen inside the house during this visit
 	m_pBlackboard->AddData("TimeInHouse", 0.f);
 	m_pBlackboard->AddData("EnteredHouses", &m_HousesEntered);
+	m_pBlackboard->AddData("ItemsLeft", &m_ItemsLeft);
+	m_pHouseRoute = new HouseRouteOptimizer(m_Parameters.HouseMemoryTime);
+	if (m_IsDeterministic) m_pHouseRoute->SetEvaluationBudget(m_HouseRouteEvaluationBudget);
+	m_pBlackboard->AddData("HouseRoute", m_pHouseRoute);
 	m_pBlackboard->AddData("Path", &m_Path);
 	m_pBlackboard->AddData("CurrentPathNode", &m_CurrentPathNode);
 
@@ -67,17 +112,46 @@ void Plugin::Initialize(IBaseInterface* pInterface, PluginInfo& info)
 	std::vector<EntityInfo> entities{};
 	m_pBlackboard->AddData("Entities", entities);
 
-	m_pBlackboard->AddData("WorldInfo", m_pInterface->World_GetInfo());
+	WorldInfo worldInfo{ m_pInterface->World_GetInfo() };
+	m_pBlackboard->AddData("WorldInfo", worldInfo);
+
+	//Exploration, WorldInfo::Dimensions holds the full size of the world
+	const Elite::Vector2 worldHalfSize{ worldInfo.Dimensions * 0.5f };
+	m_pExplorationGrid = new ExplorationGrid(worldInfo.Center - worldHalfSize, worldInfo.Center + worldHalfSize, m_ExplorationCellSize);
+	const Elite::Vector2 boundsMargin{ 2 * m_ExplorationCellSize, 2 * m_ExplorationCellSize };
+	m_pExplorationGrid->SetReachableBounds(worldInfo.Center - worldHalfSize + boundsMargin, worldInfo.Center + worldHalfSize - boundsMargin);
+	m_pBlackboard->AddData("ExplorationGrid", m_pExplorationGrid);
+	m_pBlackboard->AddData("ExplorationTarget", Elite::Vector2{});
+	m_pBlackboard->AddData("HasExplorationTarget", false); //Until a frontier is picked the target means nothing
+
+	//Pathfinding
+	m_pPathPlanner = new PathPlanner(worldInfo.Center - worldHalfSize, worldInfo.Center + worldHalfSize, m_PathfindingCellSize, 16, !m_IsDeterministic);
+	m_PlannedPath.Points.reserve(512);
+	m_pBlackboard->AddData("PathPlanner", m_pPathPlanner);
+	m_pBlackboard->AddData("PlannedPath", &m_PlannedPath);
+	m_pPathSmoother = new PathSmoother(1.f, std::max<float>(3.f, 2 * m_PathfindingCellSize));
+	m_pBlackboard->AddData("PathSmoother", m_pPathSmoother);
+	m_pNavMeshCache = new NavMeshCache(m_pInterface, m_NavMeshCacheCellSize);
+	m_pLevelIndex = new LevelIndex();
+	m_pLevelFields = new LevelFields();
+	//Only shared once the index is confirmed
+	m_pBlackboard->AddData("LevelIndex", static_cast<LevelIndex*>(nullptr));
+	m_pBlackboard->AddData("LevelFields", static_cast<LevelFields*>(nullptr));
+	LoadLevelIndex(worldInfo);
 
 	//Enemies
+	m_pFleeField = new FleeField();
+	m_Threats.reserve(64);
+	m_pContextSteering = new ContextSteering(32);
+	m_pBlackboard->AddData("FleeField", m_pFleeField);
+	m_pBlackboard->AddData("ContextSteering", m_pContextSteering);
 	m_pBlackboard->AddData("EnemiesLastSeen", &m_EnemiesLastSeen);
-	m_pBlackboard->AddData("EnemyMemoryTime", m_EnemyMemoryTime);
-	m_pBlackboard->AddData("RememberedEnemyFleeRange", m_RememberedEnemyFleeRange);
 	m_pBlackboard->AddData("RememberFleeLocation", Elite::Vector2{});
 	m_pBlackboard->AddData("RememberFleeLocationWeight", 0.f);
 
 	//Add interface to blackboard
 	m_pBlackboard->AddData("Interface", m_pInterface);
+	m_pBlackboard->AddData("Parameters", static_cast<const AIParameters*>(&m_Parameters));
 
 	m_Path.push_back({ -86,27 });
 	m_Path.push_back({ -110,110 });
@@ -211,12 +285,32 @@ void Plugin::DllInit()
 void Plugin::DllShutdown()
 {
 	//Called wheb the plugin gets unloaded
-	SAFE_DELETE(m_pSeek);
-	SAFE_DELETE(m_pWander);
-	SAFE_DELETE(m_pFlee);
-	SAFE_DELETE(m_pFace);
+	SAFE_DELETE(m_pAvoid);
+	if (m_pSteeringPipeline != nullptr && m_pSteeringPipeline->GetEvaluations() > 0)
+		std::cout << "Steering pipeline: " << m_pSteeringPipeline->GetAverageCost() * 1000000.f << " microseconds per frame" << '\n';
+	SAFE_DELETE(m_pSteeringPipeline);
+	if (m_pVelocityObstacles != nullptr && m_pVelocityObstacles->GetEvaluations() > 0)
+		std::cout << "Velocity obstacles: " << m_pVelocityObstacles->GetAverageCost() * 1000000.f << " microseconds per frame" << '\n';
+	SAFE_DELETE(m_pVelocityObstacles);
 	SAFE_DELETE(m_pInventory);
+	SAFE_DELETE(m_pInventoryOptimizer);
+	SAFE_DELETE(m_pExplorationGrid);
+	SAFE_DELETE(m_pHouseRoute);
+	SAFE_DELETE(m_pPathPlanner);
+	if (m_pPathSmoother != nullptr && m_pPathSmoother->GetSmoothedPaths() > 0)
+		std::cout << "Path smoothing: " << m_pPathSmoother->GetSmoothedPaths() << " paths, " << m_pPathSmoother->GetLengthReduction() * 100.f << "% shorter, "
+			<< m_pPathSmoother->GetAverageCost() * 1000.f << "ms per path" << '\n';
+	SAFE_DELETE(m_pPathSmoother);
+	if (m_pNavMeshCache != nullptr)
+		std::cout << "NavMesh cache hits: " << m_pNavMeshCache->GetHits() << ", misses: " << m_pNavMeshCache->GetMisses() << '\n';
+	SAFE_DELETE(m_pNavMeshCache);
+	SAFE_DELETE(m_pFleeField);
+	SAFE_DELETE(m_pContextSteering);
+	SAFE_DELETE(m_pLevelFields);
+	SAFE_DELETE(m_pLevelIndex);
 	SAFE_DELETE(m_pBehaviorTree);
+	//Writes what is left of the trace
+	SAFE_DELETE(m_pTraceRecorder);
 }
 
 //Called only once, during initialization
@@ -228,6 +322,18 @@ void Plugin::InitGameDebugParams(GameDebugParams& params)
 	params.EnemyCount = 20; //How many enemies? (Default = 20)
 	params.GodMode = false; //GodMode > You can't die, can be usefull to inspect certain behaviours (Default = false)
 	params.AutoGrabClosestItem = false; //A call to Item_Grab(...) returns the closest item that can be grabbed. (EntityInfo argument is ignored)
+
+	//The level the framework is about to load, the index and fields are baked from it
+	m_LevelFilePath = params.LevelFile;
+
+	//Same seed, same wandering
+	m_Seed = params.Seed;
+	Wander wander{};
+	if (m_pBlackboard != nullptr && m_pBlackboard->GetData("Wander", wander))
+	{
+		wander.SetRandomSeed(uint64_t(m_Seed), Random::Stream::Wander);
+		m_pBlackboard->ChangeData("Wander", wander);
+	}
 }
 
 //Only Active in DEBUG Mode
@@ -281,8 +387,11 @@ void Plugin::Update(float dt)
 //This function calculates the new SteeringOutput, called once per frame
 SteeringPlugin_Output Plugin::UpdateSteering(float dt)
 {
+	if (m_pTraceRecorder != nullptr) m_pTraceRecorder->BeginFrame(dt);
 	auto agentInfo = m_pInterface->Agent_GetInfo();
 	m_pBlackboard->ChangeData("Agent", agentInfo);
+	m_pExplorationGrid->MarkFOV(agentInfo);
+	if (m_ValidateInventory) m_pInventory->Validate();
 
 	//Update data
 	float SteeringCooldown{};
@@ -295,17 +404,23 @@ SteeringPlugin_Output Plugin::UpdateSteering(float dt)
 	else m_pBlackboard->ChangeData("TimeInHouse", 0.f);
 
 	std::for_each(m_HousesEntered.begin(), m_HousesEntered.end(), [dt](LastSeen& lastSeen) {lastSeen.timeElapsed += dt; });
-	float houseMemoryTime{ m_HouseMemoryTime };
+	float houseMemoryTime{ m_Parameters.HouseMemoryTime };
 	m_HousesEntered.erase(std::remove_if(m_HousesEntered.begin(), m_HousesEntered.end(), [houseMemoryTime](const LastSeen& lastSeen) {
 		return lastSeen.timeElapsed >= houseMemoryTime;
 	}), m_HousesEntered.end());
 
+	std::for_each(m_ItemsLeft.begin(), m_ItemsLeft.end(), [dt](LastSeen& lastSeen) {lastSeen.timeElapsed += dt; });
+	float itemLeftMemoryTime{ m_Parameters.ItemLeftMemoryTime };
+	m_ItemsLeft.erase(std::remove_if(m_ItemsLeft.begin(), m_ItemsLeft.end(), [itemLeftMemoryTime](const LastSeen& lastSeen) {
+		return lastSeen.timeElapsed >= itemLeftMemoryTime;
+	}), m_ItemsLeft.end());
+
 	std::for_each(m_EnemiesLastSeen.begin(), m_EnemiesLastSeen.end(), [dt](LastSeen& lastSeen) {
 		lastSeen.timeElapsed += dt; 
 		lastSeen.PredictedLocation = lastSeen.SeenLocation + lastSeen.timeElapsed * lastSeen.Velocty;
 	});
-	float enemyMemoryTime{ m_EnemyMemoryTime };
-	float enemyWorryRange{ m_RememberedEnemyFleeRange };
+	float enemyMemoryTime{ m_Parameters.EnemyMemoryTime };
+	float enemyWorryRange{ m_Parameters.RememberedEnemyFleeRange };
 	m_EnemiesLastSeen.erase(
 		std::remove_if(m_EnemiesLastSeen.begin(), m_EnemiesLastSeen.end(),
 			[enemyMemoryTime, enemyWorryRange, &agentInfo](const LastSeen& lastSeen) {
@@ -326,8 +441,24 @@ SteeringPlugin_Output Plugin::UpdateSteering(float dt)
 	auto vEntitiesInFOV = GetEntitiesInFOV();
 
 	m_pBlackboard->ChangeData("Houses", vHousesInFOV);
+	ConfirmLevelIndex(vHousesInFOV);
+	for (const HouseInfo& house : vHousesInFOV)
+	{
+		m_pPathPlanner->AddHouse(house);
+		m_pPathSmoother->AddHouse(house);
+		m_pHouseRoute->AddHouse(house);
+	}
+	m_pHouseRoute->Update(dt, agentInfo.Position);
+	m_pHouseRoute->Improve(m_HouseRouteTimeBudget);
+	//Items left on the ground aren't worth walking to again
+	vEntitiesInFOV.erase(std::remove_if(vEntitiesInFOV.begin(), vEntitiesInFOV.end(), [this](const EntityInfo& entity) {
+		return entity.Type == eEntityType::ITEM && std::find(m_ItemsLeft.begin(), m_ItemsLeft.end(), entity) != m_ItemsLeft.end();
+	}), vEntitiesInFOV.end());
 	m_pBlackboard->ChangeData("Entities", vEntitiesInFOV);
 
+	m_Threats.clear();
+	m_pAvoid->ClearObstacles();
+	m_pVelocityObstacles->Clear();
 	for (auto& e : vEntitiesInFOV)
 	{
 		if (e.Type == eEntityType::PURGEZONE)
@@ -335,8 +466,24 @@ SteeringPlugin_Output Plugin::UpdateSteering(float dt)
 			PurgeZoneInfo zoneInfo;
 			m_pInterface->PurgeZone_GetInfo(e, zoneInfo);
 			std::cout << "Purge Zone in FOV:" << e.Location.x << ", "<< e.Location.y <<  " ---EntityHash: " << e.EntityHash << "---Radius: "<< zoneInfo.Radius << std::endl;
+			m_Threats.push_back(FleeField::Threat{ zoneInfo.Center, zoneInfo.Radius });
 		}
+		else if (e.Type == eEntityType::ENEMY)
+		{
+			EnemyInfo enemyInfo;
+			m_pInterface->Enemy_GetInfo(e, enemyInfo);
+			m_pAvoid->AddObstacle(enemyInfo.Location, enemyInfo.Size);
+			m_pVelocityObstacles->AddNeighbour(enemyInfo.Location, enemyInfo.LinearVelocity, enemyInfo.Size);
+			m_Threats.push_back(FleeField::Threat{ enemyInfo.Location, 0.f });
+		}
+	}
+
+	//Before the tree, it flees along the field. Does nothing when the threats are the same as last frame
+	for (const LastSeen& enemy : m_EnemiesLastSeen)
+	{
+		m_Threats.push_back(FleeField::Threat{ enemy.PredictedLocation, 0.f });
 	}
+	m_pFleeField->Update(agentInfo.Position, m_Threats);
 
 	m_pBehaviorTree->Update(dt);
 
@@ -345,19 +492,35 @@ SteeringPlugin_Output Plugin::UpdateSteering(float dt)
 
 	//if (!Elite::AreEqual(m_Target.x, 0.f) || !Elite::AreEqual(m_Target.y, 0.f)) target.Position = m_Target;
 
-	if (m_pSteeringBehavior == m_pFlee)
+	SteeringState steeringState{};
+	m_pBlackboard->GetData("Steering", steeringState);
+
+	bool isFollowingField{ false };
+	if (steeringState.Is(SteeringState::Kind::Flee))
 	{
 		//If fleeing, agent should take in surroundings => Seek to localy inverted target
+		//The flee targets already come out of the context maps, which follow the flee field
 		Elite::Vector2 agentToTarget{ target.Position - agentInfo.Position };
 		target.Position += -2 * agentToTarget;
-		m_pSteeringBehavior = m_pSeek;
+		if (m_IsLevelIndexConfirmed && m_pLevelFields->IsLoaded())
+		{
+			//The fields already keep the agent off the walls, the navmesh would only pull it back into them
+			target.Position = GetFieldFleeTarget(agentInfo.Position, agentToTarget);
+			isFollowingField = true;
+		}
+		steeringState = Seek{};
 	}
 
-	if(m_pSteeringBehavior != m_pFace) target.Position = m_pInterface->NavMesh_GetClosestPathPoint(target.Position);
-	m_pSteeringBehavior->SetTarget(target);
+	const bool isFacing{ steeringState.Is(SteeringState::Kind::Face) };
+	if(!isFacing && !isFollowingField) target.Position = m_pNavMeshCache->GetClosestPathPoint(target.Position, agentInfo.Position);
 
 	m_Target = target.Position;
-	steering = m_pSteeringBehavior->CalculateSteering(dt, agentInfo);
+	m_pSteeringPipeline->Clear();
+	m_pSteeringPipeline->Add(steeringState, target);
+	if (!isFacing) m_pSteeringPipeline->Add(*m_pAvoid, m_AvoidanceWeight);
+	steering = m_pSteeringPipeline->CalculateSteering(dt, agentInfo);
+	m_pBlackboard->ChangeData("Steering", steeringState);
+	if (!isFacing) steering.LinearVelocity = m_pVelocityObstacles->GetSafeVelocity(agentInfo, steering.LinearVelocity, dt);
 	//steering = m_pFace->CalculateSteering(dt, agentInfo);
 	m_pBlackboard->GetData("RunMode", steering.RunMode);
 
@@ -368,12 +531,14 @@ SteeringPlugin_Output Plugin::UpdateSteering(float dt)
 	m_PreviousAgentHistoryIndex = (m_PreviousAgentHistoryIndex + 1) % m_AgentHistorySize;
 	m_AgentHistory[m_PreviousAgentHistoryIndex] = agentInfo;
 
+	if (m_pTraceRecorder != nullptr) m_pTraceRecorder->EndFrame(steering);
 	return steering;
 }
 
 //This function should only be used for rendering debug elements
 void Plugin::Render(float dt) const
 {
+#if PLUGIN_DEBUG_DRAW
 	//This Render function should only contain calls to Interface->Draw_... functions
 	TargetData target{};
 	m_pBlackboard->GetData("Target", target);
@@ -384,23 +549,24 @@ void Plugin::Render(float dt) const
 	m_pInterface->Draw_Circle(m_Target, 1.7f, { 0,1,0 });
 
 	auto worldInfo = m_pInterface->World_GetInfo();
+	const Elite::Vector2 worldHalfSize{ worldInfo.Dimensions * 0.5f }; //Dimensions is the full size
 	Elite::Vector2 worldPoints[4] = {
-		{worldInfo.Center + Elite::Vector2{worldInfo.Dimensions.x, worldInfo.Dimensions.y}},
-		{worldInfo.Center + Elite::Vector2{-worldInfo.Dimensions.x, worldInfo.Dimensions.y}},
-		{worldInfo.Center + Elite::Vector2{-worldInfo.Dimensions.x, -worldInfo.Dimensions.y}},
-		{worldInfo.Center + Elite::Vector2{worldInfo.Dimensions.x, -worldInfo.Dimensions.y}},
+		{worldInfo.Center + Elite::Vector2{worldHalfSize.x, worldHalfSize.y}},
+		{worldInfo.Center + Elite::Vector2{-worldHalfSize.x, worldHalfSize.y}},
+		{worldInfo.Center + Elite::Vector2{-worldHalfSize.x, -worldHalfSize.y}},
+		{worldInfo.Center + Elite::Vector2{worldHalfSize.x, -worldHalfSize.y}},
 	};
 	m_pInterface->Draw_Polygon(worldPoints, 4, { 1,0,0 });
 
-	const float tooCloseToBorderRange{ 125.f }; //Corresponds to Behaviors.h agentIsReachingWorldBounds
+	const float tooCloseToBorderRange{ m_Parameters.WorldBoundsRange }; //The range agentIsReachingWorldBounds in Behaviours.h turns back at
 	Elite::Vector2 agentBounds[4] = {
-		{worldInfo.Center + Elite::Vector2{worldInfo.Dimensions.x - tooCloseToBorderRange, worldInfo.Dimensions.y - tooCloseToBorderRange}},
-		{worldInfo.Center + Elite::Vector2{-worldInfo.Dimensions.x + tooCloseToBorderRange, worldInfo.Dimensions.y - tooCloseToBorderRange}},
-		{worldInfo.Center + Elite::Vector2{-worldInfo.Dimensions.x + tooCloseToBorderRange, -worldInfo.Dimensions.y + tooCloseToBorderRange}},
-		{worldInfo.Center + Elite::Vector2{worldInfo.Dimensions.x - tooCloseToBorderRange, -worldInfo.Dimensions.y + tooCloseToBorderRange}},
+		{worldInfo.Center + Elite::Vector2{worldHalfSize.x - tooCloseToBorderRange, worldHalfSize.y - tooCloseToBorderRange}},
+		{worldInfo.Center + Elite::Vector2{-worldHalfSize.x + tooCloseToBorderRange, worldHalfSize.y - tooCloseToBorderRange}},
+		{worldInfo.Center + Elite::Vector2{-worldHalfSize.x + tooCloseToBorderRange, -worldHalfSize.y + tooCloseToBorderRange}},
+		{worldInfo.Center + Elite::Vector2{worldHalfSize.x - tooCloseToBorderRange, -worldHalfSize.y + tooCloseToBorderRange}},
 	};
 	m_pInterface->Draw_Polygon(agentBounds, 4, { 1,1,1 });
-
+#endif
 }
 
 vector<HouseInfo> Plugin::GetHousesInFOV() const
@@ -422,6 +588,128 @@ vector<HouseInfo> Plugin::GetHousesInFOV() const
 	return vHousesInFOV;
 }
 
+bool Plugin::LoadLevelIndex(const WorldInfo& worldInfo)
+{
+	//GameLevel.gppl bakes to GameLevel.gppli and GameLevel.gpplf
+	const size_t extension{ m_LevelFilePath.find_last_of('.') };
+	const size_t directory{ m_LevelFilePath.find_last_of("/\\") };
+	const std::string basePath{ extension != std::string::npos && (directory == std::string::npos || extension > directory) ?
+		m_LevelFilePath.substr(0, extension) : m_LevelFilePath };
+	const std::string indexFilePath{ basePath + ".gppli" };
+	const std::string fieldsFilePath{ basePath + ".gpplf" };
+
+	//The level is hashed every time, so whatever was baked from an older version of it is baked again
+	MappedFile levelFile{};
+	if (!levelFile.Open(m_LevelFilePath))
+	{
+		std::cout << "Level not loaded: " << m_LevelFilePath << " could not be opened" << '\n';
+		return false;
+	}
+	const uint64_t levelHash{ LevelIndex::HashSource(levelFile.GetData(), levelFile.GetSize()) };
+
+	bool isBaked{ false };
+	if (!m_pLevelIndex->Load(indexFilePath, levelHash))
+	{
+		LevelParser parser{};
+		LevelGeometry level{};
+		if (!parser.Parse(levelFile.GetData(), levelFile.GetSize(), level))
+		{
+			std::cout << "Level not loaded: " << parser.GetError() << '\n';
+			return false;
+		}
+
+		if (!LevelIndex::Bake(level, levelHash, indexFilePath) || !m_pLevelIndex->Load(indexFilePath, levelHash))
+		{
+			std::cout << "Level index could not be baked to " << indexFilePath << '\n';
+			return false;
+		}
+		isBaked = true;
+	}
+
+	const Elite::Vector2 indexSize{ m_pLevelIndex->GetWorldMax() - m_pLevelIndex->GetWorldMin() };
+	if (fabsf(indexSize.x - worldInfo.Dimensions.x) > 1.f || fabsf(indexSize.y - worldInfo.Dimensions.y) > 1.f)
+	{
+		m_pLevelIndex->Unload();
+		return false;
+	}
+
+	//Fields belong to the index they were baked from, a fresh index gets fresh fields
+	if (isBaked || !m_pLevelFields->Load(fieldsFilePath, *m_pLevelIndex))
+	{
+		if (!LevelFields::Bake(*m_pLevelIndex, fieldsFilePath) || !m_pLevelFields->Load(fieldsFilePath, *m_pLevelIndex))
+			std::cout << "Level fields could not be baked to " << fieldsFilePath << '\n';
+	}
+	return true;
+}
+
+void Plugin::ConfirmLevelIndex(const vector<HouseInfo>& housesInFOV)
+{
+	if (m_IsLevelIndexConfirmed || !m_pLevelIndex->IsLoaded() || housesInFOV.empty()) return;
+
+	//Every level has the same size, the first houses seen tell whether the index is about this one
+	for (const HouseInfo& house : housesInFOV)
+	{
+		if (m_pLevelIndex->FindHouse(house.Center) != -1) continue;
+
+		std::cout << "Level index does not match this level, ignoring it" << '\n';
+		m_pLevelFields->Unload();
+		m_pLevelIndex->Unload();
+		return;
+	}
+
+	m_IsLevelIndexConfirmed = true;
+	m_pBlackboard->ChangeData("LevelIndex", m_pLevelIndex);
+	if (m_pLevelFields->IsLoaded()) m_pBlackboard->ChangeData("LevelFields", m_pLevelFields);
+	for (uint32_t i{}; i < m_pLevelIndex->GetAmountOfHouses(); ++i)
+	{
+		const HouseInfo house{ m_pLevelIndex->GetHouseInfo(i) };
+		m_pPathPlanner->AddHouse(house);
+		m_pPathSmoother->AddHouse(house);
+		m_pHouseRoute->AddHouse(house);
+
+		const LevelIndex::House& indexedHouse{ m_pLevelIndex->GetHouse(i) };
+		for (uint32_t doorway{ indexedHouse.firstDoorway }; doorway < indexedHouse.firstDoorway + indexedHouse.doorwayCount; ++doorway)
+		{
+			m_pPathPlanner->AddDoorway(m_pLevelIndex->GetDoorway(doorway).center);
+			m_pPathSmoother->AddDoorway(m_pLevelIndex->GetDoorway(doorway).center);
+		}
+	}
+}
+
+Elite::Vector2 Plugin::GetFieldFleeTarget(const Elite::Vector2& agentPosition, const Elite::Vector2& agentToThreat) const
+{
+	const float fleeDistance{ agentToThreat.Magnitude() };
+	if (fleeDistance <= 0.f) return agentPosition;
+	const Elite::Vector2 away{ -agentToThreat / fleeDistance };
+
+	//Run towards the nearest safe region, as long as getting there doesn't mean running at the threat
+	Elite::Vector2 direction{ away };
+	const float minAlignment{ 0.3f };
+	for (LevelFields::FlowField field : { LevelFields::FlowField::HouseInteriors, LevelFields::FlowField::MapCenter })
+	{
+		if (m_pLevelFields->GetFlowDistance(field, agentPosition) <= 0.f) break; //Already in a safe region
+
+		Elite::Vector2 flowDirection{};
+		if (m_pLevelFields->GetFlowDirection(field, agentPosition, flowDirection) && Elite::Dot(flowDirection, away) >= minAlignment)
+		{
+			direction = flowDirection;
+			break;
+		}
+	}
+
+	//Push off walls that are too close instead of sliding into them
+	const float wallClearance{ 3.f };
+	const float wallDistance{ m_pLevelFields->GetDistance(agentPosition) };
+	if (wallDistance < wallClearance)
+	{
+		const float wallWeight{ 2.f * (1.f - std::max<float>(wallDistance, 0.f) / wallClearance) };
+		direction += m_pLevelFields->GetDistanceGradient(agentPosition) * wallWeight;
+		if (direction.Magnitude() > 0.f) direction.Normalize();
+	}
+
+	return agentPosition + direction * fleeDistance;
+}
+
 vector<EntityInfo> Plugin::GetEntitiesInFOV() const
 {
 	vector<EntityInfo> vEntitiesInFOV = {};
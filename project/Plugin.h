@@ -1,10 +1,32 @@
 #pragma once
 #include "IExamPlugin.h"
+#include "PluginExport.h"
 #include "Exam_HelperStructs.h"
 #include "HelperStructs.h"
 #include "SteeringBehaviors.h"
+#include "SteeringPipeline.h"
+#include "VelocityObstacles.h"
 #include "EBehaviorTree.h"
 #include "Inventory.h"
+#include "InventoryOptimizer.h"
+#include "ExplorationGrid.h"
+#include "PathPlanner.h"
+#include "PathSmoother.h"
+#include "NavMeshCache.h"
+#include "HouseRouteOptimizer.h"
+#include "LevelIndex.h"
+#include "LevelFields.h"
+#include "FleeField.h"
+#include "ContextSteering.h"
+#include "TraceRecorder.h"
+#include "AIParameters.h"
+
+//Builds nobody looks at (GPP_NO_DEBUG_DRAW, the headless harness) leave the debug drawing out
+#if defined(GPP_NO_DEBUG_DRAW)
+#define PLUGIN_DEBUG_DRAW 0
+#else
+#define PLUGIN_DEBUG_DRAW 1
+#endif
 
 class IBaseInterface;
 class IExamInterface;
@@ -13,6 +35,8 @@ class Plugin :public IExamPlugin
 {
 public:
 	Plugin() {};
+	//Plays with these instead of loading AIParameters.txt
+	explicit Plugin(const AIParameters& parameters) : m_Parameters{ parameters }, m_HasParameters{ true } {};
 	virtual ~Plugin() {};
 
 	void Initialize(IBaseInterface* pInterface, PluginInfo& info) override;
@@ -30,6 +54,9 @@ private:
 	IExamInterface* m_pInterface = nullptr;
 	vector<HouseInfo> GetHousesInFOV() const;
 	vector<EntityInfo> GetEntitiesInFOV() const;
+	bool LoadLevelIndex(const WorldInfo& worldInfo);
+	void ConfirmLevelIndex(const vector<HouseInfo>& housesInFOV);
+	Elite::Vector2 GetFieldFleeTarget(const Elite::Vector2& agentPosition, const Elite::Vector2& agentToThreat) const;
 
 	Elite::Vector2 m_Target = {};
 	bool m_CanRun = false; //Demo purpose
@@ -37,15 +64,25 @@ private:
 	bool m_UseItem = false; //Demo purpose
 	bool m_RemoveItem = false; //Demo purpose
 	float m_AngSpeed = 0.f; //Demo purpose
+	int m_Seed{ GameDebugParams{}.Seed }; //Game seed, every behaviour draws its own random stream from it
+	//GPP_TRACE=file records the game, GPP_DETERMINISTIC=1 (HeadlessReplay) plays one back. Either way nothing may depend on timing
+	TraceRecorder* m_pTraceRecorder = nullptr;
+	bool m_IsDeterministic{ false };
+	//Memory times, ranges and thresholds, shared with the behaviours through the blackboard ("Parameters")
+	AIParameters m_Parameters{};
+	bool m_HasParameters{ false }; //Given by the host, nothing is loaded then
 
 	//Enemy memory
-	float m_EnemyMemoryTime = 2.5f; //Amount of seconds positions enemies were last seen at are remembered
-	float m_RememberedEnemyFleeRange = 20.f; //After surpassing this value, dont worry about the enemies anymore
 	std::vector<LastSeen> m_EnemiesLastSeen{};
 
 	//House memory
 	std::vector<LastSeen> m_HousesEntered{};
-	float m_HouseMemoryTime = 120.f;
+	HouseRouteOptimizer* m_pHouseRoute = nullptr;
+	const float m_HouseRouteTimeBudget{ 0.0005f }; //Seconds per frame spent improving the house route
+	const int m_HouseRouteEvaluationBudget{ 1024 }; //Moves per frame instead, when the game has to play back the same
+
+	//Items the agent decided against, they stay on the ground
+	std::vector<LastSeen> m_ItemsLeft{};
 
 	//Agent memory
 	const size_t m_AgentHistorySize{ 50 };
@@ -56,19 +93,45 @@ private:
 	std::vector<Elite::Vector2> m_Path{};
 	size_t m_CurrentPathNode{ 0 };
 
+	//Exploration
+	ExplorationGrid* m_pExplorationGrid = nullptr;
+	const float m_ExplorationCellSize{ 4.f };
+
+	//Pathfinding
+	PathPlanner* m_pPathPlanner = nullptr;
+	PlannedPath m_PlannedPath{};
+	const float m_PathfindingCellSize{ 2.f };
+	PathSmoother* m_pPathSmoother = nullptr;
+	NavMeshCache* m_pNavMeshCache = nullptr;
+	const float m_NavMeshCacheCellSize{ 1.f };
+
+	//Level knowledge, baked once from the level file and memory mapped afterwards, next to the level (.gppli, .gpplf)
+	LevelIndex* m_pLevelIndex = nullptr;
+	LevelFields* m_pLevelFields = nullptr;
+	std::string m_LevelFilePath{ "GameLevel.gppl" }; //GameDebugParams::LevelFile
+	bool m_IsLevelIndexConfirmed{ false }; //Only used once the houses in view match it
+
+	//Distance to the remembered enemies and purge zones in view, kept up to date every frame
+	FleeField* m_pFleeField = nullptr;
+	std::vector<FleeField::Threat> m_Threats{};
+	ContextSteering* m_pContextSteering = nullptr;
+
 	Elite::Blackboard* m_pBlackboard = nullptr;
 	Elite::IDecisionMaking* m_pBehaviorTree = nullptr;
 
 	//Inventory
 	Inventory* m_pInventory = nullptr;
+	bool m_ValidateInventory{ false }; //GPP_VALIDATE_INVENTORY=1 cross-checks the inventory's shadow against the host every frame
+	InventoryOptimizer* m_pInventoryOptimizer = nullptr;
 
 	//Steering
-	ISteeringBehavior* m_pSteeringBehavior = nullptr; //Will point to current steering behavior, doesn't get initiated. Do not delete
-	Seek* m_pSeek = nullptr;
-	Wander* m_pWander = nullptr;
-	Flee* m_pFlee = nullptr;
-	Face* m_pFace = nullptr;
+	//The current behaviour is a SteeringState stored in the blackboard ("Steering")
 	const float m_SteeringCooldown = 0.5f;
+	//The behaviour picked by the tree, blended with avoiding the enemies in view
+	SteeringPipeline* m_pSteeringPipeline = nullptr;
+	Avoid* m_pAvoid = nullptr;
+	const float m_AvoidanceWeight{ 1.f };
+	VelocityObstacles* m_pVelocityObstacles = nullptr; //Keeps the final velocity clear of the enemies in view
 };
 
 //ENTRY
@@ -76,8 +139,17 @@ private:
 //The plugin returned by this function is also the plugin used by the host program
 extern "C"
 {
-	__declspec (dllexport) IPluginBase* Register()
+	PLUGIN_EXPORT IPluginBase* Register()
 	{
 		return new Plugin();
 	}
+
+	//For hosts that play several parameter sets side by side (HeadlessTune), in the format of AIParameters.txt
+	PLUGIN_EXPORT IPluginBase* RegisterWithParameters(const char* pParameters)
+	{
+		AIParameters parameters{};
+		std::string error{};
+		if (!parameters.Parse(pParameters, error)) return nullptr;
+		return new Plugin(parameters);
+	}
 }
\ No newline at end of file
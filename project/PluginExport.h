@@ -0,0 +1,11 @@
+#pragma once
+
+//Marks what the host looks up in the plugin library, Register() and RegisterWithParameters().
+//Everything else stays inside the library on compilers that hide symbols by default or when told to.
+#if defined(_WIN32)
+#define PLUGIN_EXPORT __declspec(dllexport)
+#elif defined(__GNUC__)
+#define PLUGIN_EXPORT __attribute__((visibility("default")))
+#else
+#define PLUGIN_EXPORT
+#endif
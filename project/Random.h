@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+
+//Small seedable random generator (PCG32, O'Neill), owned per user instead of the global rand() state.
+//Every seed has 2^63 independent streams, so each behaviour can draw from its own stream of the same
+//game seed and replays and parallel simulations don't depend on who drew first.
+class Random final
+{
+public:
+	//Streams handed out by the plugin, one per user
+	enum class Stream : uint64_t
+	{
+		Wander = 1
+	};
+
+	explicit Random(uint64_t seed = 0, uint64_t stream = 0) { Seed(seed, stream); }
+
+	void Seed(uint64_t seed, uint64_t stream)
+	{
+		m_Increment = (stream << 1u) | 1u;
+		m_State = 0;
+		Next();
+		m_State += Mix(seed);
+		Next();
+	}
+	void Seed(uint64_t seed, Stream stream) { Seed(seed, uint64_t(stream)); }
+
+	uint32_t Next()
+	{
+		const uint64_t previous{ m_State };
+		m_State = previous * 6364136223846793005ull + m_Increment;
+		const uint32_t shifted{ uint32_t(((previous >> 18u) ^ previous) >> 27u) };
+		const uint32_t rotation{ uint32_t(previous >> 59u) };
+		return (shifted >> rotation) | (shifted << ((32u - rotation) & 31u));
+	}
+
+	//[0, 1), from the top 24 bits so every value is exact
+	float NextFloat() { return float(Next() >> 8u) * (1.f / 16777216.f); }
+	//[min, max)
+	float Range(float min, float max) { return min + (max - min) * NextFloat(); }
+
+private:
+	//Spreads close seeds (1234, 1235) over the whole state
+	static uint64_t Mix(uint64_t value)
+	{
+		value += 0x9E3779B97F4A7C15ull;
+		value = (value ^ (value >> 30u)) * 0xBF58476D1CE4E5B9ull;
+		value = (value ^ (value >> 27u)) * 0x94D049BB133111EBull;
+		return value ^ (value >> 31u);
+	}
+
+	uint64_t m_State{};
+	uint64_t m_Increment{};
+};
@@ -27,16 +27,13 @@ SteeringPlugin_Output Wander::CalculateSteering(float deltaT, const AgentInfo& a
 	Elite::Vector2 currDirection{ m_Target.Position - agentInfo.Position };
 	currDirection.Normalize();
 	
-	float randAngle{ ToRadians(float(rand() % 360)) };
-	while (abs(randAngle - abs(m_WanderAngle)) > m_AngleChange) 
-	{ 
-		randAngle = ToRadians(float(rand() % 360)); 
-	};
+	//Random change within the max angle change, drawn directly
+	m_WanderAngle += m_Random.Range(-m_AngleChange, m_AngleChange);
+	if (m_WanderAngle > float(E_PI)) m_WanderAngle -= 2 * float(E_PI);
+	else if (m_WanderAngle < -float(E_PI)) m_WanderAngle += 2 * float(E_PI);
 
-	m_WanderAngle = randAngle;
-
-	target.Position.x = cos(randAngle);
-	target.Position.y = sin(randAngle);
+	target.Position.x = cos(m_WanderAngle);
+	target.Position.y = sin(m_WanderAngle);
 	target.Position *= m_Offset;
 	target.Position += agentInfo.Position;
 
@@ -158,3 +155,52 @@ SteeringPlugin_Output Pursuit::CalculateSteering(float deltaT, const AgentInfo&
 
 	return Seek::CalculateSteering(deltaT, agentInfo);
 }
+
+//AVOID
+//*****
+SteeringPlugin_Output Avoid::CalculateSteering(float deltaT, const AgentInfo& agentInfo)
+{
+	SteeringPlugin_Output avoid{};
+	avoid.AutoOrient = true;
+
+	Elite::Vector2 heading{ agentInfo.LinearVelocity };
+	if (heading.Normalize() <= 0.f) heading = Elite::OrientationToVector(agentInfo.Orientation);
+	const Elite::Vector2 side{ -heading.y, heading.x };
+
+	float urgency{};
+	for (size_t i{}; i < m_ObstaclePositions.size(); ++i)
+	{
+		const Elite::Vector2 toObstacle{ m_ObstaclePositions[i] - agentInfo.Position };
+		const float ahead{ Elite::Dot(toObstacle, heading) };
+		if (ahead <= 0.f || ahead > m_DetectionRange) continue;
+
+		const float lateral{ Elite::Dot(toObstacle, side) };
+		const float reach{ m_ObstacleRadii[i] + agentInfo.AgentSize * 0.5f };
+		if (abs(lateral) > reach) continue;
+
+		//Go around on the side the obstacle leaves open
+		const float obstacleUrgency{ 1.f - ahead / m_DetectionRange };
+		avoid.LinearVelocity += side * (lateral > 0.f ? -obstacleUrgency : obstacleUrgency);
+		urgency = std::max<float>(urgency, obstacleUrgency);
+	}
+
+	if (avoid.LinearVelocity.Normalize() > 0.f) avoid.LinearVelocity *= agentInfo.MaxLinearSpeed * urgency;
+	return avoid;
+}
+
+void Avoid::ClearObstacles()
+{
+	m_ObstaclePositions.clear();
+	m_ObstacleRadii.clear();
+}
+
+void Avoid::AddObstacle(const Elite::Vector2& position, float radius)
+{
+	m_ObstaclePositions.push_back(position);
+	m_ObstacleRadii.push_back(radius);
+}
+
+void Avoid::SetDetectionRange(float range)
+{
+	m_DetectionRange = range;
+}
@@ -12,26 +12,29 @@
 //-----------------------------------------------------------------
 #include <Exam_HelperStructs.h>
 #include "SteeringHelpers.h"
+#include "Random.h"
 
 using namespace Elite;
 
 #pragma region **ISTEERINGBEHAVIOR** (BASE)
+//Common base without virtual functions, every behaviour is a plain value that can be copied around.
+//Dispatch goes through the concrete type (SteeringState, SteeringPipeline).
 class ISteeringBehavior
 {
 public:
 	ISteeringBehavior() = default;
-	virtual ~ISteeringBehavior() = default;
-
-	virtual SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo) = 0;
 
 	//Seek Functions
 	void SetTarget(const TargetData& target) { m_Target = target; }
+	const TargetData& GetTarget() const { return m_Target; }
 
 	template<class T, typename std::enable_if<std::is_base_of<ISteeringBehavior, T>::value>::type* = nullptr>
 	T* As()
 	{ return static_cast<T*>(this); }
 
 protected:
+	~ISteeringBehavior() = default; //Never deleted through the base
+
 	TargetData m_Target;
 };
 #pragma endregion
@@ -43,10 +46,10 @@ class Seek : public ISteeringBehavior
 {
 public:
 	Seek() = default;
-	virtual ~Seek() = default;
+	~Seek() = default;
 
 	//Seek Behaviour
-	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo) override;
+	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo);
 };
 
 //////////////////////////
@@ -56,18 +59,20 @@ class Wander : public Seek
 {
 public:
 	Wander() = default;
-	virtual ~Wander() = default;
+	~Wander() = default;
 
 	//Wander Behavior
-	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo) override;
+	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo);
 
 	void SetWanderOffset(float offset) { m_Offset = offset; };
 	void SetMaxAngleChange(float rad) { m_AngleChange = rad; };
 	void SetWanderAngle(float currentAngle);
+	void SetRandomSeed(uint64_t seed, Random::Stream stream) { m_Random.Seed(seed, stream); }
 protected:
 	float m_Offset = 6.f; //Offset for target
 	float m_AngleChange = ToRadians(15); //max angle change per frame
 	float m_WanderAngle = 0.f; //curr Angle
+	Random m_Random{}; //Own stream, seeded by the plugin
 };
 
 
@@ -78,10 +83,10 @@ class Flee : public Seek
 {
 public:
 	Flee() = default;
-	virtual ~Flee() = default;
+	~Flee() = default;
 
 	//Flee behavior
-	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo) override;
+	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo);
 };
 
 //////////////////////////
@@ -91,10 +96,10 @@ class Arrive : public Seek
 {
 public:
 	Arrive() = default;
-	virtual ~Arrive() = default;
+	~Arrive() = default;
 
 	//Arrive behavior
-	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo) override;
+	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo);
 
 	void SetSlowRadius(float slowRadius);
 	void SetTargetRadius(float targetRadius);
@@ -111,10 +116,10 @@ class Face : public Seek
 {
 public:
 	Face() = default;
-	virtual ~Face() = default;
+	~Face() = default;
 
 	//Flee behavior
-	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo) override;
+	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo);
 };
 
 
@@ -125,13 +130,13 @@ class Evade : public Flee
 {
 public:
 	Evade() = default;
-	virtual ~Evade() = default;
+	~Evade() = default;
 
 	void SetEvadeRadius(float radius);
 	float GetEvadeRadius() const;
 
 	//Evade behavior
-	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo) override;
+	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo);
 
 private:
 	float m_EvadeRadius = 20.f;
@@ -145,10 +150,33 @@ class Pursuit : public Seek
 {
 public:
 	Pursuit() = default;
-	virtual ~Pursuit() = default;
+	~Pursuit() = default;
 
 	//Pursuit behavior
-	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo) override;
+	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo);
+};
+
+
+//////////////////////////
+//AVOID
+//*****
+class Avoid : public ISteeringBehavior
+{
+public:
+	Avoid() = default;
+	~Avoid() = default;
+
+	//Avoid behavior, steers sideways around the obstacles ahead, faster the closer they are
+	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo);
+
+	void ClearObstacles();
+	void AddObstacle(const Elite::Vector2& position, float radius);
+	void SetDetectionRange(float range);
+
+private:
+	std::vector<Elite::Vector2> m_ObstaclePositions;
+	std::vector<float> m_ObstacleRadii;
+	float m_DetectionRange = 8.f;
 };
 #endif
 
@@ -49,23 +49,9 @@ struct SteeringParams //Also used as Target for SteeringBehaviors
 #pragma endregion
 
 #pragma region Operator Overloads
-	SteeringParams(const SteeringParams& other)
-	{
-		Position = other.Position;
-		Orientation = other.Orientation;
-		LinearVelocity = other.LinearVelocity;
-		AngularVelocity = other.AngularVelocity;
-	}
-
-	SteeringParams& operator=(const SteeringParams& other)
-	{
-		Position = other.Position;
-		Orientation = other.Orientation;
-		LinearVelocity = other.LinearVelocity;
-		AngularVelocity = other.AngularVelocity;
-
-		return *this;
-	}
+	//Defaulted, so targets (and the behaviours holding them) stay trivially copyable
+	SteeringParams(const SteeringParams& other) = default;
+	SteeringParams& operator=(const SteeringParams& other) = default;
 
 	bool operator==(const SteeringParams& other) const
 	{
@@ -0,0 +1,122 @@
+#include "stdafx.h"
+#include "SteeringPipeline.h"
+#include <chrono>
+
+const int SteeringPipeline::m_MaxSlots;
+const int SteeringPipeline::m_TimedInterval;
+
+SteeringPipeline::SteeringPipeline(Policy policy, float priorityThreshold)
+	: m_Policy{ policy }
+	, m_PriorityThreshold{ priorityThreshold }
+{
+}
+
+void SteeringPipeline::Clear()
+{
+	m_SlotCount = 0;
+}
+
+bool SteeringPipeline::Add(SteeringState& state, const TargetData& target, float weight, int priority)
+{
+	if (m_SlotCount >= m_MaxSlots) return false;
+
+	m_pStates[m_SlotCount] = &state;
+	m_pAvoids[m_SlotCount] = nullptr;
+	m_Targets[m_SlotCount] = target;
+	m_Weights[m_SlotCount] = weight;
+	m_Priorities[m_SlotCount] = priority;
+	++m_SlotCount;
+	return true;
+}
+
+bool SteeringPipeline::Add(Avoid& avoid, float weight, int priority)
+{
+	if (m_SlotCount >= m_MaxSlots) return false;
+
+	m_pStates[m_SlotCount] = nullptr;
+	m_pAvoids[m_SlotCount] = &avoid;
+	m_Weights[m_SlotCount] = weight;
+	m_Priorities[m_SlotCount] = priority;
+	++m_SlotCount;
+	return true;
+}
+
+SteeringPlugin_Output SteeringPipeline::CalculateSteering(float deltaT, const AgentInfo& agentInfo)
+{
+	//Reading the clock costs about as much as a behaviour, so only one call in m_TimedInterval is timed
+	using Clock = std::chrono::steady_clock;
+	const bool isTimed{ m_Evaluations % m_TimedInterval == 0 };
+	const Clock::time_point begin{ isTimed ? Clock::now() : Clock::time_point{} };
+
+	//Highest priority first, slots with the same priority stay in the order they were added
+	int order[m_MaxSlots]{};
+	for (int slot{}; slot < m_SlotCount; ++slot)
+	{
+		int index{ slot };
+		for (; index > 0 && m_Priorities[order[index - 1]] < m_Priorities[slot]; --index) order[index] = order[index - 1];
+		order[index] = slot;
+	}
+
+	SteeringPlugin_Output steering{};
+	if (m_Policy == Policy::Blend)
+	{
+		Combine(order, m_SlotCount, deltaT, agentInfo, steering);
+	}
+	else
+	{
+		//Groups are only evaluated until one is over the threshold, the lowest group is used when none is
+		const float linearThreshold{ m_PriorityThreshold * agentInfo.MaxLinearSpeed };
+		const float angularThreshold{ m_PriorityThreshold * agentInfo.MaxAngularSpeed };
+		for (int first{}; first < m_SlotCount;)
+		{
+			int last{ first + 1 };
+			while (last < m_SlotCount && m_Priorities[order[last]] == m_Priorities[order[first]]) ++last;
+
+			Combine(order + first, last - first, deltaT, agentInfo, steering);
+			if (steering.LinearVelocity.SqrtMagnitude() > linearThreshold * linearThreshold ||
+				abs(steering.AngularVelocity) > angularThreshold) break;
+			first = last;
+		}
+	}
+
+	const float speed{ steering.LinearVelocity.Magnitude() };
+	if (speed > agentInfo.MaxLinearSpeed) steering.LinearVelocity *= agentInfo.MaxLinearSpeed / speed;
+	steering.AngularVelocity = Elite::Clamp(steering.AngularVelocity, -agentInfo.MaxAngularSpeed, agentInfo.MaxAngularSpeed);
+
+	++m_Evaluations;
+	if (isTimed)
+	{
+		++m_TimedEvaluations;
+		m_Seconds += std::chrono::duration<double>(Clock::now() - begin).count();
+	}
+	return steering;
+}
+
+float SteeringPipeline::GetAverageCost() const
+{
+	if (m_TimedEvaluations == 0) return 0.f;
+	return float(m_Seconds / m_TimedEvaluations);
+}
+
+SteeringPlugin_Output SteeringPipeline::Evaluate(int slot, float deltaT, const AgentInfo& agentInfo)
+{
+	if (m_pAvoids[slot] != nullptr) return m_pAvoids[slot]->CalculateSteering(deltaT, agentInfo);
+
+	SteeringState* pState{ m_pStates[slot] };
+	pState->SetTarget(m_Targets[slot]);
+	return pState->CalculateSteering(deltaT, agentInfo);
+}
+
+void SteeringPipeline::Combine(const int* pSlots, int slotCount, float deltaT, const AgentInfo& agentInfo, SteeringPlugin_Output& steering)
+{
+	//Any behaviour that turns the agent itself takes the orientation over
+	steering = SteeringPlugin_Output{};
+	for (int i{}; i < slotCount; ++i)
+	{
+		const int slot{ pSlots[i] };
+		const SteeringPlugin_Output output{ Evaluate(slot, deltaT, agentInfo) };
+		steering.LinearVelocity += output.LinearVelocity * m_Weights[slot];
+		steering.AngularVelocity += output.AngularVelocity * m_Weights[slot];
+		if (!output.AutoOrient && m_Weights[slot] > 0.f) steering.AutoOrient = false;
+	}
+}
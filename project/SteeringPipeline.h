@@ -0,0 +1,57 @@
+#pragma once
+#include "SteeringState.h"
+
+//Runs several steering behaviours in one frame and combines their outputs.
+//Behaviours are added into fixed slots and evaluated in one pass. A slot holds either a steering state, which
+//dispatches on its own kind, or the avoidance behaviour, so there is no virtual dispatch.
+//Blend sums the weighted outputs. Priority blends per priority group, highest first, and takes the first group
+//whose output is above the threshold (a fraction of the agent's max speeds), so avoidance only takes over
+//when there is something to avoid. The groups below the one taken are never evaluated.
+class SteeringPipeline final
+{
+public:
+	enum class Policy
+	{
+		Blend,
+		Priority
+	};
+
+	SteeringPipeline(Policy policy = Policy::Blend, float priorityThreshold = 0.1f);
+	~SteeringPipeline() = default;
+	SteeringPipeline(const SteeringPipeline&) = delete;
+	SteeringPipeline& operator=(const SteeringPipeline&) = delete;
+	SteeringPipeline(SteeringPipeline&&) = delete;
+	SteeringPipeline& operator=(SteeringPipeline&&) = delete;
+
+	void Clear();
+	//The behaviours are referenced until the next clear, returns false when every slot is taken
+	bool Add(SteeringState& state, const TargetData& target, float weight = 1.f, int priority = 0);
+	bool Add(Avoid& avoid, float weight = 1.f, int priority = 0);
+	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo);
+
+	void SetPolicy(Policy policy) { m_Policy = policy; }
+	int GetEvaluations() const { return m_Evaluations; }
+	float GetAverageCost() const; //Seconds per evaluation
+
+private:
+	static const int m_MaxSlots{ 8 };
+	static const int m_TimedInterval{ 16 };
+
+	SteeringPlugin_Output Evaluate(int slot, float deltaT, const AgentInfo& agentInfo);
+	//Evaluates the slots and sums their weighted outputs
+	void Combine(const int* pSlots, int slotCount, float deltaT, const AgentInfo& agentInfo, SteeringPlugin_Output& steering);
+
+	Policy m_Policy{};
+	float m_PriorityThreshold{};
+
+	int m_SlotCount{};
+	SteeringState* m_pStates[m_MaxSlots]{};
+	Avoid* m_pAvoids[m_MaxSlots]{};
+	TargetData m_Targets[m_MaxSlots]{};
+	float m_Weights[m_MaxSlots]{};
+	int m_Priorities[m_MaxSlots]{};
+
+	int m_Evaluations{};
+	int m_TimedEvaluations{};
+	double m_Seconds{};
+};
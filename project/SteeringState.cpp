@@ -0,0 +1,40 @@
+#include "stdafx.h"
+#include "SteeringState.h"
+
+static_assert(std::is_trivially_copyable<SteeringState>::value, "The steering state has to stay a plain copy");
+
+void SteeringState::SetTarget(const TargetData& target)
+{
+	switch (m_Kind)
+	{
+	case Kind::Seek: m_Seek.SetTarget(target); break;
+	case Kind::Wander: m_Wander.SetTarget(target); break;
+	case Kind::Flee: m_Flee.SetTarget(target); break;
+	case Kind::Arrive: m_Arrive.SetTarget(target); break;
+	case Kind::Face: m_Face.SetTarget(target); break;
+	case Kind::Evade: m_Evade.SetTarget(target); break;
+	case Kind::Pursuit: m_Pursuit.SetTarget(target); break;
+	}
+}
+
+SteeringPlugin_Output SteeringState::CalculateSteering(float deltaT, const AgentInfo& agentInfo)
+{
+	switch (m_Kind)
+	{
+	case Kind::Seek:
+		return m_Seek.CalculateSteering(deltaT, agentInfo);
+	case Kind::Wander:
+		return m_Wander.CalculateSteering(deltaT, agentInfo);
+	case Kind::Flee:
+		return m_Flee.CalculateSteering(deltaT, agentInfo);
+	case Kind::Arrive:
+		return m_Arrive.CalculateSteering(deltaT, agentInfo);
+	case Kind::Face:
+		return m_Face.CalculateSteering(deltaT, agentInfo);
+	case Kind::Evade:
+		return m_Evade.CalculateSteering(deltaT, agentInfo);
+	case Kind::Pursuit:
+		return m_Pursuit.CalculateSteering(deltaT, agentInfo);
+	}
+	return SteeringPlugin_Output{};
+}
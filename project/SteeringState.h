@@ -0,0 +1,59 @@
+#pragma once
+#include "SteeringBehaviors.h"
+
+//The steering behaviour the agent is using, stored by value: a tag and a union of the behaviours it can be.
+//Evaluating it is a switch on the tag with direct calls, there is no heap object or virtual call behind it,
+//and copying it copies the whole behaviour (wander angle and random stream included), so it can live
+//inline in the blackboard and be snapshotted with a plain copy.
+class SteeringState final
+{
+public:
+	enum class Kind
+	{
+		Seek,
+		Wander,
+		Flee,
+		Arrive,
+		Face,
+		Evade,
+		Pursuit
+	};
+
+	SteeringState() : SteeringState(Seek{}) {}
+	SteeringState(const Seek& seek) : m_Kind{ Kind::Seek }, m_Seek{ seek } {}
+	SteeringState(const Wander& wander) : m_Kind{ Kind::Wander }, m_Wander{ wander } {}
+	SteeringState(const Flee& flee) : m_Kind{ Kind::Flee }, m_Flee{ flee } {}
+	SteeringState(const Arrive& arrive) : m_Kind{ Kind::Arrive }, m_Arrive{ arrive } {}
+	SteeringState(const Face& face) : m_Kind{ Kind::Face }, m_Face{ face } {}
+	SteeringState(const Evade& evade) : m_Kind{ Kind::Evade }, m_Evade{ evade } {}
+	SteeringState(const Pursuit& pursuit) : m_Kind{ Kind::Pursuit }, m_Pursuit{ pursuit } {}
+
+	Kind GetKind() const { return m_Kind; }
+	bool Is(Kind kind) const { return m_Kind == kind; }
+	//Has to be the behaviour of the current kind
+	template<class T> T& Get() { return Member(static_cast<T*>(nullptr)); }
+
+	void SetTarget(const TargetData& target);
+	SteeringPlugin_Output CalculateSteering(float deltaT, const AgentInfo& agentInfo);
+
+private:
+	Seek& Member(Seek*) { assert(m_Kind == Kind::Seek); return m_Seek; }
+	Wander& Member(Wander*) { assert(m_Kind == Kind::Wander); return m_Wander; }
+	Flee& Member(Flee*) { assert(m_Kind == Kind::Flee); return m_Flee; }
+	Arrive& Member(Arrive*) { assert(m_Kind == Kind::Arrive); return m_Arrive; }
+	Face& Member(Face*) { assert(m_Kind == Kind::Face); return m_Face; }
+	Evade& Member(Evade*) { assert(m_Kind == Kind::Evade); return m_Evade; }
+	Pursuit& Member(Pursuit*) { assert(m_Kind == Kind::Pursuit); return m_Pursuit; }
+
+	Kind m_Kind;
+	union
+	{
+		Seek m_Seek;
+		Wander m_Wander;
+		Flee m_Flee;
+		Arrive m_Arrive;
+		Face m_Face;
+		Evade m_Evade;
+		Pursuit m_Pursuit;
+	};
+};
@@ -0,0 +1,348 @@
+#include "stdafx.h"
+#include "Trace.h"
+
+namespace
+{
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		int32_t seed;
+		uint32_t framesPerChunk;
+	};
+
+	struct ChunkHeader
+	{
+		uint32_t frames;
+		uint32_t size; //Bytes that follow
+	};
+
+	const uint32_t g_Magic{ 0x54505047 }; //"GPPT"
+	const uint32_t g_Version{ 1 };
+	const uint32_t g_FramesPerChunk{ 256 };
+
+	const char* g_RecordNames[]{
+		"Frame", "Output", "World_GetInfo", "World_GetStats", "Fov_GetHouseByIndex", "Fov_GetEntityByIndex", "Agent_GetInfo",
+		"Enemy_GetInfo", "NavMesh_GetClosestPathPoint", "Inventory_AddItem", "Inventory_UseItem", "Inventory_RemoveItem",
+		"Inventory_GetItem", "Inventory_GetCapacity", "Item_GetInfo", "Item_Grab", "Item_Destroy", "Weapon_GetAmmo",
+		"Medkit_GetHealth", "Food_GetEnergy", "PurgeZone_GetInfo", "RequestShutdown"
+	};
+	static_assert(sizeof(g_RecordNames) / sizeof(g_RecordNames[0]) == size_t(TraceRecord::Count), "A record has no name");
+
+	//Field by field, padding would otherwise end up in the trace
+	template<typename Visitor> void Visit(Elite::Vector2& value, const Visitor& visit) { visit(value.x); visit(value.y); }
+	template<typename Visitor> void Visit(float& value, const Visitor& visit) { visit(value); }
+	template<typename Visitor> void Visit(int& value, const Visitor& visit) { visit(value); }
+	template<typename Visitor> void Visit(bool& value, const Visitor& visit) { visit(value); }
+
+	template<typename Visitor> void Visit(WorldInfo& info, const Visitor& visit)
+	{
+		Visit(info.Center, visit);
+		Visit(info.Dimensions, visit);
+	}
+
+	template<typename Visitor> void Visit(StatisticsInfo& info, const Visitor& visit)
+	{
+		visit(info.Score); visit(info.Difficulty); visit(info.TimeSurvived); visit(info.KillCountdown);
+		visit(info.NumEnemiesKilled); visit(info.NumEnemiesHit); visit(info.NumItemsPickUp); visit(info.NumMissedShots); visit(info.NumChkpntsReached);
+	}
+
+	template<typename Visitor> void Visit(AgentInfo& info, const Visitor& visit)
+	{
+		visit(info.Stamina); visit(info.Health); visit(info.Energy);
+		visit(info.RunMode); visit(info.IsInHouse); visit(info.Bitten); visit(info.WasBitten); visit(info.Death);
+		visit(info.FOV_Angle); visit(info.FOV_Range);
+		Visit(info.LinearVelocity, visit); visit(info.AngularVelocity); visit(info.CurrentLinearSpeed);
+		Visit(info.Position, visit); visit(info.Orientation);
+		visit(info.MaxLinearSpeed); visit(info.MaxAngularSpeed); visit(info.GrabRange); visit(info.AgentSize);
+	}
+
+	template<typename Visitor> void Visit(HouseInfo& info, const Visitor& visit)
+	{
+		Visit(info.Center, visit);
+		Visit(info.Size, visit);
+	}
+
+	template<typename Visitor> void Visit(EntityInfo& info, const Visitor& visit)
+	{
+		visit(info.Type); Visit(info.Location, visit); visit(info.EntityHash);
+	}
+
+	template<typename Visitor> void Visit(EnemyInfo& info, const Visitor& visit)
+	{
+		visit(info.Type); Visit(info.Location, visit); Visit(info.LinearVelocity, visit);
+		visit(info.EnemyHash); visit(info.Size); visit(info.Health);
+	}
+
+	template<typename Visitor> void Visit(ItemInfo& info, const Visitor& visit)
+	{
+		visit(info.Type); Visit(info.Location, visit); visit(info.ItemHash);
+	}
+
+	template<typename Visitor> void Visit(PurgeZoneInfo& info, const Visitor& visit)
+	{
+		Visit(info.Center, visit); visit(info.Radius); visit(info.ZoneHash);
+	}
+
+	template<typename Visitor> void Visit(SteeringPlugin_Output& steering, const Visitor& visit)
+	{
+		Visit(steering.LinearVelocity, visit); visit(steering.AngularVelocity); visit(steering.AutoOrient); visit(steering.RunMode);
+	}
+
+	void PutVarint(std::vector<uint8_t>& bytes, size_t value)
+	{
+		while (value >= 0x80)
+		{
+			bytes.push_back(uint8_t(value | 0x80));
+			value >>= 7;
+		}
+		bytes.push_back(uint8_t(value));
+	}
+
+	bool GetVarint(const std::vector<uint8_t>& bytes, size_t& position, size_t& value)
+	{
+		value = 0;
+		for (size_t shift{}; shift < sizeof(size_t) * 8 && position < bytes.size(); shift += 7)
+		{
+			const uint8_t byte{ bytes[position++] };
+			value |= size_t(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0) return true;
+		}
+		return false;
+	}
+}
+
+const char* ToString(TraceRecord record)
+{
+	return record < TraceRecord::Count ? g_RecordNames[size_t(record)] : "Unknown";
+}
+
+#pragma region TracePayload
+void TracePayload::Clear()
+{
+	m_Bytes.clear();
+	m_ReadPosition = 0;
+}
+
+void TracePayload::Append(const void* pData, size_t size)
+{
+	const uint8_t* pBytes{ static_cast<const uint8_t*>(pData) };
+	m_Bytes.insert(m_Bytes.end(), pBytes, pBytes + size);
+}
+
+bool TracePayload::Extract(void* pData, size_t size)
+{
+	if (m_ReadPosition + size > m_Bytes.size()) return false;
+
+	memcpy(pData, m_Bytes.data() + m_ReadPosition, size);
+	m_ReadPosition += size;
+	return true;
+}
+
+bool TracePayload::Match(const TracePayload& arguments)
+{
+	const std::vector<uint8_t>& expected{ arguments.m_Bytes };
+	if (m_ReadPosition + expected.size() > m_Bytes.size()) return false;
+	if (!std::equal(expected.begin(), expected.end(), m_Bytes.begin() + m_ReadPosition)) return false;
+
+	m_ReadPosition += expected.size();
+	return true;
+}
+
+//Copies are taken so one Visit serves both directions
+#define TRACE_PAYLOAD_TYPE(Type) \
+	void TracePayload::Put(const Type& value) \
+	{ \
+		Type written{ value }; \
+		Visit(written, [this](const auto& field) { Append(&field, sizeof(field)); }); \
+	} \
+	bool TracePayload::Get(Type& value) \
+	{ \
+		Type read{ value }; \
+		bool isRead{ true }; \
+		Visit(read, [this, &isRead](auto& field) { isRead = Extract(&field, sizeof(field)) && isRead; }); \
+		if (isRead) value = read; \
+		return isRead; \
+	}
+
+TRACE_PAYLOAD_TYPE(bool)
+TRACE_PAYLOAD_TYPE(int)
+TRACE_PAYLOAD_TYPE(float)
+TRACE_PAYLOAD_TYPE(Elite::Vector2)
+TRACE_PAYLOAD_TYPE(WorldInfo)
+TRACE_PAYLOAD_TYPE(StatisticsInfo)
+TRACE_PAYLOAD_TYPE(AgentInfo)
+TRACE_PAYLOAD_TYPE(HouseInfo)
+TRACE_PAYLOAD_TYPE(EntityInfo)
+TRACE_PAYLOAD_TYPE(EnemyInfo)
+TRACE_PAYLOAD_TYPE(ItemInfo)
+TRACE_PAYLOAD_TYPE(PurgeZoneInfo)
+TRACE_PAYLOAD_TYPE(SteeringPlugin_Output)
+#undef TRACE_PAYLOAD_TYPE
+
+void TracePayload::Put(UINT value)
+{
+	Put(int(value));
+}
+
+bool TracePayload::Get(UINT& value)
+{
+	int read{};
+	if (!Get(read)) return false;
+	value = UINT(read);
+	return true;
+}
+#pragma endregion
+
+#pragma region TraceWriter
+TraceWriter::~TraceWriter()
+{
+	Close();
+}
+
+bool TraceWriter::Open(const std::string& filePath, int seed)
+{
+	Close();
+	m_File.open(filePath, std::ios::binary | std::ios::trunc);
+	if (!m_File.is_open()) return false;
+
+	const Header header{ g_Magic, g_Version, seed, g_FramesPerChunk };
+	m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	m_Chunk.clear();
+	for (std::vector<uint8_t>& previous : m_Previous) previous.clear();
+	m_ChunkFrames = 0;
+	return bool(m_File);
+}
+
+void TraceWriter::Write(TraceRecord record, const TracePayload& payload)
+{
+	if (!m_File.is_open()) return;
+	//Chunks start on a frame, so a reader can start at any of them
+	if (record == TraceRecord::Frame)
+	{
+		if (m_ChunkFrames == g_FramesPerChunk) WriteChunk();
+		++m_ChunkFrames;
+	}
+
+	const std::vector<uint8_t>& bytes{ payload.GetBytes() };
+	std::vector<uint8_t>& previous{ m_Previous[size_t(record)] };
+	m_Delta.resize(bytes.size());
+	for (size_t i{}; i < bytes.size(); ++i) m_Delta[i] = bytes[i] ^ (i < previous.size() ? previous[i] : uint8_t{});
+	previous = bytes;
+
+	//Kind, size, then (zero run, literal run, literals) until the size is covered
+	m_Chunk.push_back(uint8_t(record));
+	PutVarint(m_Chunk, m_Delta.size());
+	size_t position{};
+	while (position < m_Delta.size())
+	{
+		size_t zeros{};
+		while (position + zeros < m_Delta.size() && m_Delta[position + zeros] == 0) ++zeros;
+		position += zeros;
+
+		size_t literals{};
+		while (position + literals < m_Delta.size() && m_Delta[position + literals] != 0) ++literals;
+		PutVarint(m_Chunk, zeros);
+		PutVarint(m_Chunk, literals);
+		m_Chunk.insert(m_Chunk.end(), m_Delta.begin() + position, m_Delta.begin() + position + literals);
+		position += literals;
+	}
+}
+
+void TraceWriter::Close()
+{
+	if (!m_File.is_open()) return;
+
+	WriteChunk();
+	m_File.close();
+}
+
+void TraceWriter::WriteChunk()
+{
+	if (!m_Chunk.empty())
+	{
+		const ChunkHeader header{ m_ChunkFrames, uint32_t(m_Chunk.size()) };
+		m_File.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		m_File.write(reinterpret_cast<const char*>(m_Chunk.data()), std::streamsize(m_Chunk.size()));
+		m_File.flush();
+	}
+
+	m_Chunk.clear();
+	for (std::vector<uint8_t>& previous : m_Previous) previous.clear();
+	m_ChunkFrames = 0;
+}
+#pragma endregion
+
+#pragma region TraceReader
+bool TraceReader::Open(const std::string& filePath)
+{
+	m_File.close();
+	m_File.clear();
+	m_Chunk.clear();
+	m_Position = 0;
+	m_Error.clear();
+
+	m_File.open(filePath, std::ios::binary);
+	if (!m_File.is_open()) return Fail("Could not open " + filePath);
+
+	Header header{};
+	if (!m_File.read(reinterpret_cast<char*>(&header), sizeof(header))) return Fail(filePath + " is too short");
+	if (header.magic != g_Magic || header.version != g_Version) return Fail(filePath + " is not a trace of this version");
+
+	m_Seed = header.seed;
+	return true;
+}
+
+bool TraceReader::Read(TraceRecord& record, TracePayload& payload)
+{
+	if (!m_Error.empty()) return false;
+	if (m_Position >= m_Chunk.size() && !ReadChunk()) return false;
+
+	record = TraceRecord(m_Chunk[m_Position++]);
+	size_t size{};
+	if (record >= TraceRecord::Count || !GetVarint(m_Chunk, m_Position, size)) return Fail("Damaged record");
+
+	std::vector<uint8_t>& bytes{ payload.GetBytes() };
+	payload.Clear();
+	bytes.resize(size);
+	size_t position{};
+	while (position < size)
+	{
+		size_t zeros{}, literals{};
+		if (!GetVarint(m_Chunk, m_Position, zeros) || !GetVarint(m_Chunk, m_Position, literals)) return Fail("Damaged record");
+		if (position + zeros + literals > size || m_Position + literals > m_Chunk.size()) return Fail("Damaged record");
+
+		std::fill(bytes.begin() + position, bytes.begin() + position + zeros, uint8_t{});
+		position += zeros;
+		std::copy(m_Chunk.begin() + m_Position, m_Chunk.begin() + m_Position + literals, bytes.begin() + position);
+		position += literals;
+		m_Position += literals;
+	}
+
+	std::vector<uint8_t>& previous{ m_Previous[size_t(record)] };
+	for (size_t i{}; i < size && i < previous.size(); ++i) bytes[i] ^= previous[i];
+	previous = bytes;
+	return true;
+}
+
+bool TraceReader::ReadChunk()
+{
+	ChunkHeader header{};
+	if (!m_File.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+
+	m_Chunk.resize(header.size);
+	if (!m_File.read(reinterpret_cast<char*>(m_Chunk.data()), std::streamsize(header.size))) return Fail("Trace ends in the middle of a chunk");
+
+	m_Position = 0;
+	for (std::vector<uint8_t>& previous : m_Previous) previous.clear();
+	return !m_Chunk.empty();
+}
+
+bool TraceReader::Fail(const std::string& error)
+{
+	m_Error = error;
+	m_Chunk.clear();
+	m_Position = 0;
+	return false;
+}
+#pragma endregion
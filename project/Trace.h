@@ -0,0 +1,142 @@
+#pragma once
+#include <fstream>
+#include "Exam_HelperStructs.h"
+
+//Everything the plugin asked the framework and answered it, one record per call, see TraceRecorder.
+//Frames are stored in chunks that decode on their own. Every record is XORed with the previous record of the same
+//kind in its chunk and the zero runs that leaves are packed, most answers barely change between frames.
+enum class TraceRecord : uint8_t
+{
+	Frame, //dt, starts a frame
+	Output, //What UpdateSteering returned, ends a frame
+	World_GetInfo,
+	World_GetStats,
+	Fov_GetHouseByIndex,
+	Fov_GetEntityByIndex,
+	Agent_GetInfo,
+	Enemy_GetInfo,
+	NavMesh_GetClosestPathPoint,
+	Inventory_AddItem,
+	Inventory_UseItem,
+	Inventory_RemoveItem,
+	Inventory_GetItem,
+	Inventory_GetCapacity,
+	Item_GetInfo,
+	Item_Grab,
+	Item_Destroy,
+	Weapon_GetAmmo,
+	Medkit_GetHealth,
+	Food_GetEnergy,
+	PurgeZone_GetInfo,
+	RequestShutdown,
+
+	//@END
+	Count
+};
+
+const char* ToString(TraceRecord record);
+
+//The arguments followed by the answer of one call, bit for bit so floats come back exactly the same
+class TracePayload final
+{
+public:
+	void Clear();
+
+	void Put(const bool& value);
+	void Put(const int& value);
+	void Put(UINT value);
+	void Put(const float& value);
+	void Put(const Elite::Vector2& value);
+	void Put(const WorldInfo& value);
+	void Put(const StatisticsInfo& value);
+	void Put(const AgentInfo& value);
+	void Put(const HouseInfo& value);
+	void Put(const EntityInfo& value);
+	void Put(const EnemyInfo& value);
+	void Put(const ItemInfo& value);
+	void Put(const PurgeZoneInfo& value);
+	void Put(const SteeringPlugin_Output& value);
+
+	//False once the payload is used up, value is left alone then
+	bool Get(bool& value);
+	bool Get(int& value);
+	bool Get(UINT& value);
+	bool Get(float& value);
+	bool Get(Elite::Vector2& value);
+	bool Get(WorldInfo& value);
+	bool Get(StatisticsInfo& value);
+	bool Get(AgentInfo& value);
+	bool Get(HouseInfo& value);
+	bool Get(EntityInfo& value);
+	bool Get(EnemyInfo& value);
+	bool Get(ItemInfo& value);
+	bool Get(PurgeZoneInfo& value);
+	bool Get(SteeringPlugin_Output& value);
+
+	//Whether the unread part starts with these arguments, skips past them if it does
+	bool Match(const TracePayload& arguments);
+
+	std::vector<uint8_t>& GetBytes() { return m_Bytes; }
+	const std::vector<uint8_t>& GetBytes() const { return m_Bytes; }
+
+private:
+	void Append(const void* pData, size_t size);
+	bool Extract(void* pData, size_t size);
+
+	std::vector<uint8_t> m_Bytes{};
+	size_t m_ReadPosition{};
+};
+
+class TraceWriter final
+{
+public:
+	TraceWriter() = default;
+	~TraceWriter();
+	TraceWriter(const TraceWriter&) = delete;
+	TraceWriter& operator=(const TraceWriter&) = delete;
+	TraceWriter(TraceWriter&&) = delete;
+	TraceWriter& operator=(TraceWriter&&) = delete;
+
+	bool Open(const std::string& filePath, int seed);
+	bool IsOpen() const { return m_File.is_open(); }
+	void Write(TraceRecord record, const TracePayload& payload);
+	//Writes the last chunk
+	void Close();
+
+private:
+	void WriteChunk();
+
+	std::ofstream m_File{};
+	std::vector<uint8_t> m_Chunk{};
+	std::vector<uint8_t> m_Previous[size_t(TraceRecord::Count)]{};
+	std::vector<uint8_t> m_Delta{};
+	uint32_t m_ChunkFrames{};
+};
+
+class TraceReader final
+{
+public:
+	TraceReader() = default;
+	~TraceReader() = default;
+	TraceReader(const TraceReader&) = delete;
+	TraceReader& operator=(const TraceReader&) = delete;
+	TraceReader(TraceReader&&) = delete;
+	TraceReader& operator=(TraceReader&&) = delete;
+
+	bool Open(const std::string& filePath);
+	int GetSeed() const { return m_Seed; }
+	//False at the end of the trace, or when it is damaged (GetError isn't empty then)
+	bool Read(TraceRecord& record, TracePayload& payload);
+	const std::string& GetError() const { return m_Error; }
+
+private:
+	bool ReadChunk();
+	bool Fail(const std::string& error);
+
+	std::ifstream m_File{};
+	int m_Seed{};
+	std::vector<uint8_t> m_Chunk{};
+	size_t m_Position{};
+	std::vector<uint8_t> m_Previous[size_t(TraceRecord::Count)]{};
+	std::string m_Error{};
+};
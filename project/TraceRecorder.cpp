@@ -0,0 +1,274 @@
+#include "stdafx.h"
+#include "TraceRecorder.h"
+
+TraceRecorder::TraceRecorder(IExamInterface* pInterface, const std::string& filePath, int seed)
+	: m_pInterface{ pInterface }
+{
+	if (!m_Writer.Open(filePath, seed)) std::cout << "Trace could not be written to " << filePath << '\n';
+}
+
+void TraceRecorder::BeginFrame(float dt)
+{
+	m_IsRecording = true;
+	m_Payload.Clear();
+	m_Payload.Put(dt);
+	m_Writer.Write(TraceRecord::Frame, m_Payload);
+}
+
+void TraceRecorder::EndFrame(const SteeringPlugin_Output& steering)
+{
+	m_Payload.Clear();
+	m_Payload.Put(steering);
+	m_Writer.Write(TraceRecord::Output, m_Payload);
+	m_IsRecording = false;
+}
+
+#pragma region World
+WorldInfo TraceRecorder::World_GetInfo() const
+{
+	const WorldInfo info{ m_pInterface->World_GetInfo() };
+	if (!m_IsRecording) return info;
+
+	m_Payload.Clear();
+	m_Payload.Put(info);
+	m_Writer.Write(TraceRecord::World_GetInfo, m_Payload);
+	return info;
+}
+
+StatisticsInfo TraceRecorder::World_GetStats() const
+{
+	const StatisticsInfo stats{ m_pInterface->World_GetStats() };
+	if (!m_IsRecording) return stats;
+
+	m_Payload.Clear();
+	m_Payload.Put(stats);
+	m_Writer.Write(TraceRecord::World_GetStats, m_Payload);
+	return stats;
+}
+
+bool TraceRecorder::Fov_GetHouseByIndex(UINT index, HouseInfo& houseInfo) const
+{
+	const bool isFound{ m_pInterface->Fov_GetHouseByIndex(index, houseInfo) };
+	if (!m_IsRecording) return isFound;
+
+	m_Payload.Clear();
+	m_Payload.Put(index);
+	m_Payload.Put(isFound);
+	m_Payload.Put(houseInfo);
+	m_Writer.Write(TraceRecord::Fov_GetHouseByIndex, m_Payload);
+	return isFound;
+}
+
+bool TraceRecorder::Fov_GetEntityByIndex(UINT index, EntityInfo& enemyInfo) const
+{
+	const bool isFound{ m_pInterface->Fov_GetEntityByIndex(index, enemyInfo) };
+	if (!m_IsRecording) return isFound;
+
+	m_Payload.Clear();
+	m_Payload.Put(index);
+	m_Payload.Put(isFound);
+	m_Payload.Put(enemyInfo);
+	m_Writer.Write(TraceRecord::Fov_GetEntityByIndex, m_Payload);
+	return isFound;
+}
+
+AgentInfo TraceRecorder::Agent_GetInfo() const
+{
+	const AgentInfo agent{ m_pInterface->Agent_GetInfo() };
+	if (!m_IsRecording) return agent;
+
+	m_Payload.Clear();
+	m_Payload.Put(agent);
+	m_Writer.Write(TraceRecord::Agent_GetInfo, m_Payload);
+	return agent;
+}
+
+bool TraceRecorder::Enemy_GetInfo(EntityInfo entity, EnemyInfo& enemy)
+{
+	const bool isFound{ m_pInterface->Enemy_GetInfo(entity, enemy) };
+	if (!m_IsRecording) return isFound;
+
+	m_Payload.Clear();
+	m_Payload.Put(entity);
+	m_Payload.Put(isFound);
+	m_Payload.Put(enemy);
+	m_Writer.Write(TraceRecord::Enemy_GetInfo, m_Payload);
+	return isFound;
+}
+
+Elite::Vector2 TraceRecorder::NavMesh_GetClosestPathPoint(Elite::Vector2 goal) const
+{
+	const Elite::Vector2 pathPoint{ m_pInterface->NavMesh_GetClosestPathPoint(goal) };
+	if (!m_IsRecording) return pathPoint;
+
+	m_Payload.Clear();
+	m_Payload.Put(goal);
+	m_Payload.Put(pathPoint);
+	m_Writer.Write(TraceRecord::NavMesh_GetClosestPathPoint, m_Payload);
+	return pathPoint;
+}
+#pragma endregion
+
+#pragma region Inventory
+bool TraceRecorder::Inventory_AddItem(UINT slotId, ItemInfo item)
+{
+	const bool isAdded{ m_pInterface->Inventory_AddItem(slotId, item) };
+	if (!m_IsRecording) return isAdded;
+
+	m_Payload.Clear();
+	m_Payload.Put(slotId);
+	m_Payload.Put(item);
+	m_Payload.Put(isAdded);
+	m_Writer.Write(TraceRecord::Inventory_AddItem, m_Payload);
+	return isAdded;
+}
+
+bool TraceRecorder::Inventory_UseItem(UINT slotId)
+{
+	const bool isUsed{ m_pInterface->Inventory_UseItem(slotId) };
+	if (!m_IsRecording) return isUsed;
+
+	m_Payload.Clear();
+	m_Payload.Put(slotId);
+	m_Payload.Put(isUsed);
+	m_Writer.Write(TraceRecord::Inventory_UseItem, m_Payload);
+	return isUsed;
+}
+
+bool TraceRecorder::Inventory_RemoveItem(UINT slotId)
+{
+	const bool isRemoved{ m_pInterface->Inventory_RemoveItem(slotId) };
+	if (!m_IsRecording) return isRemoved;
+
+	m_Payload.Clear();
+	m_Payload.Put(slotId);
+	m_Payload.Put(isRemoved);
+	m_Writer.Write(TraceRecord::Inventory_RemoveItem, m_Payload);
+	return isRemoved;
+}
+
+bool TraceRecorder::Inventory_GetItem(UINT slotId, ItemInfo& item)
+{
+	const bool isFound{ m_pInterface->Inventory_GetItem(slotId, item) };
+	if (!m_IsRecording) return isFound;
+
+	m_Payload.Clear();
+	m_Payload.Put(slotId);
+	m_Payload.Put(isFound);
+	m_Payload.Put(item);
+	m_Writer.Write(TraceRecord::Inventory_GetItem, m_Payload);
+	return isFound;
+}
+
+UINT TraceRecorder::Inventory_GetCapacity() const
+{
+	const UINT capacity{ m_pInterface->Inventory_GetCapacity() };
+	if (!m_IsRecording) return capacity;
+
+	m_Payload.Clear();
+	m_Payload.Put(capacity);
+	m_Writer.Write(TraceRecord::Inventory_GetCapacity, m_Payload);
+	return capacity;
+}
+#pragma endregion
+
+#pragma region Items
+bool TraceRecorder::Item_GetInfo(EntityInfo entity, ItemInfo& item)
+{
+	const bool isFound{ m_pInterface->Item_GetInfo(entity, item) };
+	if (!m_IsRecording) return isFound;
+
+	m_Payload.Clear();
+	m_Payload.Put(entity);
+	m_Payload.Put(isFound);
+	m_Payload.Put(item);
+	m_Writer.Write(TraceRecord::Item_GetInfo, m_Payload);
+	return isFound;
+}
+
+bool TraceRecorder::Item_Grab(EntityInfo entity, ItemInfo& item)
+{
+	const bool isGrabbed{ m_pInterface->Item_Grab(entity, item) };
+	if (!m_IsRecording) return isGrabbed;
+
+	m_Payload.Clear();
+	m_Payload.Put(entity);
+	m_Payload.Put(isGrabbed);
+	m_Payload.Put(item);
+	m_Writer.Write(TraceRecord::Item_Grab, m_Payload);
+	return isGrabbed;
+}
+
+bool TraceRecorder::Item_Destroy(EntityInfo entity)
+{
+	const bool isDestroyed{ m_pInterface->Item_Destroy(entity) };
+	if (!m_IsRecording) return isDestroyed;
+
+	m_Payload.Clear();
+	m_Payload.Put(entity);
+	m_Payload.Put(isDestroyed);
+	m_Writer.Write(TraceRecord::Item_Destroy, m_Payload);
+	return isDestroyed;
+}
+
+int TraceRecorder::Weapon_GetAmmo(ItemInfo& item)
+{
+	const ItemInfo asked{ item };
+	const int ammo{ m_pInterface->Weapon_GetAmmo(item) };
+	if (!m_IsRecording) return ammo;
+
+	m_Payload.Clear();
+	m_Payload.Put(asked);
+	m_Payload.Put(ammo);
+	m_Writer.Write(TraceRecord::Weapon_GetAmmo, m_Payload);
+	return ammo;
+}
+
+int TraceRecorder::Medkit_GetHealth(ItemInfo& item)
+{
+	const ItemInfo asked{ item };
+	const int health{ m_pInterface->Medkit_GetHealth(item) };
+	if (!m_IsRecording) return health;
+
+	m_Payload.Clear();
+	m_Payload.Put(asked);
+	m_Payload.Put(health);
+	m_Writer.Write(TraceRecord::Medkit_GetHealth, m_Payload);
+	return health;
+}
+
+int TraceRecorder::Food_GetEnergy(ItemInfo& item)
+{
+	const ItemInfo asked{ item };
+	const int energy{ m_pInterface->Food_GetEnergy(item) };
+	if (!m_IsRecording) return energy;
+
+	m_Payload.Clear();
+	m_Payload.Put(asked);
+	m_Payload.Put(energy);
+	m_Writer.Write(TraceRecord::Food_GetEnergy, m_Payload);
+	return energy;
+}
+#pragma endregion
+
+bool TraceRecorder::PurgeZone_GetInfo(EntityInfo entity, PurgeZoneInfo& zone)
+{
+	const bool isFound{ m_pInterface->PurgeZone_GetInfo(entity, zone) };
+	if (!m_IsRecording) return isFound;
+
+	m_Payload.Clear();
+	m_Payload.Put(entity);
+	m_Payload.Put(isFound);
+	m_Payload.Put(zone);
+	m_Writer.Write(TraceRecord::PurgeZone_GetInfo, m_Payload);
+	return isFound;
+}
+
+void TraceRecorder::RequestShutdown() const
+{
+	m_pInterface->RequestShutdown();
+	if (!m_IsRecording) return;
+
+	m_Payload.Clear();
+	m_Writer.Write(TraceRecord::RequestShutdown, m_Payload);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "IExamInterface.h"
+#include "Trace.h"
+
+//Sits between the plugin and the framework and writes every answer the plugin gets to a trace,
+//together with what UpdateSteering returns, so the game can be played back without the framework (HeadlessReplay).
+//Only frames are recorded: from the start of UpdateSteering to what it returns, plus everything before the first one.
+//Debug input, drawing and whatever Render asks are passed on without being recorded.
+class TraceRecorder final : public IExamInterface
+{
+public:
+	TraceRecorder(IExamInterface* pInterface, const std::string& filePath, int seed);
+	~TraceRecorder() = default;
+	TraceRecorder(const TraceRecorder&) = delete;
+	TraceRecorder& operator=(const TraceRecorder&) = delete;
+	TraceRecorder(TraceRecorder&&) = delete;
+	TraceRecorder& operator=(TraceRecorder&&) = delete;
+
+	bool IsOpen() const { return m_Writer.IsOpen(); }
+	void BeginFrame(float dt);
+	void EndFrame(const SteeringPlugin_Output& steering);
+
+	WorldInfo World_GetInfo() const override;
+	StatisticsInfo World_GetStats() const override;
+	bool Fov_GetHouseByIndex(UINT index, HouseInfo& houseInfo) const override;
+	bool Fov_GetEntityByIndex(UINT index, EntityInfo& enemyInfo) const override;
+	AgentInfo Agent_GetInfo() const override;
+	bool Enemy_GetInfo(EntityInfo entity, EnemyInfo& enemy) override;
+	Elite::Vector2 NavMesh_GetClosestPathPoint(Elite::Vector2 goal) const override;
+
+	bool Inventory_AddItem(UINT slotId, ItemInfo item) override;
+	bool Inventory_UseItem(UINT slotId) override;
+	bool Inventory_RemoveItem(UINT slotId) override;
+	bool Inventory_GetItem(UINT slotId, ItemInfo& item) override;
+	UINT Inventory_GetCapacity() const override;
+
+	bool Item_GetInfo(EntityInfo entity, ItemInfo& item) override;
+	bool Item_Grab(EntityInfo entity, ItemInfo& item) override;
+	bool Item_Destroy(EntityInfo entity) override;
+	int Weapon_GetAmmo(ItemInfo& item) override;
+	int Medkit_GetHealth(ItemInfo& item) override;
+	int Food_GetEnergy(ItemInfo& item) override;
+
+	bool PurgeZone_GetInfo(EntityInfo entity, PurgeZoneInfo& zone) override;
+
+	Elite::Vector2 Debug_ConvertScreenToWorld(Elite::Vector2 screenPos) const override { return m_pInterface->Debug_ConvertScreenToWorld(screenPos); }
+	Elite::Vector2 Debug_ConvertWorldToScreen(Elite::Vector2 worldPos) const override { return m_pInterface->Debug_ConvertWorldToScreen(worldPos); }
+
+	bool Input_IsKeyboardKeyDown(Elite::InputScancode key) const override { return m_pInterface->Input_IsKeyboardKeyDown(key); }
+	bool Input_IsKeyboardKeyUp(Elite::InputScancode key) const override { return m_pInterface->Input_IsKeyboardKeyUp(key); }
+	bool Input_IsMouseButtonDown(Elite::InputMouseButton button) const override { return m_pInterface->Input_IsMouseButtonDown(button); }
+	bool Input_IsMouseButtonUp(Elite::InputMouseButton button) const override { return m_pInterface->Input_IsMouseButtonUp(button); }
+	Elite::MouseData Input_GetMouseData(Elite::InputType type, Elite::InputMouseButton button) const override { return m_pInterface->Input_GetMouseData(type, button); }
+
+	void RequestShutdown() const override;
+
+	void Draw_Polygon(const Elite::Vector2* points, int count, const Elite::Vector3& color, float depth) override { m_pInterface->Draw_Polygon(points, count, color, depth); }
+	void Draw_SolidPolygon(const Elite::Vector2* points, int count, const Elite::Vector3& color, float depth, bool triangulate = false) override { m_pInterface->Draw_SolidPolygon(points, count, color, depth, triangulate); }
+	void Draw_Circle(const Elite::Vector2& center, float radius, const Elite::Vector3& color, float depth) override { m_pInterface->Draw_Circle(center, radius, color, depth); }
+	void Draw_SolidCircle(const Elite::Vector2& center, float32 radius, const Elite::Vector2& axis, const Elite::Vector3& color, float depth) override { m_pInterface->Draw_SolidCircle(center, radius, axis, color, depth); }
+	void Draw_Segment(const Elite::Vector2& p1, const Elite::Vector2& p2, const Elite::Vector3& color, float depth) override { m_pInterface->Draw_Segment(p1, p2, color, depth); }
+	void Draw_Direction(const Elite::Vector2& p, Elite::Vector2 dir, float length, const Elite::Vector3& color, float depth = 0.9f) override { m_pInterface->Draw_Direction(p, dir, length, color, depth); }
+	void Draw_Transform(const b2Transform& xf, float depth) override { m_pInterface->Draw_Transform(xf, depth); }
+	void Draw_Point(const Elite::Vector2& p, float size, const Elite::Vector3& color, float depth) override { m_pInterface->Draw_Point(p, size, color, depth); }
+	float NextDepthSlice() override { return m_pInterface->NextDepthSlice(); }
+
+private:
+	IExamInterface* m_pInterface;
+	mutable TraceWriter m_Writer{};
+	mutable TracePayload m_Payload{}; //Arguments, then the answer
+	bool m_IsRecording{ true };
+};
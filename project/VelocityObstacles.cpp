@@ -0,0 +1,212 @@
+#include "stdafx.h"
+#include "VelocityObstacles.h"
+#include <chrono>
+
+namespace
+{
+	const float g_Epsilon{ 0.00001f };
+
+	float Determinant(const Elite::Vector2& left, const Elite::Vector2& right)
+	{
+		return left.x * right.y - left.y * right.x;
+	}
+}
+
+const int VelocityObstacles::m_MaxNeighbours;
+
+VelocityObstacles::VelocityObstacles(float timeHorizon)
+	: m_TimeHorizon{ timeHorizon }
+{
+}
+
+void VelocityObstacles::Clear()
+{
+	m_NeighbourCount = 0;
+}
+
+bool VelocityObstacles::AddNeighbour(const Elite::Vector2& position, const Elite::Vector2& velocity, float radius)
+{
+	if (m_NeighbourCount >= m_MaxNeighbours) return false;
+
+	m_PositionX[m_NeighbourCount] = position.x;
+	m_PositionY[m_NeighbourCount] = position.y;
+	m_VelocityX[m_NeighbourCount] = velocity.x;
+	m_VelocityY[m_NeighbourCount] = velocity.y;
+	m_Radius[m_NeighbourCount] = radius;
+	++m_NeighbourCount;
+	return true;
+}
+
+Elite::Vector2 VelocityObstacles::GetSafeVelocity(const AgentInfo& agentInfo, const Elite::Vector2& preferredVelocity, float deltaT)
+{
+	if (m_NeighbourCount == 0) return preferredVelocity;
+
+	using Clock = std::chrono::steady_clock;
+	const Clock::time_point begin{ Clock::now() };
+
+	BuildLines(agentInfo, deltaT);
+
+	Elite::Vector2 result{};
+	const int failedLine{ Solve(m_Lines, m_NeighbourCount, agentInfo.MaxLinearSpeed, preferredVelocity, false, result) };
+	if (failedLine < m_NeighbourCount) SolveLeastPenetration(failedLine, agentInfo.MaxLinearSpeed, result);
+
+	++m_Evaluations;
+	m_Seconds += std::chrono::duration<double>(Clock::now() - begin).count();
+	return result;
+}
+
+float VelocityObstacles::GetAverageCost() const
+{
+	if (m_Evaluations == 0) return 0.f;
+	return float(m_Seconds / m_Evaluations);
+}
+
+void VelocityObstacles::BuildLines(const AgentInfo& agentInfo, float deltaT)
+{
+	//Both cases of the construction are computed and one is selected, so the loop has no branches.
+	//Outside the combined radius the velocity is pushed out of the truncated cone, either through its cutoff
+	//circle or over one of its legs. When already colliding it is pushed out within this frame instead.
+	const float agentX{ agentInfo.Position.x }, agentY{ agentInfo.Position.y };
+	const float agentVelocityX{ agentInfo.LinearVelocity.x }, agentVelocityY{ agentInfo.LinearVelocity.y };
+	const float agentRadius{ agentInfo.AgentSize * 0.5f };
+	const float inverseTimeHorizon{ 1.f / m_TimeHorizon }, inverseDeltaT{ 1.f / std::max<float>(deltaT, g_Epsilon) };
+	for (int i{}; i < m_NeighbourCount; ++i)
+	{
+		const float relativeX{ m_PositionX[i] - agentX }, relativeY{ m_PositionY[i] - agentY };
+		const float relativeVelocityX{ agentVelocityX - m_VelocityX[i] }, relativeVelocityY{ agentVelocityY - m_VelocityY[i] };
+		const float distanceSqrd{ relativeX * relativeX + relativeY * relativeY };
+		const float radius{ m_Radius[i] + agentRadius }, radiusSqrd{ radius * radius };
+		const bool isColliding{ distanceSqrd <= radiusSqrd };
+
+		//Cutoff circle, or the circle of this frame when colliding
+		const float inverseTime{ isColliding ? inverseDeltaT : inverseTimeHorizon };
+		const float wX{ relativeVelocityX - inverseTime * relativeX }, wY{ relativeVelocityY - inverseTime * relativeY };
+		const float wLengthSqrd{ wX * wX + wY * wY }, wLength{ sqrtf(wLengthSqrd) };
+		const float inverseWLength{ 1.f / std::max<float>(wLength, g_Epsilon) };
+		const float wDot{ wX * relativeX + wY * relativeY };
+		const bool isOnCutoff{ isColliding || (wDot < 0.f && wDot * wDot > radiusSqrd * wLengthSqrd) };
+		const float cutoffDirectionX{ wY * inverseWLength }, cutoffDirectionY{ -wX * inverseWLength };
+		const float cutoffScale{ (radius * inverseTime - wLength) * inverseWLength };
+		const float cutoffUX{ cutoffScale * wX }, cutoffUY{ cutoffScale * wY };
+
+		//Legs
+		const float leg{ sqrtf(std::max<float>(0.f, distanceSqrd - radiusSqrd)) };
+		const float inverseDistanceSqrd{ 1.f / std::max<float>(distanceSqrd, g_Epsilon) };
+		const bool isLeftLeg{ relativeX * wY - relativeY * wX > 0.f };
+		const float legDirectionX{ (isLeftLeg ? relativeX * leg - relativeY * radius : -relativeX * leg - relativeY * radius) * inverseDistanceSqrd };
+		const float legDirectionY{ (isLeftLeg ? relativeX * radius + relativeY * leg : relativeX * radius - relativeY * leg) * inverseDistanceSqrd };
+		const float legDot{ relativeVelocityX * legDirectionX + relativeVelocityY * legDirectionY };
+		const float legUX{ legDot * legDirectionX - relativeVelocityX }, legUY{ legDot * legDirectionY - relativeVelocityY };
+
+		m_DirectionX[i] = isOnCutoff ? cutoffDirectionX : legDirectionX;
+		m_DirectionY[i] = isOnCutoff ? cutoffDirectionY : legDirectionY;
+		m_PointX[i] = agentVelocityX + (isOnCutoff ? cutoffUX : legUX);
+		m_PointY[i] = agentVelocityY + (isOnCutoff ? cutoffUY : legUY);
+	}
+
+	for (int i{}; i < m_NeighbourCount; ++i)
+	{
+		m_Lines[i].point = Elite::Vector2{ m_PointX[i], m_PointY[i] };
+		m_Lines[i].direction = Elite::Vector2{ m_DirectionX[i], m_DirectionY[i] };
+	}
+}
+
+bool VelocityObstacles::SolveOnLine(const Line* pLines, int lineNo, float radius, const Elite::Vector2& optimal, bool isDirectionOptimal, Elite::Vector2& result) const
+{
+	//Part of the line within the speed circle
+	const Line& line{ pLines[lineNo] };
+	const float dot{ Elite::Dot(line.point, line.direction) };
+	const float discriminant{ dot * dot + radius * radius - line.point.SqrtMagnitude() };
+	if (discriminant < 0.f) return false;
+
+	const float discriminantRoot{ sqrtf(discriminant) };
+	float left{ -dot - discriminantRoot }, right{ -dot + discriminantRoot };
+
+	//Clipped by every line before it
+	for (int i{}; i < lineNo; ++i)
+	{
+		const float denominator{ Determinant(line.direction, pLines[i].direction) };
+		const float numerator{ Determinant(pLines[i].direction, line.point - pLines[i].point) };
+		if (abs(denominator) <= g_Epsilon)
+		{
+			if (numerator < 0.f) return false;
+			continue;
+		}
+
+		const float t{ numerator / denominator };
+		if (denominator >= 0.f) right = std::min<float>(right, t);
+		else left = std::max<float>(left, t);
+		if (left > right) return false;
+	}
+
+	if (isDirectionOptimal)
+	{
+		result = line.point + line.direction * (Elite::Dot(optimal, line.direction) > 0.f ? right : left);
+		return true;
+	}
+
+	const float t{ Elite::Dot(line.direction, optimal - line.point) };
+	result = line.point + line.direction * Elite::Clamp(t, left, right);
+	return true;
+}
+
+int VelocityObstacles::Solve(const Line* pLines, int lineCount, float radius, const Elite::Vector2& optimal, bool isDirectionOptimal, Elite::Vector2& result) const
+{
+	if (isDirectionOptimal) result = optimal * radius;
+	else if (optimal.SqrtMagnitude() > radius * radius) result = optimal.GetNormalized() * radius;
+	else result = optimal;
+
+	//Incremental: only a line the current result violates changes it, to the best point on that line
+	for (int i{}; i < lineCount; ++i)
+	{
+		if (Determinant(pLines[i].direction, pLines[i].point - result) <= 0.f) continue;
+
+		const Elite::Vector2 previousResult{ result };
+		if (!SolveOnLine(pLines, i, radius, optimal, isDirectionOptimal, result))
+		{
+			result = previousResult;
+			return i;
+		}
+	}
+	return lineCount;
+}
+
+void VelocityObstacles::SolveLeastPenetration(int failedLine, float radius, Elite::Vector2& result)
+{
+	//No velocity satisfies every line, minimize the largest violation instead by solving, per violated line,
+	//a program over the lines before it projected onto it
+	float distance{};
+	for (int i{ failedLine }; i < m_NeighbourCount; ++i)
+	{
+		const Line& line{ m_Lines[i] };
+		if (Determinant(line.direction, line.point - result) <= distance) continue;
+
+		int projectedCount{};
+		for (int j{}; j < i; ++j)
+		{
+			const Line& other{ m_Lines[j] };
+			Line projected{};
+			const float determinant{ Determinant(line.direction, other.direction) };
+			if (abs(determinant) <= g_Epsilon)
+			{
+				//Parallel lines pointing the same way never bind, opposite ones meet halfway
+				if (Elite::Dot(line.direction, other.direction) > 0.f) continue;
+				projected.point = (line.point + other.point) * 0.5f;
+			}
+			else
+			{
+				projected.point = line.point + line.direction * (Determinant(other.direction, line.point - other.point) / determinant);
+			}
+			projected.direction = (other.direction - line.direction).GetNormalized();
+			m_ProjectedLines[projectedCount++] = projected;
+		}
+
+		const Elite::Vector2 previousResult{ result };
+		if (Solve(m_ProjectedLines, projectedCount, radius, Elite::Vector2{ -line.direction.y, line.direction.x }, true, result) < projectedCount)
+		{
+			//Can only fail through rounding, the result was already optimal
+			result = previousResult;
+		}
+		distance = Determinant(line.direction, line.point - result);
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "Exam_HelperStructs.h"
+
+//Local avoidance with optimal reciprocal collision avoidance (ORCA, van den Berg et al.).
+//Every neighbour turns into a half plane of velocities that stay clear of it for the time horizon, a 2D linear
+//program then picks the allowed velocity closest to the preferred one. Zombies don't avoid the agent back,
+//so the agent takes the full avoidance effort instead of half of it.
+//Neighbours and half planes live in fixed arrays, the half planes are built without branches so that loop vectorizes.
+class VelocityObstacles final
+{
+public:
+	VelocityObstacles(float timeHorizon = 1.5f);
+	~VelocityObstacles() = default;
+	VelocityObstacles(const VelocityObstacles&) = delete;
+	VelocityObstacles& operator=(const VelocityObstacles&) = delete;
+	VelocityObstacles(VelocityObstacles&&) = delete;
+	VelocityObstacles& operator=(VelocityObstacles&&) = delete;
+
+	void Clear();
+	bool AddNeighbour(const Elite::Vector2& position, const Elite::Vector2& velocity, float radius); //False when full
+	//Closest velocity to the preferred one that avoids every neighbour, or that collides the least when none does
+	Elite::Vector2 GetSafeVelocity(const AgentInfo& agentInfo, const Elite::Vector2& preferredVelocity, float deltaT);
+
+	int GetNeighbourCount() const { return m_NeighbourCount; }
+	int GetEvaluations() const { return m_Evaluations; }
+	float GetAverageCost() const; //Seconds per evaluation
+
+private:
+	static const int m_MaxNeighbours{ 256 };
+
+	struct Line
+	{
+		Elite::Vector2 point;
+		Elite::Vector2 direction; //Allowed velocities are on the left
+	};
+
+	void BuildLines(const AgentInfo& agentInfo, float deltaT);
+	bool SolveOnLine(const Line* pLines, int lineNo, float radius, const Elite::Vector2& optimal, bool isDirectionOptimal, Elite::Vector2& result) const;
+	int Solve(const Line* pLines, int lineCount, float radius, const Elite::Vector2& optimal, bool isDirectionOptimal, Elite::Vector2& result) const;
+	void SolveLeastPenetration(int failedLine, float radius, Elite::Vector2& result);
+
+	float m_TimeHorizon{};
+
+	int m_NeighbourCount{};
+	float m_PositionX[m_MaxNeighbours]{};
+	float m_PositionY[m_MaxNeighbours]{};
+	float m_VelocityX[m_MaxNeighbours]{};
+	float m_VelocityY[m_MaxNeighbours]{};
+	float m_Radius[m_MaxNeighbours]{};
+
+	float m_PointX[m_MaxNeighbours]{};
+	float m_PointY[m_MaxNeighbours]{};
+	float m_DirectionX[m_MaxNeighbours]{};
+	float m_DirectionY[m_MaxNeighbours]{};
+	Line m_Lines[m_MaxNeighbours]{};
+	Line m_ProjectedLines[m_MaxNeighbours]{};
+
+	int m_Evaluations{};
+	double m_Seconds{};
+};
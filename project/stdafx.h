@@ -14,6 +14,7 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <climits>
 
 //mmgr specific includes
 #include <stdlib.h>
@@ -24,6 +25,7 @@
 
 #ifndef	_WIN32
 #include <unistd.h>
+typedef unsigned int UINT; //windows.h has it on Windows
 #endif
 
 using namespace std;
@@ -33,7 +35,9 @@ using namespace std;
 #include <GL/gl3w.h>
 #include <ImGui/imgui.h>
 #include <SDL2/SDL.h>
+#ifdef _WIN32
 #include <SDL2/SDL_syswm.h>
+#endif
 
 #include "EliteMath/EMath.h"
 #include "EliteInput/EInputCodes.h"